@@ -0,0 +1,39 @@
+#include "I2CTransfer.h"
+
+
+I2CTransfer myTransfer;
+
+// supplied as a reference - persistent allocation required
+const uint8_t nodes[] = { 8, 9, 10, 11 };
+
+struct __attribute__((packed)) STRUCT {
+  uint32_t timestamp;
+  float value;
+} reading;
+
+
+void setup()
+{
+  Serial.begin(115200);
+  Wire.begin();
+
+  configST myConfig;
+  myTransfer.begin(Wire, myConfig);
+  myTransfer.setPollList(nodes, sizeof(nodes));
+}
+
+
+void loop()
+{
+  // only the master drives the bus, so any number of nodes can
+  // report without arbitration - each call polls the next node
+  if(myTransfer.pollNext())
+  {
+    myTransfer.rxObj(reading);
+    Serial.print(myTransfer.currentAddress());
+    Serial.print(": ");
+    Serial.print(reading.timestamp);
+    Serial.print(" ");
+    Serial.println(reading.value);
+  }
+}
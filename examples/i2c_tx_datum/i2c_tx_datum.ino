@@ -1,28 +1,28 @@
-#include "I2CTransfer.h"
-
-
-I2CTransfer myTransfer;
-
-struct __attribute__((packed)) STRUCT {
-  char z;
-  float y;
-} testStruct;
-
-
-void setup()
-{
-  Serial.begin(115200);
-  Wire.begin();
-
-  myTransfer.begin(Wire);
-
-  testStruct.z = '$';
-  testStruct.y = 4.5;
-}
-
-
-void loop()
-{
-  myTransfer.sendDatum(testStruct);
-  delay(500);
-}
+#include "I2CTransfer.h"
+
+
+I2CTransfer myTransfer;
+
+struct __attribute__((packed)) STRUCT {
+  char z;
+  float y;
+} testStruct;
+
+
+void setup()
+{
+  Serial.begin(115200);
+  Wire.begin();
+
+  myTransfer.begin(Wire);
+
+  testStruct.z = '$';
+  testStruct.y = 4.5;
+}
+
+
+void loop()
+{
+  myTransfer.sendDatum(testStruct);
+  delay(500);
+}
@@ -0,0 +1,32 @@
+#include "I2CTransfer.h"
+
+
+I2CTransfer myTransfer;
+
+const uint8_t MY_ADDRESS = 8; // Give every sensor node its own address
+
+struct __attribute__((packed)) STRUCT {
+  uint32_t timestamp;
+  float value;
+} reading;
+
+
+void setup()
+{
+  Serial.begin(115200);
+  Wire.begin(MY_ADDRESS);
+
+  configST myConfig;
+  myTransfer.begin(Wire, myConfig);
+}
+
+
+void loop()
+{
+  reading.timestamp = millis();
+  reading.value     = analogRead(A0) * (5.0 / 1023.0);
+
+  // stays queued until the master polls this node - returns 0 if the queue is full
+  myTransfer.queueDatum(reading);
+  delay(100);
+}
@@ -1,43 +1,39 @@
-#include "SPITransfer.h"
-
-
-SPITransfer myTransfer;
-
-struct __attribute__((packed)) STRUCT {
-  char z;
-  float y;
-} testStruct;
-
-volatile bool procNewPacket = false;
-
-
-void setup()
-{
-  Serial.begin(115200);
-  
-  SPCR |= bit (SPE);
-  pinMode(MISO, OUTPUT);
-  SPI.attachInterrupt();
-  
-  myTransfer.begin(SPI);
-}
-
-
-void loop()
-{
-  if(procNewPacket)
-  {
-    procNewPacket = false;
-    
-    myTransfer.rxObj(testStruct);
-    Serial.print(testStruct.z);
-    Serial.println(testStruct.y);
-  }
-}
-
-
-ISR (SPI_STC_vect)
-{
-  if(myTransfer.available())
-    procNewPacket = true;
-}
+#include "SPITransfer.h"
+
+
+SPITransfer myTransfer;
+
+struct __attribute__((packed)) STRUCT {
+  char z;
+  float y;
+} testStruct;
+
+
+void setup()
+{
+  Serial.begin(115200);
+  
+  SPCR |= bit (SPE);
+  pinMode(MISO, OUTPUT);
+  SPI.attachInterrupt();
+  
+  configST myConfig;
+  myTransfer.beginSlave(SPI, myConfig);
+}
+
+
+void loop()
+{
+  if(myTransfer.available())
+  {
+    myTransfer.rxObj(testStruct);
+    Serial.print(testStruct.z);
+    Serial.println(testStruct.y);
+  }
+}
+
+
+ISR (SPI_STC_vect)
+{
+  SPITransfer::receiveByte(SPDR);
+}
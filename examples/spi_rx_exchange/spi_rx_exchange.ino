@@ -0,0 +1,49 @@
+#include "SPITransfer.h"
+
+
+SPITransfer myTransfer;
+
+const uint8_t READY_PIN = 9; // Driven HIGH while another packet fits in the RX ring
+
+struct __attribute__((packed)) REQUEST {
+  uint8_t channel;
+} request;
+
+struct __attribute__((packed)) READING {
+  uint8_t channel;
+  float value;
+} reading;
+
+
+void setup()
+{
+  Serial.begin(115200);
+  
+  SPCR |= bit (SPE);
+  pinMode(MISO, OUTPUT);
+  SPI.attachInterrupt();
+  
+  configST myConfig;
+  myTransfer.beginSlave(SPI, myConfig, READY_PIN);
+}
+
+
+void loop()
+{
+  if(myTransfer.available())
+  {
+    myTransfer.rxObj(request);
+
+    reading.channel = request.channel;
+    reading.value   = analogRead(A0 + request.channel) * (5.0 / 1023.0);
+
+    // queued, goes out while the master clocks in its next request
+    myTransfer.sendDatum(reading);
+  }
+}
+
+
+ISR (SPI_STC_vect)
+{
+  SPDR = SPITransfer::receiveByte(SPDR);
+}
@@ -1,32 +1,30 @@
-#include "SPITransfer.h"
-
-
-SPITransfer myTransfer;
-
-struct __attribute__((packed)) STRUCT {
-  char z;
-  float y;
-} testStruct;
-
-
-void setup()
-{
-  Serial.begin(115200);
-  while(!Serial);
-  
-  digitalWrite(SS, HIGH);
-  SPI.begin();
-  SPI.setClockDivider(SPI_CLOCK_DIV8);
-
-  myTransfer.begin(SPI);
-
-  testStruct.z = '$';
-  testStruct.y = 4.5;
-}
-
-
-void loop()
-{
-  myTransfer.sendDatum(testStruct);
-  delay(500);
-}
+#include "SPITransfer.h"
+
+
+SPITransfer myTransfer;
+
+struct __attribute__((packed)) STRUCT {
+  char z;
+  float y;
+} testStruct;
+
+
+void setup()
+{
+  Serial.begin(115200);
+  while(!Serial);
+  
+  SPI.begin();
+
+  myTransfer.begin(SPI);
+
+  testStruct.z = '$';
+  testStruct.y = 4.5;
+}
+
+
+void loop()
+{
+  myTransfer.sendDatum(testStruct);
+  delay(500);
+}
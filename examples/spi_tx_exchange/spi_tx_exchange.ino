@@ -0,0 +1,47 @@
+#include "SPITransfer.h"
+
+
+SPITransfer myTransfer;
+
+const uint8_t READY_PIN = 9; // Driven HIGH by the slave while it can take another packet
+
+struct __attribute__((packed)) REQUEST {
+  uint8_t channel;
+} request;
+
+struct __attribute__((packed)) READING {
+  uint8_t channel;
+  float value;
+} reading;
+
+
+void setup()
+{
+  Serial.begin(115200);
+
+  SPI.begin();
+
+  configST myConfig;
+  myTransfer.begin(SPI, myConfig, SS, READY_PIN);
+
+  request.channel = 0;
+}
+
+
+void loop()
+{
+  // the reading clocked in while the request goes out answers the
+  // previous request - the slave queues it once it has parsed that one
+  myTransfer.txObj(request);
+
+  if(myTransfer.exchange(sizeof(request)))
+  {
+    myTransfer.rxObj(reading);
+    Serial.print(reading.channel);
+    Serial.print(": ");
+    Serial.println(reading.value);
+  }
+
+  request.channel = (request.channel + 1) % 4;
+  delay(10);
+}
@@ -1,35 +1,45 @@
-#include "SerialTransfer.h"
-
-
-SerialTransfer myTransfer;
-
-const int fileSize = 2000;
-char file[fileSize];
-char fileName[10];
-
-
-void setup()
-{
-  Serial.begin(115200);
-  Serial1.begin(115200);
-  
-  myTransfer.begin(Serial1);
-}
-
-
-void loop()
-{
-  if (myTransfer.available())
-  {
-    if (!myTransfer.currentPacketID())
-    {
-      myTransfer.rxObj(fileName);
-      Serial.println();
-      Serial.println(fileName);
-    }
-    else if (myTransfer.currentPacketID() == 1)
-      for(uint8_t i=2; i<myTransfer.bytesRead; i++)
-        Serial.print((char)myTransfer.packet.rxBuff[i]);
-    Serial.println();
-  }
-}
\ No newline at end of file
+#include "SerialTransfer.h"
+
+
+SerialTransfer myTransfer;
+
+const int fileSize = 2000;
+char file[fileSize];
+char fileName[10];
+
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial1.begin(115200);
+
+  ///////////////////////////////////////////////////////////////// Config Parameters
+  configST myConfig;
+  myConfig.debug          = true;
+  myConfig.messageBuff    = (uint8_t*)file; // Fragments are reassembled here, in any order
+  myConfig.messageBuffLen = fileSize;
+  myConfig.flowWindow     = 64;             // Size of this board's UART RX buffer, advertised to the sender
+  /////////////////////////////////////////////////////////////////
+  
+  myTransfer.begin(Serial1, myConfig);
+}
+
+
+void loop()
+{
+  if (myTransfer.available())
+  {
+    if (myTransfer.status == NEW_MESSAGE)
+    {
+      for(uint32_t i=0; i<myTransfer.currentMessageLen(); i++)
+        Serial.print(file[i]);
+      Serial.println();
+    }
+    else
+    {
+      myTransfer.rxObj(fileName);
+      Serial.println();
+      Serial.println(fileName);
+    }
+  }
+}
@@ -0,0 +1,35 @@
+#include "ReliableTransfer.h"
+
+
+SerialTransfer   myTransfer;
+ReliableTransfer myLink;
+
+struct __attribute__((packed)) STRUCT {
+  uint32_t count;
+  float reading;
+} testStruct;
+
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial1.begin(115200);
+
+  myTransfer.begin(Serial1);
+  myLink.begin(myTransfer);
+}
+
+
+void loop()
+{
+  // Payloads are delivered exactly once and in order, lost ones are retransmitted by the sender
+  if (myLink.available())
+  {
+    myLink.rxObj(testStruct);
+    Serial.print(testStruct.count);
+    Serial.print(" | ");
+    Serial.print(testStruct.reading);
+    Serial.print(" | RTT ");
+    Serial.println(myLink.smoothedRTT());
+  }
+}
@@ -0,0 +1,44 @@
+#include "SerialTransfer.h"
+
+
+SerialTransfer myTransfer;
+
+
+/////////////////////////////////////////////////////////////////// Callbacks
+void chunk(const uint8_t data[], const uint16_t& len, const uint32_t& offset)
+{
+  // data points straight into the receive buffer - consume it before returning
+  for (uint16_t i=0; i<len; i++)
+    Serial.print((char)data[i]);
+}
+
+void complete(const uint32_t& messageLen)
+{
+  Serial.println();
+  Serial.print("Received ");
+  Serial.print(messageLen);
+  Serial.println(" bytes");
+}
+///////////////////////////////////////////////////////////////////
+
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial1.begin(115200);
+
+  ///////////////////////////////////////////////////////////////// Config Parameters
+  configST myConfig;
+  myConfig.debug           = true;
+  myConfig.chunkCallback   = chunk;
+  myConfig.messageCallback = complete;
+  /////////////////////////////////////////////////////////////////
+  
+  myTransfer.begin(Serial1, myConfig);
+}
+
+
+void loop()
+{
+  myTransfer.tick();
+}
@@ -0,0 +1,34 @@
+#include "ReliableTransfer.h"
+
+
+SerialTransfer   myTransfer;
+ReliableTransfer myLink;
+
+struct __attribute__((packed)) STRUCT {
+  uint32_t count;
+  float reading;
+} testStruct;
+
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial1.begin(115200);
+
+  myTransfer.begin(Serial1);
+  myLink.begin(myTransfer); // Both ends must use the same window size
+}
+
+
+void loop()
+{
+  // Keep the window full - sendDatum() returns 0 while RELIABLE_WINDOW_SIZE packets are unacknowledged
+  if (myLink.sendDatum(testStruct))
+  {
+    testStruct.count++;
+    testStruct.reading = analogRead(A0) * 5.0 / 1023.0;
+  }
+
+  // Processes ACKs and retransmits lost packets
+  myLink.tick();
+}
@@ -0,0 +1,239 @@
+/*
+ bridge_bench.cpp
+ Description:
+ ------------
+  * Host benchmark for SerialBridge. Simulated UARTs move one byte per
+  "byte time" from one or two devices through a hub to a host, either
+  relayed by SerialBridge (cut-through) or received and re-sent by a
+  pair of SerialTransfers (store-and-forward). Every CORRUPT_EVERY-th
+  frame has a payload bit flipped on the device link. Reports
+  delivered/corrupt frames, errors caught by the hub and mean
+  device-to-host latency in byte times as CSV
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/bridge_bench.cpp src/Packet.cpp src/SerialTransfer.cpp src/SerialBridge.cpp extras/host/Arduino.cpp -o bridge_bench
+*/
+#include "Arduino.h"
+#include "SerialBridge.h"
+#include "SerialTransfer.h"
+#include <deque>
+
+
+const uint16_t PAYLOAD_LENS[] = {16, 64, 250, 1000};
+const uint32_t FRAMES         = 2000; // Per device and run
+const uint32_t CORRUPT_EVERY  = 50;
+const uint8_t  MAX_DEVICES    = 2;
+
+
+/*
+ class WireStream
+ Description:
+ ------------
+  * One end of a simulated UART. Bytes written are queued and reach the
+  peer's end one per tick()
+*/
+class WireStream : public Stream
+{
+  public: // <<---------------------------------------//public
+	WireStream*         peer = NULL;
+	std::deque<uint8_t> txQueue;
+	std::deque<uint8_t> rxFifo;
+
+
+	int available()
+	{
+		return rxFifo.size();
+	}
+
+	int read()
+	{
+		if (rxFifo.empty())
+			return -1;
+
+		uint8_t val = rxFifo.front();
+		rxFifo.pop_front();
+
+		return val;
+	}
+
+	int peek()
+	{
+		return rxFifo.empty() ? -1 : rxFifo.front();
+	}
+
+	size_t write(uint8_t val)
+	{
+		txQueue.push_back(val);
+		return 1;
+	}
+
+	void tick()
+	{
+		if (txQueue.empty())
+			return;
+
+		peer->rxFifo.push_back(txQueue.front());
+		txQueue.pop_front();
+	}
+
+	using Print::write;
+};
+
+
+/*
+ void connect(WireStream& a, WireStream& b)
+ Description:
+ ------------
+  * Joins two ends into a full duplex link
+*/
+void connect(WireStream& a, WireStream& b)
+{
+	a.peer = &b;
+	b.peer = &a;
+}
+
+
+/*
+ void run(const bool cutThrough, const uint8_t& numDevices, const uint16_t& len)
+ Description:
+ ------------
+  * Sends FRAMES frames of "len" payload bytes from every device, one
+  at a time per device, and prints a CSV row
+*/
+void run(const bool cutThrough, const uint8_t& numDevices, const uint16_t& len)
+{
+	WireStream     devPort[MAX_DEVICES];
+	WireStream     hubDown[MAX_DEVICES];
+	WireStream     hubUp;
+	WireStream     hostPort;
+	SerialTransfer device[MAX_DEVICES];
+	SerialBridge   bridge[MAX_DEVICES];
+	SerialTransfer hubRx[MAX_DEVICES];
+	SerialTransfer hubTx;
+	SerialTransfer host;
+	configST       config;
+
+	uint32_t sent[MAX_DEVICES]     = {0};
+	uint32_t sentAt[MAX_DEVICES]   = {0};
+	bool     inFlight[MAX_DEVICES] = {false};
+	bool     damaged[MAX_DEVICES]  = {false};
+	uint32_t delivered = 0;
+	uint32_t corrupt   = 0;
+	uint32_t lost      = 0;
+	uint32_t hubErrors = 0;
+	double   latency   = 0;
+
+	config.debug   = 0;
+	config.timeout = 1000;
+
+	connect(hubUp, hostPort);
+	hubTx.begin(hubUp, config);
+	host.begin(hostPort, config);
+
+	for (uint8_t d = 0; d < numDevices; d++)
+	{
+		connect(devPort[d], hubDown[d]);
+		device[d].begin(devPort[d], config);
+
+		if (cutThrough)
+		{
+			bridge[d].begin(hubDown[d], config);
+			bridge[d].routeID(hubUp, d);
+		}
+		else
+			hubRx[d].begin(hubDown[d], config);
+	}
+
+	for (uint32_t now = 0; ; now++)
+	{
+		bool busy = false;
+
+		for (uint8_t d = 0; d < numDevices; d++)
+		{
+			if (!inFlight[d] && (sent[d] < FRAMES))
+			{
+				memset(device[d].packet.txBuff, (uint8_t)sent[d], len);
+				device[d].txObj(sent[d]);
+				device[d].sendData(len, 1, d);
+
+				damaged[d] = !(sent[d] % CORRUPT_EVERY);
+
+				if (damaged[d])
+					devPort[d].txQueue[PREAMBLE_SIZE + 5] ^= 0x01;
+
+				sentAt[d]   = now;
+				inFlight[d] = true;
+				sent[d]++;
+			}
+
+			busy |= inFlight[d];
+			devPort[d].tick();
+		}
+
+		if (!busy)
+			break;
+
+		for (uint8_t d = 0; d < numDevices; d++)
+		{
+			if (cutThrough)
+				bridge[d].available();
+			else if (hubRx[d].available())
+			{
+				memcpy(hubTx.packet.txBuff, hubRx[d].packet.rxBuff, hubRx[d].bytesRead);
+				hubTx.sendData(hubRx[d].bytesRead, hubRx[d].currentCommand(), hubRx[d].currentPacketID());
+			}
+			else if (hubRx[d].status == CRC_ERROR)
+				hubErrors++;
+		}
+
+		hubUp.tick();
+
+		if (host.available())
+		{
+			uint8_t  d = host.currentPacketID();
+			uint32_t seq;
+
+			host.rxObj(seq);
+
+			if ((host.bytesRead != len) || (seq != (sent[d] - 1)) || damaged[d])
+				corrupt++;
+			else
+				delivered++;
+
+			latency += now - sentAt[d];
+			inFlight[d] = false;
+		}
+
+		for (uint8_t d = 0; d < numDevices; d++) // Frames that never arrive are given up on
+		{
+			if (inFlight[d] && ((now - sentAt[d]) > (uint32_t)(numDevices + 2) * (len + PREAMBLE_SIZE + POSTAMBLE_SIZE)))
+			{
+				if (!damaged[d])
+					lost++;
+
+				inFlight[d] = false;
+			}
+		}
+	}
+
+	if (cutThrough)
+		for (uint8_t d = 0; d < numDevices; d++)
+			hubErrors += bridge[d].forwardErrors;
+
+	printf("%s,%u,%u,%u,%u,%u,%u,%u,%.1f\n", cutThrough ? "cut_through" : "store_and_forward", numDevices, len, FRAMES * numDevices, delivered, corrupt, lost, hubErrors, (delivered + corrupt) ? latency / (delivered + corrupt) : 0);
+}
+
+
+int main()
+{
+	printf("mode,devices,payload_len,frames,delivered,corrupt_delivered,lost,hub_errors,latency_byte_times\n");
+
+	for (uint8_t i = 0; i < (sizeof(PAYLOAD_LENS) / sizeof(PAYLOAD_LENS[0])); i++)
+		for (uint8_t devices = 1; devices <= MAX_DEVICES; devices++)
+		{
+			run(false, devices, PAYLOAD_LENS[i]);
+			run(true, devices, PAYLOAD_LENS[i]);
+		}
+
+	return 0;
+}
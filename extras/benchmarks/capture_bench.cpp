@@ -0,0 +1,159 @@
+/*
+ capture_bench.cpp
+ Description:
+ ------------
+  * Host benchmark of PacketCapture. Sends packets between two
+  SerialTransfers over an in-process LoopbackChannel with capture off
+  and on (into a Stream that only counts bytes), reporting receive
+  cost per frame and capture size per frame as CSV. Given a file name,
+  also captures the receiving end of a link with bit errors there,
+  for extras/tools/capture_replay.cpp
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/capture_bench.cpp src/Packet.cpp src/PacketCapture.cpp src/SerialTransfer.cpp src/LoopbackStream.cpp extras/host/Arduino.cpp -o capture_bench -lpthread
+ Usage:
+ ------
+  * capture_bench [capture.bin] && capture_replay capture.bin
+*/
+#include "Arduino.h"
+#include "LoopbackStream.h"
+#include "PacketCapture.h"
+#include "SerialTransfer.h"
+#include <stdio.h>
+
+
+const uint32_t FRAMES = 20000;
+const uint16_t LEN    = 64;
+const uint16_t BATCH  = 8; // Packets sent before the receiver drains them - an error flushes whatever is queued
+
+
+/*
+ class FileStream
+ Description:
+ ------------
+  * Write-only Stream into a file, or a byte counter if there is none
+*/
+class FileStream : public Stream
+{
+  public: // <<---------------------------------------//public
+	FILE*  file;
+	size_t count = 0;
+
+
+	FileStream(FILE* _file = NULL) : file(_file)
+	{
+	}
+
+	int available()
+	{
+		return 0;
+	}
+
+	int read()
+	{
+		return -1;
+	}
+
+	int peek()
+	{
+		return -1;
+	}
+
+	size_t write(uint8_t val)
+	{
+		return write(&val, 1);
+	}
+
+	size_t write(const uint8_t* buffer, size_t size)
+	{
+		count += size;
+
+		return file ? fwrite(buffer, 1, size, file) : size;
+	}
+};
+
+
+/*
+ void run(const char* scenario, PacketCapture* capture, FileStream* out, const double& ber)
+ Description:
+ ------------
+  * Sends FRAMES packets and prints a CSV row
+*/
+void run(const char* scenario, PacketCapture* capture, FileStream* out, const double& ber)
+{
+	LoopbackChannel* link = new LoopbackChannel;
+	loopbackConfigST linkConfig;
+	SerialTransfer   tx;
+	SerialTransfer   rx;
+	configST         config;
+	uint32_t         good = 0;
+
+	linkConfig.ber = ber;
+	link->begin(linkConfig);
+
+	config.debug = 0;
+	tx.begin(link->a, config);
+
+	if (capture)
+	{
+		out->count = 0;
+		capture->begin(*out);
+	}
+
+	config.capture = capture;
+	rx.begin(link->b, config);
+
+	uint32_t start = micros();
+
+	for (uint32_t sent = 0; sent < FRAMES;)
+	{
+		for (uint16_t i = 0; (i < BATCH) && (sent < FRAMES); i++, sent++)
+		{
+			memset(tx.packet.txBuff, sent, LEN);
+			tx.sendData(LEN);
+		}
+
+		while (link->b.available())
+			if (rx.available() && (rx.status == NEW_DATA))
+				good++;
+	}
+
+	double elapsed = micros() - start;
+
+	printf("%s,%g,%u,%.1f,%.1f\n", scenario, ber, good, (elapsed * 1000) / FRAMES, out ? ((double)out->count / FRAMES) : 0);
+
+	delete link;
+}
+
+
+int main(int argc, char* argv[])
+{
+	PacketCapture capture;
+	FileStream    counter;
+
+	printf("capture,ber,frames_ok,ns_per_frame,capture_bytes_per_frame\n");
+
+	run("off", NULL, NULL, 0);
+	run("on", &capture, &counter, 0);
+	run("off", NULL, NULL, 1e-4);
+	run("on", &capture, &counter, 1e-4);
+
+	if (argc > 1)
+	{
+		FILE* file = fopen(argv[1], "wb");
+
+		if (!file)
+		{
+			perror(argv[1]);
+			return 1;
+		}
+
+		FileStream out(file);
+
+		run("file", &capture, &out, 1e-4);
+		fclose(file);
+		printf("\n%u capture bytes written to %s\n", (uint32_t)out.count, argv[1]);
+	}
+
+	return 0;
+}
@@ -0,0 +1,430 @@
+/*
+ channel_bench.cpp
+ Description:
+ ------------
+  * Deterministic channel simulation. Two SerialTransfer endpoints are
+  joined by a virtual serial line running on VirtualClock (us), with
+  configurable bandwidth, bit-error rate, error bursts, byte drops and
+  byte duplication, all drawn from a seeded generator so every run
+  gives the same numbers. The sender keeps the line saturated with
+  numbered, pseudo-random payloads and the receiver checks each packet
+  it accepts. Each scenario prints one CSV row:
+   * goodput_Bps - Intact, first-time payload bytes per simulated second
+   * efficiency - goodput_Bps / line bandwidth
+   * frame_loss - Fraction of packets sent that never arrived intact
+   * false_accept - Fraction of packets accepted with a wrong payload
+   (the CRC missed the damage)
+   * resync_mean_us/resync_max_us - Line time between the last damaged
+   byte and the start of the next packet accepted
+  Compare packet sizes, FEC parity and stale-packet timeouts (the
+  receiver's resync strategy) by editing SCENARIOS
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/channel_bench.cpp src/Packet.cpp src/PacketFEC.cpp src/SerialTransfer.cpp extras/host/Arduino.cpp -o channel_bench
+*/
+#include "Arduino.h"
+#include "PacketFEC.h"
+#include "SerialTransfer.h"
+#include <deque>
+
+
+const uint32_t PACKETS = 2000; // Sent per scenario
+
+
+struct simConfigST
+{
+	uint32_t bandwidth = 100000; // Bytes per second
+	double   ber       = 0;      // Probability of each bit being flipped
+	double   burstRate = 0;      // Probability of each byte starting an error burst
+	uint16_t burstLen  = 0;      // Bytes replaced with noise per burst
+	double   dropRate  = 0;      // Probability of each byte being lost
+	double   dupRate   = 0;      // Probability of each byte arriving twice
+	uint32_t seed      = 1;
+};
+
+
+struct scenarioST
+{
+	const char* name;
+	simConfigST channel;
+	uint16_t    len;     // Payload bytes per packet
+	uint8_t     parity;  // FEC parity bytes, 0 = off
+	uint32_t    timeout; // Receiver's stale packet timeout in us, 0 = none
+};
+
+
+/*
+ class SimPipe
+ Description:
+ ------------
+  * One direction of the virtual line. Bytes are impaired as they are
+  written and become readable once the simulated line has carried them
+*/
+class SimPipe
+{
+  public: // <<---------------------------------------//public
+	uint32_t lastHit  = 0;     // Arrival tick of the last damaged, dropped or duplicated byte
+	bool     hit      = false; // Whether or not lastHit was set
+	double   lineFree = 0;     // Tick the line finishes sending what was written so far
+
+
+	void begin(const simConfigST& _config)
+	{
+		config   = _config;
+		rng      = config.seed ? config.seed : 1;
+		burst    = 0;
+		lineFree = 0;
+		hit      = false;
+		queue.clear();
+	}
+
+	void write(uint8_t val)
+	{
+		double now = VirtualClock::now();
+
+		if (lineFree < now)
+			lineFree = now;
+
+		lineFree += 1000000.0 / config.bandwidth;
+
+		bool damaged = false;
+
+		if (!burst && (uniform() < config.burstRate))
+			burst = config.burstLen;
+
+		if (burst)
+		{
+			val = next();
+			burst--;
+			damaged = true;
+		}
+
+		for (uint8_t bit = 0; (bit < 8) && config.ber; bit++)
+		{
+			if (uniform() < config.ber)
+			{
+				val    ^= 1 << bit;
+				damaged = true;
+			}
+		}
+
+		uint32_t arrival = lineFree;
+
+		if (config.dropRate && (uniform() < config.dropRate))
+		{
+			markHit(arrival);
+			return;
+		}
+
+		queue.push_back({val, arrival});
+
+		if (config.dupRate && (uniform() < config.dupRate))
+		{
+			queue.push_back({val, arrival});
+			damaged = true;
+		}
+
+		if (damaged)
+			markHit(arrival);
+	}
+
+	int available()
+	{
+		uint32_t now   = VirtualClock::now();
+		int      count = 0;
+
+		for (std::deque<SimByte>::iterator it = queue.begin(); (it != queue.end()) && ((int32_t)(now - it->arrival) >= 0); it++)
+			count++;
+
+		return count;
+	}
+
+	int read()
+	{
+		if (!available())
+			return -1;
+
+		uint8_t val = queue.front().val;
+		queue.pop_front();
+
+		return val;
+	}
+
+	int peek()
+	{
+		return available() ? queue.front().val : -1;
+	}
+
+
+  private: // <<---------------------------------------//private
+	struct SimByte
+	{
+		uint8_t  val;
+		uint32_t arrival;
+	};
+
+	simConfigST          config;
+	std::deque<SimByte>  queue;
+	uint32_t             rng   = 1;
+	uint16_t             burst = 0; // Bytes left in the current burst
+
+
+	uint32_t next()
+	{
+		rng ^= rng << 13; // xorshift32
+		rng ^= rng >> 17;
+		rng ^= rng << 5;
+
+		return rng;
+	}
+
+	double uniform()
+	{
+		return next() / 4294967296.0;
+	}
+
+	void markHit(const uint32_t& arrival)
+	{
+		lastHit = arrival;
+		hit     = true;
+	}
+};
+
+
+/*
+ class SimStream
+ Description:
+ ------------
+  * One end of the virtual line
+*/
+class SimStream : public Stream
+{
+  public: // <<---------------------------------------//public
+	SimPipe* rx = NULL;
+	SimPipe* tx = NULL;
+
+
+	int available()
+	{
+		return rx->available();
+	}
+
+	int read()
+	{
+		return rx->read();
+	}
+
+	int peek()
+	{
+		return rx->peek();
+	}
+
+	size_t write(uint8_t val)
+	{
+		tx->write(val);
+		return 1;
+	}
+
+	using Print::write;
+};
+
+
+/*
+ void fill(uint8_t arr[], const uint16_t& len, const uint32_t& seq)
+ Description:
+ ------------
+  * Writes the payload of packet "seq": its number, then bytes only that
+  number produces
+*/
+void fill(uint8_t arr[], const uint16_t& len, const uint32_t& seq)
+{
+	uint32_t state = (seq * 2654435761u) | 1;
+
+	for (uint16_t i = 0; i < len; i++)
+	{
+		if (i < 4)
+		{
+			arr[i] = (seq >> (8 * (3 - i))) & 0xFF;
+			continue;
+		}
+
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		arr[i] = state;
+	}
+}
+
+
+/*
+ void run(const scenarioST& scenario)
+ Description:
+ ------------
+  * Simulates one scenario and prints its CSV row
+*/
+void run(const scenarioST& scenario)
+{
+	static uint8_t expected[MAX_PACKET_SIZE];
+	SimPipe        aToB;
+	SimPipe        bToA;
+	SimStream      a;
+	SimStream      b;
+	SerialTransfer tx;
+	SerialTransfer rx;
+	PacketFEC      fec(scenario.parity ? scenario.parity : 1);
+	configST       config;
+	simConfigST    quiet;
+	uint8_t*       seen = new uint8_t[PACKETS]();
+
+	VirtualClock::set(0);
+
+	aToB.begin(scenario.channel);
+	bToA.begin(quiet);
+	a.rx = &bToA;
+	a.tx = &aToB;
+	b.rx = &aToB;
+	b.tx = &bToA;
+
+	config.debug   = 0;
+	config.clock   = VirtualClock::now;
+	config.timeout = scenario.timeout ? scenario.timeout : __UINT32_MAX__;
+	config.fec     = scenario.parity ? &fec : NULL;
+	tx.begin(a, config);
+	rx.begin(b, config);
+
+	uint16_t len       = (scenario.len < rx.packet.maxPayload()) ? scenario.len : rx.packet.maxPayload();
+	uint32_t sent      = 0;
+	uint32_t good      = 0;
+	uint32_t dups      = 0;
+	uint32_t wrong     = 0;
+	uint32_t resyncs   = 0;
+	double   resyncSum = 0;
+	uint32_t resyncMax = 0;
+	uint32_t lastGood  = 0; // Arrival tick of the last packet accepted
+	double   step      = 1000000.0 / scenario.channel.bandwidth;
+	double   frameTime = (PREAMBLE_SIZE + (scenario.parity ? fec.encodedLen(len) : len) + POSTAMBLE_SIZE) * step;
+	double   clock     = 0;
+
+	while ((sent < PACKETS) || (clock < (aToB.lineFree + frameTime))) // Then one more packet time to drain the line
+	{
+		if ((sent < PACKETS) && (aToB.lineFree <= (clock + step)))
+		{
+			fill(tx.packet.txBuff, len, sent);
+			tx.sendData(len);
+			sent++;
+		}
+
+		clock += step;
+		VirtualClock::set((uint32_t)clock);
+
+		if (!rx.available() || (rx.status != NEW_DATA))
+			continue;
+
+		uint32_t seq = ((uint32_t)rx.packet.rxBuff[0] << 24) | ((uint32_t)rx.packet.rxBuff[1] << 16) | ((uint32_t)rx.packet.rxBuff[2] << 8) | rx.packet.rxBuff[3];
+
+		fill(expected, len, seq);
+
+		if ((rx.bytesRead != len) || (seq >= PACKETS) || memcmp(expected, rx.packet.rxBuff, len))
+		{
+			wrong++;
+			continue;
+		}
+
+		if (seen[seq])
+		{
+			dups++;
+			continue;
+		}
+
+		seen[seq] = 1;
+		good++;
+
+		uint32_t startTick = VirtualClock::now() - (uint32_t)frameTime;
+
+		if (aToB.hit && ((int32_t)(aToB.lastHit - lastGood) > 0) && ((int32_t)(startTick - aToB.lastHit) > 0))
+		{
+			uint32_t resync = startTick - aToB.lastHit;
+
+			resyncSum += resync;
+			resyncs++;
+
+			if (resync > resyncMax)
+				resyncMax = resync;
+		}
+
+		lastGood = VirtualClock::now();
+	}
+
+	double seconds = clock / 1000000;
+	double goodput = (good * (double)len) / seconds;
+
+	printf("%s,%u,%u,%u,%u,%u,%u,%u,%.0f,%.3f,%.4f,%.4f,%.0f,%u\n",
+	       scenario.name,
+	       len,
+	       scenario.parity,
+	       scenario.timeout,
+	       sent,
+	       good,
+	       dups,
+	       wrong,
+	       goodput,
+	       goodput / scenario.channel.bandwidth,
+	       1 - ((double)good / sent),
+	       (good + dups + wrong) ? ((double)wrong / (good + dups + wrong)) : 0,
+	       resyncs ? (resyncSum / resyncs) : 0,
+	       resyncMax);
+
+	delete[] seen;
+}
+
+
+/*
+ simConfigST channel(const double& ber, const double& burstRate, const uint16_t& burstLen, const double& dropRate, const double& dupRate)
+ Description:
+ ------------
+  * Shorthand for a 100 kB/s line with the given impairments
+*/
+simConfigST channel(const double& ber, const double& burstRate, const uint16_t& burstLen, const double& dropRate, const double& dupRate)
+{
+	simConfigST config;
+
+	config.ber       = ber;
+	config.burstRate = burstRate;
+	config.burstLen  = burstLen;
+	config.dropRate  = dropRate;
+	config.dupRate   = dupRate;
+
+	return config;
+}
+
+
+int main()
+{
+	const scenarioST SCENARIOS[] = {
+		{"clean",     channel(0, 0, 0, 0, 0),        64,  0, 0},
+		{"ber_1e-4",  channel(1e-4, 0, 0, 0, 0),     16,  0, 0},
+		{"ber_1e-4",  channel(1e-4, 0, 0, 0, 0),     64,  0, 0},
+		{"ber_1e-4",  channel(1e-4, 0, 0, 0, 0),     254, 0, 0},
+		{"ber_1e-4",  channel(1e-4, 0, 0, 0, 0),     254, 8, 0},
+		{"ber_1e-3",  channel(1e-3, 0, 0, 0, 0),     64,  0, 0},
+		{"ber_1e-3",  channel(1e-3, 0, 0, 0, 0),     64,  8, 0},
+		{"ber_1e-3",  channel(1e-3, 0, 0, 0, 0),     64,  0, 2000},
+		{"bursts_8",  channel(0, 1e-4, 8, 0, 0),     64,  0, 0},
+		{"bursts_8",  channel(0, 1e-4, 8, 0, 0),     64,  16, 0},
+		{"bursts_8",  channel(0, 1e-4, 8, 0, 0),     64,  0, 2000},
+		{"drops",     channel(0, 0, 0, 1e-4, 0),     64,  0, 0},
+		{"drops",     channel(0, 0, 0, 1e-4, 0),     64,  0, 2000},
+		{"drops",     channel(0, 0, 0, 1e-4, 0),     254, 0, 5000},
+		{"dups",      channel(0, 0, 0, 0, 1e-4),     64,  0, 0},
+		{"dups",      channel(0, 0, 0, 0, 1e-4),     64,  0, 2000},
+		{"noisy",     channel(1e-2, 0, 0, 0, 0),     64,  0, 2000},
+		{"everything", channel(1e-4, 1e-4, 8, 1e-4, 1e-4), 64, 8, 2000},
+	};
+
+	printf("scenario,payload_bytes,fec_parity,timeout_us,sent,delivered,duplicates,corrupt,goodput_Bps,efficiency,frame_loss,false_accept,resync_mean_us,resync_max_us\n");
+
+	for (uint8_t i = 0; i < (sizeof(SCENARIOS) / sizeof(SCENARIOS[0])); i++)
+		run(SCENARIOS[i]);
+
+	return 0;
+}
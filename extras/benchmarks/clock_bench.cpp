@@ -0,0 +1,179 @@
+/*
+ clock_bench.cpp
+ Description:
+ ------------
+  * Host benchmark of the Packet clock source. Parses a stream of
+  frames byte by byte and in blocks with the millis(), micros() and
+  VirtualClock time sources, reporting clock reads and parse cost per
+  frame as CSV. Then checks that a packet stalled past its timeout is
+  dropped at exactly the same tick on every run under VirtualClock
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/clock_bench.cpp src/Packet.cpp extras/host/Arduino.cpp -o clock_bench
+*/
+#include "Arduino.h"
+#include "Packet.h"
+
+
+const uint16_t LEN    = 64;
+const uint32_t FRAMES = 20000;
+const uint16_t BLOCK  = 64; // Bytes per parse() call in block mode, like one SerialTransfer read chunk
+
+
+clockFunctionPtr timedClock = clockMillis;
+uint32_t         clockReads = 0;
+
+
+/*
+ uint32_t countedClock()
+ Description:
+ ------------
+  * Forwards to timedClock, counting every read
+*/
+uint32_t countedClock()
+{
+	clockReads++;
+
+	return timedClock();
+}
+
+
+/*
+ uint16_t buildFrame(uint8_t wire[])
+ Description:
+ ------------
+  * Writes one LEN byte frame into wire[] and returns its length
+*/
+uint16_t buildFrame(uint8_t wire[])
+{
+	Packet   tx;
+	configST config;
+
+	config.debug = 0;
+	tx.begin(config);
+
+	for (uint16_t i = 0; i < LEN; i++)
+		tx.txBuff[i] = i;
+
+	uint16_t len = tx.constructPacket(LEN);
+
+	memcpy(wire, tx.preamble, PREAMBLE_SIZE);
+	memcpy(wire + PREAMBLE_SIZE, tx.txPayload, len);
+	memcpy(wire + PREAMBLE_SIZE + len, tx.postamble, POSTAMBLE_SIZE);
+
+	return PREAMBLE_SIZE + len + POSTAMBLE_SIZE;
+}
+
+
+/*
+ void bench(const char* name, const clockFunctionPtr& source, const bool& block)
+ Description:
+ ------------
+  * Parses FRAMES frames with "source" as the clock and prints a CSV row
+*/
+void bench(const char* name, const clockFunctionPtr& source, const bool& block)
+{
+	static uint8_t wire[MAX_PACKET_SIZE + PREAMBLE_SIZE + POSTAMBLE_SIZE];
+	uint16_t       wireLen = buildFrame(wire);
+	Packet         rx;
+	configST       config;
+	uint32_t       good = 0;
+
+	config.debug   = 0;
+	config.timeout = __UINT32_MAX__; // Only the cost of reading the clock is measured here
+	config.clock   = countedClock;
+	rx.begin(config);
+
+	timedClock = source;
+	clockReads = 0;
+
+	uint32_t start = micros();
+
+	for (uint32_t n = 0; n < FRAMES; n++)
+	{
+		if (block)
+		{
+			for (uint16_t offset = 0; offset < wireLen;)
+			{
+				uint16_t len = ((wireLen - offset) < BLOCK) ? (wireLen - offset) : BLOCK;
+				uint16_t consumed;
+
+				while (len)
+				{
+					if (rx.parse(wire + offset, len, consumed))
+						good++;
+
+					offset += consumed;
+					len    -= consumed;
+				}
+			}
+		}
+		else
+		{
+			for (uint16_t i = 0; i < wireLen; i++)
+				if (rx.parse(wire[i]))
+					good++;
+		}
+	}
+
+	double elapsed = micros() - start;
+
+	printf("%s,%s,%u,%.2f,%.1f\n", name, block ? "block" : "byte", good, (double)clockReads / FRAMES, (elapsed * 1000) / FRAMES);
+}
+
+
+/*
+ uint32_t staleTick()
+ Description:
+ ------------
+  * Feeds half a frame, then one byte per virtual ms until the parser
+  reports the packet stale. Returns the tick it happened at
+*/
+uint32_t staleTick()
+{
+	static uint8_t wire[MAX_PACKET_SIZE + PREAMBLE_SIZE + POSTAMBLE_SIZE];
+	uint16_t       wireLen = buildFrame(wire);
+	Packet         rx;
+	configST       config;
+
+	config.debug   = 0;
+	config.timeout = DEFAULT_TIMEOUT;
+	config.clock   = VirtualClock::now;
+	rx.begin(config);
+
+	VirtualClock::set(__UINT32_MAX__ - 10); // Start just short of a wrap-around
+
+	for (uint16_t i = 0; i < (wireLen / 2); i++)
+		rx.parse(wire[i]);
+
+	for (uint32_t tick = 0; tick < (10 * DEFAULT_TIMEOUT); tick++)
+	{
+		VirtualClock::advance(1);
+		rx.parse(0, false);
+
+		if (rx.status == STALE_PACKET_ERROR)
+			return tick + 1;
+	}
+
+	return 0;
+}
+
+
+int main()
+{
+	printf("clock,mode,frames_ok,clock_reads_per_frame,ns_per_frame\n");
+
+	bench("millis", clockMillis, false);
+	bench("millis", clockMillis, true);
+	bench("micros", clockMicros, false);
+	bench("micros", clockMicros, true);
+	bench("virtual", VirtualClock::now, false);
+	bench("virtual", VirtualClock::now, true);
+
+	uint32_t first  = staleTick();
+	uint32_t second = staleTick();
+
+	printf("\nstale_after_ticks,%u,%u,%s\n", first, second, ((first == DEFAULT_TIMEOUT) && (first == second)) ? "deterministic" : "MISMATCH");
+
+	return 0;
+}
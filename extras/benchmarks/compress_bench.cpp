@@ -0,0 +1,283 @@
+/*
+ compress_bench.cpp
+ Description:
+ ------------
+  * Host benchmark of PacketCompressor. Splits streams of text, log
+  lines, binary sensor records and random bytes into frames of several
+  sizes and reports as CSV, per stream and frame size: the share of
+  frames compressed, the payload and wire size ratios, the codec cost
+  in ns/byte each way, the wire time saved per frame at 115200 baud
+  and the CPU time spent on it here. Every frame also goes through
+  constructPacket() and parse() (timestamped, packed when it fits) and
+  is checked against the original, as is txBuff after compression.
+  The last column is how many times slower than this host a target may
+  run the codec and still gain: time the compress()/decompress() loops
+  on the target to see which rows pay there
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/compress_bench.cpp src/Packet.cpp src/PacketCompress.cpp extras/host/Arduino.cpp -o compress_bench
+ Usage:
+ ------
+  * compress_bench
+*/
+#include "Arduino.h"
+#include "Packet.h"
+#include "PacketCompress.h"
+#include <stdio.h>
+
+
+const uint32_t STREAM_SIZE = 0x40000; // Bytes per stream
+const uint32_t TOTAL_BYTES = 4000000; // Payload bytes per codec measurement
+const uint32_t BAUD        = 115200;  // 10 bits per byte on the wire
+const uint16_t MAX_PACKED  = 254;     // The COBS overhead byte only reaches the first 255 payload bytes
+const uint16_t SIZES[]     = {32, 64, 128, 254, MAX_PACKET_SIZE - TIMESTAMP_SIZE}; // Frames are timestamped
+const char*    KINDS[]     = {"text", "log", "sensor", "random"};
+const char*    WORDS[]     = {"lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit", "sed", "do",
+                              "eiusmod", "tempor", "incididunt", "ut", "labore", "et", "dolore", "magna", "aliqua", "enim",
+                              "ad", "minim", "veniam", "quis", "nostrud", "exercitation", "ullamco", "laboris", "nisi", "aliquip"};
+
+
+uint32_t          rngState = 12345;
+volatile uint32_t sink; // Keeps the optimiser from dropping results
+
+
+/*
+ uint32_t nextRandom()
+ Description:
+ ------------
+  * xorshift32 - deterministic so that runs are comparable
+*/
+uint32_t nextRandom()
+{
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+
+	return rngState;
+}
+
+
+/*
+ void fill(uint8_t stream[], const uint8_t& kind)
+ Description:
+ ------------
+  * Fills stream[] with STREAM_SIZE bytes of a KINDS stream:
+   text   - words picked at random, in sentences
+   log    - timestamped sensor log lines
+   sensor - 16-byte little endian records sampled every 10 ms
+   random - incompressible
+*/
+void fill(uint8_t stream[], const uint8_t& kind)
+{
+	char     line[96];
+	uint32_t len     = 0;
+	uint32_t time    = 0;
+	int16_t  axes[3] = {120, -40, 980};
+	uint16_t battery = 12400;
+
+	rngState = 12345 + kind;
+
+	while (len < STREAM_SIZE)
+	{
+		int n = 0;
+
+		if (kind == 0)
+			n = snprintf(line, sizeof(line), "%s%s", WORDS[nextRandom() % (sizeof(WORDS) / sizeof(WORDS[0]))], (nextRandom() % 8) ? " " : ". ");
+		else if (kind == 1)
+		{
+			time += 100 + (nextRandom() % 20);
+			n     = snprintf(line, sizeof(line), "%08u I sensor%u: temp=%d.%02u C hum=%u%% bat=%umV\n", time, nextRandom() % 4, 20 + (int)(nextRandom() % 5), nextRandom() % 100, 40 + (nextRandom() % 20), 3700 + (nextRandom() % 50));
+		}
+		else if (kind == 2)
+		{
+			time += 10;
+
+			for (uint8_t i = 0; i < 3; i++)
+				axes[i] += (int16_t)(nextRandom() % 7) - 3;
+
+			if (!(time % 1000))
+				battery--;
+
+			line[0] = time & 0xFF;
+			line[1] = (time >> 8) & 0xFF;
+			line[2] = (time >> 16) & 0xFF;
+			line[3] = (time >> 24) & 0xFF;
+
+			for (uint8_t i = 0; i < 3; i++)
+			{
+				line[4 + (i * 2)] = axes[i] & 0xFF;
+				line[5 + (i * 2)] = (axes[i] >> 8) & 0xFF;
+			}
+
+			line[10] = battery & 0xFF;
+			line[11] = (battery >> 8) & 0xFF;
+			line[12] = 0x01;               // Status
+			line[13] = 0x00;
+			line[14] = (time / 10) & 0xFF; // Sequence number
+			line[15] = 0xA5;               // Record marker
+			n        = 16;
+		}
+		else
+		{
+			line[0] = nextRandom();
+			n       = 1;
+		}
+
+		for (int i = 0; (i < n) && (len < STREAM_SIZE); i++)
+			stream[len++] = line[i];
+	}
+}
+
+
+/*
+ uint16_t buildFrame(Packet& tx, uint8_t wire[], const uint8_t payload[], const uint16_t& len)
+ Description:
+ ------------
+  * Writes the frame of "payload" into wire[] and returns its length
+*/
+uint16_t buildFrame(Packet& tx, uint8_t wire[], const uint8_t payload[], const uint16_t& len)
+{
+	memcpy(tx.txBuff, payload, len);
+	tx.constructPacket(len, 0x0102, 7);
+
+	memcpy(wire, tx.preamble, PREAMBLE_SIZE);
+	memcpy(wire + PREAMBLE_SIZE, tx.txPayload, tx.bytesToSend);
+	memcpy(wire + PREAMBLE_SIZE + tx.bytesToSend, tx.postamble, POSTAMBLE_SIZE);
+
+	return PREAMBLE_SIZE + tx.bytesToSend + POSTAMBLE_SIZE;
+}
+
+
+/*
+ void run(const uint8_t stream[], const uint8_t& kind, const uint16_t& len)
+ Description:
+ ------------
+  * Measures one stream at one frame size and prints a CSV row
+*/
+void run(const uint8_t stream[], const uint8_t& kind, const uint16_t& len)
+{
+	static uint8_t  work[STREAM_SIZE];
+	static uint16_t compressedLen[STREAM_SIZE / 32];
+	static uint8_t  wire[PACKET_SIZE];
+
+	uint32_t frames = STREAM_SIZE / len;
+	uint32_t reps   = (TOTAL_BYTES / (frames * len)) + 1;
+
+	// Codec alone
+	PacketCompressor* stats = NULL;
+	uint32_t compressTime   = 0;
+	uint32_t decompressTime = 0;
+	uint32_t total          = 0;
+
+	for (uint32_t r = 0; r < reps; r++)
+	{
+		PacketCompressor* compressor = new PacketCompressor;
+
+		memcpy(work, stream, frames * len);
+
+		uint32_t start = micros();
+
+		for (uint32_t f = 0; f < frames; f++)
+			if ((compressedLen[f] = compressor->compress(work + (f * len), len))) // Copied back for decompress() to expand in place
+				memcpy(work + (f * len), compressor->compressed(), compressedLen[f]);
+
+		compressTime += micros() - start;
+		start         = micros();
+
+		for (uint32_t f = 0; f < frames; f++)
+			if (compressedLen[f])
+				total += compressor->decompress(work + (f * len), compressedLen[f], len);
+
+		decompressTime += micros() - start;
+
+		if (stats)
+			delete compressor;
+		else
+			stats = compressor;
+	}
+
+	sink = total;
+
+	// Through the framing, with and without compression
+	PacketCompressor txCompressor;
+	PacketCompressor rxCompressor;
+	Packet           plain;
+	Packet           tx;
+	Packet           rx;
+	configST         config;
+	uint32_t         plainWire      = 0;
+	uint32_t         compressedWire = 0;
+	uint32_t         bad            = 0;
+
+	config.debug      = 0;
+	config.packed     = (len <= MAX_PACKED);
+	config.timestamps = true;
+	plain.begin(config);
+
+	config.compressor = &txCompressor;
+	tx.begin(config);
+
+	config.compressor = &rxCompressor;
+	rx.begin(config);
+
+	for (uint32_t f = 0; f < frames; f++)
+	{
+		const uint8_t* payload = stream + (f * len);
+
+		plainWire += buildFrame(plain, wire, payload, len);
+
+		uint16_t wireLen = buildFrame(tx, wire, payload, len);
+		uint16_t rxLen   = 0;
+
+		compressedWire += wireLen;
+
+		if ((tx.txPayload != tx.txBuff) && memcmp(tx.txBuff, payload, len)) // Compressed frames leave txBuff as it was
+			bad++;
+
+		for (uint16_t i = 0; i < wireLen; i++)
+			rxLen = rx.parse(wire[i]);
+
+		if ((rxLen != len) || memcmp(rx.rxBuff, payload, len))
+			bad++;
+	}
+
+	double bytes        = (double)frames * len * reps;
+	double compressNs   = (compressTime * 1000.0) / bytes;
+	double decompressNs = (decompressTime * 1000.0) / bytes;
+	double savedUs      = (((double)plainWire - compressedWire) / frames) * 10 * 1000000.0 / BAUD;
+	double cpuUs        = ((compressTime + decompressTime) / (double)reps) / frames;
+
+	printf("%s,%u,%u,%.1f,%.2f,%.2f,%.2f,%.2f,%.1f,%.3f,%.0f,%u\n",
+	       KINDS[kind],
+	       len,
+	       frames,
+	       (100.0 * stats->framesCompressed) / frames,
+	       stats->bytesOut ? (double)stats->bytesIn / stats->bytesOut : 1.0,
+	       (double)plainWire / compressedWire,
+	       compressNs,
+	       decompressNs,
+	       savedUs,
+	       cpuUs,
+	       (cpuUs > 0) ? savedUs / cpuUs : 0,
+	       bad);
+
+	delete stats;
+}
+
+
+int main()
+{
+	static uint8_t stream[STREAM_SIZE];
+
+	printf("stream,payload_bytes,frames,compressed_pct,payload_ratio,wire_ratio,compress_ns_per_byte,decompress_ns_per_byte,wire_us_saved_per_frame,host_cpu_us_per_frame,break_even_slowdown,bad\n");
+
+	for (uint8_t kind = 0; kind < (sizeof(KINDS) / sizeof(KINDS[0])); kind++)
+	{
+		fill(stream, kind);
+
+		for (uint8_t s = 0; s < (sizeof(SIZES) / sizeof(SIZES[0])); s++)
+			run(stream, kind, SIZES[s]);
+	}
+
+	return 0;
+}
@@ -0,0 +1,198 @@
+/*
+ fec_bench.cpp
+ Description:
+ ------------
+  * Host benchmark for the PacketFEC Reed-Solomon mode. Reports
+  encode/decode throughput per parity length, then the goodput
+  (delivered payload bytes per wire byte) of max-size packets sent
+  through a channel with random bit errors, with and without FEC.
+  Every packet reported is compared in full against what was sent -
+  damaged ones the CRC let through are counted as false accepts and
+  left out of the goodput. Results are printed as CSV
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/fec_bench.cpp src/Packet.cpp src/PacketFEC.cpp extras/host/Arduino.cpp -o fec_bench
+*/
+#include "Arduino.h"
+#include "Packet.h"
+#include "PacketFEC.h"
+
+
+const uint8_t  PARITIES[]   = {0, 4, 8, 16, 32};
+const double   BERS[]       = {0, 1e-5, 1e-4, 5e-4, 1e-3, 3e-3, 1e-2};
+const uint32_t THROUGHPUT_N = 2000;
+const uint32_t GOODPUT_N    = 2000;
+
+
+uint32_t rngState = 12345;
+
+
+/*
+ uint32_t nextRandom()
+ Description:
+ ------------
+  * xorshift32 - deterministic so that runs are comparable
+*/
+uint32_t nextRandom()
+{
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+
+	return rngState;
+}
+
+
+/*
+ void benchThroughput()
+ Description:
+ ------------
+  * Times encoding and decoding of max-size payloads, with the max
+  correctable number of errors injected into every block for decode
+*/
+void benchThroughput()
+{
+	static uint8_t data[MAX_PACKET_SIZE];
+	static uint8_t buff[MAX_PACKET_SIZE];
+
+	printf("test,parity,data_bytes,encode_MBps,decode_clean_MBps,decode_errors_MBps\n");
+
+	for (uint8_t p = 0; p < sizeof(PARITIES); p++)
+	{
+		if (!PARITIES[p])
+			continue;
+
+		PacketFEC fec(PARITIES[p]);
+		uint16_t  len = fec.maxDataLen(MAX_PACKET_SIZE);
+		uint16_t  encLen;
+
+		for (uint16_t i = 0; i < len; i++)
+			data[i] = nextRandom();
+
+		uint32_t start = micros();
+		for (uint32_t n = 0; n < THROUGHPUT_N; n++)
+		{
+			memcpy(buff, data, len);
+			encLen = fec.encode(buff, len);
+		}
+		double encodeUs = micros() - start;
+
+		static uint8_t encoded[MAX_PACKET_SIZE];
+		memcpy(encoded, buff, encLen);
+
+		start = micros();
+		for (uint32_t n = 0; n < THROUGHPUT_N; n++)
+		{
+			memcpy(buff, encoded, encLen);
+			fec.decode(buff, encLen);
+		}
+		double cleanUs = micros() - start;
+
+		start = micros();
+		for (uint32_t n = 0; n < THROUGHPUT_N; n++)
+		{
+			memcpy(buff, encoded, encLen);
+
+			for (uint16_t block = 0; (block * FEC_BLOCK_SIZE) < encLen; block++)
+				for (uint8_t e = 0; e < (PARITIES[p] / 2); e++)
+					buff[(block * FEC_BLOCK_SIZE) + (e * 7)] ^= 0x5A;
+
+			fec.decode(buff, encLen);
+		}
+		double errorsUs = micros() - start;
+
+		double bytes = (double)len * THROUGHPUT_N;
+		printf("throughput,%u,%u,%.2f,%.2f,%.2f\n", PARITIES[p], len, bytes / encodeUs, bytes / cleanUs, bytes / errorsUs);
+	}
+}
+
+
+/*
+ void benchGoodput()
+ Description:
+ ------------
+  * Sends max-size packets through a binary symmetric channel and
+  counts the payload bytes delivered intact, and the packets reported
+  with damaged payloads
+*/
+void benchGoodput()
+{
+	static Packet  tx;
+	static Packet  rx;
+	static uint8_t wire[PACKET_SIZE];
+	static uint8_t sent[MAX_PACKET_SIZE];
+
+	printf("test,parity,ber,payload_bytes,frames_ok,frames_sent,false_accepts,goodput\n");
+
+	for (uint8_t b = 0; b < (sizeof(BERS) / sizeof(BERS[0])); b++)
+	{
+		for (uint8_t p = 0; p < sizeof(PARITIES); p++)
+		{
+			PacketFEC fec(PARITIES[p]);
+			configST  config;
+
+			config.debug   = 0;
+			config.fec     = PARITIES[p] ? &fec : NULL;
+			config.timeout = __UINT32_MAX__;
+
+			tx.begin(config);
+			rx.begin(config);
+
+			uint16_t len       = PARITIES[p] ? fec.maxDataLen(MAX_PACKET_SIZE) : MAX_PACKET_SIZE;
+			uint32_t threshold = (uint32_t)(BERS[b] * 4294967295.0);
+			uint32_t framesOk  = 0;
+			uint32_t falseOk   = 0;
+			uint64_t wireBytes = 0;
+
+			for (uint32_t n = 0; n < GOODPUT_N; n++)
+			{
+				for (uint16_t i = 0; i < len; i++)
+					tx.txBuff[i] = nextRandom();
+
+				memcpy(sent, tx.txBuff, len);
+				tx.constructPacket(len);
+
+				uint16_t frameLen = 0;
+				memcpy(wire, tx.preamble, PREAMBLE_SIZE);
+				frameLen += PREAMBLE_SIZE;
+				memcpy(wire + frameLen, tx.txPayload, tx.bytesToSend);
+				frameLen += tx.bytesToSend;
+				memcpy(wire + frameLen, tx.postamble, POSTAMBLE_SIZE);
+				frameLen += POSTAMBLE_SIZE;
+
+				for (uint16_t i = 0; i < frameLen; i++)
+					for (uint8_t bit = 0; bit < 8; bit++)
+						if (threshold && (nextRandom() < threshold))
+							wire[i] ^= 1 << bit;
+
+				wireBytes += frameLen;
+
+				for (uint16_t i = 0; i < frameLen; i++) // Frames are fed back to back, so a corrupted header costs resync time too
+				{
+					rx.parse(wire[i]);
+
+					if (rx.status == NEW_DATA)
+					{
+						if ((rx.bytesRead == len) && !memcmp(rx.rxBuff, sent, len))
+							framesOk++;
+						else
+							falseOk++;
+					}
+					else if (rx.status <= 0)
+						rx.reset();
+				}
+			}
+
+			printf("goodput,%u,%g,%u,%u,%u,%u,%.4f\n", PARITIES[p], BERS[b], len, framesOk, GOODPUT_N, falseOk, ((double)framesOk * len) / wireBytes);
+		}
+	}
+}
+
+
+int main()
+{
+	benchThroughput();
+	benchGoodput();
+
+	return 0;
+}
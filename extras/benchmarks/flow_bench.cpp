@@ -0,0 +1,211 @@
+/*
+ flow_bench.cpp
+ Description:
+ ------------
+  * Host check and benchmark of credit-based flow control. Two
+  SerialTransfers, each run by its own thread, are joined by a
+  LoopbackChannel whose buffer is built as small as a UART RX FIFO -
+  bytes written while it is full are dropped like an overrun. One
+  end, or both at once, sends FRAMES sequence-numbered packets as
+  fast as sendData() takes them while reading whatever arrives, with
+  flowWindow set to the buffer size. The fragmented case sends
+  messages instead, each as CHUNK_LEN-byte sendChunk() fragments
+  reassembled into the receiver's messageBuff, so messages complete
+  while the receiving end is itself waiting for credit. Prints one CSV
+  row per case and exits non-zero if any packet or message was lost,
+  damaged or reordered:
+   * delivered - Packets (or messages) received in order and intact,
+   per direction
+   * overrun_bytes - Bytes dropped by a full buffer (must be 0)
+   * refused_sends - sendData() calls that returned 0 so a received
+   packet could be read first
+   * credit_timeouts - Waits for credit that ran into flowTimeout
+   * goodput_Bps - Payload bytes delivered per second, both directions
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -DLOOPBACK_BUFFER_SIZE=64 -Iextras/host -Isrc extras/benchmarks/flow_bench.cpp src/Packet.cpp src/SerialTransfer.cpp src/LoopbackStream.cpp extras/host/Arduino.cpp -o flow_bench -lpthread
+ Usage:
+ ------
+  * flow_bench
+*/
+#include "Arduino.h"
+#include "LoopbackStream.h"
+#include "SerialTransfer.h"
+#include <stdio.h>
+#include <thread>
+
+
+const uint32_t FRAMES      = 2000;  // Per direction
+const uint32_t TIME_OUT    = 30000; // ms to deliver all packets
+const uint16_t MESSAGE_LEN = 300;   // Fragmented case
+const uint16_t CHUNK_LEN   = 12;    // Keeps each fragment's frame within half the window
+
+
+struct endST
+{
+	SerialTransfer link;
+	bool           sends     = false;
+	uint32_t       sent      = 0;
+	uint32_t       delivered = 0; // From the other end
+	uint32_t       bad       = 0;
+	uint32_t       refused   = 0;
+	uint16_t       offset    = 0; // Of the next fragment of message "sent"
+	uint8_t        message[MESSAGE_LEN];
+};
+
+
+/*
+ void fill(uint8_t arr[], const uint32_t& seq, const uint16_t& len)
+ Description:
+ ------------
+  * Writes packet "seq": its number, then a pattern derived from it
+*/
+void fill(uint8_t arr[], const uint32_t& seq, const uint16_t& len)
+{
+	arr[0] = (seq >> 24) & 0xFF;
+	arr[1] = (seq >> 16) & 0xFF;
+	arr[2] = (seq >> 8) & 0xFF;
+	arr[3] = seq & 0xFF;
+
+	for (uint16_t i = 4; i < len; i++)
+		arr[i] = (seq * 31) + i;
+}
+
+
+/*
+ void serve(endST& end, const uint16_t& len, const bool& peerSends, const bool& fragment, const uint32_t& start)
+ Description:
+ ------------
+  * One end's loop: sends its packets (or message fragments if
+  "fragment" is set) while checking the ones that arrive, until both
+  directions are done or TIME_OUT passes
+*/
+void serve(endST& end, const uint16_t& len, const bool& peerSends, const bool& fragment, const uint32_t& start)
+{
+	uint8_t expected[MESSAGE_LEN > MAX_PACKET_SIZE ? MESSAGE_LEN : MAX_PACKET_SIZE];
+
+	while (((end.sends && (end.sent < FRAMES)) || (peerSends && (end.delivered < FRAMES))) && ((millis() - start) < TIME_OUT))
+	{
+		if (end.sends && (end.sent < FRAMES) && fragment)
+		{
+			uint16_t chunkLen = ((len - end.offset) < CHUNK_LEN) ? (len - end.offset) : CHUNK_LEN;
+			bool     last     = (end.offset + chunkLen) == len;
+
+			fill(expected, end.sent, len);
+
+			if (end.link.sendChunk(expected + end.offset, chunkLen, end.offset, last, 0, end.sent & 0xFF))
+			{
+				end.offset += chunkLen;
+
+				if (last)
+				{
+					end.offset = 0;
+					end.sent++;
+				}
+			}
+			else
+				end.refused++; // Retried with the same fragment
+		}
+		else if (end.sends && (end.sent < FRAMES))
+		{
+			fill(end.link.packet.txBuff, end.sent, len);
+
+			if (end.link.sendData(len))
+				end.sent++;
+			else
+				end.refused++;
+		}
+
+		while (end.link.available())
+		{
+			fill(expected, end.delivered, len);
+
+			if (fragment)
+			{
+				if ((end.link.status != NEW_MESSAGE) || (end.link.currentMessageLen() != len) || memcmp(end.message, expected, len))
+					end.bad++;
+			}
+			else if ((end.link.bytesRead != len) || memcmp(end.link.packet.rxBuff, expected, len))
+				end.bad++;
+
+			end.delivered++;
+		}
+
+		yield();
+	}
+}
+
+
+/*
+ bool run(const char* name, const uint16_t& len, const bool& both, const bool fragment = false)
+ Description:
+ ------------
+  * Sends FRAMES packets of "len" bytes from a to b, and from b to a
+  at the same time if "both" is set. With "fragment" set each one is
+  a message of "len" bytes sent as fragments. Prints a CSV row and
+  returns whether or not every packet arrived in order and intact
+*/
+bool run(const char* name, const uint16_t& len, const bool& both, const bool fragment = false)
+{
+	LoopbackChannel* channel = new LoopbackChannel;
+	loopbackConfigST linkConfig;
+	configST         config;
+	endST            a;
+	endST            b;
+
+	channel->begin(linkConfig);
+
+	config.debug      = 0;
+	config.flowWindow = LOOPBACK_BUFFER_SIZE;
+
+	config.messageBuff    = a.message;
+	config.messageBuffLen = sizeof(a.message);
+	a.link.begin(channel->a, config);
+
+	config.messageBuff    = b.message;
+	config.messageBuffLen = sizeof(b.message);
+	b.link.begin(channel->b, config);
+
+	a.sends = true;
+	b.sends = both;
+
+	uint32_t start = millis();
+
+	std::thread peer([&] { serve(b, len, true, fragment, start); });
+	serve(a, len, both, fragment, start);
+	peer.join();
+
+	uint32_t elapsed = millis() - start;
+	uint32_t dropped = channel->a.txStats().bytesDropped + channel->b.txStats().bytesDropped;
+	bool     ok      = (b.delivered == FRAMES) && (!both || (a.delivered == FRAMES)) && !a.bad && !b.bad && !dropped;
+
+	printf("%s,%u,%u,%u,%u,%u,%u,%.0f,%s\n",
+	       name,
+	       len,
+	       b.delivered - b.bad,
+	       a.delivered - a.bad,
+	       dropped,
+	       a.refused + b.refused,
+	       a.link.packet.stats.timeouts + b.link.packet.stats.timeouts,
+	       ((double)(a.delivered + b.delivered) * len * 1000.0) / (elapsed ? elapsed : 1),
+	       ok ? "ok" : "FAILED");
+
+	delete channel;
+
+	return ok;
+}
+
+
+int main()
+{
+	bool ok = true;
+
+	printf("case,payload_bytes,delivered_a_to_b,delivered_b_to_a,overrun_bytes,refused_sends,credit_timeouts,goodput_Bps,result\n");
+
+	ok &= run("one-way", 20, false);
+	ok &= run("one-way", 500, false);     // Frames larger than half the window go out as credit comes in
+	ok &= run("saturated-both", 20, true); // Frames fit half the window, so neither end waits part way through one
+	ok &= run("fragmented-both", MESSAGE_LEN, true, true);
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,256 @@
+/*
+ framing_bench.cpp
+ Description:
+ ------------
+  * Host benchmark of the framing hot paths: constructPacket(), parse()
+  byte by byte and in blocks, and PacketCRC::calculate(), across
+  payload sizes, debug levels and packed (COBS) and unpacked modes.
+  COBS stuffing/unstuffing is private to Packet, so its cost is
+  reported as the difference between the packed and unpacked rows.
+  Every row is CSV with the payload rate in MB/s and ns/byte, so a
+  change to any of these paths can be measured before and after:
+   framing_bench > before.csv
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/framing_bench.cpp src/Packet.cpp extras/host/Arduino.cpp -o framing_bench
+*/
+#include "Arduino.h"
+#include "Packet.h"
+#include "PacketTrace.h"
+
+
+const uint16_t SIZES[]      = {1, 8, 32, 64, 128, 254, 512, MAX_PACKET_SIZE};
+const uint16_t MAX_PACKED   = 254;     // The COBS overhead byte only reaches the first 255 payload bytes
+const uint32_t TOTAL_BYTES  = 4000000; // Payload bytes per measurement
+const uint16_t BLOCK        = 64;      // Bytes per parse() call in block mode, like one SerialTransfer read chunk
+const char*    LEVEL_NAMES[] = {"debug0", "debug1", "trace"};
+
+
+uint32_t          rngState = 12345;
+volatile uint32_t sink; // Keeps the optimiser from dropping results
+
+
+/*
+ uint32_t nextRandom()
+ Description:
+ ------------
+  * xorshift32 - deterministic so that runs are comparable
+*/
+uint32_t nextRandom()
+{
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+
+	return rngState;
+}
+
+
+/*
+ void configure(configST& config, const uint8_t& level, const bool& packed)
+ Description:
+ ------------
+  * Fills "config" for a LEVEL_NAMES level
+*/
+void configure(configST& config, const uint8_t& level, const bool& packed)
+{
+	static PacketTrace trace;
+
+	config.debug  = (level == 1);
+	config.packed = packed;
+	config.trace  = (level == 2) ? &trace : NULL;
+}
+
+
+/*
+ void report(const char* op, const bool& packed, const uint8_t& level, const uint16_t& len, const uint32_t& iterations, const uint32_t& elapsed)
+ Description:
+ ------------
+  * Prints a CSV row
+*/
+void report(const char* op, const bool& packed, const uint8_t& level, const uint16_t& len, const uint32_t& iterations, const uint32_t& elapsed)
+{
+	double bytes = (double)len * iterations;
+
+	printf("%s,%s,%s,%u,%u,%.1f,%.3f\n", op, packed ? "packed" : "unpacked", LEVEL_NAMES[level], len, iterations, bytes / (elapsed ? elapsed : 1), (elapsed * 1000.0) / bytes);
+}
+
+
+/*
+ uint16_t buildFrame(uint8_t wire[], const uint8_t payload[], const uint16_t& len, const bool& packed)
+ Description:
+ ------------
+  * Writes the frame of "payload" into wire[] and returns its length
+*/
+uint16_t buildFrame(uint8_t wire[], const uint8_t payload[], const uint16_t& len, const bool& packed)
+{
+	Packet   tx;
+	configST config;
+
+	configure(config, 0, packed);
+	tx.begin(config);
+	memcpy(tx.txBuff, payload, len);
+
+	uint16_t payloadLen = tx.constructPacket(len, 0x0102, 7);
+
+	memcpy(wire, tx.preamble, PREAMBLE_SIZE);
+	memcpy(wire + PREAMBLE_SIZE, tx.txPayload, tx.bytesToSend);
+	memcpy(wire + PREAMBLE_SIZE + tx.bytesToSend, tx.postamble, POSTAMBLE_SIZE);
+
+	return (payloadLen == len) ? (PREAMBLE_SIZE + tx.bytesToSend + POSTAMBLE_SIZE) : 0;
+}
+
+
+/*
+ void benchConstruct(const uint8_t payload[], const uint16_t& len, const uint8_t& level, const bool& packed, const uint32_t& iterations)
+ Description:
+ ------------
+  * Times constructPacket(). Packed mode stuffs txBuff in place, so the
+  payload is copied back in before every call in both modes
+*/
+void benchConstruct(const uint8_t payload[], const uint16_t& len, const uint8_t& level, const bool& packed, const uint32_t& iterations)
+{
+	Packet   tx;
+	configST config;
+	uint32_t total = 0;
+
+	configure(config, level, packed);
+	tx.begin(config);
+
+	uint32_t start = micros();
+
+	for (uint32_t n = 0; n < iterations; n++)
+	{
+		memcpy(tx.txBuff, payload, len);
+		total += tx.constructPacket(len, 0x0102, 7) + tx.postamble[1];
+	}
+
+	uint32_t elapsed = micros() - start;
+
+	sink = total;
+	report("construct", packed, level, len, iterations, elapsed);
+}
+
+
+/*
+ void benchParse(const uint8_t wire[], const uint16_t& wireLen, const uint16_t& len, const uint8_t& level, const bool& packed, const bool& block, const uint32_t& iterations)
+ Description:
+ ------------
+  * Times parse() over a frame, byte by byte or BLOCK bytes at a time.
+  Prints nothing if any frame fails to parse
+*/
+void benchParse(const uint8_t wire[], const uint16_t& wireLen, const uint16_t& len, const uint8_t& level, const bool& packed, const bool& block, const uint32_t& iterations)
+{
+	Packet   rx;
+	configST config;
+	uint32_t good = 0;
+
+	configure(config, level, packed);
+	rx.begin(config);
+
+	uint32_t start = micros();
+
+	for (uint32_t n = 0; n < iterations; n++)
+	{
+		if (block)
+		{
+			for (uint16_t offset = 0; offset < wireLen;)
+			{
+				uint16_t chunk = ((wireLen - offset) < BLOCK) ? (wireLen - offset) : BLOCK;
+				uint16_t consumed;
+
+				while (chunk)
+				{
+					if (rx.parse(wire + offset, chunk, consumed))
+						good++;
+
+					offset += consumed;
+					chunk  -= consumed;
+				}
+			}
+		}
+		else
+		{
+			for (uint16_t i = 0; i < wireLen; i++)
+				if (rx.parse(wire[i]))
+					good++;
+		}
+	}
+
+	uint32_t elapsed = micros() - start;
+
+	if (good != iterations)
+	{
+		fprintf(stderr, "parse %s %u bytes: %u of %u frames parsed\n", packed ? "packed" : "unpacked", len, good, iterations);
+		return;
+	}
+
+	sink = rx.rxBuff[len - 1];
+	report(block ? "parse_block" : "parse_byte", packed, level, len, iterations, elapsed);
+}
+
+
+/*
+ void benchCRC(const uint8_t payload[], const uint16_t& len, const uint32_t& iterations)
+ Description:
+ ------------
+  * Times PacketCRC::calculate() alone
+*/
+void benchCRC(uint8_t payload[], const uint16_t& len, const uint32_t& iterations)
+{
+	uint32_t total = 0;
+	uint32_t start = micros();
+
+	for (uint32_t n = 0; n < iterations; n++)
+	{
+		payload[0] = n; // Stops the compiler hoisting the loop-invariant CRC
+		total     += crc.calculate(payload, len);
+	}
+
+	uint32_t elapsed = micros() - start;
+
+	sink = total;
+	report("crc", false, 0, len, iterations, elapsed);
+}
+
+
+int main()
+{
+	static uint8_t payload[MAX_PACKET_SIZE];
+	static uint8_t wire[PACKET_SIZE];
+
+	for (uint16_t i = 0; i < MAX_PACKET_SIZE; i++) // Random bytes, so START_BYTE turns up as often as on a real link
+		payload[i] = nextRandom();
+
+	printf("op,mode,level,payload_bytes,iterations,MBps,ns_per_byte\n");
+
+	for (uint8_t s = 0; s < (sizeof(SIZES) / sizeof(SIZES[0])); s++)
+	{
+		uint16_t len        = SIZES[s];
+		uint32_t iterations = TOTAL_BYTES / len;
+
+		if (iterations > 1000000)
+			iterations = 1000000;
+
+		benchCRC(payload, len, iterations);
+
+		for (uint8_t p = 0; p < 2; p++)
+		{
+			bool packed = p;
+
+			if (packed && (len > MAX_PACKED))
+				continue;
+
+			uint16_t wireLen = buildFrame(wire, payload, len, packed);
+
+			for (uint8_t level = 0; level < (sizeof(LEVEL_NAMES) / sizeof(LEVEL_NAMES[0])); level++)
+			{
+				benchConstruct(payload, len, level, packed, iterations);
+				benchParse(wire, wireLen, len, level, packed, false, iterations);
+				benchParse(wire, wireLen, len, level, packed, true, iterations);
+			}
+		}
+	}
+
+	return 0;
+}
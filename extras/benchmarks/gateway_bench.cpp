@@ -0,0 +1,239 @@
+/*
+ gateway_bench.cpp
+ Description:
+ ------------
+  * Host benchmark for SerialGateway. For a growing number of links,
+  one "device" thread writes packets into the master end of a pty
+  pair per link while the gateway serves the slave ends. The handler
+  checks every packet and replies to every REPLY_EVERY-th one through
+  the link's send queue. Reports packet rate and the CPU time the
+  gateway spent per packet (device thread excluded) as CSV, and exits
+  non-zero if a packet was lost or damaged, send() refused a reply or
+  fewer replies reached the devices than were due
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/gateway_bench.cpp src/Packet.cpp src/SerialTransfer.cpp src/PosixStream.cpp src/PosixSerial.cpp src/SerialGateway.cpp extras/host/Arduino.cpp -o gateway_bench -lpthread
+*/
+#include "Arduino.h"
+#include "SerialGateway.h"
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+
+const uint8_t  LINK_COUNTS[] = {1, 2, 4, 8, 16, 32};
+const uint32_t PACKETS       = 64000; // Per run, split between the links
+const uint16_t PAYLOAD_LEN   = 64;
+const uint8_t  WORKERS       = 4;
+const uint8_t  REPLY_EVERY   = 16;
+const uint32_t RUN_WAIT_MS   = 10000;
+
+
+std::atomic<uint32_t> received{0};
+std::atomic<uint32_t> corrupt{0};
+std::atomic<uint32_t> refused{0}; // Replies send() did not queue
+
+
+/*
+ double cpuMicros(clockid_t clock)
+ Description:
+ ------------
+  * CPU time of the process or the calling thread in us
+*/
+double cpuMicros(clockid_t clock)
+{
+	struct timespec ts;
+	clock_gettime(clock, &ts);
+
+	return (ts.tv_sec * 1e6) + (ts.tv_nsec / 1e3);
+}
+
+
+/*
+ void handlePacket(SerialGateway& gateway, const GatewayPacket& packet)
+ Description:
+ ------------
+  * Checks the payload and acknowledges every REPLY_EVERY-th packet
+*/
+void handlePacket(SerialGateway& gateway, const GatewayPacket& packet)
+{
+	uint32_t seq;
+
+	memcpy(&seq, packet.payload, sizeof(seq));
+
+	if ((packet.len != PAYLOAD_LEN) || (packet.payload[PAYLOAD_LEN - 1] != packet.link))
+		corrupt++;
+
+	if (!(seq % REPLY_EVERY) && !gateway.send(packet.link, packet.payload, sizeof(seq), 1))
+		refused++;
+
+	received++;
+}
+
+
+/*
+ bool run(const uint8_t& numLinks)
+ Description:
+ ------------
+  * Pushes PACKETS packets through numLinks links and prints a CSV row.
+  Returns whether or not every packet and every reply went through
+*/
+bool run(const uint8_t& numLinks)
+{
+	SerialGateway* gw = new SerialGateway; // Links can't be removed, so each run gets a fresh gateway
+	int            masters[GATEWAY_MAX_LINKS];
+	configST       config;
+	Packet         framer;
+	static uint8_t frames[GATEWAY_MAX_LINKS][PACKET_SIZE];
+	uint16_t       pendingLen[GATEWAY_MAX_LINKS]; // Bytes of frames[] ready to write
+	uint16_t       pendingPos[GATEWAY_MAX_LINKS]; // Bytes of frames[] written
+
+	config.debug   = 0;
+	config.timeout = 1000;
+	framer.begin(config);
+
+	for (uint8_t i = 0; i < numLinks; i++)
+	{
+		char slavePath[64];
+
+		masters[i] = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+		if ((masters[i] < 0) || grantpt(masters[i]) || unlockpt(masters[i]) || ptsname_r(masters[i], slavePath, sizeof(slavePath)))
+			exit(1);
+
+		if (gw->addLink(slavePath, 3000000, config) < 0)
+			exit(1);
+	}
+
+	received = 0;
+	corrupt  = 0;
+	refused  = 0;
+
+	framer.constructPacket(sizeof(uint32_t), 1);
+
+	uint32_t replyLen   = PREAMBLE_SIZE + framer.bytesToSend + POSTAMBLE_SIZE; // Bytes per reply frame
+	uint64_t replyBytes = 0;
+	uint32_t repliesDue = 0;
+
+	double   cpuStart  = cpuMicros(CLOCK_PROCESS_CPUTIME_ID);
+	uint32_t wallStart = micros();
+
+	gw->begin(handlePacket, WORKERS);
+
+	double   deviceStart = cpuMicros(CLOCK_THREAD_CPUTIME_ID); // The device thread is this one
+	uint32_t perLink     = PACKETS / numLinks;
+	uint32_t sent[GATEWAY_MAX_LINKS];
+	uint32_t total = perLink * numLinks;
+	uint8_t  sink[4096];
+	ssize_t  got;
+
+	repliesDue = ((perLink + REPLY_EVERY - 1) / REPLY_EVERY) * numLinks;
+
+	memset(sent, 0, sizeof(sent));
+	memset(pendingLen, 0, sizeof(pendingLen));
+	memset(pendingPos, 0, sizeof(pendingPos));
+
+	for (uint32_t done = 0; done < total;)
+	{
+		for (uint8_t i = 0; i < numLinks; i++)
+		{
+			if (pendingLen[i] == pendingPos[i]) // Next frame
+			{
+				if (sent[i] == perLink)
+					continue;
+
+				memset(framer.txBuff, i, PAYLOAD_LEN);
+				memcpy(framer.txBuff, &sent[i], sizeof(sent[i]));
+				framer.constructPacket(PAYLOAD_LEN);
+
+				pendingLen[i] = 0;
+				pendingPos[i] = 0;
+				memcpy(frames[i], framer.preamble, PREAMBLE_SIZE);
+				pendingLen[i] += PREAMBLE_SIZE;
+				memcpy(frames[i] + pendingLen[i], framer.txPayload, framer.bytesToSend);
+				pendingLen[i] += framer.bytesToSend;
+				memcpy(frames[i] + pendingLen[i], framer.postamble, POSTAMBLE_SIZE);
+				pendingLen[i] += POSTAMBLE_SIZE;
+				sent[i]++;
+			}
+
+			ssize_t written = write(masters[i], frames[i] + pendingPos[i], pendingLen[i] - pendingPos[i]);
+
+			if (written > 0) // pty full - carry on next round
+			{
+				pendingPos[i] += written;
+
+				if (pendingPos[i] == pendingLen[i])
+					done++;
+			}
+
+			while ((got = read(masters[i], sink, sizeof(sink))) > 0) // Drain replies
+				replyBytes += got;
+		}
+	}
+
+	uint32_t waitStart = millis();
+
+	while (((received < total) || (replyBytes < ((uint64_t)repliesDue * replyLen))) && ((millis() - waitStart) < RUN_WAIT_MS))
+		for (uint8_t i = 0; i < numLinks; i++)
+			while ((got = read(masters[i], sink, sizeof(sink))) > 0)
+				replyBytes += got;
+
+	double   deviceUs = cpuMicros(CLOCK_THREAD_CPUTIME_ID) - deviceStart;
+	double   wallUs   = micros() - wallStart;
+	double   cpuUs    = cpuMicros(CLOCK_PROCESS_CPUTIME_ID) - cpuStart - deviceUs;
+	uint32_t dropped  = 0;
+	uint32_t errors   = 0;
+	uint32_t replies  = 0;
+	uint32_t txDrops  = 0;
+
+	gw->end();
+
+	for (uint8_t i = 0; i < numLinks; i++)
+	{
+		GatewayLinkStats stats = gw->linkStats(i);
+
+		dropped += stats.rxDropped;
+		errors += stats.rxErrors;
+		replies += stats.txPackets;
+		txDrops += stats.txDropped;
+	}
+
+	uint32_t delivered = replyBytes / replyLen;
+	bool     ok        = (received == total) && !corrupt && !dropped && !refused && !txDrops && (replies == repliesDue) && (delivered == repliesDue);
+
+	printf("%u,%u,%u,%u,%.0f,%.2f,%u,%u,%u,%u,%u,%u,%s\n",
+	       numLinks,
+	       total,
+	       (uint32_t)received,
+	       (uint32_t)corrupt,
+	       received / (wallUs / 1e6),
+	       cpuUs / received,
+	       dropped,
+	       errors,
+	       repliesDue,
+	       replies,
+	       delivered,
+	       (uint32_t)refused + txDrops,
+	       ok ? "ok" : "FAILED");
+
+	delete gw;
+
+	for (uint8_t i = 0; i < numLinks; i++)
+		close(masters[i]);
+
+	return ok;
+}
+
+
+int main()
+{
+	bool ok = true;
+
+	printf("links,packets_sent,packets_received,corrupt,packets_per_s,gateway_cpu_us_per_packet,dropped,errors,replies_due,replies_sent,replies_received,replies_dropped,result\n");
+
+	for (uint8_t i = 0; i < sizeof(LINK_COUNTS); i++)
+		ok &= run(LINK_COUNTS[i]);
+
+	return ok ? 0 : 1;
+}
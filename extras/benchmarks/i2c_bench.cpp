@@ -0,0 +1,272 @@
+/*
+ i2c_bench.cpp
+ Description:
+ ------------
+  * Host check and benchmark of I2CTransfer over the mock Wire bus in
+  extras/host, which like the AVR core drops whatever a transaction
+  writes past its BUFFER_LENGTH (32) bytes. Prints one CSV row per
+  case and exits non-zero if any check fails:
+   * chunks - FRAMES packets of every length up to MAX_PACKET_SIZE sent
+   to a slave, each split into as few 32-byte transactions as the
+   frame needs and checked in full by the slave's callback
+   * nack - A packet sent to an address nobody answers is reported as
+   not sent
+   * poll - The master runs pollNext() over three slaves with queues
+   kept full of packets (a busy one, a quieter one, an idle one) and
+   an address nobody answers. Every poll of a slave with a packet
+   queued must return its oldest packet intact, every other poll must
+   return 0 with status NO_DATA
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/i2c_bench.cpp src/Packet.cpp src/I2CTransfer.cpp extras/host/Arduino.cpp extras/host/Wire.cpp -o i2c_bench
+ Usage:
+ ------
+  * i2c_bench
+*/
+#include "Arduino.h"
+#include "Wire.h"
+#include "I2CTransfer.h"
+#include <stdio.h>
+
+
+const uint32_t FRAMES                   = 20000;
+const uint8_t  SLAVE_ADDRESS            = 8;
+const uint8_t  POLL_SLAVES              = 3;
+const uint32_t POLL_FRAMES[POLL_SLAVES] = {3000, 1000, 0}; // Queued by each slave of the poll case
+const uint8_t  POLL_LIST[]              = {SLAVE_ADDRESS, SLAVE_ADDRESS + 1, SLAVE_ADDRESS + 2, SLAVE_ADDRESS + 3}; // The last one is absent
+
+
+TwoWire Wire2;
+TwoWire Wire3;
+
+I2CTransfer master;
+I2CTransfer slave;
+I2CTransfer pollSlaves[POLL_SLAVES];
+
+uint32_t expectedSeq = 0;
+uint16_t expectedLen = 0;
+uint32_t received    = 0;
+uint32_t intact      = 0;
+
+
+/*
+ void fill(uint8_t arr[], const uint32_t& seq, const uint16_t& len)
+ Description:
+ ------------
+  * Writes payload "seq" of "len" bytes
+*/
+void fill(uint8_t arr[], const uint32_t& seq, const uint16_t& len)
+{
+	for (uint16_t i = 0; i < len; i++)
+		arr[i] = (seq * 7) + (i * 13);
+}
+
+
+/*
+ bool check(I2CTransfer& end, const uint32_t& seq, const uint16_t& len)
+ Description:
+ ------------
+  * Returns whether or not the packet "end" just parsed is payload
+  "seq" of "len" bytes, with the command sendData() was given
+*/
+bool check(I2CTransfer& end, const uint32_t& seq, const uint16_t& len)
+{
+	uint8_t expected[MAX_PACKET_SIZE];
+
+	fill(expected, seq, len);
+
+	return (end.packet.bytesRead == len) && (end.currentCommand() == (seq & 0x1FF)) && !memcmp(end.packet.rxBuff, expected, len);
+}
+
+
+/*
+ void onPacket()
+ Description:
+ ------------
+  * Slave callback, run from its onReceive() handler
+*/
+void onPacket()
+{
+	received++;
+
+	if (check(slave, expectedSeq, expectedLen))
+		intact++;
+}
+
+
+const functionPtr callbacks[] = {onPacket, onPacket, onPacket, onPacket};
+
+
+/*
+ bool benchChunks()
+ Description:
+ ------------
+  * Sends FRAMES packets of every length and counts the transactions
+  they took against the fewest that fit the Wire buffer
+*/
+bool benchChunks()
+{
+	uint64_t payload      = 0;
+	uint32_t transactions = Wire.transactions;
+	uint32_t fewest       = 0;
+	uint64_t busBytes     = Wire.bytesTransferred;
+	uint32_t start        = micros();
+
+	for (uint32_t n = 0; n < FRAMES; n++)
+	{
+		uint16_t len = 1 + ((n * 37) % MAX_PACKET_SIZE);
+
+		expectedSeq = n;
+		expectedLen = len;
+		fill(master.packet.txBuff, n, len);
+
+		if (master.sendData(len, n & 0x1FF, n & 3, SLAVE_ADDRESS) != len)
+			break;
+
+		payload += len;
+		fewest  += (PREAMBLE_SIZE + master.packet.bytesToSend + POSTAMBLE_SIZE + BUFFER_LENGTH - 1) / BUFFER_LENGTH;
+	}
+
+	uint32_t elapsed = micros() - start;
+
+	transactions = Wire.transactions - transactions;
+	busBytes     = Wire.bytesTransferred - busBytes;
+
+	printf("chunks,%u,%u,%u,%u,%.3f,%.1f\n", intact, FRAMES, transactions, fewest, (double)payload / busBytes, (payload * 8.0) / (elapsed ? elapsed : 1));
+
+	return (received == FRAMES) && (intact == FRAMES) && (transactions == fewest);
+}
+
+
+/*
+ bool benchNack()
+ Description:
+ ------------
+  * Sends to an address with no slave on it
+*/
+bool benchNack()
+{
+	fill(master.packet.txBuff, 0, 100);
+
+	uint16_t sent = master.sendData(100, 0, 0, SLAVE_ADDRESS + 1);
+
+	printf("nack,%u\n", sent);
+
+	return !sent;
+}
+
+
+/*
+ bool benchPoll()
+ Description:
+ ------------
+  * Polls the slaves round-robin until each one's packets are all in.
+  Only one slave's Wire handlers can run per process, so the one
+  pollNext() is about to ask is made classToUse first
+*/
+bool benchPoll()
+{
+	TwoWire* ports[POLL_SLAVES] = {&Wire1, &Wire2, &Wire3};
+	configST config;
+	uint32_t queued[POLL_SLAVES]    = {0};
+	uint32_t delivered[POLL_SLAVES] = {0};
+	uint32_t polls                  = 0;
+	uint32_t missed                 = 0; // Polls of a slave with a packet queued that returned none
+	uint32_t bad                    = 0;
+	uint32_t spurious               = 0; // Packets from a slave with nothing queued
+	uint8_t  pollIndex              = 0;
+	uint64_t busBytes               = Wire.bytesTransferred;
+	uint64_t payload                = 0;
+
+	config.debug = 0;
+
+	for (uint8_t i = 0; i < POLL_SLAVES; i++)
+	{
+		ports[i]->begin(POLL_LIST[i]);
+		pollSlaves[i].begin(*ports[i], config);
+	}
+
+	master.setPollList(POLL_LIST, sizeof(POLL_LIST));
+
+	while ((delivered[0] < POLL_FRAMES[0]) || (delivered[1] < POLL_FRAMES[1]))
+	{
+		for (uint8_t i = 0; i < POLL_SLAVES; i++)
+		{
+			while (queued[i] < POLL_FRAMES[i])
+			{
+				uint16_t len = 1 + ((queued[i] * 37) % 200);
+
+				fill(pollSlaves[i].packet.txBuff, queued[i] + i, len);
+
+				if (!pollSlaves[i].queueData(len, (queued[i] + i) & 0x1FF, i))
+					break; // Queue full, this one goes next time
+
+				queued[i]++;
+			}
+		}
+
+		uint8_t address = POLL_LIST[pollIndex];
+		uint8_t i       = address - SLAVE_ADDRESS;
+
+		if (i < POLL_SLAVES)
+			I2CTransfer::classToUse = &pollSlaves[i];
+
+		pollIndex = (pollIndex + 1) % sizeof(POLL_LIST);
+		polls++;
+
+		if (master.pollNext())
+		{
+			if ((i >= POLL_SLAVES) || (delivered[i] == queued[i]))
+			{
+				spurious++;
+				continue;
+			}
+
+			uint16_t len = 1 + ((delivered[i] * 37) % 200);
+
+			if ((master.currentAddress() != address) || (master.currentPacketID() != i) || !check(master, delivered[i] + i, len))
+				bad++;
+
+			delivered[i]++;
+			payload += len;
+		}
+		else if ((i < POLL_SLAVES) && (delivered[i] < queued[i]))
+			missed++;
+		else if (master.status != NO_DATA)
+			bad++;
+	}
+
+	printf("poll,%u,%u,%u,%u,%u,%u,%u,%.3f\n", delivered[0], delivered[1], delivered[2], polls, missed, spurious, bad, (double)payload / (Wire.bytesTransferred - busBytes));
+
+	return !missed && !spurious && !bad;
+}
+
+
+int main()
+{
+	configST config;
+	bool     ok = true;
+
+	config.debug = 0;
+
+	Wire.begin();
+	master.begin(Wire, config);
+
+	config.callbacks    = callbacks;
+	config.callbacksLen = sizeof(callbacks) / sizeof(callbacks[0]);
+
+	Wire1.begin(SLAVE_ADDRESS);
+	slave.begin(Wire1, config);
+	I2CTransfer::classToUse = &slave; // Its Wire handlers act on this one
+
+	printf("case,frames_ok,frames_sent,transactions,fewest_transactions,payload_per_bus_byte,payload_Mbps_host\n");
+	ok &= benchChunks();
+
+	printf("case,payload_bytes_sent\n");
+	ok &= benchNack();
+
+	printf("case,delivered_busy,delivered_quiet,delivered_idle,polls,missed,spurious,bad,payload_per_bus_byte\n");
+	ok &= benchPoll();
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+/*
+ latency_bench.cpp
+ Description:
+ ------------
+  * Host benchmark of timestamped packets and PacketLatency. A sender
+  and a receiver share one us clock and a LoopbackChannel limited to
+  100 kB/s with 200 us of latency. Command 1 is sent at a steady rate
+  while command 2 is sent in bursts, first idle then with enough load
+  to queue behind them. Reports per command one-way and dispatch
+  latency percentiles (us) as CSV, and checks the histogram
+  percentiles against the exact ones
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/latency_bench.cpp src/Packet.cpp src/PacketLatency.cpp src/SerialTransfer.cpp src/LoopbackStream.cpp extras/host/Arduino.cpp -o latency_bench -lpthread
+*/
+#include "Arduino.h"
+#include "LoopbackStream.h"
+#include "PacketLatency.h"
+#include "SerialTransfer.h"
+#include <algorithm>
+#include <vector>
+
+
+const uint32_t DURATION_US = 500000;
+const uint32_t PERIOD_US   = 2000; // Between command 1 packets
+const uint16_t LEN         = 32;
+const float    PERCENTS[]  = {50, 90, 99, 99.9};
+
+
+/*
+ void report(const char* scenario, const uint16_t& command, PacketLatency& latency, std::vector<uint32_t>& exact)
+ Description:
+ ------------
+  * Prints the CSV row of a command, plus the exact p99 of its one-way
+  latency next to the histogram's
+*/
+void report(const char* scenario, const uint16_t& command, PacketLatency& latency, std::vector<uint32_t>& exact)
+{
+	LatencyHistogram* oneWay   = latency.oneWay(command);
+	LatencyHistogram* dispatch = latency.dispatch(command);
+
+	if (!oneWay || exact.empty())
+		return;
+
+	printf("%s,%u,%u", scenario, command, oneWay->count);
+
+	for (uint8_t i = 0; i < (sizeof(PERCENTS) / sizeof(PERCENTS[0])); i++)
+		printf(",%u", oneWay->percentile(PERCENTS[i]));
+
+	std::sort(exact.begin(), exact.end());
+
+	printf(",%u,%u,%u,%u\n", oneWay->maxValue, exact[(exact.size() * 99) / 100], dispatch->percentile(50), dispatch->percentile(99));
+}
+
+
+/*
+ void run(const char* scenario, const uint8_t& burst)
+ Description:
+ ------------
+  * Sends command 1 every PERIOD_US and a burst of "burst" command 2
+  packets every 10 periods
+*/
+void run(const char* scenario, const uint8_t& burst)
+{
+	LoopbackChannel*      link = new LoopbackChannel;
+	loopbackConfigST      linkConfig;
+	SerialTransfer        tx;
+	SerialTransfer        rx;
+	PacketLatency         latency;
+	configST              config;
+	std::vector<uint32_t> exact[3];
+
+	linkConfig.bandwidth = 100000;
+	linkConfig.latency   = 200;
+	link->begin(linkConfig);
+
+	config.debug      = 0;
+	config.clock      = clockMicros;
+	config.timeout    = 100000;
+	config.timestamps = true;
+	tx.begin(link->a, config);
+
+	config.timestamps = false;
+	config.latency    = &latency;
+	rx.begin(link->b, config);
+
+	uint32_t start    = micros();
+	uint32_t nextSend = start;
+	uint32_t period   = 0;
+
+	while ((micros() - start) < (DURATION_US + 50000))
+	{
+		if (((micros() - start) < DURATION_US) && ((int32_t)(micros() - nextSend) >= 0))
+		{
+			memset(tx.packet.txBuff, 1, LEN);
+			tx.sendData(LEN, 1);
+
+			if (!(period % 10))
+			{
+				for (uint8_t i = 0; i < burst; i++)
+				{
+					memset(tx.packet.txBuff, 2, LEN);
+					tx.sendData(LEN, 2);
+				}
+			}
+
+			period++;
+			nextSend += PERIOD_US;
+		}
+
+		if (rx.available())
+		{
+			uint16_t command = rx.currentCommand();
+
+			if (command < 3)
+				exact[command].push_back(micros() - rx.packet.currentTimestamp());
+		}
+	}
+
+	report(scenario, 1, latency, exact[1]);
+	report(scenario, 2, latency, exact[2]);
+
+	delete link;
+}
+
+
+int main()
+{
+	printf("scenario,command,packets,oneway_p50_us,oneway_p90_us,oneway_p99_us,oneway_p999_us,oneway_max_us,exact_p99_us,dispatch_p50_us,dispatch_p99_us\n");
+
+	run("idle", 1);
+	run("bursts_of_8", 8);
+	run("bursts_of_32", 32);
+
+	return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ link_bench.cpp
+ Description:
+ ------------
+  * Host benchmark of SerialTransfer over the simulated transports.
+  One thread sends sequence-numbered packets while another receives
+  them, through an ideal LoopbackChannel (framing/parsing throughput
+  alone), Unix domain socket pairs (stream and seqpacket), lossy
+  loopback links and a bandwidth/latency-limited one. Reports
+  delivered frames, payload throughput, CPU time per frame and the
+  receiver's link statistics as CSV
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/link_bench.cpp src/Packet.cpp src/SerialTransfer.cpp src/PosixStream.cpp src/PosixSocket.cpp src/LoopbackStream.cpp extras/host/Arduino.cpp -o link_bench -lpthread
+*/
+#include "Arduino.h"
+#include "LoopbackStream.h"
+#include "PosixSocket.h"
+#include "SerialTransfer.h"
+#include <thread>
+#include <time.h>
+
+
+const uint32_t FRAMES     = 20000;
+const uint16_t LEN        = 254;
+const uint32_t RX_WAIT_MS = 500; // Receiver gives up after this long without a packet
+
+
+/*
+ double cpuMicros()
+ Description:
+ ------------
+  * Process CPU time (all threads) in us
+*/
+double cpuMicros()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+	return (ts.tv_sec * 1e6) + (ts.tv_nsec / 1e3);
+}
+
+
+/*
+ void run(const char* name, BulkStream& txPort, BulkStream& rxPort, LoopbackStream* txLoop, const uint32_t& frames, const uint32_t& maxInFlight)
+ Description:
+ ------------
+  * Sends "frames" packets from txPort to rxPort and prints a CSV row.
+  On loopback links the sender keeps at most "maxInFlight" bytes
+  queued rather than overrunning the buffer. Throughput counts up to
+  the last packet received
+*/
+void run(const char* name, BulkStream& txPort, BulkStream& rxPort, LoopbackStream* txLoop, const uint32_t& frames, const uint32_t& maxInFlight)
+{
+	SerialTransfer tx;
+	SerialTransfer rx;
+	configST       config;
+	uint32_t       framesOk = 0;
+
+	config.debug   = 0;
+	config.timeout = 50;
+	tx.begin(txPort, config);
+	rx.begin(rxPort, config);
+
+	double   cpuStart  = cpuMicros();
+	uint32_t wallStart = micros();
+	uint32_t wallEnd   = wallStart;
+
+	std::thread receiver([&] {
+		uint32_t lastPacket = millis();
+
+		while ((millis() - lastPacket) < RX_WAIT_MS)
+		{
+			if (rx.available())
+			{
+				uint32_t seq;
+
+				rx.rxObj(seq);
+
+				if ((rx.bytesRead == LEN) && (rx.packet.rxBuff[LEN - 1] == (uint8_t)seq))
+					framesOk++;
+
+				lastPacket = millis();
+				wallEnd    = micros();
+
+				if (seq == (frames - 1))
+					break;
+			}
+			else
+				std::this_thread::yield(); // Let the sender run on a single core
+		}
+	});
+
+	for (uint32_t seq = 0; seq < frames; seq++)
+	{
+		while (txLoop && ((LOOPBACK_BUFFER_SIZE - (uint32_t)txLoop->availableForWrite()) > (maxInFlight - PACKET_SIZE)))
+			std::this_thread::yield();
+
+		memset(tx.packet.txBuff, (uint8_t)seq, LEN);
+		tx.txObj(seq);
+		tx.sendData(LEN);
+	}
+
+	receiver.join();
+
+	double      wallUs = wallEnd - wallStart;
+	double      cpuUs  = cpuMicros() - cpuStart;
+	linkStatsST stats  = rx.packet.stats;
+
+	printf("%s,%u,%u,%.2f,%.2f,%u,%u\n", name, frames, framesOk, ((double)framesOk * LEN) / wallUs, cpuUs / frames, stats.crcErrors + stats.payloadErrors + stats.stopByteErrors + stats.staleErrors, stats.resyncBytes);
+}
+
+
+/*
+ void runLoopback(const char* name, const loopbackConfigST& config, const uint32_t& frames, const uint32_t& maxInFlight = LOOPBACK_BUFFER_SIZE)
+ Description:
+ ------------
+  * Runs the benchmark over a fresh LoopbackChannel
+*/
+void runLoopback(const char* name, const loopbackConfigST& config, const uint32_t& frames, const uint32_t& maxInFlight = LOOPBACK_BUFFER_SIZE)
+{
+	LoopbackChannel* link = new LoopbackChannel; // Too big for the stack
+
+	link->begin(config);
+	run(name, link->a, link->b, &link->a, frames, maxInFlight);
+
+	delete link;
+}
+
+
+/*
+ void runSocket(const char* name, const int& type)
+ Description:
+ ------------
+  * Runs the benchmark over a fresh Unix domain socket pair
+*/
+void runSocket(const char* name, const int& type)
+{
+	PosixSocket a;
+	PosixSocket b;
+
+	if (!PosixSocket::pair(a, b, type))
+		return;
+
+	run(name, a, b, NULL, FRAMES, 0);
+}
+
+
+int main()
+{
+	loopbackConfigST config;
+
+	printf("transport,frames_sent,frames_ok,payload_MBps,cpu_us_per_frame,rx_errors,resync_bytes\n");
+
+	runLoopback("loopback", config, FRAMES);
+	runSocket("unix_stream", SOCK_STREAM);
+	runSocket("unix_seqpacket", SOCK_SEQPACKET);
+
+	config.ber = 1e-5; // A UART-sized backlog, SerialTransfer drops what is buffered after a bad frame
+	runLoopback("loopback_ber_1e-5", config, FRAMES, 2 * PACKET_SIZE);
+
+	config.ber = 1e-4;
+	runLoopback("loopback_ber_1e-4", config, FRAMES, 2 * PACKET_SIZE);
+
+	config.ber       = 0;
+	config.bandwidth = 1000000;
+	config.latency   = 500;
+	runLoopback("loopback_1MBps_500us", config, 2000);
+
+	return 0;
+}
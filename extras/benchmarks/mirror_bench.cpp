@@ -0,0 +1,200 @@
+/*
+ mirror_bench.cpp
+ Description:
+ ------------
+  * Host benchmark of StateMirror. Streams a 200-byte state struct of
+  which a few fields change per update between two SerialTransfers
+  over an in-process LoopbackChannel, once with sendDatum() and once
+  mirrored (with and without a return path for ACKs), at several bit
+  error rates. Reports wire bytes per update each way, the reduction
+  against sendDatum() and how often the receiver's copy was stale as
+  CSV. Also checks that changed() reports exactly the bytes that
+  changed
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/mirror_bench.cpp src/Packet.cpp src/SerialTransfer.cpp src/StateMirror.cpp src/LoopbackStream.cpp extras/host/Arduino.cpp -o mirror_bench -lpthread
+ Usage:
+ ------
+  * mirror_bench
+*/
+#include "Arduino.h"
+#include "LoopbackStream.h"
+#include "SerialTransfer.h"
+#include "StateMirror.h"
+#include <stdio.h>
+
+
+const uint32_t UPDATES = 20000; // 200 s at 100 Hz
+
+
+struct vehicleState
+{
+	uint32_t time;
+	float    position[3];
+	float    velocity[3];
+	float    attitude[4];
+	int16_t  motors[8];
+	uint16_t battery;
+	int16_t  temperature[8];
+	uint8_t  mode;
+	uint8_t  flags;
+	uint32_t errors;
+	uint8_t  config[116];
+};
+
+static_assert(sizeof(vehicleState) == 200, "vehicleState is 200 bytes");
+
+
+/*
+ uint32_t next(uint32_t& seed)
+ Description:
+ ------------
+  * xorshift32
+*/
+uint32_t next(uint32_t& seed)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+
+	return seed;
+}
+
+
+/*
+ void step(vehicleState& state, const uint32_t& n, uint32_t& seed)
+ Description:
+ ------------
+  * Advances the state one 10 ms update: the clock, one axis of the
+  position and two motors every update, the rest now and then
+*/
+void step(vehicleState& state, const uint32_t& n, uint32_t& seed)
+{
+	state.time        += 10;
+	state.position[0] += 0.01f;
+
+	state.motors[next(seed) & 7] = next(seed) & 0x3FF;
+	state.motors[next(seed) & 7] = next(seed) & 0x3FF;
+
+	if (!(n % 10))
+		state.battery = 11000 + (next(seed) % 1500);
+
+	if (!(n % 50))
+		state.temperature[next(seed) & 7] = next(seed) % 900;
+
+	if (!(n % 1000))
+		state.mode++;
+
+	if (!(n % 2000))
+		state.config[next(seed) % sizeof(state.config)] = next(seed);
+}
+
+
+/*
+ void run(const char* scenario, const bool& mirrored, const bool& twoWay, const double& ber)
+ Description:
+ ------------
+  * Sends UPDATES updates and prints a CSV row
+*/
+void run(const char* scenario, const bool& mirrored, const bool& twoWay, const double& ber)
+{
+	LoopbackChannel* link = new LoopbackChannel;
+	loopbackConfigST linkConfig;
+	SerialTransfer   tx;
+	SerialTransfer   rx;
+	configST         config;
+	StateMirror      sender;
+	StateMirror      receiver;
+	vehicleState     txState;
+	vehicleState     rxState;
+	vehicleState     before;
+	uint32_t         seed       = 1;
+	uint32_t         stale      = 0;
+	uint32_t         wrongFlags = 0;
+
+	memset(&txState, 0, sizeof(txState));
+	memset(&rxState, 0, sizeof(rxState));
+
+	linkConfig.ber = ber;
+	link->begin(linkConfig);
+
+	config.debug = 0;
+	tx.begin(link->a, config);
+	rx.begin(link->b, config);
+
+	sender.begin(tx, &txState, sizeof(txState), 1);
+	receiver.begin(rx, &rxState, sizeof(rxState), 1);
+
+	for (uint32_t n = 0; n < UPDATES; n++)
+	{
+		step(txState, n, seed);
+
+		if (mirrored)
+		{
+			sender.update();
+
+			before = rxState;
+
+			if (receiver.available())
+				for (uint16_t i = 0; i < sizeof(rxState); i++)
+					if (receiver.changed(i, 1) != (((uint8_t*)&before)[i] != ((uint8_t*)&rxState)[i]))
+						wrongFlags++;
+
+			if (twoWay)
+				sender.available();
+			else
+				while (link->a.available()) // Return path down
+					link->a.read();
+		}
+		else
+		{
+			tx.sendDatum(txState);
+
+			while (rx.available())
+				if (rx.status == NEW_DATA)
+					rx.rxObj(rxState);
+		}
+
+		if (memcmp(&txState, &rxState, sizeof(txState)))
+			stale++;
+	}
+
+	uint32_t forward = link->a.txStats().bytesSent;
+	uint32_t reverse = twoWay ? link->b.txStats().bytesSent : 0;
+
+	static double baseline = 0;
+
+	if (!mirrored)
+		baseline = forward;
+
+	printf("%s,%g,%.1f,%.1f,%.2f,%u,%u,%u,%u,%u\n",
+	       scenario,
+	       ber,
+	       (double)forward / UPDATES,
+	       (double)reverse / UPDATES,
+	       baseline / forward,
+	       stale,
+	       sender.keyframesSent,
+	       sender.deltasSent,
+	       receiver.updatesDropped,
+	       wrongFlags);
+
+	delete link;
+}
+
+
+int main()
+{
+	const double bers[] = {0, 1e-5, 1e-4};
+
+	printf("scenario,ber,wire_bytes_per_update,return_bytes_per_update,reduction,stale_updates,keyframes,deltas,deltas_dropped,wrong_changed_flags\n");
+
+	for (uint8_t i = 0; i < (sizeof(bers) / sizeof(bers[0])); i++)
+	{
+		run("sendDatum", false, false, bers[i]);
+		run("mirror", true, true, bers[i]);
+		run("mirror-one-way", true, false, bers[i]);
+	}
+
+	return 0;
+}
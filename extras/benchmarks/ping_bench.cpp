@@ -0,0 +1,102 @@
+/*
+ ping_bench.cpp
+ Description:
+ ------------
+  * Host benchmark of SerialTransfer::ping(). Two ends share a
+  LoopbackChannel limited to 100 kB/s with a configurable latency and
+  count us on clocks skewed by a known offset. The pinging end sends
+  an automatic ping every 5 ms for 2 s, with and without data queued
+  behind it, and reports the estimated RTT, variance, suggested
+  timeout and clock offset error (us) as CSV
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/ping_bench.cpp src/Packet.cpp src/SerialTransfer.cpp src/LoopbackStream.cpp extras/host/Arduino.cpp -o ping_bench -lpthread
+*/
+#include "Arduino.h"
+#include "LoopbackStream.h"
+#include "SerialTransfer.h"
+
+
+const uint32_t DURATION_US = 2000000;
+const uint32_t INTERVAL_US = 5000; // Between automatic pings
+const int32_t  SKEW_US     = 123456; // Peer's clock runs this far ahead
+const uint16_t LEN         = 64;
+
+
+/*
+ uint32_t peerClock()
+ Description:
+ ------------
+  * The peer's clock, SKEW_US ahead of micros()
+*/
+uint32_t peerClock()
+{
+	return micros() + SKEW_US;
+}
+
+
+/*
+ void run(const char* scenario, const uint32_t& latencyUs, const uint8_t& load)
+ Description:
+ ------------
+  * Pings the peer for DURATION_US while sending "load" data packets
+  per ping interval, then prints a CSV row
+*/
+void run(const char* scenario, const uint32_t& latencyUs, const uint8_t& load)
+{
+	LoopbackChannel* link = new LoopbackChannel;
+	loopbackConfigST linkConfig;
+	SerialTransfer   local;
+	SerialTransfer   peer;
+	configST         config;
+
+	linkConfig.bandwidth = 100000;
+	linkConfig.latency   = latencyUs;
+	link->begin(linkConfig);
+
+	config.debug        = 0;
+	config.timeout      = 100000;
+	config.clock        = clockMicros;
+	config.pingInterval = INTERVAL_US;
+	local.begin(link->a, config);
+
+	config.clock        = peerClock;
+	config.pingInterval = 0;
+	peer.begin(link->b, config);
+
+	uint32_t start    = micros();
+	uint32_t nextSend = start;
+
+	while ((micros() - start) < DURATION_US)
+	{
+		if (load && ((int32_t)(micros() - nextSend) >= 0))
+		{
+			memset(local.packet.txBuff, 1, LEN);
+
+			for (uint8_t i = 0; i < load; i++)
+				local.sendData(LEN, 1);
+
+			nextSend += INTERVAL_US;
+		}
+
+		local.available();
+		peer.available();
+	}
+
+	printf("%s,%u,%u,%u,%u,%u,%u,%d\n", scenario, latencyUs, load, local.rttSamples(), local.smoothedRTT(), local.rttVariance(), local.suggestedTimeout(), local.clockOffset() - SKEW_US);
+
+	delete link;
+}
+
+
+int main()
+{
+	printf("scenario,latency_us,load_packets,samples,srtt_us,rttvar_us,suggested_timeout_us,offset_error_us\n");
+
+	run("idle", 200, 0);
+	run("idle", 2000, 0);
+	run("loaded", 2000, 4);
+	run("loaded", 2000, 6);
+
+	return 0;
+}
@@ -0,0 +1,231 @@
+/*
+ pty_bench.cpp
+ Description:
+ ------------
+  * End-to-end host test of SerialTransfer over a pseudo-terminal pair.
+  One thread sends sequence-numbered max-size packets into the pty
+  master while another receives them from the slave, first through a
+  naive Stream that costs a syscall per byte (FdStream), then through
+  PosixSerial. Reports delivered frames, payload throughput and CPU
+  time per frame as CSV
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/pty_bench.cpp src/Packet.cpp src/SerialTransfer.cpp src/PosixStream.cpp src/PosixSerial.cpp extras/host/Arduino.cpp -o pty_bench -lpthread
+*/
+#include "Arduino.h"
+#include "SerialTransfer.h"
+#include "PosixSerial.h"
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
+
+const uint32_t FRAMES     = 5000;
+const uint32_t BAUD       = 3000000;
+const uint32_t RX_WAIT_MS = 5000; // Receiver gives up after this long without a packet
+
+
+/*
+ class FdStream
+ Description:
+ ------------
+  * Stream the way it is usually faked around a file descriptor: one
+  ioctl()/read() per byte received and one write() per block sent
+*/
+class FdStream : public Stream
+{
+  public: // <<---------------------------------------//public
+	int fd = -1;
+
+
+	int available()
+	{
+		int count = 0;
+		ioctl(fd, FIONREAD, &count);
+		return count;
+	}
+
+	int read()
+	{
+		uint8_t val;
+		return (::read(fd, &val, 1) == 1) ? val : -1;
+	}
+
+	int peek()
+	{
+		return -1;
+	}
+
+	size_t write(uint8_t val)
+	{
+		return write(&val, 1);
+	}
+
+	size_t write(const uint8_t* buffer, size_t size)
+	{
+		size_t total = 0;
+
+		while (total < size)
+		{
+			ssize_t written = ::write(fd, buffer + total, size - total);
+
+			if (written <= 0)
+				break;
+
+			total += written;
+		}
+
+		return total;
+	}
+
+	using Print::write;
+};
+
+
+/*
+ double cpuMicros()
+ Description:
+ ------------
+  * Process CPU time (all threads) in us
+*/
+double cpuMicros()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+	return (ts.tv_sec * 1e6) + (ts.tv_nsec / 1e3);
+}
+
+
+/*
+ bool openPty(int& master, char slavePath[], const size_t& len)
+ Description:
+ ------------
+  * Opens a new pseudo-terminal pair
+*/
+bool openPty(int& master, char slavePath[], const size_t& len)
+{
+	master = posix_openpt(O_RDWR | O_NOCTTY);
+
+	if ((master < 0) || grantpt(master) || unlockpt(master) || ptsname_r(master, slavePath, len))
+		return false;
+
+	return true;
+}
+
+
+/*
+ void run(const char* name, SerialTransfer& tx, SerialTransfer& rx, PosixSerial* rxPosix)
+ Description:
+ ------------
+  * Sends FRAMES packets from tx to rx and prints a CSV row
+*/
+void run(const char* name, SerialTransfer& tx, SerialTransfer& rx, PosixSerial* rxPosix)
+{
+	uint32_t framesOk  = 0;
+	uint32_t lastSeq   = 0;
+	uint16_t len       = MAX_PACKET_SIZE;
+	double   cpuStart  = cpuMicros();
+	uint32_t wallStart = micros();
+
+	std::thread receiver([&] {
+		uint32_t lastPacket = millis();
+
+		while ((framesOk < FRAMES) && ((millis() - lastPacket) < RX_WAIT_MS))
+		{
+			if (rxPosix)
+				rxPosix->waitAvailable(1);
+
+			if (rx.available())
+			{
+				uint32_t seq;
+
+				rx.rxObj(seq);
+
+				if ((rx.bytesRead == len) && (seq == lastSeq) && (rx.packet.rxBuff[len - 1] == (uint8_t)seq))
+					framesOk++;
+
+				lastSeq    = seq + 1;
+				lastPacket = millis();
+			}
+		}
+	});
+
+	for (uint32_t seq = 0; seq < FRAMES; seq++)
+	{
+		memset(tx.packet.txBuff, (uint8_t)seq, len);
+		tx.txObj(seq);
+		tx.sendData(len);
+	}
+
+	receiver.join();
+
+	double wallUs = micros() - wallStart;
+	double cpuUs  = cpuMicros() - cpuStart;
+
+	printf("%s,%u,%u,%.2f,%.2f\n", name, framesOk, FRAMES, ((double)framesOk * len) / wallUs, cpuUs / FRAMES);
+}
+
+
+int main()
+{
+	int      master;
+	char     slavePath[64];
+	configST config;
+
+	config.debug   = 0;
+	config.timeout = 1000;
+
+	printf("transport,frames_ok,frames_sent,payload_MBps,cpu_us_per_frame\n");
+
+	{
+		FdStream       txPort;
+		FdStream       rxPort;
+		SerialTransfer tx;
+		SerialTransfer rx;
+
+		if (!openPty(master, slavePath, sizeof(slavePath)))
+			return 1;
+
+		PosixSerial setup; // Raw mode only, the streams below do the I/O
+
+		txPort.fd = master;
+		rxPort.fd = open(slavePath, O_RDWR | O_NOCTTY);
+
+		setup.begin(master, BAUD);
+		setup.begin(rxPort.fd, BAUD);
+		fcntl(master, F_SETFL, fcntl(master, F_GETFL) & ~O_NONBLOCK); // Blocking writes
+		tx.begin(txPort, config);
+		rx.begin(rxPort, config);
+
+		run("fd_per_byte", tx, rx, NULL);
+
+		close(rxPort.fd);
+		close(master);
+	}
+
+	{
+		PosixSerial    txPort;
+		PosixSerial    rxPort;
+		SerialTransfer tx;
+		SerialTransfer rx;
+
+		if (!openPty(master, slavePath, sizeof(slavePath)))
+			return 1;
+
+		if (!txPort.begin(master, BAUD) || !rxPort.begin(slavePath, BAUD))
+			return 1;
+
+		tx.begin(txPort, config);
+		rx.begin(rxPort, config);
+
+		run("posix_serial", tx, rx, &rxPort);
+
+		txPort.end();
+		close(master);
+	}
+
+	return 0;
+}
@@ -0,0 +1,304 @@
+/*
+ reliable_bench.cpp
+ Description:
+ ------------
+  * Lossy-channel check and benchmark of ReliableTransfer. Two
+  SerialTransfers are joined by an in-process LoopbackChannel running
+  at 1 MB/s with bit errors in both directions. One end sends MESSAGES
+  numbered payloads of pseudo-random length, content and command
+  (several sequence number wraps) while the other checks that each one
+  arrives in order, exactly once and intact. Prints one CSV row per
+  bit error rate and exits non-zero if any message was lost, repeated,
+  reordered or damaged. A second table runs request/response traffic:
+  the other end answers each request from inside its available() loop,
+  while still holding the request, and every answer must come back the
+  same way:
+   * delivered - Messages received in order and intact
+   * bad - Messages out of order, repeated, damaged or with the wrong
+   command (must be 0)
+   * retransmissions/checksum_errors - Payloads resent and packets the
+   CRC-16 caught after the link's CRC-8 let them through
+   * rto_ms - Retransmit timeout at the end of the run
+   * goodput_Bps - Payload bytes delivered per second
+   * seed - Seed of the channel's bit errors (request/response only)
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/reliable_bench.cpp src/Packet.cpp src/SerialTransfer.cpp src/ReliableTransfer.cpp src/LoopbackStream.cpp extras/host/Arduino.cpp -o reliable_bench -lpthread
+ Usage:
+ ------
+  * reliable_bench
+*/
+#include "Arduino.h"
+#include "LoopbackStream.h"
+#include "ReliableTransfer.h"
+#include <stdio.h>
+
+
+const uint32_t MESSAGES  = 3000;    // Per bit error rate, over 11 sequence number wraps
+const uint16_t MAX_LEN   = 256;     // Largest message
+const uint32_t BANDWIDTH = 1000000; // Bytes per second each way
+const uint32_t TIME_OUT  = 60000;   // ms to deliver all messages
+
+
+/*
+ uint16_t message(const uint32_t& n, uint8_t arr[], uint16_t& command)
+ Description:
+ ------------
+  * Builds message "n": its number, then bytes from a generator seeded
+  with it, so the receiver can rebuild it to compare
+*/
+uint16_t message(const uint32_t& n, uint8_t arr[], uint16_t& command)
+{
+	uint32_t seed = (n * 2654435761UL) | 1;
+	uint16_t len;
+
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+
+	len     = 4 + (seed % (MAX_LEN - 3));
+	command = (seed >> 16) % (MAX_PACKET_SIZE + 1); // The parser takes commands up to MAX_PACKET_SIZE
+
+	arr[0] = (n >> 24) & 0xFF;
+	arr[1] = (n >> 16) & 0xFF;
+	arr[2] = (n >> 8) & 0xFF;
+	arr[3] = n & 0xFF;
+
+	for (uint16_t i = 4; i < len; i++)
+	{
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		arr[i] = seed;
+	}
+
+	return len;
+}
+
+
+/*
+ bool run(const double& ber)
+ Description:
+ ------------
+  * Sends MESSAGES messages and prints a CSV row. Returns whether or not
+  all of them arrived in order, exactly once and intact
+*/
+bool run(const double& ber)
+{
+	LoopbackChannel* link = new LoopbackChannel;
+	loopbackConfigST linkConfig;
+	SerialTransfer   txLink;
+	SerialTransfer   rxLink;
+	configST         config;
+	ReliableTransfer tx;
+	ReliableTransfer rx;
+	uint8_t          sent[MAX_LEN];
+	uint8_t          expected[MAX_LEN];
+	uint8_t          got[MAX_LEN];
+	uint32_t         next      = 0;
+	uint32_t         delivered = 0;
+	uint32_t         bad       = 0;
+	uint32_t         bytes     = 0;
+
+	linkConfig.bandwidth = BANDWIDTH;
+	linkConfig.ber       = ber;
+	link->begin(linkConfig);
+
+	config.debug = 0;
+	txLink.begin(link->a, config);
+	rxLink.begin(link->b, config);
+
+	tx.begin(txLink);
+	rx.begin(rxLink);
+
+	uint32_t start = millis();
+
+	while ((delivered < MESSAGES) && ((millis() - start) < TIME_OUT))
+	{
+		while ((next < MESSAGES) && tx.canSend())
+		{
+			uint16_t command;
+			uint16_t len = message(next, sent, command);
+
+			if (tx.send(sent, len, command) != len)
+				break;
+
+			next++;
+		}
+
+		tx.tick();
+
+		while (rx.available())
+		{
+			uint16_t command;
+			uint16_t len = message(delivered, expected, command);
+
+			rx.rxObj(got, 0, rx.bytesRead);
+
+			if ((rx.bytesRead != len) || (rx.currentCommand() != command) || memcmp(got, expected, len))
+				bad++;
+			else
+				bytes += len;
+
+			delivered++;
+		}
+	}
+
+	uint32_t elapsed = millis() - start;
+
+	printf("%g,%u,%u,%u,%u,%u,%.0f\n",
+	       ber,
+	       delivered - bad,
+	       bad,
+	       tx.retransmissions(),
+	       tx.checksumErrors() + rx.checksumErrors(),
+	       tx.currentRTO(),
+	       (bytes * 1000.0) / (elapsed ? elapsed : 1));
+
+	delete link;
+
+	return (delivered == MESSAGES) && !bad;
+}
+
+
+/*
+ bool runEcho(const double& ber, const uint32_t& seed)
+ Description:
+ ------------
+  * Sends MESSAGES requests, as fast as the window allows, to
+  an end that echoes each one as soon as available() delivers it.
+  Prints a CSV row and returns whether or not every answer arrived in
+  order, exactly once and intact
+*/
+bool runEcho(const double& ber, const uint32_t& seed)
+{
+	LoopbackChannel* link = new LoopbackChannel;
+	loopbackConfigST linkConfig;
+	SerialTransfer   clientLink;
+	SerialTransfer   serverLink;
+	configST         config;
+	ReliableTransfer client;
+	ReliableTransfer server;
+	uint8_t          buff[MAX_LEN];
+	uint8_t          expected[MAX_LEN];
+	uint8_t          got[MAX_LEN];
+	uint32_t         requested = 0; // Sent by the client
+	uint32_t         served    = 0; // Received by the server
+	uint32_t         answered  = 0; // Sent by the server
+	uint32_t         delivered = 0; // Answers received by the client
+	uint32_t         bad       = 0;
+	uint32_t         bytes     = 0;
+
+	linkConfig.bandwidth = BANDWIDTH;
+	linkConfig.ber       = ber;
+	linkConfig.seed      = seed;
+	link->begin(linkConfig);
+
+	config.debug = 0;
+	clientLink.begin(link->a, config);
+	serverLink.begin(link->b, config);
+
+	client.begin(clientLink);
+	server.begin(serverLink);
+
+	uint32_t start = millis();
+
+	while ((delivered < MESSAGES) && ((millis() - start) < TIME_OUT))
+	{
+		while ((requested < MESSAGES) && client.canSend())
+		{
+			uint16_t command;
+			uint16_t len = message(requested, buff, command);
+
+			if (client.send(buff, len, command) != len)
+				break;
+
+			requested++;
+		}
+
+		while (server.available())
+		{
+			uint16_t command;
+			uint16_t len = message(served, expected, command);
+
+			server.rxObj(got, 0, server.bytesRead);
+
+			if ((server.bytesRead != len) || (server.currentCommand() != command) || memcmp(got, expected, len))
+				bad++;
+
+			served++;
+
+			while ((answered < served) && server.canSend()) // Answer while the request is still held
+			{
+				len = message(answered, buff, command);
+
+				if (server.send(buff, len, command) != len)
+					break;
+
+				answered++;
+			}
+		}
+
+		while ((answered < served) && server.canSend()) // Answers the window held back
+		{
+			uint16_t command;
+			uint16_t len = message(answered, buff, command);
+
+			if (server.send(buff, len, command) != len)
+				break;
+
+			answered++;
+		}
+
+		while (client.available())
+		{
+			uint16_t command;
+			uint16_t len = message(delivered, expected, command);
+
+			client.rxObj(got, 0, client.bytesRead);
+
+			if ((client.bytesRead != len) || (client.currentCommand() != command) || memcmp(got, expected, len))
+				bad++;
+			else
+				bytes += len;
+
+			delivered++;
+		}
+	}
+
+	uint32_t elapsed = millis() - start;
+
+	printf("%g,%u,%u,%u,%u,%u,%u,%.0f\n",
+	       ber,
+	       seed,
+	       delivered - bad,
+	       bad,
+	       client.retransmissions() + server.retransmissions(),
+	       client.checksumErrors() + server.checksumErrors(),
+	       client.currentRTO(),
+	       (bytes * 1000.0) / (elapsed ? elapsed : 1));
+
+	delete link;
+
+	return (delivered == MESSAGES) && !bad;
+}
+
+
+int main()
+{
+	const double bers[] = {0, 1e-5, 1e-4, 5e-4}; // 5e-4 damages about half the frames
+	bool         ok     = true;
+
+	printf("ber,delivered,bad,retransmissions,checksum_errors,rto_ms,goodput_Bps\n");
+
+	for (uint8_t i = 0; i < (sizeof(bers) / sizeof(bers[0])); i++)
+		ok &= run(bers[i]);
+
+	printf("ber,seed,answered,bad,retransmissions,checksum_errors,rto_ms,goodput_Bps\n");
+
+	for (uint8_t i = 2; i < (sizeof(bers) / sizeof(bers[0])); i++) // Lossy enough to lose ACKs
+		for (uint32_t seed = 1; seed <= 4; seed++)
+			ok &= runEcho(bers[i], seed);
+
+	return ok ? 0 : 1;
+}
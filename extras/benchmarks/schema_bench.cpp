@@ -0,0 +1,258 @@
+/*
+ schema_bench.cpp
+ Description:
+ ------------
+  * Host benchmark of PacketSchema. Checks a schema's encoded bytes
+  against the same struct packed by hand (little endian, no padding)
+  and its round trip, then times txObj()/rxObj() of the raw struct and
+  packing it by hand against txSchema()/rxSchema(), reporting ns per
+  struct and wire size as CSV
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/schema_bench.cpp src/Packet.cpp extras/host/Arduino.cpp -o schema_bench
+ Usage:
+ ------
+  * schema_bench
+*/
+#include "Arduino.h"
+#include "Packet.h"
+#include "PacketSchema.h"
+#include <stdio.h>
+
+
+const uint32_t ITERATIONS = 10000000;
+
+
+struct telemetry
+{
+	uint8_t  node;
+	uint32_t time;
+	int16_t  temperature;
+	float    volts;
+	double   position;
+	bool     armed;
+	int32_t  accel[3];
+	uint64_t counter;
+};
+
+typedef PacketSchema<SCHEMA_FIELD(telemetry, node),
+                     SCHEMA_FIELD(telemetry, time),
+                     SCHEMA_FIELD(telemetry, temperature),
+                     SCHEMA_FIELD(telemetry, volts),
+                     SCHEMA_FIELD(telemetry, position),
+                     SCHEMA_FIELD(telemetry, armed),
+                     SCHEMA_FIELD(telemetry, accel),
+                     SCHEMA_FIELD(telemetry, counter)> telemetrySchema;
+
+static_assert(telemetrySchema::SIZE == 40, "telemetrySchema is 40 bytes on the wire");
+
+
+/*
+ uint16_t pack(uint8_t arr[], const uint64_t& val, const uint8_t& len, uint16_t index)
+ Description:
+ ------------
+  * Hand-packs the low "len" bytes of "val" little endian at arr[index]
+*/
+uint16_t pack(uint8_t arr[], const uint64_t& val, const uint8_t& len, uint16_t index)
+{
+	for (uint8_t i = 0; i < len; i++)
+		arr[index++] = (val >> (8 * i)) & 0xFF;
+
+	return index;
+}
+
+
+/*
+ uint16_t unpack(const uint8_t arr[], uint64_t& val, const uint8_t& len, uint16_t index)
+ Description:
+ ------------
+  * Reads "len" little endian bytes at arr[index] into "val"
+*/
+uint16_t unpack(const uint8_t arr[], uint64_t& val, const uint8_t& len, uint16_t index)
+{
+	val = 0;
+
+	for (uint8_t i = 0; i < len; i++)
+		val |= (uint64_t)arr[index++] << (8 * i);
+
+	return index;
+}
+
+
+/*
+ uint16_t handPack(const telemetry& val, uint8_t arr[])
+ Description:
+ ------------
+  * Packs "val" field by field with shifts, the way it is done without
+  a schema
+*/
+uint16_t handPack(const telemetry& val, uint8_t arr[])
+{
+	uint16_t index = 0;
+	uint32_t volts;
+	uint64_t position;
+
+	memcpy(&volts, &val.volts, sizeof(volts));
+	memcpy(&position, &val.position, sizeof(position));
+
+	index = pack(arr, val.node, 1, index);
+	index = pack(arr, val.time, 4, index);
+	index = pack(arr, (uint16_t)val.temperature, 2, index);
+	index = pack(arr, volts, 4, index);
+	index = pack(arr, position, 8, index);
+	index = pack(arr, val.armed, 1, index);
+
+	for (uint8_t i = 0; i < 3; i++)
+		index = pack(arr, (uint32_t)val.accel[i], 4, index);
+
+	return pack(arr, val.counter, 8, index);
+}
+
+
+/*
+ uint16_t handUnpack(const uint8_t arr[], telemetry& val)
+ Description:
+ ------------
+  * Reverse of handPack()
+*/
+uint16_t handUnpack(const uint8_t arr[], telemetry& val)
+{
+	uint16_t index = 0;
+	uint64_t field;
+	uint32_t volts;
+
+	index = unpack(arr, field, 1, index); val.node        = field;
+	index = unpack(arr, field, 4, index); val.time        = field;
+	index = unpack(arr, field, 2, index); val.temperature = field;
+	index = unpack(arr, field, 4, index); volts           = field;
+	memcpy(&val.volts, &volts, sizeof(volts));
+	index = unpack(arr, field, 8, index);
+	memcpy(&val.position, &field, sizeof(field));
+	index = unpack(arr, field, 1, index); val.armed       = field;
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		index        = unpack(arr, field, 4, index);
+		val.accel[i] = field;
+	}
+
+	return unpack(arr, val.counter, 8, index);
+}
+
+
+/*
+ bool check(const telemetry& val)
+ Description:
+ ------------
+  * Compares the schema's encoding of "val" with a hand-packed one and
+  decodes it back
+*/
+bool check(const telemetry& val)
+{
+	uint8_t   encoded[telemetrySchema::SIZE];
+	uint8_t   expected[telemetrySchema::SIZE];
+	telemetry decoded;
+
+	telemetrySchema::encode(val, encoded);
+	memset(&decoded, 0, sizeof(decoded));
+	telemetrySchema::decode(encoded, decoded);
+
+	return (handPack(val, expected) == sizeof(expected)) &&
+	       !memcmp(encoded, expected, sizeof(expected)) &&
+	       (decoded.node == val.node) &&
+	       (decoded.time == val.time) &&
+	       (decoded.temperature == val.temperature) &&
+	       !memcmp(&decoded.volts, &val.volts, sizeof(val.volts)) &&
+	       !memcmp(&decoded.position, &val.position, sizeof(val.position)) &&
+	       (decoded.armed == val.armed) &&
+	       !memcmp(decoded.accel, val.accel, sizeof(val.accel)) &&
+	       (decoded.counter == val.counter);
+}
+
+
+int main()
+{
+	Packet    packet;
+	configST  config;
+	telemetry val     = {7, 123456789, -4012, 3.3f, -1234.5678, true, {-1, 65536, -32768}, 0x0123456789ABCDEFULL};
+	uint32_t  seed    = 1;
+	uint32_t  checked = 0;
+	uint32_t  sum     = 0;
+
+	config.debug = 0;
+	packet.begin(config);
+
+	for (; checked < 100000; checked++)
+	{
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+
+		val.node        = seed;
+		val.time        = seed * 2654435761UL;
+		val.temperature = seed >> 7;
+		val.volts       = (float)seed / 977;
+		val.position    = -(double)seed / 13;
+		val.armed       = seed & 1;
+		val.accel[0]    = seed ^ 0x80000000UL;
+		val.accel[1]    = -(int32_t)seed;
+		val.accel[2]    = seed >> 3;
+		val.counter     = ((uint64_t)seed << 32) | ~seed;
+
+		if (!check(val))
+		{
+			printf("schema encoding mismatch for seed %u\n", seed);
+			return 1;
+		}
+	}
+
+	printf("op,struct_bytes,wire_bytes,iterations,ns_per_struct\n");
+
+	uint32_t start = micros();
+
+	for (uint32_t i = 0; i < ITERATIONS; i++)
+	{
+		val.time = i;
+		packet.txObj(val);
+		memcpy(packet.rxBuff, packet.txBuff, sizeof(val));
+		packet.rxObj(val);
+		sum += val.time;
+	}
+
+	double elapsed = micros() - start;
+
+	printf("txObj+rxObj,%u,%u,%u,%.2f\n", (uint32_t)sizeof(telemetry), (uint32_t)sizeof(telemetry), ITERATIONS, (elapsed * 1000) / ITERATIONS);
+
+	start = micros();
+
+	for (uint32_t i = 0; i < ITERATIONS; i++)
+	{
+		val.time = i;
+		handPack(val, packet.txBuff);
+		memcpy(packet.rxBuff, packet.txBuff, telemetrySchema::SIZE);
+		handUnpack(packet.rxBuff, val);
+		sum += val.time;
+	}
+
+	elapsed = micros() - start;
+
+	printf("hand-packed,%u,%u,%u,%.2f\n", (uint32_t)sizeof(telemetry), (uint32_t)telemetrySchema::SIZE, ITERATIONS, (elapsed * 1000) / ITERATIONS);
+
+	start = micros();
+
+	for (uint32_t i = 0; i < ITERATIONS; i++)
+	{
+		val.time = i;
+		packet.txSchema<telemetrySchema>(val);
+		memcpy(packet.rxBuff, packet.txBuff, telemetrySchema::SIZE);
+		packet.rxSchema<telemetrySchema>(val);
+		sum += val.time;
+	}
+
+	elapsed = micros() - start;
+
+	printf("txSchema+rxSchema,%u,%u,%u,%.2f\n", (uint32_t)sizeof(telemetry), (uint32_t)telemetrySchema::SIZE, ITERATIONS, (elapsed * 1000) / ITERATIONS);
+	printf("\n%u random structs matched their hand-packed bytes (checksum %u)\n", checked, sum);
+
+	return 0;
+}
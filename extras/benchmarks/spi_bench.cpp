@@ -0,0 +1,292 @@
+/*
+ spi_bench.cpp
+ Description:
+ ------------
+  * Host check and benchmark of SPITransfer over the mock SPI bus in
+  extras/host, with a master and a slave in one process (the slave's
+  SPI interrupt is a function the bus calls per byte). Prints one CSV
+  row per case and exits non-zero if any check fails:
+   * blocks - FRAMES packets of every length up to MAX_PACKET_SIZE,
+   each clocked out by a single block transfer and checked in full
+   by the slave
+   * ready-line - The slave stops reading, so the master must stop
+   sending (sendData() returns 0 once the ready line drops) without
+   a byte reaching the full RX ring. Once the slave reads again,
+   every packet accepted arrives intact and sending resumes
+   * exchange-shorter/exchange-longer - exchange() requests answered
+   with replies half or twice their length, each checked in full
+   * reply-during-send - The master uses sendData() while the slave
+   has a reply queued, which must be reported by the master's next
+   available()
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/spi_bench.cpp src/Packet.cpp src/SPITransfer.cpp extras/host/Arduino.cpp extras/host/SPI.cpp -o spi_bench
+ Usage:
+ ------
+  * spi_bench
+*/
+#include "Arduino.h"
+#include "SPI.h"
+#include "SPITransfer.h"
+#include <stdio.h>
+
+
+const uint32_t FRAMES    = 20000;
+const uint8_t  READY_PIN = 7; // Looped back by the host's digitalWrite()/digitalRead()
+
+
+SPITransfer master;
+SPITransfer slave;
+
+
+/*
+ uint8_t slaveISR(const uint8_t mosi)
+ Description:
+ ------------
+  * Stands in for the slave's SPI interrupt
+*/
+uint8_t slaveISR(const uint8_t mosi)
+{
+	return SPITransfer::receiveByte(mosi);
+}
+
+
+/*
+ void fill(uint8_t arr[], const uint32_t& seq, const uint16_t& len)
+ Description:
+ ------------
+  * Writes payload "seq" of "len" bytes
+*/
+void fill(uint8_t arr[], const uint32_t& seq, const uint16_t& len)
+{
+	for (uint16_t i = 0; i < len; i++)
+		arr[i] = (seq * 7) + (i * 13);
+}
+
+
+/*
+ bool check(SPITransfer& end, const uint32_t& seq, const uint16_t& len)
+ Description:
+ ------------
+  * Returns whether or not the packet "end" just reported is payload
+  "seq" of "len" bytes
+*/
+bool check(SPITransfer& end, const uint32_t& seq, const uint16_t& len)
+{
+	uint8_t expected[MAX_PACKET_SIZE];
+
+	fill(expected, seq, len);
+
+	return (end.bytesRead == len) && (end.currentPacketID() == (seq & 0xFF)) && !memcmp(end.packet.rxBuff, expected, len);
+}
+
+
+/*
+ void begin()
+ Description:
+ ------------
+  * Starts both ends afresh on the bus, joined by the ready line
+*/
+void begin()
+{
+	configST config;
+
+	config.debug       = 0;
+	config.flowTimeout = 10;
+	master.begin(SPI, config, SS, READY_PIN);
+	slave.beginSlave(SPI, config, READY_PIN);
+
+	SPITransfer::classToUse = &slave;
+	SPI.attachSlave(slaveISR);
+}
+
+
+/*
+ bool benchBlocks()
+ Description:
+ ------------
+  * Sends FRAMES packets of every length, each read by the slave
+  before the next
+*/
+bool benchBlocks()
+{
+	begin();
+
+	uint32_t ok           = 0;
+	uint64_t payload      = 0;
+	uint32_t transactions = SPI.transactions;
+	uint64_t busBytes     = SPI.bytesTransferred;
+	uint32_t start        = micros();
+
+	for (uint32_t n = 0; n < FRAMES; n++)
+	{
+		uint16_t len = 1 + ((n * 37) % MAX_PACKET_SIZE);
+
+		fill(master.packet.txBuff, n, len);
+
+		if (master.sendData(len, 0, n & 0xFF) != len)
+			break;
+
+		if (slave.available() && check(slave, n, len))
+			ok++;
+
+		payload += len;
+	}
+
+	uint32_t elapsed = micros() - start;
+
+	transactions = SPI.transactions - transactions;
+	busBytes     = SPI.bytesTransferred - busBytes;
+
+	printf("blocks,%u,%u,%u,%.3f,%.1f\n", ok, FRAMES, transactions, (double)payload / busBytes, (payload * 8.0) / (elapsed ? elapsed : 1));
+
+	return (ok == FRAMES) && (transactions == FRAMES);
+}
+
+
+/*
+ bool benchReady()
+ Description:
+ ------------
+  * Sends until the slave's ready line holds the master off, then
+  reads everything the slave buffered
+*/
+bool benchReady()
+{
+	const uint16_t len      = 200;
+	uint32_t       accepted = 0;
+	uint32_t       ok       = 0;
+	uint64_t       busBytes;
+
+	begin();
+
+	while (accepted < 100)
+	{
+		fill(master.packet.txBuff, accepted, len);
+
+		if (!master.sendData(len, 0, accepted & 0xFF))
+			break;
+
+		accepted++;
+	}
+
+	busBytes = SPI.bytesTransferred;
+
+	fill(master.packet.txBuff, accepted, len);
+	bool held = !master.sendData(len, 0, accepted & 0xFF) && (SPI.bytesTransferred == busBytes); // Refused without touching the bus
+
+	for (uint32_t n = 0; n < accepted; n++)
+		if (slave.available() && check(slave, n, len))
+			ok++;
+
+	fill(master.packet.txBuff, accepted, len);
+	bool resumed = (master.sendData(len, 0, accepted & 0xFF) == len) && slave.available() && check(slave, accepted, len);
+
+	printf("ready-line,%u,%u,%u,%s,%s\n", ok, accepted, master.packet.stats.timeouts, held ? "held" : "NOT HELD", resumed ? "resumed" : "STUCK");
+
+	return accepted && (ok == accepted) && held && resumed;
+}
+
+
+/*
+ bool benchExchange(const char* name, const uint8_t& num, const uint8_t& den)
+ Description:
+ ------------
+  * Sends FRAMES requests with exchange(). The slave answers each with
+  num/den times its length, which comes back with the next request
+*/
+bool benchExchange(const char* name, const uint8_t& num, const uint8_t& den)
+{
+	begin();
+
+	uint32_t ok       = 0;
+	uint64_t busBytes = SPI.bytesTransferred;
+	uint64_t payload  = 0;
+
+	for (uint32_t n = 0; n < FRAMES; n++)
+	{
+		uint16_t len = 1 + ((n * 37) % 300);
+
+		fill(master.packet.txBuff, n, len);
+		master.exchange(len, 0, n & 0xFF);
+
+		if (n)
+		{
+			uint16_t prevLen  = 1 + (((n - 1) * 37) % 300);
+			uint16_t replyLen = ((prevLen * num) / den) + 1;
+
+			if (check(master, n - 1, replyLen))
+				ok++;
+
+			payload += replyLen;
+		}
+
+		if (!slave.available() || !check(slave, n, len))
+			break;
+
+		uint16_t replyLen = ((len * num) / den) + 1;
+
+		fill(slave.packet.txBuff, n, replyLen);
+		slave.sendData(replyLen, 0, n & 0xFF);
+		slave.available(); // Reads the idle bytes that stretched the transaction, so the ready line comes back up
+		payload += len;
+	}
+
+	printf("%s,%u,%u,%.3f\n", name, ok, FRAMES - 1, (double)payload / (SPI.bytesTransferred - busBytes)); // Both directions share the bus bytes
+
+	return ok == (FRAMES - 1);
+}
+
+
+/*
+ bool benchReplyDuringSend()
+ Description:
+ ------------
+  * Queues a reply on the slave, then sends with sendData(): the reply
+  is clocked in alongside and must not be lost
+*/
+bool benchReplyDuringSend()
+{
+	uint32_t ok = 0;
+
+	begin();
+
+	for (uint32_t n = 0; n < 1000; n++)
+	{
+		uint16_t len = 1 + ((n * 37) % 300);
+
+		fill(slave.packet.txBuff, n, len);
+		slave.sendData(len, 0, n & 0xFF);
+
+		fill(master.packet.txBuff, n + 1, 20);
+		master.sendData(20, 0, (n + 1) & 0xFF);
+
+		if (master.available() && check(master, n, len) && slave.available() && check(slave, n + 1, 20))
+			ok++;
+
+		slave.available();
+	}
+
+	printf("reply-during-send,%u,1000\n", ok);
+
+	return ok == 1000;
+}
+
+
+int main()
+{
+	bool ok = true;
+
+	printf("case,frames_ok,frames_sent,transactions,payload_per_bus_byte,payload_Mbps_host\n");
+	ok &= benchBlocks();
+
+	printf("case,frames_ok,frames_accepted,ready_timeouts,held_off,after_draining\n");
+	ok &= benchReady();
+
+	printf("case,replies_ok,replies_expected,payload_per_bus_byte\n");
+	ok &= benchExchange("exchange-shorter", 1, 2);
+	ok &= benchExchange("exchange-longer", 2, 1);
+	ok &= benchReplyDuringSend();
+
+	return ok ? 0 : 1;
+}
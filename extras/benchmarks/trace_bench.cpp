@@ -0,0 +1,223 @@
+/*
+ trace_bench.cpp
+ Description:
+ ------------
+  * Host benchmark of PacketTrace. Parses a stream of frames byte by
+  byte and in blocks with tracing off and on, reporting parse cost per
+  frame as CSV. Given a file name, also traces a short exchange (a
+  good frame, line noise, a corrupted frame and a sent packet) and
+  writes the dump there for extras/tools/trace_decode.cpp
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/benchmarks/trace_bench.cpp src/Packet.cpp src/PacketTrace.cpp extras/host/Arduino.cpp -o trace_bench
+ Usage:
+ ------
+  * trace_bench [dump.bin] && trace_decode dump.bin
+*/
+#include "Arduino.h"
+#include "Packet.h"
+#include "PacketTrace.h"
+#include <stdio.h>
+
+
+const uint16_t LEN    = 64;
+const uint32_t FRAMES = 20000;
+const uint16_t BLOCK  = 64; // Bytes per parse() call in block mode, like one SerialTransfer read chunk
+
+
+/*
+ class FileStream
+ Description:
+ ------------
+  * Write-only Stream into a file
+*/
+class FileStream : public Stream
+{
+  public: // <<---------------------------------------//public
+	FILE* file;
+
+
+	FileStream(FILE* _file) : file(_file)
+	{
+	}
+
+	int available()
+	{
+		return 0;
+	}
+
+	int read()
+	{
+		return -1;
+	}
+
+	int peek()
+	{
+		return -1;
+	}
+
+	size_t write(uint8_t val)
+	{
+		return fwrite(&val, 1, 1, file);
+	}
+
+	size_t write(const uint8_t* buffer, size_t size)
+	{
+		return fwrite(buffer, 1, size, file);
+	}
+};
+
+
+/*
+ uint16_t buildFrame(uint8_t wire[], const uint16_t& len)
+ Description:
+ ------------
+  * Writes one "len" byte frame into wire[] and returns its length
+*/
+uint16_t buildFrame(uint8_t wire[], const uint16_t& len)
+{
+	Packet   tx;
+	configST config;
+
+	config.debug = 0;
+	tx.begin(config);
+
+	for (uint16_t i = 0; i < len; i++)
+		tx.txBuff[i] = i;
+
+	uint16_t payloadLen = tx.constructPacket(len, 0x0102, 7);
+
+	memcpy(wire, tx.preamble, PREAMBLE_SIZE);
+	memcpy(wire + PREAMBLE_SIZE, tx.txBuff, payloadLen);
+	memcpy(wire + PREAMBLE_SIZE + payloadLen, tx.postamble, POSTAMBLE_SIZE);
+
+	return PREAMBLE_SIZE + payloadLen + POSTAMBLE_SIZE;
+}
+
+
+/*
+ void bench(PacketTrace* trace, const bool& block)
+ Description:
+ ------------
+  * Parses FRAMES frames and prints a CSV row
+*/
+void bench(PacketTrace* trace, const bool& block)
+{
+	static uint8_t wire[PACKET_SIZE];
+	uint16_t       wireLen = buildFrame(wire, LEN);
+	Packet         rx;
+	configST       config;
+	uint32_t       good = 0;
+
+	config.debug = 0;
+	config.trace = trace;
+	rx.begin(config);
+
+	uint32_t start = micros();
+
+	for (uint32_t n = 0; n < FRAMES; n++)
+	{
+		if (block)
+		{
+			for (uint16_t offset = 0; offset < wireLen;)
+			{
+				uint16_t len = ((wireLen - offset) < BLOCK) ? (wireLen - offset) : BLOCK;
+				uint16_t consumed;
+
+				while (len)
+				{
+					if (rx.parse(wire + offset, len, consumed))
+						good++;
+
+					offset += consumed;
+					len    -= consumed;
+				}
+			}
+		}
+		else
+		{
+			for (uint16_t i = 0; i < wireLen; i++)
+				if (rx.parse(wire[i]))
+					good++;
+		}
+	}
+
+	double elapsed = micros() - start;
+
+	printf("%s,%s,%u,%.1f\n", trace ? "on" : "off", block ? "block" : "byte", good, (elapsed * 1000) / FRAMES);
+}
+
+
+/*
+ void demo(const char* path)
+ Description:
+ ------------
+  * Traces a short exchange and writes the dump to "path"
+*/
+void demo(const char* path)
+{
+	static PacketTrace trace;
+	static uint8_t     wire[PACKET_SIZE];
+	const uint8_t      noise[] = {0x00, 0x55, 0xFF};
+	uint16_t           wireLen = buildFrame(wire, 8);
+	uint16_t           consumed;
+	Packet             rx;
+	configST           config;
+
+	config.debug = 0;
+	config.trace = &trace;
+	config.clock = VirtualClock::now;
+	rx.begin(config);
+
+	for (uint16_t i = 0; i < wireLen; i++) // Byte by byte, one tick per byte
+	{
+		VirtualClock::advance(1);
+		rx.parse(wire[i]);
+	}
+
+	for (uint8_t i = 0; i < sizeof(noise); i++)
+	{
+		VirtualClock::advance(1);
+		rx.parse(noise[i]);
+	}
+
+	wire[PREAMBLE_SIZE + 3] ^= 0x10; // Corrupt a payload byte, then parse the frame as one block
+	VirtualClock::advance(10);
+	rx.parse(wire, wireLen, consumed);
+
+	VirtualClock::advance(10);
+	rx.txBuff[0] = 42;
+	rx.constructPacket(1, CONTROL_FLAG | 0x01, 3);
+
+	FILE* file = fopen(path, "wb");
+
+	if (!file)
+	{
+		perror(path);
+		return;
+	}
+
+	FileStream out(file);
+	size_t     written = trace.dump(out);
+
+	fclose(file);
+	printf("\n%u records (%u bytes) written to %s\n", trace.size(), (uint32_t)written, path);
+}
+
+
+int main(int argc, char* argv[])
+{
+	static PacketTrace trace;
+
+	printf("trace,mode,frames_ok,ns_per_frame\n");
+
+	bench(NULL, false);
+	bench(&trace, false);
+	bench(NULL, true);
+	bench(&trace, true);
+
+	if (argc > 1)
+		demo(argv[1]);
+
+	return 0;
+}
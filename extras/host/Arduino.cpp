@@ -0,0 +1,73 @@
+#include "Arduino.h"
+#include <sched.h>
+#include <time.h>
+
+
+HostSerial Serial;
+
+
+static uint64_t monotonicMicros()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000ULL) + ((uint64_t)ts.tv_nsec / 1000ULL);
+}
+
+
+static const uint64_t startMicros = monotonicMicros();
+
+
+uint32_t millis()
+{
+	return (uint32_t)((monotonicMicros() - startMicros) / 1000ULL);
+}
+
+
+uint32_t micros()
+{
+	return (uint32_t)(monotonicMicros() - startMicros);
+}
+
+
+void delay(uint32_t ms)
+{
+	delayMicroseconds(ms * 1000UL);
+}
+
+
+void delayMicroseconds(uint32_t us)
+{
+	struct timespec ts;
+	ts.tv_sec  = us / 1000000UL;
+	ts.tv_nsec = (long)(us % 1000000UL) * 1000L;
+	nanosleep(&ts, NULL);
+}
+
+
+void yield()
+{
+	sched_yield(); // Lets the thread playing the peer run, even on a single core
+}
+
+
+static uint8_t pinStates[256]; // Pins are simple latches so that handshake lines can be looped back
+
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+	(void)pin;
+	(void)mode;
+}
+
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+	pinStates[pin] = val ? HIGH : LOW;
+}
+
+
+int digitalRead(uint8_t pin)
+{
+	return pinStates[pin];
+}
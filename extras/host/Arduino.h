@@ -0,0 +1,254 @@
+/*
+ Arduino.h (host shim)
+ Description:
+ ------------
+  * Minimal stand-in for the Arduino core so that the library
+  sources can be compiled and exercised on a Linux host. Provides
+  the Print/Stream classes, millis()/micros()/delay() and a
+  "Serial" instance that writes to stdout. Build with
+  "-Iextras/host -Isrc" and link extras/host/Arduino.cpp
+*/
+#pragma once
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+#define HIGH   0x1
+#define LOW    0x0
+#define INPUT  0x0
+#define OUTPUT 0x1
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+
+uint32_t millis();
+uint32_t micros();
+void     delay(uint32_t ms);
+void     delayMicroseconds(uint32_t us);
+void     yield();
+void     pinMode(uint8_t pin, uint8_t mode);
+void     digitalWrite(uint8_t pin, uint8_t val);
+int      digitalRead(uint8_t pin);
+
+#define noInterrupts()
+#define interrupts()
+
+
+class Print
+{
+  public: // <<---------------------------------------//public
+	virtual ~Print()
+	{
+	}
+
+	virtual size_t write(uint8_t val) = 0;
+
+	virtual size_t write(const uint8_t* buffer, size_t size)
+	{
+		size_t n = 0;
+
+		while (size--)
+			n += write(*buffer++);
+
+		return n;
+	}
+
+	size_t write(const char* str)
+	{
+		return write((const uint8_t*)str, strlen(str));
+	}
+
+	size_t print(const __FlashStringHelper* str)
+	{
+		return write((const char*)str);
+	}
+
+	size_t print(const char* str)
+	{
+		return write(str);
+	}
+
+	size_t print(char c)
+	{
+		return write((uint8_t)c);
+	}
+
+	size_t print(long val, int base = DEC)
+	{
+		char buff[34];
+
+		if (base == HEX)
+			snprintf(buff, sizeof(buff), "%lX", val);
+		else
+			snprintf(buff, sizeof(buff), "%ld", val);
+
+		return write(buff);
+	}
+
+	size_t print(unsigned long val, int base = DEC)
+	{
+		char buff[34];
+
+		if (base == HEX)
+			snprintf(buff, sizeof(buff), "%lX", val);
+		else
+			snprintf(buff, sizeof(buff), "%lu", val);
+
+		return write(buff);
+	}
+
+	size_t print(int val, int base = DEC)
+	{
+		return print((long)val, base);
+	}
+
+	size_t print(unsigned int val, int base = DEC)
+	{
+		return print((unsigned long)val, base);
+	}
+
+	size_t print(unsigned char val, int base = DEC)
+	{
+		return print((unsigned long)val, base);
+	}
+
+	size_t print(double val, int digits = 2)
+	{
+		char buff[48];
+		snprintf(buff, sizeof(buff), "%.*f", digits, val);
+		return write(buff);
+	}
+
+	size_t println()
+	{
+		return write("\r\n");
+	}
+
+	template <typename T>
+	size_t println(const T& val)
+	{
+		size_t n = print(val);
+		return n + println();
+	}
+
+	template <typename T>
+	size_t println(const T& val, int format)
+	{
+		size_t n = print(val, format);
+		return n + println();
+	}
+
+	size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)))
+	{
+		char    buff[256];
+		va_list args;
+
+		va_start(args, format);
+		int len = vsnprintf(buff, sizeof(buff), format, args);
+		va_end(args);
+
+		if (len < 0)
+			return 0;
+
+		if ((size_t)len >= sizeof(buff))
+			len = sizeof(buff) - 1;
+
+		return write((const uint8_t*)buff, len);
+	}
+};
+
+
+class Stream : public Print
+{
+  public: // <<---------------------------------------//public
+	virtual int available() = 0;
+	virtual int read()      = 0;
+	virtual int peek()      = 0;
+
+	virtual void flush()
+	{
+	}
+
+	void setTimeout(uint32_t _timeout)
+	{
+		timeout = _timeout;
+	}
+
+	size_t readBytes(uint8_t* buffer, size_t length)
+	{
+		size_t   count = 0;
+		uint32_t start = millis();
+
+		while (count < length)
+		{
+			if (available())
+				buffer[count++] = (uint8_t)read();
+			else if ((millis() - start) >= timeout)
+				break;
+		}
+
+		return count;
+	}
+
+
+  protected: // <<---------------------------------------//protected
+	uint32_t timeout = 1000;
+};
+
+
+class HostSerial : public Stream
+{
+  public: // <<---------------------------------------//public
+	void begin(uint32_t baud)
+	{
+		(void)baud;
+	}
+
+	int available()
+	{
+		return 0;
+	}
+
+	int read()
+	{
+		return -1;
+	}
+
+	int peek()
+	{
+		return -1;
+	}
+
+	size_t write(uint8_t val)
+	{
+		return fwrite(&val, 1, 1, stdout);
+	}
+
+	size_t write(const uint8_t* buffer, size_t size)
+	{
+		return fwrite(buffer, 1, size, stdout);
+	}
+
+	using Print::write;
+
+	operator bool()
+	{
+		return true;
+	}
+};
+
+
+extern HostSerial Serial;
@@ -0,0 +1,119 @@
+/*
+ SPI.h (host shim)
+ Description:
+ ------------
+  * Mock of the Arduino SPI library for exercising SPITransfer on a
+  Linux host. The "bus" is a function call: every byte the master
+  clocks out is handed to the handler registered with attachSlave()
+  (standing in for the slave's SPI interrupt) and whatever it returns
+  is clocked back in. Link extras/host/SPI.cpp for the "SPI" instance
+*/
+#pragma once
+#include "Arduino.h"
+
+
+#define SS   10
+#define MOSI 11
+#define MISO 12
+#define SCK  13
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+
+typedef uint8_t (*spiSlaveFunctionPtr)(const uint8_t mosi);
+
+
+class SPISettings
+{
+  public: // <<---------------------------------------//public
+	uint32_t clock    = 4000000;
+	uint8_t  bitOrder = MSBFIRST;
+	uint8_t  dataMode = SPI_MODE0;
+
+
+	SPISettings()
+	{
+	}
+
+	SPISettings(uint32_t _clock, uint8_t _bitOrder, uint8_t _dataMode)
+	{
+		clock    = _clock;
+		bitOrder = _bitOrder;
+		dataMode = _dataMode;
+	}
+};
+
+
+class SPIClass
+{
+  public: // <<---------------------------------------//public
+	SPISettings settings;
+	bool        inTransaction    = false;
+	uint32_t    transactions     = 0;
+	uint64_t    bytesTransferred = 0;
+
+
+	void begin()
+	{
+	}
+
+	void end()
+	{
+	}
+
+	void attachInterrupt()
+	{
+	}
+
+	void detachInterrupt()
+	{
+	}
+
+	void beginTransaction(SPISettings _settings)
+	{
+		settings      = _settings;
+		inTransaction = true;
+		transactions++;
+	}
+
+	void endTransaction()
+	{
+		inTransaction = false;
+	}
+
+	void attachSlave(spiSlaveFunctionPtr _slave)
+	{
+		slave = _slave;
+	}
+
+	uint8_t transfer(uint8_t data)
+	{
+		bytesTransferred++;
+
+		if (slave)
+			return slave(data);
+
+		return 0xFF;
+	}
+
+	void transfer(void* buf, size_t count)
+	{
+		uint8_t* arr = (uint8_t*)buf;
+
+		for (size_t i = 0; i < count; i++)
+			arr[i] = transfer(arr[i]);
+	}
+
+
+  private: // <<---------------------------------------//private
+	spiSlaveFunctionPtr slave = NULL;
+};
+
+
+extern SPIClass SPI;
@@ -0,0 +1,82 @@
+#include "Wire.h"
+
+
+TwoWire Wire;
+TwoWire Wire1;
+
+
+static TwoWire* bus[128]; // Slaves by 7-bit address
+
+
+void TwoWire::begin()
+{
+	end();
+}
+
+
+void TwoWire::begin(uint8_t address)
+{
+	end();
+
+	ownAddress      = address & 0x7F;
+	bus[ownAddress] = this;
+}
+
+
+void TwoWire::end()
+{
+	if ((ownAddress >= 0) && (bus[ownAddress] == this))
+		bus[ownAddress] = NULL;
+
+	ownAddress = -1;
+}
+
+
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+	TwoWire* target = bus[txAddress & 0x7F];
+
+	(void)sendStop;
+
+	if (!target)
+		return 2; // NACK on address
+
+	transactions++;
+	bytesTransferred += txLen + 1; // Plus the address byte
+
+	memcpy(target->rxBuff, txBuff, txLen);
+	target->rxLen   = txLen;
+	target->rxIndex = 0;
+
+	if (target->receiveHandler)
+		target->receiveHandler(txLen);
+
+	txLen = 0;
+
+	return 0;
+}
+
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity)
+{
+	TwoWire* target = bus[address & 0x7F];
+
+	rxLen   = 0;
+	rxIndex = 0;
+
+	if (!target)
+		return 0;
+
+	transactions++;
+	target->txLen = 0;
+
+	if (target->requestHandler)
+		target->requestHandler();
+
+	rxLen = (target->txLen < quantity) ? target->txLen : quantity;
+	memcpy(rxBuff, target->txBuff, rxLen);
+	bytesTransferred += rxLen + 1; // Plus the address byte
+	target->txLen = 0;
+
+	return rxLen;
+}
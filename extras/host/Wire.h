@@ -0,0 +1,118 @@
+/*
+ Wire.h (host shim)
+ Description:
+ ------------
+  * Mock of the Arduino Wire library for exercising I2CTransfer on a
+  Linux host. Every TwoWire instance sits on the same simulated bus:
+  endTransmission() delivers the bytes written since
+  beginTransmission() to the instance that called begin(address)
+  with the target address and runs its onReceive() handler.
+  requestFrom() runs the target's onRequest() handler and hands back
+  what it wrote. Like
+  the AVR core, a transaction holds at most BUFFER_LENGTH bytes and
+  extra bytes are dropped. Link extras/host/Wire.cpp for the "Wire"
+  and "Wire1" instances
+*/
+#pragma once
+#include "Arduino.h"
+
+
+#define BUFFER_LENGTH 32
+
+
+class TwoWire : public Stream
+{
+  public: // <<---------------------------------------//public
+	uint32_t transactions     = 0;
+	uint64_t bytesTransferred = 0;
+
+
+	void begin();
+	void begin(uint8_t address);
+	void end();
+
+	void setClock(uint32_t clock)
+	{
+		(void)clock;
+	}
+
+	void beginTransmission(uint8_t address)
+	{
+		txAddress = address;
+		txLen     = 0;
+	}
+
+	uint8_t endTransmission(bool sendStop = true);
+	uint8_t requestFrom(uint8_t address, uint8_t quantity);
+
+	size_t write(uint8_t val)
+	{
+		if (txLen >= BUFFER_LENGTH)
+			return 0;
+
+		txBuff[txLen++] = val;
+		return 1;
+	}
+
+	size_t write(const uint8_t* buffer, size_t size)
+	{
+		size_t n = 0;
+
+		while (size-- && write(*buffer++))
+			n++;
+
+		return n;
+	}
+
+	using Print::write;
+
+	int available()
+	{
+		return rxLen - rxIndex;
+	}
+
+	int read()
+	{
+		if (rxIndex >= rxLen)
+			return -1;
+
+		return rxBuff[rxIndex++];
+	}
+
+	int peek()
+	{
+		if (rxIndex >= rxLen)
+			return -1;
+
+		return rxBuff[rxIndex];
+	}
+
+	void onReceive(void (*handler)(int))
+	{
+		receiveHandler = handler;
+	}
+
+	void onRequest(void (*handler)())
+	{
+		requestHandler = handler;
+	}
+
+
+  private: // <<---------------------------------------//private
+	uint8_t txAddress = 0;
+	uint8_t txBuff[BUFFER_LENGTH];
+	uint8_t txLen = 0;
+
+	uint8_t rxBuff[BUFFER_LENGTH];
+	uint8_t rxLen   = 0;
+	uint8_t rxIndex = 0;
+
+	int8_t ownAddress = -1;
+
+	void (*receiveHandler)(int) = NULL;
+	void (*requestHandler)()    = NULL;
+};
+
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
@@ -0,0 +1,461 @@
+/*
+ capture_replay.cpp
+ Description:
+ ------------
+  * Host replay driver for PacketCapture logs. Feeds the received bytes
+  of a capture through Packet::parse() exactly as SerialTransfer did -
+  same chunks, same receive settings, the packet clock set to each
+  record's tick so stale-packet timeouts fire the same way - and checks
+  every parser outcome against the one recorded. Runs as fast as
+  possible (reporting parse throughput, so captures double as
+  realistic benchmarks) or at the original speed. Fragmented messages
+  are replayed without a reassembly buffer or chunk callback
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/tools/capture_replay.cpp src/Packet.cpp src/PacketCompress.cpp src/PacketFEC.cpp extras/host/Arduino.cpp -o capture_replay
+ Usage:
+ ------
+  * capture_replay [-r] [-v] [-n loops] capture.bin
+   * -r - Replay at the original speed
+   * -v - Print every record
+   * -n - Replay the capture "loops" times (throughput runs)
+*/
+#include "Arduino.h"
+#include "Packet.h"
+#include "PacketCapture.h"
+#include "PacketCompress.h"
+#include "PacketFEC.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+
+struct replayST
+{
+	uint32_t records    = 0;
+	uint32_t rxBytes    = 0;
+	uint32_t txBytes    = 0;
+	uint32_t discarded  = 0;
+	uint32_t frames     = 0; // Outcomes recorded
+	uint32_t mismatches = 0;
+	uint32_t good       = 0; // NEW_DATA outcomes replayed
+	uint32_t errors     = 0; // Error outcomes replayed
+};
+
+
+/*
+ bool readVarint(const std::vector<uint8_t>& capture, size_t& pos, uint32_t& val)
+ Description:
+ ------------
+  * Decodes an unsigned LEB128 value at capture[pos], moving pos past it
+*/
+bool readVarint(const std::vector<uint8_t>& capture, size_t& pos, uint32_t& val)
+{
+	val = 0;
+
+	for (uint8_t shift = 0; (pos < capture.size()) && (shift < 35); shift += 7)
+	{
+		uint8_t b = capture[pos++];
+
+		val |= (uint32_t)(b & 0x7F) << shift;
+
+		if (!(b & 0x80))
+			return true;
+	}
+
+	return false;
+}
+
+
+/*
+ const char* statusName(const int8_t& status)
+ Description:
+ ------------
+  * Name of a Packet status code
+*/
+const char* statusName(const int8_t& status)
+{
+	switch (status)
+	{
+	case 4:  return "NEW_MESSAGE";
+	case 3:  return "CONTINUE";
+	case 2:  return "NEW_DATA";
+	case 1:  return "NO_DATA";
+	case 0:  return "CRC_ERROR";
+	case -1: return "PAYLOAD_ERROR";
+	case -2: return "STOP_BYTE_ERROR";
+	case -3: return "STALE_PACKET_ERROR";
+	}
+
+	return "?";
+}
+
+
+/*
+ class Replay
+ Description:
+ ------------
+  * Parser state of one pass over a capture
+*/
+class Replay
+{
+  public: // <<---------------------------------------//public
+	replayST stats;
+	bool     verbose = false;
+
+
+	Replay()
+	{
+		configST config;
+
+		config.debug = 0;
+		config.clock = VirtualClock::now;
+		rx.begin(config);
+	}
+
+	~Replay()
+	{
+		delete fec;
+		delete compressor;
+	}
+
+	/*
+	 void Replay::configure(const uint8_t data[])
+	 Description:
+	 ------------
+	  * Applies a CAPTURE_CONFIG record
+	*/
+	void configure(const uint8_t data[])
+	{
+		configST config;
+
+		delete fec;
+		delete compressor;
+		fec        = data[5] ? new PacketFEC(data[5]) : NULL;
+		compressor = data[6] ? new PacketCompressor : NULL;
+
+		config.debug      = 0;
+		config.clock      = VirtualClock::now;
+		config.timeout    = data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+		config.packed     = data[4];
+		config.fec        = fec;
+		config.compressor = compressor;
+		rx.begin(config);
+
+		if (verbose)
+			printf("config timeout %u, %s, FEC parity %u%s\n", config.timeout, config.packed ? "packed" : "unpacked", data[5], data[6] ? ", compressed" : "");
+	}
+
+	/*
+	 void Replay::parse(const uint8_t arr[], const uint16_t& len)
+	 Description:
+	 ------------
+	  * Parses a CAPTURE_RX chunk. Like SerialTransfer, the rest of the
+	  chunk is dropped once the parser reports an error
+	*/
+	void parse(const uint8_t arr[], const uint16_t& len)
+	{
+		uint16_t pos = 0;
+
+		stats.rxBytes += len;
+
+		while (pos < len)
+		{
+			uint16_t consumed;
+
+			rx.parse(arr + pos, len - pos, consumed);
+			pos += consumed;
+
+			if ((rx.status == CONTINUE) || (rx.status == NO_DATA))
+				continue;
+
+			outcome();
+
+			if (rx.status <= 0)
+			{
+				rx.reset();
+				break;
+			}
+		}
+	}
+
+	/*
+	 void Replay::expect(const uint8_t data[])
+	 Description:
+	 ------------
+	  * Takes a CAPTURE_FRAME record. A stale packet found while
+	  SerialTransfer had nothing to read is reproduced by polling the
+	  parser the same way
+	*/
+	void expect(const uint8_t data[])
+	{
+		int8_t status = data[0];
+
+		stats.frames++;
+
+		if ((status == STALE_PACKET_ERROR) && outcomes.empty())
+		{
+			rx.parse(0xFF, false);
+
+			if (rx.status == STALE_PACKET_ERROR)
+			{
+				outcome();
+				rx.reset();
+			}
+		}
+
+		uint8_t  packetID = data[1];
+		uint16_t command  = data[2] | ((uint16_t)data[3] << 8);
+		uint16_t len      = data[4] | ((uint16_t)data[5] << 8);
+
+		if (verbose)
+			printf("frame %s, ID %u, command 0x%04X, %u bytes\n", statusName(status), packetID, command, len);
+
+		if (outcomes.empty())
+		{
+			mismatch("recorded %s, replay has no outcome", statusName(status));
+			return;
+		}
+
+		outcomeST got = outcomes.front();
+
+		outcomes.erase(outcomes.begin());
+
+		if ((got.status != status) || (got.packetID != packetID) || (got.command != command) || (got.len != len))
+			mismatch("recorded %s ID %u command 0x%04X %u bytes, replayed %s ID %u command 0x%04X %u bytes",
+			         statusName(status), packetID, command, len,
+			         statusName(got.status), got.packetID, got.command, got.len);
+	}
+
+	/*
+	 void Replay::finish()
+	 Description:
+	 ------------
+	  * Counts outcomes the capture has no record of
+	*/
+	void finish()
+	{
+		for (size_t i = 0; i < outcomes.size(); i++)
+			mismatch("replayed %s with no recorded outcome", statusName(outcomes[i].status));
+
+		outcomes.clear();
+	}
+
+
+  private: // <<---------------------------------------//private
+	struct outcomeST
+	{
+		int8_t   status;
+		uint8_t  packetID;
+		uint16_t command;
+		uint16_t len;
+	};
+
+	Packet                 rx;
+	PacketFEC*             fec        = NULL;
+	PacketCompressor*      compressor = NULL;
+	std::vector<outcomeST> outcomes; // Replayed, not yet matched with a record
+
+
+	void outcome()
+	{
+		outcomeST got = {rx.status, rx.currentPacketID(), (uint16_t)(rx.currentCommand() | rx.currentFlags()), rx.bytesRead};
+
+		if (rx.status > 0)
+			stats.good++;
+		else
+			stats.errors++;
+
+		outcomes.push_back(got);
+	}
+
+	void mismatch(const char* format, ...)
+	{
+		va_list args;
+
+		if (stats.mismatches++ < 10)
+		{
+			printf("mismatch at record %u: ", stats.records);
+			va_start(args, format);
+			vprintf(format, args);
+			va_end(args);
+			printf("\n");
+		}
+	}
+};
+
+
+/*
+ bool replay(const std::vector<uint8_t>& capture, Replay& state, const bool& realtime)
+ Description:
+ ------------
+  * Runs one pass over the capture. Returns false if it is malformed
+*/
+bool replay(const std::vector<uint8_t>& capture, Replay& state, const bool& realtime)
+{
+	uint32_t ticksPerSecond = capture[5] | ((uint32_t)capture[6] << 8) | ((uint32_t)capture[7] << 16) | ((uint32_t)capture[8] << 24);
+	size_t   pos            = CAPTURE_HEADER_SIZE;
+	uint32_t time           = 0;
+	uint32_t firstTime      = 0;
+	uint32_t start          = micros();
+
+	while (pos < capture.size())
+	{
+		uint8_t  type = capture[pos++];
+		uint32_t delta;
+		uint32_t len;
+
+		if (!readVarint(capture, pos, delta) || !readVarint(capture, pos, len) || ((pos + len) > capture.size()))
+			return false;
+
+		const uint8_t* data = capture.data() + pos;
+
+		pos  += len;
+		time += delta;
+
+		if (!state.stats.records++)
+			firstTime = time;
+
+		VirtualClock::set(time);
+
+		if (realtime && ticksPerSecond)
+		{
+			uint64_t due = ((uint64_t)(time - firstTime) * 1000000) / ticksPerSecond;
+
+			while ((micros() - start) < due)
+				delayMicroseconds(50);
+		}
+
+		if (state.verbose)
+			printf("%10u  ", time);
+
+		switch (type)
+		{
+		case CAPTURE_RX:
+			if (state.verbose)
+				printf("rx %u bytes\n", len);
+
+			state.parse(data, len);
+			break;
+
+		case CAPTURE_TX:
+			if (state.verbose)
+				printf("tx frame of %u bytes\n", len);
+
+			state.stats.txBytes += len;
+			break;
+
+		case CAPTURE_FRAME:
+			if (len >= CAPTURE_FRAME_SIZE)
+				state.expect(data);
+			break;
+
+		case CAPTURE_DISCARD:
+			if (state.verbose)
+				printf("discarded %u bytes\n", len);
+
+			state.stats.discarded += len;
+			break;
+
+		case CAPTURE_CONFIG:
+			if (len >= CAPTURE_CONFIG_SIZE)
+				state.configure(data);
+			break;
+
+		default:
+			if (state.verbose)
+				printf("record type %u, %u bytes\n", type, len);
+		}
+	}
+
+	state.finish();
+
+	return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+	bool        realtime = false;
+	bool        verbose  = false;
+	uint32_t    loops    = 1;
+	const char* path     = NULL;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-r"))
+			realtime = true;
+		else if (!strcmp(argv[i], "-v"))
+			verbose = true;
+		else if (!strcmp(argv[i], "-n") && ((i + 1) < argc))
+			loops = strtoul(argv[++i], NULL, 10);
+		else
+			path = argv[i];
+	}
+
+	FILE* in = path ? fopen(path, "rb") : stdin;
+
+	if (!in)
+	{
+		perror(path);
+		return 1;
+	}
+
+	std::vector<uint8_t> capture;
+	uint8_t              buff[4096];
+	size_t               got;
+
+	while ((got = fread(buff, 1, sizeof(buff), in)) > 0)
+		capture.insert(capture.end(), buff, buff + got);
+
+	if ((capture.size() < CAPTURE_HEADER_SIZE) || memcmp(capture.data(), "STCP", 4) || (capture[4] != CAPTURE_VERSION))
+	{
+		fprintf(stderr, "not a capture (version %u)\n", CAPTURE_VERSION);
+		return 1;
+	}
+
+	replayST total;
+	uint32_t start = micros();
+
+	for (uint32_t n = 0; n < loops; n++)
+	{
+		Replay state;
+
+		state.verbose = verbose && !n;
+
+		if (!replay(capture, state, realtime))
+		{
+			fprintf(stderr, "capture truncated or corrupt after record %u\n", state.stats.records);
+			return 1;
+		}
+
+		if (!n)
+			total = state.stats;
+		else
+		{
+			total.rxBytes    += state.stats.rxBytes;
+			total.good       += state.stats.good;
+			total.errors     += state.stats.errors;
+			total.mismatches += state.stats.mismatches;
+		}
+	}
+
+	double elapsed = micros() - start;
+
+	printf("records,rx_bytes,tx_bytes,discarded_bytes,frames_recorded,frames_replayed,errors_replayed,mismatches,loops,rx_MBps,frames_per_s\n");
+	printf("%u,%u,%u,%u,%u,%u,%u,%u,%u,%.1f,%.0f\n",
+	       total.records,
+	       total.rxBytes / loops,
+	       total.txBytes,
+	       total.discarded,
+	       total.frames,
+	       total.good / loops,
+	       total.errors / loops,
+	       total.mismatches,
+	       loops,
+	       realtime ? 0 : (total.rxBytes / elapsed),
+	       realtime ? 0 : (((total.good + total.errors) * 1000000.0) / elapsed));
+
+	return total.mismatches ? 2 : 0;
+}
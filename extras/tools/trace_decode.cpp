@@ -0,0 +1,221 @@
+/*
+ trace_decode.cpp
+ Description:
+ ------------
+  * Host decoder for PacketTrace::dump() output. Reads a capture (file
+  or stdin), finds every dump in it - other serial output around the
+  dumps is skipped - and prints one line per record: tick, ticks since
+  the previous record, event and its details. Parser byte events are
+  grouped per packet so a frame reads as one block
+ Build:
+ ------
+  * g++ -O2 -std=gnu++11 -Iextras/host -Isrc extras/tools/trace_decode.cpp -o trace_decode
+ Usage:
+ ------
+  * trace_decode [capture.bin]
+*/
+#include "PacketTrace.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+
+const char* STATE_NAMES[] = {"start", "id", "command", "command2", "overhead", "len", "len2", "payload", "crc", "crc2", "stop"};
+
+
+/*
+ const char* statusName(const int8_t& status)
+ Description:
+ ------------
+  * Name of a Packet status code
+*/
+const char* statusName(const int8_t& status)
+{
+	switch (status)
+	{
+	case 4:  return "NEW_MESSAGE";
+	case 3:  return "CONTINUE";
+	case 2:  return "NEW_DATA";
+	case 1:  return "NO_DATA";
+	case 0:  return "CRC_ERROR";
+	case -1: return "PAYLOAD_ERROR";
+	case -2: return "STOP_BYTE_ERROR";
+	case -3: return "STALE_PACKET_ERROR";
+	}
+
+	return "?";
+}
+
+
+/*
+ const char* stateName(const uint8_t& state)
+ Description:
+ ------------
+  * Name of a Packet parser state
+*/
+const char* stateName(const uint8_t& state)
+{
+	if (state < (sizeof(STATE_NAMES) / sizeof(STATE_NAMES[0])))
+		return STATE_NAMES[state];
+
+	return "?";
+}
+
+
+/*
+ uint32_t readLE(const uint8_t arr[], const uint8_t& len)
+ Description:
+ ------------
+  * Reads a little endian integer of "len" bytes
+*/
+uint32_t readLE(const uint8_t arr[], const uint8_t& len)
+{
+	uint32_t val = 0;
+
+	for (uint8_t i = len; i > 0; i--)
+		val = (val << 8) | arr[i - 1];
+
+	return val;
+}
+
+
+/*
+ size_t decodeDump(const uint8_t arr[], const size_t& len)
+ Description:
+ ------------
+  * Prints the dump at the start of arr[]. Returns the number of bytes
+  it took up, 0 if arr[] does not hold a whole dump
+*/
+size_t decodeDump(const uint8_t arr[], const size_t& len)
+{
+	const size_t HEADER_SIZE = 11;
+	const size_t RECORD_SIZE = 8;
+
+	if ((len < HEADER_SIZE) || memcmp(arr, "PTRC", 4) || (arr[4] != TRACE_DUMP_VERSION))
+		return 0;
+
+	uint16_t count       = readLE(arr + 5, 2);
+	uint32_t overwritten = readLE(arr + 7, 4);
+	size_t   size        = HEADER_SIZE + (count * RECORD_SIZE);
+
+	if (len < size)
+		return 0;
+
+	printf("# %u records, %u overwritten before the first\n", count, overwritten);
+
+	uint32_t last    = readLE(arr + HEADER_SIZE, 4);
+	bool     inFrame = false;
+
+	for (uint16_t i = 0; i < count; i++)
+	{
+		const uint8_t* rec   = arr + HEADER_SIZE + (i * RECORD_SIZE);
+		uint32_t       time  = readLE(rec, 4);
+		uint8_t        event = rec[4];
+		uint8_t        arg   = rec[5];
+		uint16_t       value = readLE(rec + 6, 2);
+
+		if ((event == TRACE_RX_BYTE) && inFrame && arg) // Continue the frame's line
+		{
+			printf(" %s:%02X", stateName(arg), value);
+			last = time;
+			continue;
+		}
+
+		if (inFrame)
+			printf("\n");
+
+		inFrame = false;
+		printf("%10u %+8d  ", time, (int32_t)(time - last));
+		last = time;
+
+		switch (event)
+		{
+		case TRACE_RX_BYTE:
+			if (arg)
+				printf("rx   %s:%02X", stateName(arg), value);
+			else if (value == 0x7E)
+				printf("rx   start");
+			else
+				printf("rx   skip %02X", value);
+
+			inFrame = (value == 0x7E) || arg;
+
+			if (!inFrame)
+				printf("\n");
+			break;
+
+		case TRACE_RX_PAYLOAD:
+			printf("rx   payload block of %u bytes\n", value);
+			break;
+
+		case TRACE_RX_STATUS:
+			printf("rx   %s, %u bytes\n", statusName((int8_t)arg), value);
+			break;
+
+		case TRACE_TX_PACKET:
+			printf("tx   packet ID %u, %u bytes\n", arg, value);
+			break;
+
+		case TRACE_TX_COMMAND:
+			printf("tx   command 0x%04X\n", value);
+			break;
+
+		default:
+			if (event >= TRACE_USER)
+				printf("user event %u, arg %u, value %u\n", event - TRACE_USER, arg, value);
+			else
+				printf("unknown event %u, arg %u, value %u\n", event, arg, value);
+		}
+	}
+
+	if (inFrame)
+		printf("\n");
+
+	return size;
+}
+
+
+int main(int argc, char* argv[])
+{
+	FILE* in = stdin;
+
+	if (argc > 1)
+	{
+		in = fopen(argv[1], "rb");
+
+		if (!in)
+		{
+			perror(argv[1]);
+			return 1;
+		}
+	}
+
+	std::vector<uint8_t> capture;
+	uint8_t              buff[4096];
+	size_t               got;
+	uint16_t             dumps = 0;
+
+	while ((got = fread(buff, 1, sizeof(buff), in)) > 0)
+		capture.insert(capture.end(), buff, buff + got);
+
+	for (size_t i = 0; i < capture.size();)
+	{
+		size_t used = decodeDump(capture.data() + i, capture.size() - i);
+
+		if (used)
+		{
+			dumps++;
+			i += used;
+		}
+		else
+			i++;
+	}
+
+	if (!dumps)
+	{
+		fprintf(stderr, "no trace dump found\n");
+		return 1;
+	}
+
+	return 0;
+}
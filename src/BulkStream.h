@@ -0,0 +1,68 @@
+#pragma once
+#include "Arduino.h"
+
+
+/*
+ class BulkStream
+ Description:
+ ------------
+  * Stream that can also hand over received bytes and take whole
+  frames in blocks. SerialTransfer uses these instead of one read()
+  per byte and three writes per frame when its port is a BulkStream.
+  The defaults fall back on the plain Stream calls, transports
+  override whichever they can do better
+*/
+class BulkStream : public Stream
+{
+  public: // <<---------------------------------------//public
+	/*
+	 size_t BulkStream::readAvailable(uint8_t arr[], const size_t& len)
+	 Description:
+	 ------------
+	  * Copies up to "len" received bytes without blocking
+	 Inputs:
+	 -------
+	  * uint8_t arr[] - Buffer to copy received bytes into
+	  * const size_t& len - Size of arr[]
+	 Return:
+	 -------
+	  * size_t - Number of bytes copied into arr[]
+	*/
+	virtual size_t readAvailable(uint8_t arr[], const size_t& len)
+	{
+		size_t count = 0;
+
+		while ((count < len) && (available() > 0))
+			arr[count++] = read();
+
+		return count;
+	}
+
+
+	/*
+	 size_t BulkStream::writeFrame(const uint8_t preamble[], const size_t& preambleLen, const uint8_t payload[], const size_t& payloadLen, const uint8_t postamble[], const size_t& postambleLen)
+	 Description:
+	 ------------
+	  * Writes a whole frame at once
+	 Inputs:
+	 -------
+	  * const uint8_t preamble[] - Frame preamble
+	  * const size_t& preambleLen - Number of bytes in preamble[]
+	  * const uint8_t payload[] - Stuffed payload
+	  * const size_t& payloadLen - Number of bytes in payload[]
+	  * const uint8_t postamble[] - Frame postamble
+	  * const size_t& postambleLen - Number of bytes in postamble[]
+	 Return:
+	 -------
+	  * size_t - Number of bytes written
+	*/
+	virtual size_t writeFrame(const uint8_t preamble[], const size_t& preambleLen, const uint8_t payload[], const size_t& payloadLen, const uint8_t postamble[], const size_t& postambleLen)
+	{
+		size_t count = write(preamble, preambleLen);
+
+		count += write(payload, payloadLen);
+		count += write(postamble, postambleLen);
+
+		return count;
+	}
+};
@@ -1,152 +1,435 @@
-#include "I2CTransfer.h"
-
-
-/*
- void I2CTransfer::begin(TwoWire &_port, configST& configs)
- Description:
- ------------
-  * Advanced initializer for the I2CTransfer Class
- Inputs:
- -------
-  * const TwoWire &_port - I2C port to communicate over
-  * const configST& configs - Struct that holds config
-  values for all possible initialization parameters
- Return:
- -------
-  * void
-*/
-void I2CTransfer::begin(TwoWire& _port, const configST& configs)
-{
-	port = &_port;
-	port->onReceive((void (*)(int))processData);
-	packet.begin(configs);
-}
-
-
-/*
- void I2CTransfer::begin(TwoWire &_port, const bool& _debug, Stream &_debugPort)
- Description:
- ------------
-  * Simple initializer for the SerialTransfer Class
- Inputs:
- -------
-  * const TwoWire &_port - I2C port to communicate over
-  * const bool& _debug - Whether or not to print error messages
-  * const Stream &_debugPort - Serial port to print error messages
- Return:
- -------
-  * void
-*/
-void I2CTransfer::begin(TwoWire& _port, const bool& _debug, Stream& _debugPort)
-{
-	port = &_port;
-	packet.begin(_debug, _debugPort);
-}
-
-
-/*
- uint8_t I2CTransfer::sendData(const uint16_t &messageLen, const uint8_t &packetID, const uint8_t &targetAddress=0)
- Description:
- ------------
-  * Send a specified number of bytes in packetized form
- Inputs:
- -------
-  * const uint16_t &messageLen - Number of values in txBuff
-  to send as the payload in the next packet
-  * const uint8_t &packetID - The packet 8-bit identifier
-  * const uint8_t &targetAddress - I2C address to the device the packet
-      will be transmitted to
- Return:
- -------
-  * uint8_t numBytesIncl - Number of payload bytes included in packet
-*/
-uint8_t I2CTransfer::sendData(const uint16_t& messageLen, const uint8_t& packetID, const uint8_t& targetAddress)
-{
-	uint8_t numBytesIncl;
-
-	numBytesIncl = packet.constructPacket(messageLen, packetID);
-
-	port->beginTransmission(targetAddress);
-	port->write(packet.preamble, sizeof(packet.preamble));
-	port->write(packet.txBuff, numBytesIncl);
-	port->write(packet.postamble, sizeof(packet.postamble));
-	port->endTransmission();
-
-	return numBytesIncl;
-}
-
-
-/*
- void I2CTransfer::processData()
- Description:
- ------------
-  * Parses incoming serial data automatically when an
-  I2C frame is received
- Inputs:
- -------
-  * void
- Return:
- -------
-  * void
-*/
-void I2CTransfer::processData()
-{
-	uint8_t recChar;
-	classToUse->bytesRead = 0;
-
-	while (classToUse->port->available())
-	{
-		recChar               = classToUse->port->read();
-		classToUse->bytesRead = classToUse->packet.parse(recChar);
-		classToUse->status    = classToUse->packet.status;
-		
-		if (classToUse->status != CONTINUE)
-		{
-			if (classToUse->status <= 0)
-				classToUse->reset();
-
-			break;
-		}
-	}
-}
-
-
-/*
- uint8_t I2CTransfer::currentPacketID()
- Description:
- ------------
-  * Returns the ID of the last parsed packet
- Inputs:
- -------
-  * void
- Return:
- -------
-  * uint8_t - ID of the last parsed packet
-*/
-uint8_t I2CTransfer::currentPacketID()
-{
-	return packet.currentPacketID();
-}
-
-
-/*
- void I2CTransfer::reset()
- Description:
- ------------
-  * Clears out the tx, and rx buffers, plus resets
-  the "bytes read" variable, finite state machine, etc
- Inputs:
- -------
-  * void
- Return:
- -------
-  * void
-*/
-void I2CTransfer::reset()
-{
-	packet.reset();
-	status = packet.status;
-}
-
-
-I2CTransfer* I2CTransfer::classToUse = NULL;
+#include "I2CTransfer.h"
+
+
+/*
+ void I2CTransfer::begin(TwoWire &_port, configST& configs)
+ Description:
+ ------------
+  * Advanced initializer for the I2CTransfer Class
+ Inputs:
+ -------
+  * const TwoWire &_port - I2C port to communicate over
+  * const configST& configs - Struct that holds config
+  values for all possible initialization parameters
+ Return:
+ -------
+  * void
+*/
+void I2CTransfer::begin(TwoWire& _port, const configST& configs)
+{
+	port = &_port;
+	port->onReceive(processData);
+	port->onRequest(serveRequest);
+	beginTransfer(configs);
+}
+
+
+/*
+ void I2CTransfer::begin(TwoWire &_port, const bool& _debug, Stream &_debugPort)
+ Description:
+ ------------
+  * Simple initializer for the SerialTransfer Class
+ Inputs:
+ -------
+  * const TwoWire &_port - I2C port to communicate over
+  * const bool& _debug - Whether or not to print error messages
+  * const Stream &_debugPort - Serial port to print error messages
+ Return:
+ -------
+  * void
+*/
+void I2CTransfer::begin(TwoWire& _port, const bool& _debug, Stream& _debugPort)
+{
+	port = &_port;
+	port->onReceive(processData);
+	port->onRequest(serveRequest);
+	beginTransfer(_debug, _debugPort, DEFAULT_TIMEOUT);
+}
+
+
+/*
+ uint16_t I2CTransfer::sendData(const uint16_t &messageLen, const uint16_t &command, const uint8_t &packetID, const uint8_t &targetAddress=0)
+ Description:
+ ------------
+  * Send a specified number of bytes in packetized form. The frame
+  is split into as many I2C_CHUNK_SIZE byte transactions as needed
+  so that it never overflows the Wire buffer
+ Inputs:
+ -------
+  * const uint16_t &messageLen - Number of values in txBuff
+  to send as the payload in the next packet
+  * const uint16_t &command - The packet 16-bit command
+  * const uint8_t &packetID - The packet 8-bit identifier
+  * const uint8_t &targetAddress - I2C address to the device the packet
+      will be transmitted to
+ Return:
+ -------
+  * uint16_t numBytesIncl - Number of payload bytes included in packet
+  (0 if the target did not acknowledge)
+*/
+uint16_t I2CTransfer::sendData(const uint16_t& messageLen, const uint16_t& command, const uint8_t& packetID, const uint8_t& targetAddress)
+{
+	address = targetAddress;
+
+	return sendPacket(messageLen, command, packetID);
+}
+
+
+/*
+ uint16_t I2CTransfer::queueData(const uint16_t &messageLen, const uint16_t &command, const uint8_t &packetID)
+ Description:
+ ------------
+  * Slave only - queues a packet for the master to collect with
+  poll(). Queued packets are served in order, one chunk per request
+ Inputs:
+ -------
+  * const uint16_t &messageLen - Number of values in txBuff
+  to send as the payload in the next packet
+  * const uint16_t &command - The packet 16-bit command
+  * const uint8_t &packetID - The packet 8-bit identifier
+ Return:
+ -------
+  * uint16_t numBytesIncl - Number of payload bytes included in packet
+  (0 if the queue is too full to take it)
+*/
+uint16_t I2CTransfer::queueData(const uint16_t& messageLen, const uint16_t& command, const uint8_t& packetID)
+{
+	uint16_t numBytesIncl = packet.constructPacket(messageLen, command, packetID);
+	uint16_t frameLen     = sizeof(packet.preamble) + packet.bytesToSend + sizeof(packet.postamble);
+	uint16_t head         = txHead;
+	uint8_t  header[2];
+
+	if (queueFree() < (frameLen + sizeof(header)))
+		return 0;
+
+	header[0] = (frameLen >> 8) & 0xFF;
+	header[1] = frameLen & 0xFF;
+
+	queueBytes(header, sizeof(header), head);
+	queueBytes(packet.preamble, sizeof(packet.preamble), head);
+	queueBytes(packet.txPayload, packet.bytesToSend, head);
+	queueBytes(packet.postamble, sizeof(packet.postamble), head);
+
+	noInterrupts(); // Publish the whole frame at once
+	txHead = head;
+	interrupts();
+
+	return numBytesIncl;
+}
+
+
+/*
+ uint16_t I2CTransfer::poll(const uint8_t &targetAddress)
+ Description:
+ ------------
+  * Master only - reads the next packet queued by the slave at
+  "targetAddress", one requestFrom() chunk at a time
+ Inputs:
+ -------
+  * const uint8_t &targetAddress - I2C address of the slave to poll
+ Return:
+ -------
+  * uint16_t bytesRead - Num bytes in RX buffer (0 if the slave had
+  nothing queued)
+*/
+uint16_t I2CTransfer::poll(const uint8_t& targetAddress)
+{
+	uint8_t  chunk[I2C_MAX_REQUEST];
+	uint16_t maxRequests = (PACKET_SIZE / I2C_MAX_REQUEST) + 2;
+
+	polled    = targetAddress;
+	bytesRead = 0;
+	status    = NO_DATA;
+
+	for (uint16_t i = 0; i < maxRequests; i++)
+	{
+		uint8_t  received = port->requestFrom(targetAddress, I2C_MAX_REQUEST);
+		uint8_t  len      = 0;
+		uint16_t consumed;
+
+		while (port->available() && (len < received))
+			chunk[len++] = port->read();
+
+		if (parseBytes(chunk, len, consumed)) // Packet or error
+			break;
+
+		if (!packet.pendingBytes()) // Nothing queued
+		{
+			status = NO_DATA;
+			break;
+		}
+	}
+
+	if (status == CONTINUE) // Slave stopped serving mid-frame, don't carry it over to the next slave
+		reset();
+
+	return bytesRead;
+}
+
+
+/*
+ void I2CTransfer::setPollList(const uint8_t addresses[], const uint8_t &len)
+ Description:
+ ------------
+  * Sets the slaves pollNext() cycles through
+ Inputs:
+ -------
+  * const uint8_t addresses[] - I2C addresses of the slaves to poll
+  (persistent allocation required)
+  * const uint8_t &len - Number of addresses in addresses[]
+ Return:
+ -------
+  * void
+*/
+void I2CTransfer::setPollList(const uint8_t addresses[], const uint8_t& len)
+{
+	pollList    = addresses;
+	pollListLen = len;
+	pollIndex   = 0;
+}
+
+
+/*
+ uint16_t I2CTransfer::pollNext()
+ Description:
+ ------------
+  * Polls the next slave of the poll list, round-robin, so that every
+  slave gets a turn no matter how busy the others are. Use
+  currentAddress() to tell which slave a packet came from
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t bytesRead - Num bytes in RX buffer (0 if the slave had
+  nothing queued)
+*/
+uint16_t I2CTransfer::pollNext()
+{
+	if (!pollListLen)
+		return 0;
+
+	uint8_t targetAddress = pollList[pollIndex];
+	pollIndex             = (pollIndex + 1) % pollListLen;
+
+	return poll(targetAddress);
+}
+
+
+/*
+ bool I2CTransfer::writeFrame()
+ Description:
+ ------------
+  * Writes the constructed packet to "address", split into as many
+  I2C_CHUNK_SIZE byte transactions as needed
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not every transaction was acknowledged
+*/
+bool I2CTransfer::writeFrame()
+{
+	chunkUsed = 0;
+	txFailed  = false;
+
+	port->beginTransmission(address);
+	writeBytes(packet.preamble, sizeof(packet.preamble));
+	writeBytes(packet.txPayload, packet.bytesToSend);
+	writeBytes(packet.postamble, sizeof(packet.postamble));
+
+	if (port->endTransmission())
+		txFailed = true;
+
+	return !txFailed;
+}
+
+
+/*
+ void I2CTransfer::writeBytes(const uint8_t arr[], const uint16_t& len)
+ Description:
+ ------------
+  * Adds bytes to the current transaction, ending it and starting
+  the next one whenever it reaches I2C_CHUNK_SIZE bytes
+ Inputs:
+ -------
+  * const uint8_t arr[] - Bytes to write
+  * const uint16_t& len - Number of bytes in arr[]
+ Return:
+ -------
+  * void
+*/
+void I2CTransfer::writeBytes(const uint8_t arr[], const uint16_t& len)
+{
+	uint16_t written = 0;
+
+	while (!txFailed && (written < len))
+	{
+		uint16_t chunk = len - written;
+
+		if (chunkUsed == I2C_CHUNK_SIZE)
+		{
+			if (port->endTransmission())
+			{
+				txFailed = true;
+				break;
+			}
+
+			port->beginTransmission(address);
+			chunkUsed = 0;
+		}
+
+		if (chunk > (I2C_CHUNK_SIZE - chunkUsed))
+			chunk = I2C_CHUNK_SIZE - chunkUsed;
+
+		port->write(arr + written, chunk);
+		chunkUsed += chunk;
+		written += chunk;
+	}
+}
+
+
+/*
+ void I2CTransfer::processData(int numBytes)
+ Description:
+ ------------
+  * Parses incoming serial data automatically when an
+  I2C transaction is received. Frames larger than the Wire buffer
+  span several transactions and are picked up where the previous
+  transaction left off
+ Inputs:
+ -------
+  * int numBytes - Number of bytes received in the transaction
+ Return:
+ -------
+  * void
+*/
+void I2CTransfer::processData(int numBytes)
+{
+	uint8_t  chunk[I2C_CHUNK_SIZE];
+	uint16_t len = 0;
+	uint16_t consumed;
+
+	(void)numBytes;
+
+	while (classToUse->port->available() && (len < sizeof(chunk)))
+		chunk[len++] = classToUse->port->read();
+
+	classToUse->parseBytes(chunk, len, consumed);
+}
+
+
+/*
+ void I2CTransfer::serveRequest()
+ Description:
+ ------------
+  * Answers a master's requestFrom() with the next chunk of the
+  oldest queued frame. A chunk never spans two frames, so that the
+  master can stop reading as soon as a packet is complete
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void I2CTransfer::serveRequest()
+{
+	I2CTransfer* self = classToUse;
+	uint8_t      chunk[I2C_MAX_REQUEST];
+	uint8_t      len  = 0;
+	uint16_t     head = self->txHead;
+	uint16_t     tail = self->txTail;
+
+	if (!self->txServing && (((head + I2C_TX_QUEUE_SIZE - tail) % I2C_TX_QUEUE_SIZE) >= 2))
+	{
+		self->txServing = (uint16_t)self->txQueue[tail] << 8;
+		tail            = (tail + 1) % I2C_TX_QUEUE_SIZE;
+		self->txServing |= self->txQueue[tail];
+		tail            = (tail + 1) % I2C_TX_QUEUE_SIZE;
+	}
+
+	while (self->txServing && (len < sizeof(chunk)) && (tail != head))
+	{
+		chunk[len++] = self->txQueue[tail];
+		tail         = (tail + 1) % I2C_TX_QUEUE_SIZE;
+		self->txServing--;
+	}
+
+	self->txTail = tail;
+
+	if (!len)
+		chunk[len++] = I2C_IDLE_BYTE;
+
+	self->port->write(chunk, len);
+}
+
+
+/*
+ uint16_t I2CTransfer::queueFree()
+ Description:
+ ------------
+  * Returns the number of bytes the slave frame queue can still take
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - Free bytes in the frame queue
+*/
+uint16_t I2CTransfer::queueFree()
+{
+	uint16_t tail;
+
+	noInterrupts(); // 16-bit reads are not atomic on 8-bit MCUs
+	tail = txTail;
+	interrupts();
+
+	return I2C_TX_QUEUE_SIZE - 1 - ((txHead + I2C_TX_QUEUE_SIZE - tail) % I2C_TX_QUEUE_SIZE);
+}
+
+
+/*
+ void I2CTransfer::queueBytes(const uint8_t arr[], const uint16_t& len, uint16_t& head)
+ Description:
+ ------------
+  * Copies bytes into the slave frame queue without publishing them
+ Inputs:
+ -------
+  * const uint8_t arr[] - Bytes to queue
+  * const uint16_t& len - Number of bytes in arr[]
+  * uint16_t& head - Queue index to copy to, advanced past the bytes
+ Return:
+ -------
+  * void
+*/
+void I2CTransfer::queueBytes(const uint8_t arr[], const uint16_t& len, uint16_t& head)
+{
+	for (uint16_t i = 0; i < len; i++)
+	{
+		txQueue[head] = arr[i];
+		head          = (head + 1) % I2C_TX_QUEUE_SIZE;
+	}
+}
+
+
+/*
+ uint8_t I2CTransfer::currentAddress()
+ Description:
+ ------------
+  * Returns the address of the slave last polled
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint8_t - Address of the slave last polled
+*/
+uint8_t I2CTransfer::currentAddress()
+{
+	return polled;
+}
+
+
+I2CTransfer* I2CTransfer::classToUse = NULL;
@@ -1,111 +1,146 @@
-#pragma once
-#include "Arduino.h"
-#include "Packet.h"
-#include "Wire.h"
-
-
-class I2CTransfer
-{
-  public: // <<---------------------------------------//public
-	Packet              packet;
-	static I2CTransfer* classToUse;
-	uint8_t             bytesRead = 0;
-	int8_t              status    = 0;
-
-
-	I2CTransfer()
-	{
-		classToUse = this;
-	};
-	void    begin(TwoWire& _port, const configST& configs);
-	void    begin(TwoWire& _port, const bool& _debug = true, Stream& _debugPort = Serial);
-	uint8_t sendData(const uint16_t& messageLen, const uint8_t& packetID = 0, const uint8_t& targetAddress = 0);
-	uint8_t currentPacketID();
-	void    reset();
-
-
-	/*
-	 uint16_t I2CTransfer::txObj(const T &val, const uint16_t &index=0, const uint16_t &len=sizeof(T))
-	 Description:
-	 ------------
-	  * Stuffs "len" number of bytes of an arbitrary object (byte, int,
-	  float, double, struct, etc...) into the transmit buffer (txBuff)
-	  starting at the index as specified by the argument "index"
-	 Inputs:
-	 -------
-	  * const T &val - Pointer to the object to be copied to the
-	  transmit buffer (txBuff)
-	  * const uint16_t &index - Starting index of the object within the
-	  transmit buffer (txBuff)
-	  * const uint16_t &len - Number of bytes of the object "val" to transmit
-	 Return:
-	 -------
-	  * uint16_t maxIndex - uint16_t maxIndex - Index of the transmit buffer (txBuff) that directly follows the bytes processed
-	  by the calling of this member function
-	*/
-	template <typename T>
-	uint16_t txObj(const T& val, const uint16_t& index = 0, const uint16_t& len = sizeof(T))
-	{
-		return packet.txObj(val, index, len);
-	}
-
-
-	/*
-	 uint16_t I2CTransfer::rxObj(const T &val, const uint16_t &index=0, const uint16_t &len=sizeof(T))
-	 Description:
-	 ------------
-	  * Reads "len" number of bytes from the receive buffer (rxBuff)
-	  starting at the index as specified by the argument "index"
-	  into an arbitrary object (byte, int, float, double, struct, etc...)
-	 Inputs:
-	 -------
-	  * const T &val - Pointer to the object to be copied into from the
-	  receive buffer (rxBuff)
-	  * const uint16_t &index - Starting index of the object within the
-	  receive buffer (rxBuff)
-	  * const uint16_t &len - Number of bytes in the object "val" received
-	 Return:
-	 -------
-	  * uint16_t maxIndex - Index of the receive buffer (rxBuff) that directly follows the bytes processed
-	  by the calling of this member function
-	*/
-	template <typename T>
-	uint16_t rxObj(const T& val, const uint16_t& index = 0, const uint16_t& len = sizeof(T))
-	{
-		return packet.rxObj(val, index, len);
-	}
-
-
-	/*
-	 uint8_t I2CTransfer::sendDatum(const T &val, const uint8_t &packetID=0, const uint8_t &targetAddress=0, const uint16_t &len=sizeof(T))
-	 Description:
-	 ------------
-	  * Stuffs "len" number of bytes of an arbitrary object (byte, int,
-	  float, double, struct, etc...) into the transmit buffer (txBuff)
-	  starting at the index as specified by the argument "index" and
-	  automatically transmits the bytes in an individual packet
-	 Inputs:
-	 -------
-	  * const T &val - Pointer to the object to be copied to the
-	  transmit buffer (txBuff)
-	  * const uint8_t &packetID - The packet 8-bit identifier
-	  * const uint8_t &targetAddress - I2C address to the device the packet
-	  will be transmitted to
-	  * const uint16_t &len - Number of bytes of the object "val" to transmit
-	 Return:
-	 -------
-	  * uint8_t - Number of payload bytes included in packet
-	*/
-	template <typename T>
-	uint8_t sendDatum(const T& val, const uint8_t& packetID = 0, const uint8_t& targetAddress = 0, const uint16_t& len = sizeof(T))
-	{
-		return sendData(packet.txObj(val, packetID, len), packetID, targetAddress);
-	}
-
-
-  private: // <<---------------------------------------//private
-	TwoWire* port;
-
-
-	static void processData();
-};
+#pragma once
+#include "Arduino.h"
+#include "Packet.h"
+#include "Transfer.h"
+#include "Wire.h"
+
+
+#if defined(I2CTRANSFER_CHUNK_SIZE) // Override to match the smallest Wire buffer on the bus when polling
+const uint16_t I2C_CHUNK_SIZE = I2CTRANSFER_CHUNK_SIZE; // Max bytes per Wire transaction
+#elif defined(I2C_BUFFER_LENGTH)
+const uint16_t I2C_CHUNK_SIZE = I2C_BUFFER_LENGTH; // Max bytes per Wire transaction
+#elif defined(BUFFER_LENGTH)
+const uint16_t I2C_CHUNK_SIZE = BUFFER_LENGTH; // Max bytes per Wire transaction
+#else
+const uint16_t I2C_CHUNK_SIZE = 32; // Max bytes per Wire transaction
+#endif
+
+#ifndef I2C_TX_QUEUE_SIZE
+#define I2C_TX_QUEUE_SIZE (PACKET_SIZE + 3) // Slave frame queue size, holds I2C_TX_QUEUE_SIZE - 1 bytes (2 length bytes per frame)
+#endif
+
+const uint8_t I2C_MAX_REQUEST = (I2C_CHUNK_SIZE < 0xFF) ? I2C_CHUNK_SIZE : 0xFF; // Bytes asked for per requestFrom()
+const uint8_t I2C_IDLE_BYTE   = 0x00; // Served when no frame is queued, ignored by the parser
+
+
+class I2CTransfer : public Transfer<I2CTransfer>
+{
+  public: // <<---------------------------------------//public
+	static I2CTransfer* classToUse;
+
+
+	I2CTransfer()
+	{
+		classToUse = this;
+	};
+	void     begin(TwoWire& _port, const configST& configs);
+	void     begin(TwoWire& _port, const bool& _debug = true, Stream& _debugPort = Serial);
+	uint16_t sendData(const uint16_t& messageLen, const uint16_t& command = 0, const uint8_t& packetID = 0, const uint8_t& targetAddress = 0);
+	uint16_t queueData(const uint16_t& messageLen, const uint16_t& command = 0, const uint8_t& packetID = 0);
+	uint16_t poll(const uint8_t& targetAddress);
+	void     setPollList(const uint8_t addresses[], const uint8_t& len);
+	uint16_t pollNext();
+	uint8_t  currentAddress();
+
+
+	/*
+	 uint16_t I2CTransfer::sendDatum(const T &val, const uint8_t &packetID=0, const uint8_t &targetAddress=0, const uint16_t &len=sizeof(T))
+	 Description:
+	 ------------
+	  * Stuffs "len" number of bytes of an arbitrary object (byte, int,
+	  float, double, struct, etc...) into the transmit buffer (txBuff)
+	  starting at the index as specified by the argument "index" and
+	  automatically transmits the bytes in an individual packet
+	 Inputs:
+	 -------
+	  * const T &val - Pointer to the object to be copied to the
+	  transmit buffer (txBuff)
+	  * const uint8_t &packetID - The packet 8-bit identifier
+	  * const uint8_t &targetAddress - I2C address to the device the packet
+	  will be transmitted to
+	  * const uint16_t &len - Number of bytes of the object "val" to transmit
+	 Return:
+	 -------
+	  * uint16_t - Number of payload bytes included in packet
+	*/
+	template <typename T>
+	uint16_t sendDatum(const T& val, const uint8_t& packetID = 0, const uint8_t& targetAddress = 0, const uint16_t& len = sizeof(T))
+	{
+		return sendData(packet.txObj(val, 0, len), 0, packetID, targetAddress);
+	}
+
+
+	/*
+	 uint16_t I2CTransfer::queueDatum(const T &val, const uint8_t &packetID=0, const uint16_t &len=sizeof(T))
+	 Description:
+	 ------------
+	  * Stuffs "len" number of bytes of an arbitrary object (byte, int,
+	  float, double, struct, etc...) into the transmit buffer (txBuff)
+	  and queues them in an individual packet for the master to poll
+	 Inputs:
+	 -------
+	  * const T &val - Pointer to the object to be copied to the
+	  transmit buffer (txBuff)
+	  * const uint8_t &packetID - The packet 8-bit identifier
+	  * const uint16_t &len - Number of bytes of the object "val" to transmit
+	 Return:
+	 -------
+	  * uint16_t - Number of payload bytes included in packet
+	*/
+	template <typename T>
+	uint16_t queueDatum(const T& val, const uint8_t& packetID = 0, const uint16_t& len = sizeof(T))
+	{
+		return queueData(packet.txObj(val, 0, len), 0, packetID);
+	}
+
+
+	/*
+	 uint16_t I2CTransfer::sendSchema<Schema>(const T &val, const uint8_t &packetID=0, const uint8_t &targetAddress=0)
+	 Description:
+	 ------------
+	  * Encodes the fields of "val" listed in "Schema" (a PacketSchema)
+	  and automatically transmits them in an individual packet
+	 Inputs:
+	 -------
+	  * const T &val - Object to be sent
+	  * const uint8_t &packetID - The packet 8-bit identifier
+	  * const uint8_t &targetAddress - I2C address to the device the packet
+	  will be transmitted to
+	 Return:
+	 -------
+	  * uint16_t - Number of payload bytes included in packet
+	*/
+	template <typename Schema, typename T>
+	uint16_t sendSchema(const T& val, const uint8_t& packetID = 0, const uint8_t& targetAddress = 0)
+	{
+		return sendData(packet.template txSchema<Schema>(val), 0, packetID, targetAddress);
+	}
+
+
+  private: // <<---------------------------------------//private
+	friend class Transfer<I2CTransfer>;
+
+	TwoWire* port;
+	uint8_t  address   = 0;     // Target of the transaction being filled by writeBytes()
+	uint16_t chunkUsed = 0;     // Bytes written to the current transaction
+	bool     txFailed  = false; // Whether or not a transaction of the current frame was NACKed
+
+	const uint8_t* pollList    = NULL; // Caller-provided slave addresses for pollNext()
+	uint8_t        pollListLen = 0;
+	uint8_t        pollIndex   = 0;
+	uint8_t        polled      = 0; // Address of the last slave polled
+
+	uint8_t           txQueue[I2C_TX_QUEUE_SIZE]; // Queued frames, each led by its 16-bit length
+	volatile uint16_t txHead    = 0;              // Written by queueData() only
+	volatile uint16_t txTail    = 0;              // Written by serveRequest() only
+	uint16_t          txServing = 0;              // Bytes of the frame being served still to go, ISR only
+
+
+	bool     writeFrame();
+	void     writeBytes(const uint8_t arr[], const uint16_t& len);
+	uint16_t queueFree();
+	void     queueBytes(const uint8_t arr[], const uint16_t& len, uint16_t& head);
+
+	static void processData(int numBytes);
+	static void serveRequest();
+};
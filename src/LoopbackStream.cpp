@@ -0,0 +1,585 @@
+#include "LoopbackStream.h"
+
+#if !defined(ARDUINO)
+
+#include <chrono>
+#include <math.h>
+
+
+/*
+ void LoopbackPipe::begin(const loopbackConfigST& _config)
+ Description:
+ ------------
+  * Empties the pipe and applies new link settings. Neither end may
+  be in use meanwhile
+ Inputs:
+ -------
+  * const loopbackConfigST& _config - Link settings
+ Return:
+ -------
+  * void
+*/
+void LoopbackPipe::begin(const loopbackConfigST& _config)
+{
+	config  = _config;
+	txStats = loopbackStatsST();
+
+	headIndex.store(0);
+	tailIndex.store(0);
+	segHead.store(0);
+	segTail.store(0);
+
+	cachedTail  = 0;
+	cachedHead  = 0;
+	freeAt      = 0;
+	rng         = config.seed ? config.seed : 1;
+	bitsToError = errorGap();
+}
+
+
+/*
+ size_t LoopbackPipe::write(const uint8_t buffer[], const size_t& size)
+ Description:
+ ------------
+  * Sends bytes down the pipe, flipping bits at the configured rate.
+  Whatever does not fit the buffer is dropped like a UART overrun
+ Inputs:
+ -------
+  * const uint8_t buffer[] - Bytes to send
+  * const size_t& size - Number of bytes in buffer[]
+ Return:
+ -------
+  * size_t - Number of bytes sent
+*/
+size_t LoopbackPipe::write(const uint8_t buffer[], const size_t& size)
+{
+	uint32_t head  = headIndex.load(std::memory_order_relaxed);
+	size_t   count = LOOPBACK_BUFFER_SIZE - (head - cachedTail);
+	size_t   first;
+
+	if (count < size)
+		count = writable();
+
+	if (count > size)
+		count = size;
+
+	if (timed() && ((segHead.load(std::memory_order_relaxed) - segTail.load(std::memory_order_acquire)) == LOOPBACK_SEGMENTS))
+		count = 0;
+
+	txStats.bytesDropped += size - count;
+
+	if (!count)
+		return 0;
+
+	first = LOOPBACK_BUFFER_SIZE - (head & (LOOPBACK_BUFFER_SIZE - 1));
+
+	if (first > count)
+		first = count;
+
+	memcpy(buff + (head & (LOOPBACK_BUFFER_SIZE - 1)), buffer, first);
+	memcpy(buff, buffer + first, count - first);
+
+	if (config.ber > 0)
+		corrupt(head, count);
+
+	txStats.bytesSent += count;
+	headIndex.store(head + count, std::memory_order_release);
+
+	if (timed())
+	{
+		uint32_t seg   = segHead.load(std::memory_order_relaxed);
+		uint64_t start = nowNs();
+
+		if (config.bandwidth)
+		{
+			if (freeAt > start) // Queued behind bytes still going out
+				start = freeAt;
+
+			freeAt = start + ((uint64_t)count * 1000000000ULL) / config.bandwidth;
+		}
+
+		segments[seg & (LOOPBACK_SEGMENTS - 1)].begin = head;
+		segments[seg & (LOOPBACK_SEGMENTS - 1)].end   = head + count;
+		segments[seg & (LOOPBACK_SEGMENTS - 1)].start = start;
+		segHead.store(seg + 1, std::memory_order_release);
+	}
+
+	return count;
+}
+
+
+/*
+ size_t LoopbackPipe::writable()
+ Description:
+ ------------
+  * Returns the free space of the buffer
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * size_t - Number of bytes that can be written without dropping any
+*/
+size_t LoopbackPipe::writable()
+{
+	cachedTail = tailIndex.load(std::memory_order_acquire);
+
+	return LOOPBACK_BUFFER_SIZE - (headIndex.load(std::memory_order_relaxed) - cachedTail);
+}
+
+
+/*
+ size_t LoopbackPipe::readable()
+ Description:
+ ------------
+  * Returns the number of bytes that have arrived at the reader's end
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * size_t - Number of bytes that can be read
+*/
+size_t LoopbackPipe::readable()
+{
+	uint32_t tail  = tailIndex.load(std::memory_order_relaxed);
+	uint32_t limit = tail;
+	uint64_t now;
+
+	if (!timed())
+	{
+		if (cachedHead == tail)
+			cachedHead = headIndex.load(std::memory_order_acquire);
+
+		return cachedHead - tail;
+	}
+
+	now = nowNs();
+
+	for (uint32_t i = segTail.load(std::memory_order_relaxed); i != segHead.load(std::memory_order_acquire); i++)
+	{
+		const Segment& seg     = segments[i & (LOOPBACK_SEGMENTS - 1)];
+		uint64_t       arrival = seg.start + ((uint64_t)config.latency * 1000);
+		uint32_t       len     = seg.end - seg.begin;
+		uint32_t       ready   = len;
+
+		if (now < arrival)
+			break;
+
+		if (config.bandwidth) // Bytes arrive one by one as they finish going out
+		{
+			uint64_t done = ((now - arrival) * config.bandwidth) / 1000000000ULL;
+
+			if (done < len)
+				ready = done;
+		}
+
+		limit = seg.begin + ready;
+
+		if (ready < len)
+			break;
+	}
+
+	return limit - tail;
+}
+
+
+/*
+ size_t LoopbackPipe::read(uint8_t arr[], const size_t& len)
+ Description:
+ ------------
+  * Copies up to "len" arrived bytes out of the pipe
+ Inputs:
+ -------
+  * uint8_t arr[] - Buffer to copy received bytes into
+  * const size_t& len - Size of arr[]
+ Return:
+ -------
+  * size_t - Number of bytes copied into arr[]
+*/
+size_t LoopbackPipe::read(uint8_t arr[], const size_t& len)
+{
+	uint32_t tail  = tailIndex.load(std::memory_order_relaxed);
+	size_t   count = readable();
+	size_t   first;
+
+	if (count > len)
+		count = len;
+
+	if (!count)
+		return 0;
+
+	first = LOOPBACK_BUFFER_SIZE - (tail & (LOOPBACK_BUFFER_SIZE - 1));
+
+	if (first > count)
+		first = count;
+
+	memcpy(arr, buff + (tail & (LOOPBACK_BUFFER_SIZE - 1)), first);
+	memcpy(arr + first, buff, count - first);
+
+	tail += count;
+
+	if (timed()) // Retire the writes read in full
+	{
+		uint32_t seg = segTail.load(std::memory_order_relaxed);
+
+		while ((seg != segHead.load(std::memory_order_acquire)) && ((int32_t)(segments[seg & (LOOPBACK_SEGMENTS - 1)].end - tail) <= 0))
+			seg++;
+
+		segTail.store(seg, std::memory_order_release);
+	}
+
+	tailIndex.store(tail, std::memory_order_release);
+
+	return count;
+}
+
+
+/*
+ int LoopbackPipe::peek()
+ Description:
+ ------------
+  * Returns the next arrived byte without consuming it
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * int - Next byte, -1 if none has arrived
+*/
+int LoopbackPipe::peek()
+{
+	if (!readable())
+		return -1;
+
+	return buff[tailIndex.load(std::memory_order_relaxed) & (LOOPBACK_BUFFER_SIZE - 1)];
+}
+
+
+/*
+ loopbackStatsST LoopbackPipe::stats()
+ Description:
+ ------------
+  * Returns the pipe's counters
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * loopbackStatsST - Bytes sent/dropped and bits flipped so far
+*/
+loopbackStatsST LoopbackPipe::stats()
+{
+	return txStats;
+}
+
+
+/*
+ bool LoopbackPipe::timed()
+ Description:
+ ------------
+  * Whether or not bytes take time to arrive
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not bandwidth or latency is simulated
+*/
+bool LoopbackPipe::timed()
+{
+	return config.bandwidth || config.latency;
+}
+
+
+/*
+ void LoopbackPipe::corrupt(const uint32_t& index, const size_t& len)
+ Description:
+ ------------
+  * Flips the bits that the error process hits within bytes just
+  written. Errors are spaced by geometrically distributed gaps, so
+  the cost is per error rather than per bit
+ Inputs:
+ -------
+  * const uint32_t& index - Ring index of the first byte written
+  * const size_t& len - Number of bytes written
+ Return:
+ -------
+  * void
+*/
+void LoopbackPipe::corrupt(const uint32_t& index, const size_t& len)
+{
+	uint64_t bits = (uint64_t)len * 8;
+	uint64_t pos  = 0;
+
+	while (bitsToError < (bits - pos))
+	{
+		pos += bitsToError;
+		buff[(index + (pos / 8)) & (LOOPBACK_BUFFER_SIZE - 1)] ^= 1 << (pos % 8);
+		txStats.bitErrors++;
+
+		pos++;
+		bitsToError = errorGap();
+	}
+
+	bitsToError -= bits - pos;
+}
+
+
+/*
+ uint64_t LoopbackPipe::errorGap()
+ Description:
+ ------------
+  * Draws the number of good bits before the next flipped one
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint64_t - Bits to skip
+*/
+uint64_t LoopbackPipe::errorGap()
+{
+	double u;
+
+	if (config.ber <= 0)
+		return UINT64_MAX;
+
+	if (config.ber >= 1)
+		return 0;
+
+	rng ^= rng << 13; // xorshift32
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	u = (rng + 1.0) / 4294967296.0; // (0, 1]
+
+	return (uint64_t)(log(u) / log(1 - config.ber));
+}
+
+
+/*
+ uint64_t LoopbackPipe::nowNs()
+ Description:
+ ------------
+  * Monotonic time in ns
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint64_t - ns since an arbitrary point
+*/
+uint64_t LoopbackPipe::nowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/*
+ int LoopbackStream::available()
+ Description:
+ ------------
+  * Returns the number of bytes that have arrived
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * int - Number of bytes that can be read without blocking
+*/
+int LoopbackStream::available()
+{
+	return rx->readable();
+}
+
+
+/*
+ int LoopbackStream::read()
+ Description:
+ ------------
+  * Reads the next arrived byte
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * int - Next byte, -1 if none has arrived
+*/
+int LoopbackStream::read()
+{
+	uint8_t val;
+
+	if (!rx->read(&val, 1))
+		return -1;
+
+	return val;
+}
+
+
+/*
+ int LoopbackStream::peek()
+ Description:
+ ------------
+  * Returns the next arrived byte without consuming it
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * int - Next byte, -1 if none has arrived
+*/
+int LoopbackStream::peek()
+{
+	return rx->peek();
+}
+
+
+/*
+ size_t LoopbackStream::readAvailable(uint8_t arr[], const size_t& len)
+ Description:
+ ------------
+  * Copies up to "len" arrived bytes without blocking
+ Inputs:
+ -------
+  * uint8_t arr[] - Buffer to copy received bytes into
+  * const size_t& len - Size of arr[]
+ Return:
+ -------
+  * size_t - Number of bytes copied into arr[]
+*/
+size_t LoopbackStream::readAvailable(uint8_t arr[], const size_t& len)
+{
+	return rx->read(arr, len);
+}
+
+
+/*
+ size_t LoopbackStream::write(uint8_t val)
+ Description:
+ ------------
+  * Sends a single byte
+ Inputs:
+ -------
+  * uint8_t val - Byte to send
+ Return:
+ -------
+  * size_t - Number of bytes sent (0 if the buffer is full)
+*/
+size_t LoopbackStream::write(uint8_t val)
+{
+	return tx->write(&val, 1);
+}
+
+
+/*
+ size_t LoopbackStream::write(const uint8_t* buffer, size_t size)
+ Description:
+ ------------
+  * Sends a block of bytes. Whatever does not fit the buffer is dropped
+ Inputs:
+ -------
+  * const uint8_t* buffer - Bytes to send
+  * size_t size - Number of bytes in buffer
+ Return:
+ -------
+  * size_t - Number of bytes sent
+*/
+size_t LoopbackStream::write(const uint8_t* buffer, size_t size)
+{
+	return tx->write(buffer, size);
+}
+
+
+/*
+ int LoopbackStream::availableForWrite()
+ Description:
+ ------------
+  * Returns the free space of the send buffer
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * int - Number of bytes that can be sent without dropping any
+*/
+int LoopbackStream::availableForWrite()
+{
+	return tx->writable();
+}
+
+
+/*
+ loopbackStatsST LoopbackStream::txStats()
+ Description:
+ ------------
+  * Returns the counters of the direction this end sends on
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * loopbackStatsST - Bytes sent/dropped and bits flipped so far
+*/
+loopbackStatsST LoopbackStream::txStats()
+{
+	return tx->stats();
+}
+
+
+/*
+ LoopbackChannel::LoopbackChannel()
+ Description:
+ ------------
+  * Connects the two ends, by default with an ideal link
+*/
+LoopbackChannel::LoopbackChannel()
+{
+	a.tx = &pipeAToB;
+	a.rx = &pipeBToA;
+	b.tx = &pipeBToA;
+	b.rx = &pipeAToB;
+
+	begin(loopbackConfigST());
+}
+
+
+/*
+ void LoopbackChannel::begin(const loopbackConfigST& config)
+ Description:
+ ------------
+  * Empties the channel and applies the same settings both ways
+ Inputs:
+ -------
+  * const loopbackConfigST& config - Link settings
+ Return:
+ -------
+  * void
+*/
+void LoopbackChannel::begin(const loopbackConfigST& config)
+{
+	begin(config, config);
+}
+
+
+/*
+ void LoopbackChannel::begin(const loopbackConfigST& aToB, const loopbackConfigST& bToA)
+ Description:
+ ------------
+  * Empties the channel and applies separate settings per direction
+ Inputs:
+ -------
+  * const loopbackConfigST& aToB - Settings of the a -> b direction
+  * const loopbackConfigST& bToA - Settings of the b -> a direction
+ Return:
+ -------
+  * void
+*/
+void LoopbackChannel::begin(const loopbackConfigST& aToB, const loopbackConfigST& bToA)
+{
+	pipeAToB.begin(aToB);
+	pipeBToA.begin(bToA);
+}
+
+
+#endif // !defined(ARDUINO)
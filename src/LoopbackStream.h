@@ -0,0 +1,149 @@
+#pragma once
+#include "Arduino.h"
+#include "BulkStream.h"
+
+#if !defined(ARDUINO)
+
+#include <atomic>
+
+
+#ifndef LOOPBACK_BUFFER_SIZE
+#define LOOPBACK_BUFFER_SIZE 65536 // Bytes in flight per direction, power of 2
+#endif
+
+#ifndef LOOPBACK_SEGMENTS
+#define LOOPBACK_SEGMENTS 1024 // Writes in flight per direction while bandwidth/latency are simulated, power of 2
+#endif
+
+
+struct loopbackConfigST
+{
+	uint32_t bandwidth = 0; // Bytes per second, 0 = unlimited
+	uint32_t latency   = 0; // us between a byte going out and it arriving
+	double   ber       = 0; // Probability of each bit being flipped on the way
+	uint32_t seed      = 1; // Runs with the same seed see the same bit errors
+};
+
+
+struct loopbackStatsST
+{
+	uint32_t bytesSent    = 0;
+	uint32_t bytesDropped = 0; // Bytes written while the buffer was full
+	uint32_t bitErrors    = 0; // Bits flipped
+};
+
+
+/*
+ class LoopbackPipe
+ Description:
+ ------------
+  * One direction of a LoopbackChannel: a lock-free, single producer,
+  single consumer byte ring. Bytes are copied in once by the writer
+  and out once by the reader - no syscalls or intermediate buffers.
+  While bandwidth or latency is simulated, every write also records
+  when it goes out so the reader only sees bytes that have "arrived"
+*/
+class LoopbackPipe
+{
+  public: // <<---------------------------------------//public
+	void            begin(const loopbackConfigST& _config);
+	size_t          write(const uint8_t buffer[], const size_t& size);
+	size_t          writable();
+	size_t          readable();
+	size_t          read(uint8_t arr[], const size_t& len);
+	int             peek();
+	loopbackStatsST stats();
+
+
+  private: // <<---------------------------------------//private
+	struct Segment
+	{
+		uint32_t begin; // Ring index of the first byte written
+		uint32_t end;   // Ring index following the last byte written
+		uint64_t start; // ns the first byte starts going out
+	};
+
+	loopbackConfigST config;
+
+	uint8_t buff[LOOPBACK_BUFFER_SIZE];
+	Segment segments[LOOPBACK_SEGMENTS];
+
+	std::atomic<uint32_t> headIndex{0}; // Written by the writer only
+	std::atomic<uint32_t> segHead{0};
+	loopbackStatsST       txStats;
+	uint32_t              cachedTail  = 0; // Writer's copy of tailIndex, refreshed only when the buffer looks full
+	uint64_t              freeAt      = 0; // ns the link finishes sending what was written so far
+	uint32_t              rng         = 1;
+	uint64_t              bitsToError = 0; // Bits left before the next flipped one
+	uint8_t               padding[64];     // Keeps the writer's and reader's state on separate cache lines
+	std::atomic<uint32_t> tailIndex{0};    // Written by the reader only
+	std::atomic<uint32_t> segTail{0};
+	uint32_t              cachedHead = 0;  // Reader's copy of headIndex, refreshed only when the buffer looks empty
+
+
+	bool     timed();
+	void     corrupt(const uint32_t& index, const size_t& len);
+	uint64_t errorGap();
+
+	static uint64_t nowNs();
+};
+
+
+/*
+ class LoopbackStream
+ Description:
+ ------------
+  * One end of a LoopbackChannel. Each end may be used from a
+  different thread
+*/
+class LoopbackStream : public BulkStream
+{
+  public: // <<---------------------------------------//public
+	int             available();
+	int             read();
+	int             peek();
+	size_t          readAvailable(uint8_t arr[], const size_t& len);
+	size_t          write(uint8_t val);
+	size_t          write(const uint8_t* buffer, size_t size);
+	int             availableForWrite();
+	loopbackStatsST txStats();
+
+	using Print::write;
+
+
+  private: // <<---------------------------------------//private
+	friend class LoopbackChannel;
+
+	LoopbackPipe* rx = NULL;
+	LoopbackPipe* tx = NULL;
+};
+
+
+/*
+ class LoopbackChannel
+ Description:
+ ------------
+  * In-process full-duplex link between two Streams (a and b) with
+  optional bandwidth, latency and bit-error simulation, to run
+  multi-node topologies and measure parsing/framing throughput
+  without serial hardware or UART speed limits
+*/
+class LoopbackChannel
+{
+  public: // <<---------------------------------------//public
+	LoopbackStream a;
+	LoopbackStream b;
+
+
+	LoopbackChannel();
+	void begin(const loopbackConfigST& config);
+	void begin(const loopbackConfigST& aToB, const loopbackConfigST& bToA);
+
+
+  private: // <<---------------------------------------//private
+	LoopbackPipe pipeAToB;
+	LoopbackPipe pipeBToA;
+};
+
+
+#endif // !defined(ARDUINO)
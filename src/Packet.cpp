@@ -1,735 +1,1288 @@
-#include "Packet.h"
-
-
-PacketCRC crc;
-
-
-/*
- void Packet::begin(const configST& configs)
- Description:
- ------------
-  * Advanced initializer for the Packet Class
- Inputs:
- -------
-  * const configST& configs - Struct that holds config
-  values for all possible initialization parameters
- Return:
- -------
-  * void
-*/
-void Packet::begin(const configST& configs)
-{
-	debugPort    = configs.debugPort;
-	debug        = configs.debug;
-	packed        = configs.packed;
-	callbacks    = configs.callbacks;
-	callbacksLen = configs.callbacksLen;
-	timeout 	 = configs.timeout;
-}
-
-
-/*
- void Packet::begin(const bool& _debug, Stream& _debugPort, const uint32_t& _timeout)
- Description:
- ------------
-  * Simple initializer for the Packet Class
- Inputs:
- -------
-  * const bool& _debug - Whether or not to print error messages
-  * Stream &_debugPort - Serial port to print error messages
-  * const uint32_t& _timeout - Number of ms to wait before
-  declaring packet parsing timeout
- Return:
- -------
-  * void
-*/
-void Packet::begin(const uint8_t& _debug, Stream& _debugPort, const uint32_t& _timeout)
-{
-	debugPort = &_debugPort;
-	debug     = _debug;
-	timeout   = _timeout;
-}
-
-
-/*
- uint8_t Packet::constructPacket(const uint16_t& messageLen, const uint8_t& command, const uint8_t& packetID)
- Description:
- ------------
-  * Calculate, format, and insert the packet protocol metadata into the packet transmit
-  buffer
- Inputs:
- -------
-  * const uint16_t& messageLen - Number of values in txBuff
-  to send as the payload in the next packet
-  * const uint8_t& command - The packet 16-bit command
-  * const uint8_t& packetID - The packet 8-bit identifier
- Return:
- -------
-  * uint16_t - Number of payload bytes included in packet
-*/
-uint16_t Packet::constructPacket(const uint16_t& messageLen, const uint16_t& command, const uint8_t& packetID)
-{
-	uint16_t size = messageLen;
-	if (messageLen > MAX_PACKET_SIZE)
-		size = MAX_PACKET_SIZE;
-
-	if (debug == 2)
-		debugPort->printf("preamble.packed: %d\n", packed);
-	if (packed) {
-		calcOverhead(txBuff, (uint8_t)messageLen);
-		stuffPacket(txBuff, (uint8_t)messageLen);
-	}
-	uint16_t crcVal = crc.calculate(txBuff, size);
-
-	if (debug == 2)
-	{
-		debugPort->printf("preamble.packetID: %d\n", packetID);
-		debugPort->printf("preamble.command: %d\n", command);
-		debugPort->printf("preamble.overheadByte: %d\n", overheadByte);
-		debugPort->printf("preamble.messageLen: %d %d %d\n", messageLen, MAX_PACKET_SIZE, size);
-	}
-
-	preamble[0] = START_BYTE;
-	preamble[1] = packetID;
-	preamble[2] = (command >> 8) & 0xFF; // Extract high byte
-	preamble[3] = command & 0xFF;        // Extract low byte
-	preamble[4] = overheadByte;
-	preamble[5] = (size >> 8) & 0xFF; 	 // Extract high byte
-	preamble[6] = size & 0xFF;        	 // Extract low byte
-
-	if (debug == 2) 
-	{
-		debugPort->printf("preamble.command.high: %d\n", preamble[2]);
-		debugPort->printf("preamble.command.low: %d\n", preamble[3]);
-		debugPort->printf("preamble.messageLen.high: %d\n", preamble[5]);
-		debugPort->printf("preamble.messageLen.low: %d\n", preamble[6]);
-	}
-
-	postamble[0] = (crcVal >> 8) & 0xFF; // Extract high byte
-	postamble[1] = crcVal & 0xFF;        // Extract low byte
-	postamble[POSTAMBLE_SIZE - 1] = STOP_BYTE;
-
-	if (debug == 2) 
-	{
-		debugPort->printf("postamble.crcVal.high: %d\n", postamble[0]);
-		debugPort->printf("postamble.crcVal.low: %d\n", postamble[1]);
-		debugPort->printf("postamble.stop: %d\n", postamble[POSTAMBLE_SIZE - 1]);
-	}
-
-	return messageLen;
-}
-
-
-/*
- uint8_t Packet::parse(const uint8_t& recChar, const bool& valid)
- Description:
- ------------
-  * Parses incoming serial data, analyzes packet contents,
-  and reports errors/successful packet reception. Executes
-  callback functions for parsed packets whos ID has a
-  corresponding callback function set via
-  "void Packet::begin(const configST configs)"
- Inputs:
- -------
-  * const uint8_t& recChar - Next char to parse in the stream
-  * const bool& valid - Set if stream is "available()" and clear if not
- Return:
- -------
-  * uint16_t - Num bytes in RX buffer
-*/
-
-uint16_t Packet::parse(const uint8_t& recChar, const bool& valid)
-{
-	uint32_t current = millis();
-	bool packet_fresh = (packetStart == 0) || ((current - packetStart) < timeout);
-
-	if(!packet_fresh) //packet is stale, start over.
-	{
-		if (debug) {
-			debugPort->println("ERROR: STALE PACKET");
-			debugPort->printf("parse.packetStart: %u\n", packetStart);
-			debugPort->printf("parse.current: %u\n", current);
-			debugPort->printf("parse.timeout: %u\n", timeout);
-			debugPort->printf("parse.(current - packetStart): %u\n", (current - packetStart));
-			debugPort->printf("parse.((current - packetStart) < timeout): %u\n", ((current - packetStart) < timeout));
-		}
-
-		bytesRead   = 0;
-		state       = find_start_byte;
-		status      = STALE_PACKET_ERROR;
-		packetStart = 0;
-
-		return bytesRead;
-	}
-
-	if (valid)
-	{
-		if (debug == 3) 
-		{
-			debugPort->printf("parse.state: %d\n", state);
-			debugPort->printf("parse.recChar: %d\n", recChar);
-		}
-		switch (state)
-		{
-		case find_start_byte: /////////////////////////////////////////
-		{
-			if (debug == 3)
-				debugPort->println("parse.state: find_start_byte");
-			if (recChar == START_BYTE)
-			{
-				state       = find_id_byte;
-				packetStart = millis();	//start the timer
-			}
-
-			break;
-		}
-
-		case find_id_byte: ////////////////////////////////////////////
-		{
-			if (debug == 3)
-				debugPort->println("parse.state: find_id_byte");
-			idByte = recChar;
-			state  = find_command;
-			break;
-		}
-
-		case find_command: ////////////////////////////////////////
-		{
-			// get the high value of the 16 byte length
-			if (debug == 3) 
-			{
-				debugPort->println("parse.state: find_command");
-				debugPort->printf("parse.(recChar >= 0): %d\n", (recChar >= 0));
-				debugPort->printf("parse.(recChar <= UINT16_MAX): %d\n", (recChar <= UINT16_MAX));
-				debugPort->printf("parse.(recChar >= 0) && (recChar <= UINT16_MAX): %d\n", (recChar >= 0) && (recChar <= UINT16_MAX));
-			}
-			if ((recChar >= 0) && (recChar <= UINT16_MAX))
-			{
-				recCharPrevious = recChar;
-				state      = find_command2;
-			}
-			else
-			{
-				bytesRead = 0;
-				state     = find_start_byte;
-				status    = PAYLOAD_ERROR;
-
-				if (debug)
-					debugPort->println("ERROR: PAYLOAD_ERROR - COMMAND INVALID - LOW BYTE");
-
-				reset();
-				return bytesRead;
-			}
-			break;
-		}
-
-		case find_command2: ////////////////////////////////////////
-		{
-			// get the low value of the 16 byte length
-			if (debug == 3) 
-			{
-				debugPort->println("parse.state: find_command2");
-				debugPort->printf("parse.(recChar >= 0): %d\n", (recChar >= 0));
-				debugPort->printf("parse.(recChar <= UINT16_MAX): %d\n", (recChar <= UINT16_MAX));
-				debugPort->printf("parse.(recChar >= 0) && (recChar <= UINT16_MAX): %d\n", (recChar >= 0) && (recChar <= UINT16_MAX));
-			}
-			if ((recChar >= 0) && (recChar <= UINT16_MAX))
-			{
-				command = ((uint16_t)recCharPrevious << 8) | recChar;  // high | low
-				payIndex   = 0;
-				state      = find_overhead_byte;
-
-				if (debug == 3) 
-				{
-					debugPort->printf("parse.command: %d\n", command);
-					debugPort->printf("parse.MAX_PACKET_SIZE: %d\n", MAX_PACKET_SIZE);
-					debugPort->printf("parse.(command >= 0): %d\n", (command > 0));
-					debugPort->printf("parse.(command <= MAX_PACKET_SIZE): %d\n", (command <= MAX_PACKET_SIZE));
-					debugPort->printf("parse.(command >= 0) && (command <= MAX_PACKET_SIZE): %d\n", (command > 0) && (command <= MAX_PACKET_SIZE));
-				}
-				if (!((command >= 0) && (command <= MAX_PACKET_SIZE)))
-				{
-					command = 0;
-					state     = find_start_byte;
-					status    = PAYLOAD_ERROR;
-
-					if (debug)
-						debugPort->println("ERROR: PAYLOAD_ERROR - COMMAND INVALID");
-
-					reset();
-					return bytesRead;
-				}
-			}
-			else
-			{
-				bytesRead = 0;
-				state     = find_start_byte;
-				status    = PAYLOAD_ERROR;
-
-				if (debug)
-					debugPort->println("ERROR: PAYLOAD_ERROR - COMMAND INVALID - HIGH BYTE");
-
-				reset();
-				return bytesRead;
-			}
-			break;
-		}
-
-		case find_overhead_byte: //////////////////////////////////////
-		{
-			if (debug == 3)
-				debugPort->println("parse.state: find_overhead_byte");
-			recOverheadByte = recChar;
-			state           = find_payload_len;
-			break;
-		}
-
-		case find_payload_len: ////////////////////////////////////////
-		{
-			// get the high value of the 16 byte length
-			if (debug == 2) 
-			{
-				debugPort->println("parse.state: find_payload_len");
-				debugPort->printf("parse.(recChar >= 0): %d\n", (recChar >= 0));
-				debugPort->printf("parse.(recChar <= UINT16_MAX): %d\n", (recChar <= UINT16_MAX));
-				debugPort->printf("parse.(recChar >= 0) && (recChar <= UINT16_MAX): %d\n", (recChar >= 0) && (recChar <= UINT16_MAX));
-			}
-			if ((recChar >= 0) && (recChar <= UINT16_MAX))
-			{
-				recCharPrevious = recChar;
-				state      = find_payload_len2;
-			}
-			else
-			{
-				bytesRead = 0;
-				state     = find_start_byte;
-				status    = PAYLOAD_ERROR;
-
-				if (debug)
-					debugPort->println("ERROR: PAYLOAD_ERROR - PAYLOAD LENGTH INVALID - LOW BYTE");
-
-				reset();
-				return bytesRead;
-			}
-			break;
-		}
-
-		case find_payload_len2: ////////////////////////////////////////
-		{
-			// get the low value of the 16 byte length
-			if (debug == 3) 
-			{
-				debugPort->println("parse.state: find_payload_len2");
-				debugPort->printf("parse.(recChar >= 0): %d\n", (recChar >= 0));
-				debugPort->printf("parse.(recChar <= UINT16_MAX): %d\n", (recChar <= UINT16_MAX));
-				debugPort->printf("parse.(recChar >= 0) && (recChar <= UINT16_MAX): %d\n", (recChar >= 0) && (recChar <= UINT16_MAX));
-			}
-			if ((recChar >= 0) && (recChar <= UINT16_MAX))
-			{
-				bytesToRec = ((uint16_t)recCharPrevious << 8) | recChar;  // high | low
-				payIndex   = 0;
-				state      = find_payload;
-
-				if (debug == 3) 
-				{
-					debugPort->printf("parse.bytesToRec: %d\n", bytesToRec);
-					debugPort->printf("parse.MAX_PACKET_SIZE: %d\n", MAX_PACKET_SIZE);
-					debugPort->printf("parse.(bytesToRec > 0): %d\n", (bytesToRec > 0));
-					debugPort->printf("parse.(bytesToRec <= MAX_PACKET_SIZE): %d\n", (bytesToRec <= MAX_PACKET_SIZE));
-					debugPort->printf("parse.(bytesToRec > 0) && (bytesToRec <= MAX_PACKET_SIZE): %d\n", (bytesToRec > 0) && (bytesToRec <= MAX_PACKET_SIZE));
-				}
-				if (!((bytesToRec > 0) && (bytesToRec <= MAX_PACKET_SIZE)))
-				{
-					bytesRead = 0;
-					state     = find_start_byte;
-					status    = PAYLOAD_ERROR;
-
-					if (debug)
-						debugPort->println("ERROR: PAYLOAD_ERROR - PAYLOAD LENGTH INVALID");
-
-					reset();
-					return bytesRead;
-				}
-			}
-			else
-			{
-				bytesRead = 0;
-				state     = find_start_byte;
-				status    = PAYLOAD_ERROR;
-
-				if (debug)
-					debugPort->println("ERROR: PAYLOAD_ERROR - PAYLOAD LENGTH INVALID - HIGH BYTE");
-
-				reset();
-				return bytesRead;
-			}
-			break;
-		}
-
-		case find_payload: ////////////////////////////////////////////
-		{
-			if (debug == 3) 
-			{
-				debugPort->println("parse.state: find_payload");
-				debugPort->printf("parse.payIndex: %d\n", payIndex);
-				debugPort->printf("parse.bytesToRec: %d\n", bytesToRec);
-				debugPort->printf("parse.recChar: %d\n", recChar);
-			}
-			
-			if (payIndex < bytesToRec)
-			{
-				rxBuff[payIndex] = recChar;
-				payIndex++;
-
-				if (payIndex == bytesToRec)
-					state    = find_crc;
-			}
-			break;
-		}
-
-		// case find_crc: ///////////////////////////////////////////
-		// {
-		// 	uint8_t calcCrc = crc.calculate(rxBuff, bytesToRec);
-
-		// 	if (calcCrc == recChar)
-		// 		state = find_end_byte;
-		// 	else
-		// 	{
-		// 		bytesRead = 0;
-		// 		state     = find_start_byte;
-		// 		status    = CRC_ERROR;
-
-		// 		if (debug)
-		// 			debugPort->println("ERROR: CRC_ERROR");
-
-		// 		reset();
-		// 		return bytesRead;
-		// 	}
-
-		// 	break;
-		// }
-
-		case find_crc: ///////////////////////////////////////////
-		{
-			// get the high value of the 16 byte crc
-			if (debug == 3)
-				debugPort->println("parse.state: find_crc");
-			recCharPrevious = recChar;
-			if (debug == 3)
-				debugPort->printf("parse.recChar.high: %d\n", recChar);
-			state = find_crc2;
-
-			break;
-		}
-
-		case find_crc2: ////////////////////////////////////////
-		{
-			// get the low value of the 16 byte crc
-			if (debug == 3)
-				debugPort->println("parse.state: find_crc2");
-			uint16_t calcCrc = crc.calculate(rxBuff, bytesToRec);
-			if (debug == 3) 
-			{
-				debugPort->printf("parse.calcCrc: %d\n", calcCrc);
-				debugPort->printf("parse.recChar.low: %d\n", recChar);
-			}
-			recvCrc = ((uint16_t)recCharPrevious << 8) | recChar;  // high | low
-			if (debug == 3) {
-				debugPort->printf("parse.recvCrc: %d\n", recvCrc);
-				debugPort->printf("parse.calcCrc==recvCrc: %d\n", (calcCrc == recvCrc));
-			}
-
-			if (calcCrc == recvCrc) {
-				state = find_end_byte;
-			}
-			else
-			{
-				bytesRead = 0;
-				state     = find_start_byte;
-				status    = CRC_ERROR;
-
-				if (debug)
-					debugPort->println("ERROR: CRC_ERROR");
-
-				reset();
-				return bytesRead;
-			}
-
-			break;
-		}
-
-		case find_end_byte: ///////////////////////////////////////////
-		{
-			if (debug == 3)
-				debugPort->println("parse.state: find_end_byte");
-			state = find_start_byte;
-
-			if (recChar == STOP_BYTE)
-			{
-				if (packed)
-					unpackPacket(rxBuff);
-
-				bytesRead = bytesToRec;
-				status    = NEW_DATA;
-
-				if (callbacks)
-				{
-					if (idByte < callbacksLen)
-						callbacks[idByte]();
-					else if (debug)
-					{
-						debugPort->print(F("ERROR: No callback available for packet ID "));
-						debugPort->println(idByte);
-					}
-				}
-				packetStart = 0;	// reset the timer
-
-				if (debug == 3)
-				{
-					debugPort->printf("parse.state2/status: %d %d\n", state, status);
-					debugPort->println();
-				}
-				return bytesToRec;
-			}
-
-			bytesRead = 0;
-			status    = STOP_BYTE_ERROR;
-
-			if (debug)
-				debugPort->println("ERROR: STOP_BYTE_ERROR");
-
-			reset();
-			return bytesRead;
-			break;
-		}
-
-		default:
-		{
-			if (debug)
-			{
-				debugPort->print("ERROR: Undefined state ");
-				debugPort->println(state);
-			}
-
-			reset();
-			bytesRead = 0;
-			state     = find_start_byte;
-			break;
-		}
-		}
-	}
-	else
-	{
-		bytesRead = 0;
-		status    = NO_DATA;
-		return bytesRead;
-	}
-
-	if (debug == 3)
-	{
-		debugPort->printf("parse.state2: %d\n", state);
-		debugPort->printf("parse.status: %d\n", status);
-		debugPort->println();
-	}
-
-	bytesRead = 0;
-	status    = CONTINUE;
-	return bytesRead;
-}
- 
-/*
- uint16_t Packet::currentCommand()
- Description:
- ------------
-  * Returns the command of the last parsed packet
- Inputs:
- -------
-  * void
- Return:
- -------
-  * uint16_t - command of the last parsed packet
-*/
-uint16_t Packet::currentCommand()
-{
-	return command;
-}
-
-
-/*
- uint8_t Packet::currentPacketID()
- Description:
- ------------
-  * Returns the ID of the last parsed packet
- Inputs:
- -------
-  * void
- Return:
- -------
-  * uint8_t - ID of the last parsed packet
-*/
-uint8_t Packet::currentPacketID()
-{
-	return idByte;
-}
-
-
-/*
- uint16_t Packet::currentReceived()
- Description:
- ------------
-  * Returns the bytes received of the last parsed packet
- Inputs:
- -------
-  * void
- Return:
- -------
-  * uint8_t - bytes received of the last parsed packet
-*/
-uint16_t Packet::currentReceived()
-{
-	return bytesToRec;
-}
-
-
-/*
- void Packet::calcOverhead(uint8_t arr[], const uint8_t &len)
- Description:
- ------------
-  * Calculates the COBS (Consistent Overhead Stuffing) Overhead
-  byte and stores it in the class's overheadByte variable. This
-  variable holds the byte position (within the payload) of the
-  first payload byte equal to that of START_BYTE
- Inputs:
- -------
-  * uint8_t arr[] - Array of values the overhead is to be calculated
-  over
-  * const uint8_t &len - Number of elements in arr[]
- Return:
- -------
-  * void
-*/
-void Packet::calcOverhead(uint8_t arr[], const uint16_t& len)
-{
-	overheadByte = 0xFF;
-
-	for (uint8_t i = 0; i < len; i++)
-	{
-		if (arr[i] == START_BYTE)
-		{
-			overheadByte = i;
-			break;
-		}
-	}
-}
-
-
-/*
- int16_t Packet::findLast(uint8_t arr[], const uint8_t &len)
- Description:
- ------------
-  * Finds last instance of the value START_BYTE within the given
-  packet array
- Inputs:
- -------
-  * uint8_t arr[] - Packet array
-  * const uint8_t &len - Number of elements in arr[]
- Return:
- -------
-  * int16_t - Index of last instance of the value START_BYTE within the given
-  packet array
-*/
-int16_t Packet::findLast(uint8_t arr[], const uint16_t& len)
-{
-	for (uint8_t i = (len - 1); i != 0xFF; i--)
-		if (arr[i] == START_BYTE)
-			return i;
-
-	return -1;
-}
-
-
-/*
- void Packet::stuffPacket(uint8_t arr[], const uint8_t &len)
- Description:
- ------------
-  * Enforces the COBS (Consistent Overhead Stuffing) ruleset across
-  all bytes in the packet against the value of START_BYTE
- Inputs:
- -------
-  * uint8_t arr[] - Array of values to stuff
-  * const uint8_t &len - Number of elements in arr[]
- Return:
- -------
-  * void
-*/
-void Packet::stuffPacket(uint8_t arr[], const uint16_t& len)
-{
-	int16_t refByte = findLast(arr, len);
-
-	if (refByte != -1)
-	{
-		for (uint8_t i = (len - 1); i != 0xFF; i--)
-		{
-			if (arr[i] == START_BYTE)
-			{
-				arr[i]  = refByte - i;
-				refByte = i;
-			}
-		}
-	}
-}
-
-
-/*
- void Packet::unpackPacket(uint8_t arr[], const uint8_t &len)
- Description:
- ------------
-  * Unpacks all COBS-stuffed bytes within the array
- Inputs:
- -------
-  * uint8_t arr[] - Array of values to unpack
-  * const uint8_t &len - Number of elements in arr[]
- Return:
- -------
-  * void
-*/
-void Packet::unpackPacket(uint8_t arr[])
-{
-	uint8_t testIndex = recOverheadByte;
-	uint8_t delta     = 0;
-
-	if (testIndex <= MAX_PACKET_SIZE)
-	{
-		while (arr[testIndex])
-		{
-			delta          = arr[testIndex];
-			arr[testIndex] = START_BYTE;
-			testIndex += delta;
-		}
-		arr[testIndex] = START_BYTE;
-	}
-}
-
-
-/*
- void Packet::reset()
- Description:
- ------------
-  * Clears out the tx, and rx buffers, plus resets
-  the "bytes read" variable, finite state machine, etc
- Inputs:
- -------
-  * void
- Return:
- -------
-  * void
-*/
-void Packet::reset()
-{
-	memset(txBuff, 0, sizeof(txBuff));
-	memset(rxBuff, 0, sizeof(rxBuff));
-
-	bytesRead   = 0;
-	recvCrc   	= 0;
-	packetStart = 0;
-}
+#include "Packet.h"
+#include "PacketCapture.h"
+#include "PacketCompress.h"
+#include "PacketFEC.h"
+#include "PacketLatency.h"
+#include "PacketTrace.h"
+
+
+PacketCRC crc;
+
+uint32_t linkStatsST::* const statsCounters[STATS_COUNTERS] = { // Wire order of the 32-bit counters in a STATS_COMMAND payload
+	&linkStatsST::framesIn,
+	&linkStatsST::framesOut,
+	&linkStatsST::bytesIn,
+	&linkStatsST::bytesOut,
+	&linkStatsST::crcErrors,
+	&linkStatsST::payloadErrors,
+	&linkStatsST::stopByteErrors,
+	&linkStatsST::staleErrors,
+	&linkStatsST::resyncBytes,
+	&linkStatsST::timeouts
+};
+
+
+/*
+ void Packet::begin(const configST& configs)
+ Description:
+ ------------
+  * Advanced initializer for the Packet Class
+ Inputs:
+ -------
+  * const configST& configs - Struct that holds config
+  values for all possible initialization parameters
+ Return:
+ -------
+  * void
+*/
+void Packet::begin(const configST& configs)
+{
+	debugPort    = configs.debugPort;
+	debug        = configs.debug;
+	packed        = configs.packed;
+	callbacks    = configs.callbacks;
+	callbacksLen = configs.callbacksLen;
+	timeout 	 = configs.timeout;
+	clock        = configs.clock ? configs.clock : clockMillis;
+	stats        = linkStatsST();
+
+	chunkCallback   = configs.chunkCallback;
+	messageCallback = configs.messageCallback;
+	messageBuff     = configs.messageBuff;
+	messageBuffLen  = configs.messageBuffLen;
+	fec             = configs.fec;
+	trace           = configs.trace;
+	capture         = configs.capture;
+	timestamps      = configs.timestamps;
+	latency         = configs.latency;
+	compressor      = configs.compressor;
+}
+
+
+/*
+ void Packet::begin(const bool& _debug, Stream& _debugPort, const uint32_t& _timeout)
+ Description:
+ ------------
+  * Simple initializer for the Packet Class
+ Inputs:
+ -------
+  * const bool& _debug - Whether or not to print error messages
+  * Stream &_debugPort - Serial port to print error messages
+  * const uint32_t& _timeout - Number of ms to wait before
+  declaring packet parsing timeout (always on the millis() clock)
+ Return:
+ -------
+  * void
+*/
+void Packet::begin(const uint8_t& _debug, Stream& _debugPort, const uint32_t& _timeout)
+{
+	debugPort = &_debugPort;
+	debug     = _debug;
+	timeout   = _timeout;
+	clock     = clockMillis;
+	stats     = linkStatsST();
+}
+
+
+/*
+ uint8_t Packet::constructPacket(const uint16_t& messageLen, const uint8_t& command, const uint8_t& packetID)
+ Description:
+ ------------
+  * Calculate, format, and insert the packet protocol metadata into the packet transmit
+  buffer
+ Inputs:
+ -------
+  * const uint16_t& messageLen - Number of values in txBuff
+  to send as the payload in the next packet
+  * const uint8_t& command - The packet 16-bit command
+  * const uint8_t& packetID - The packet 8-bit identifier
+ Return:
+ -------
+  * uint16_t - Number of payload bytes included in packet
+*/
+uint16_t Packet::constructPacket(const uint16_t& messageLen, const uint16_t& command, const uint8_t& packetID)
+{
+	return constructPacket(txBuff, messageLen, command, packetID);
+}
+
+
+/*
+ uint16_t Packet::constructPacket(uint8_t arr[], const uint16_t& messageLen, const uint16_t& command, const uint8_t& packetID)
+ Description:
+ ------------
+  * Same as above, but for a payload held outside of txBuff. Used by
+  the library to send control packets without disturbing txBuff
+ Inputs:
+ -------
+  * uint8_t arr[] - Payload to send (stuffed in place if enabled and not
+  compressed - see txPayload)
+  * const uint16_t& messageLen - Number of values in arr[]
+  to send as the payload in the next packet
+  * const uint16_t& command - The packet 16-bit command
+  * const uint8_t& packetID - The packet 8-bit identifier
+ Return:
+ -------
+  * uint16_t - Number of payload bytes included in packet
+*/
+uint16_t Packet::constructPacket(uint8_t arr[], const uint16_t& messageLen, const uint16_t& command, const uint8_t& packetID)
+{
+	uint16_t maxSize = maxPayload();
+	uint16_t flags   = 0;
+
+	uint16_t size = messageLen;
+	if (messageLen > maxSize)
+		size = maxSize;
+
+	uint8_t* payload = arr;  // Compressed payloads are finished and sent from the compressor's buffer, leaving arr[] as it is
+	uint16_t len     = size; // Payload bytes including the timestamp
+	if (compressor && !(command & CONTROL_FLAG))
+	{
+		uint16_t room = fec ? fec->maxDataLen(COMPRESS_MAX_SIZE) : COMPRESS_MAX_SIZE; // Keep room for the timestamp and parity
+
+		if (timestamps)
+			room -= TIMESTAMP_SIZE;
+
+		uint16_t compressedLen = compressor->compress(arr, size, room);
+
+		if (compressedLen)
+		{
+			payload = compressor->compressed();
+			len     = compressedLen;
+			flags   = COMPRESSED_FLAG;
+		}
+	}
+
+	if (timestamps && !(command & CONTROL_FLAG)) // Control buffers have no room to spare
+	{
+		uint32_t stamp = clock();
+
+		payload[len++] = (stamp >> 24) & 0xFF; // Extract highest byte
+		payload[len++] = (stamp >> 16) & 0xFF;
+		payload[len++] = (stamp >> 8) & 0xFF;
+		payload[len++] = stamp & 0xFF;         // Extract lowest byte
+		flags         |= TIMESTAMP_FLAG;
+	}
+
+	if (packed) {
+		calcOverhead(payload, (uint8_t)len);
+		stuffPacket(payload, (uint8_t)len);
+	}
+	uint16_t crcVal = crc.calculate(payload, len);
+
+	bytesToSend = len;
+	if (fec)
+		bytesToSend = fec->encode(payload, len);
+	txPayload = payload;
+
+	if (trace)
+	{
+		uint32_t current = clock();
+
+		trace->record(TRACE_TX_COMMAND, 0, command | flags, current);
+		trace->record(TRACE_TX_PACKET, packetID, bytesToSend, current);
+	}
+
+	preamble[0] = START_BYTE;
+	preamble[1] = packetID;
+	preamble[2] = ((command | flags) >> 8) & 0xFF; // Extract high byte
+	preamble[3] = (command | flags) & 0xFF;        // Extract low byte
+	preamble[4] = overheadByte;
+	preamble[5] = (bytesToSend >> 8) & 0xFF; // Extract high byte
+	preamble[6] = bytesToSend & 0xFF;        // Extract low byte
+
+	postamble[0] = (crcVal >> 8) & 0xFF; // Extract high byte
+	postamble[1] = crcVal & 0xFF;        // Extract low byte
+	postamble[POSTAMBLE_SIZE - 1] = STOP_BYTE;
+
+	return size;
+}
+
+
+/*
+ uint16_t Packet::parse(const uint8_t& recChar, const bool& valid)
+ Description:
+ ------------
+  * Parses incoming serial data, analyzes packet contents,
+  and reports errors/successful packet reception. Executes
+  callback functions for parsed packets whos ID has a
+  corresponding callback function set via
+  "void Packet::begin(const configST configs)"
+ Inputs:
+ -------
+  * const uint8_t& recChar - Next char to parse in the stream
+  * const bool& valid - Set if stream is "available()" and clear if not
+ Return:
+ -------
+  * uint16_t - Num bytes in RX buffer
+*/
+uint16_t Packet::parse(const uint8_t& recChar, const bool& valid)
+{
+	uint32_t current = clock();
+
+	if (valid)
+		stats.bytesIn++;
+
+	parseByte(recChar, valid, current);
+
+	if ((status != CONTINUE) && (status != NO_DATA))
+	{
+		if (trace)
+			trace->record(TRACE_RX_STATUS, status, bytesRead, current);
+
+		if (capture)
+			capture->frame(status, idByte, command, bytesRead, current);
+	}
+
+	return bytesRead;
+}
+
+
+/*
+ uint16_t Packet::parseByte(const uint8_t& recChar, const bool& valid, const uint32_t& current)
+ Description:
+ ------------
+  * Runs one char through the parser. The clock is read by the caller,
+  once per byte or once per block of bytes
+ Inputs:
+ -------
+  * const uint8_t& recChar - Next char to parse in the stream
+  * const bool& valid - Set if stream is "available()" and clear if not
+  * const uint32_t& current - Current tick of the clock
+ Return:
+ -------
+  * uint16_t - Num bytes in RX buffer
+*/
+uint16_t Packet::parseByte(const uint8_t& recChar, const bool& valid, const uint32_t& current)
+{
+	bool packet_fresh = (state == find_start_byte) || ((current - packetStart) < timeout); // Only a packet in progress can go stale
+
+	if(!packet_fresh) //packet is stale, start over.
+	{
+		if (debug) {
+			debugPort->println("ERROR: STALE PACKET");
+			debugPort->printf("parse.packetStart: %u\n", packetStart);
+			debugPort->printf("parse.current: %u\n", current);
+			debugPort->printf("parse.timeout: %u\n", timeout);
+			debugPort->printf("parse.(current - packetStart): %u\n", (current - packetStart));
+			debugPort->printf("parse.((current - packetStart) < timeout): %u\n", ((current - packetStart) < timeout));
+		}
+
+		bytesRead = 0;
+		state     = find_start_byte;
+		status    = STALE_PACKET_ERROR;
+		stats.staleErrors++;
+
+		return bytesRead;
+	}
+
+	if (valid)
+	{
+		if (trace)
+			trace->record(TRACE_RX_BYTE, state, recChar, current);
+
+		switch (state)
+		{
+		case find_start_byte: /////////////////////////////////////////
+		{
+			if (recChar == START_BYTE)
+			{
+				state       = find_id_byte;
+				packetStart = current;	//start the timer
+			}
+			else
+				stats.resyncBytes++;
+
+			break;
+		}
+
+		case find_id_byte: ////////////////////////////////////////////
+		{
+			idByte = recChar;
+			state  = find_command;
+			break;
+		}
+
+		case find_command: ////////////////////////////////////////
+		{
+			// get the high value of the 16 byte length
+			if ((recChar >= 0) && (recChar <= UINT16_MAX))
+			{
+				recCharPrevious = recChar;
+				state      = find_command2;
+			}
+			else
+			{
+				bytesRead = 0;
+				state     = find_start_byte;
+				status    = PAYLOAD_ERROR;
+				stats.payloadErrors++;
+
+				if (debug)
+					debugPort->println("ERROR: PAYLOAD_ERROR - COMMAND INVALID - LOW BYTE");
+
+				resetParser();
+				return bytesRead;
+			}
+			break;
+		}
+
+		case find_command2: ////////////////////////////////////////
+		{
+			// get the low value of the 16 byte length
+			if ((recChar >= 0) && (recChar <= UINT16_MAX))
+			{
+				command = ((uint16_t)recCharPrevious << 8) | recChar;  // high | low
+				payIndex   = 0;
+				state      = find_overhead_byte;
+
+				if (!(((command & ~COMMAND_FLAGS) >= 0) && ((command & ~COMMAND_FLAGS) <= MAX_PACKET_SIZE)))
+				{
+					command = 0;
+					state     = find_start_byte;
+					status    = PAYLOAD_ERROR;
+					stats.payloadErrors++;
+
+					if (debug)
+						debugPort->println("ERROR: PAYLOAD_ERROR - COMMAND INVALID");
+
+					resetParser();
+					return bytesRead;
+				}
+			}
+			else
+			{
+				bytesRead = 0;
+				state     = find_start_byte;
+				status    = PAYLOAD_ERROR;
+				stats.payloadErrors++;
+
+				if (debug)
+					debugPort->println("ERROR: PAYLOAD_ERROR - COMMAND INVALID - HIGH BYTE");
+
+				resetParser();
+				return bytesRead;
+			}
+			break;
+		}
+
+		case find_overhead_byte: //////////////////////////////////////
+		{
+			recOverheadByte = recChar;
+			state           = find_payload_len;
+			break;
+		}
+
+		case find_payload_len: ////////////////////////////////////////
+		{
+			// get the high value of the 16 byte length
+			if ((recChar >= 0) && (recChar <= UINT16_MAX))
+			{
+				recCharPrevious = recChar;
+				state      = find_payload_len2;
+			}
+			else
+			{
+				bytesRead = 0;
+				state     = find_start_byte;
+				status    = PAYLOAD_ERROR;
+				stats.payloadErrors++;
+
+				if (debug)
+					debugPort->println("ERROR: PAYLOAD_ERROR - PAYLOAD LENGTH INVALID - LOW BYTE");
+
+				resetParser();
+				return bytesRead;
+			}
+			break;
+		}
+
+		case find_payload_len2: ////////////////////////////////////////
+		{
+			// get the low value of the 16 byte length
+			if ((recChar >= 0) && (recChar <= UINT16_MAX))
+			{
+				bytesToRec = ((uint16_t)recCharPrevious << 8) | recChar;  // high | low
+				payIndex   = 0;
+				state      = find_payload;
+
+				if (!((bytesToRec > 0) && (bytesToRec <= MAX_PACKET_SIZE)))
+				{
+					bytesRead = 0;
+					state     = find_start_byte;
+					status    = PAYLOAD_ERROR;
+					stats.payloadErrors++;
+
+					if (debug)
+						debugPort->println("ERROR: PAYLOAD_ERROR - PAYLOAD LENGTH INVALID");
+
+					resetParser();
+					return bytesRead;
+				}
+			}
+			else
+			{
+				bytesRead = 0;
+				state     = find_start_byte;
+				status    = PAYLOAD_ERROR;
+				stats.payloadErrors++;
+
+				if (debug)
+					debugPort->println("ERROR: PAYLOAD_ERROR - PAYLOAD LENGTH INVALID - HIGH BYTE");
+
+				resetParser();
+				return bytesRead;
+			}
+			break;
+		}
+
+		case find_payload: ////////////////////////////////////////////
+		{
+			if (payIndex < bytesToRec)
+			{
+				rxBuff[payIndex] = recChar;
+				payIndex++;
+
+				if (payIndex == bytesToRec)
+					state    = find_crc;
+			}
+			break;
+		}
+
+		// case find_crc: ///////////////////////////////////////////
+		// {
+		// 	uint8_t calcCrc = crc.calculate(rxBuff, bytesToRec);
+
+		// 	if (calcCrc == recChar)
+		// 		state = find_end_byte;
+		// 	else
+		// 	{
+		// 		bytesRead = 0;
+		// 		state     = find_start_byte;
+		// 		status    = CRC_ERROR;
+
+		// 		if (debug)
+		// 			debugPort->println("ERROR: CRC_ERROR");
+
+		// 		reset();
+		// 		return bytesRead;
+		// 	}
+
+		// 	break;
+		// }
+
+		case find_crc: ///////////////////////////////////////////
+		{
+			// get the high value of the 16 byte crc
+			recCharPrevious = recChar;
+			state = find_crc2;
+
+			break;
+		}
+
+		case find_crc2: ////////////////////////////////////////
+		{
+			// get the low value of the 16 byte crc
+			if (fec) // Correct errors ahead of the CRC check
+				bytesToRec = fec->decode(rxBuff, bytesToRec);
+
+			uint16_t calcCrc = crc.calculate(rxBuff, bytesToRec);
+			recvCrc = ((uint16_t)recCharPrevious << 8) | recChar;  // high | low
+
+			if (calcCrc == recvCrc) {
+				state = find_end_byte;
+			}
+			else
+			{
+				bytesRead = 0;
+				state     = find_start_byte;
+				status    = CRC_ERROR;
+				stats.crcErrors++;
+
+				if (debug)
+					debugPort->println("ERROR: CRC_ERROR");
+
+				resetParser();
+				return bytesRead;
+			}
+
+			break;
+		}
+
+		case find_end_byte: ///////////////////////////////////////////
+		{
+			state = find_start_byte;
+
+			if (recChar == STOP_BYTE)
+			{
+				stats.framesIn++;
+
+				if (packed)
+					unpackPacket(rxBuff);
+
+				if ((command & TIMESTAMP_FLAG) && (bytesToRec >= TIMESTAMP_SIZE))
+				{
+					bytesToRec -= TIMESTAMP_SIZE;
+					rxTimestamp = ((uint32_t)rxBuff[bytesToRec] << 24) | ((uint32_t)rxBuff[bytesToRec + 1] << 16) | ((uint32_t)rxBuff[bytesToRec + 2] << 8) | rxBuff[bytesToRec + 3];
+
+					if (latency && !(command & CONTROL_FLAG))
+						latency->recordOneWay(command & ~COMMAND_FLAGS, rxTimestamp, current);
+				}
+
+				if (command & COMPRESSED_FLAG)
+				{
+					uint16_t decompressedLen = compressor ? compressor->decompress(rxBuff, bytesToRec, MAX_PACKET_SIZE) : 0;
+
+					if (!decompressedLen)
+					{
+						bytesRead = 0;
+						status    = PAYLOAD_ERROR;
+						stats.payloadErrors++;
+
+						if (debug)
+							debugPort->println("ERROR: PAYLOAD_ERROR - DECOMPRESSION FAILED");
+
+						resetParser();
+						return bytesRead;
+					}
+
+					bytesToRec = decompressedLen;
+				}
+
+				status = processFragment();
+
+				if (status == CONTINUE)
+				{
+					bytesRead = 0;
+
+					return bytesRead;
+				}
+
+				bytesRead = bytesToRec;
+
+				if (latency && !(command & CONTROL_FLAG))
+					latency->recordDispatch(command & ~COMMAND_FLAGS, clock() - packetStart);
+
+				if (callbacks && (status == NEW_DATA) && !(command & CONTROL_FLAG))
+				{
+					if (idByte < callbacksLen)
+						callbacks[idByte]();
+					else if (debug)
+					{
+						debugPort->print(F("ERROR: No callback available for packet ID "));
+						debugPort->println(idByte);
+					}
+				}
+				return bytesToRec;
+			}
+
+			bytesRead = 0;
+			status    = STOP_BYTE_ERROR;
+			stats.stopByteErrors++;
+
+			if (debug)
+				debugPort->println("ERROR: STOP_BYTE_ERROR");
+
+			resetParser();
+			return bytesRead;
+			break;
+		}
+
+		default:
+		{
+			if (debug)
+			{
+				debugPort->print("ERROR: Undefined state ");
+				debugPort->println(state);
+			}
+
+			resetParser();
+			bytesRead = 0;
+			state     = find_start_byte;
+			break;
+		}
+		}
+	}
+	else
+	{
+		bytesRead = 0;
+		status    = NO_DATA;
+		return bytesRead;
+	}
+
+	bytesRead = 0;
+	status    = CONTINUE;
+	return bytesRead;
+}
+
+
+/*
+ uint16_t Packet::parse(const uint8_t arr[], const uint16_t& len, uint16_t& consumed)
+ Description:
+ ------------
+  * Parses a block of received bytes, stopping as soon as a packet
+  is complete or an error is found. Payload bytes are copied into
+  rxBuff in bulk instead of being run through the state machine one
+  at a time
+ Inputs:
+ -------
+  * const uint8_t arr[] - Received bytes
+  * const uint16_t& len - Number of bytes in arr[]
+  * uint16_t& consumed - Set to the number of bytes of arr[] parsed
+ Return:
+ -------
+  * uint16_t - Num bytes in RX buffer
+*/
+uint16_t Packet::parse(const uint8_t arr[], const uint16_t& len, uint16_t& consumed)
+{
+	uint32_t current = clock(); // One clock read covers the whole block
+
+	consumed  = 0;
+	bytesRead = 0;
+	status    = CONTINUE;
+
+	while (consumed < len)
+	{
+		if ((state == find_payload) && ((bytesToRec - payIndex) > 1))
+		{
+			uint16_t run = bytesToRec - payIndex - 1; // The last payload byte goes through parse() to move on to the CRC
+
+			if (run > (len - consumed))
+				run = len - consumed;
+
+			memcpy(rxBuff + payIndex, arr + consumed, run);
+			payIndex += run;
+			consumed += run;
+
+			if (trace)
+				trace->record(TRACE_RX_PAYLOAD, state, run, current);
+
+			continue;
+		}
+
+		parseByte(arr[consumed++], true, current);
+
+		if (status != CONTINUE)
+		{
+			if (trace)
+				trace->record(TRACE_RX_STATUS, status, bytesRead, current);
+
+			if (capture)
+				capture->frame(status, idByte, command, bytesRead, current);
+
+			break;
+		}
+	}
+
+	stats.bytesIn += consumed;
+
+	return bytesRead;
+}
+
+
+/*
+ uint16_t Packet::pendingBytes()
+ Description:
+ ------------
+  * Returns how many more bytes the packet being parsed needs at
+  least. Exact once the payload length has been received
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - Min number of bytes left in the current packet (0 if
+  no packet has been started)
+*/
+uint16_t Packet::pendingBytes()
+{
+	if (state == find_start_byte)
+		return 0;
+
+	if (state < find_payload) // Still in the preamble, the enum counts the preamble bytes received
+		return PREAMBLE_SIZE - state + POSTAMBLE_SIZE;
+
+	if (state == find_payload)
+		return bytesToRec - payIndex + POSTAMBLE_SIZE;
+
+	return find_end_byte - state + 1;
+}
+
+
+/*
+ uint32_t Packet::now()
+ Description:
+ ------------
+  * Reads the clock stale packets are timed with, so code running
+  alongside the parser can keep time in the same ticks
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint32_t - Current tick of configST.clock
+*/
+uint32_t Packet::now()
+{
+	return clock();
+}
+
+
+/*
+ uint16_t Packet::currentCommand()
+ Description:
+ ------------
+  * Returns the command of the last parsed packet
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - command of the last parsed packet
+*/
+uint16_t Packet::currentCommand()
+{
+	return command & ~COMMAND_FLAGS;
+}
+
+
+/*
+ uint16_t Packet::currentFlags()
+ Description:
+ ------------
+  * Returns the library-reserved command bits (COMMAND_FLAGS) of the
+  last parsed packet
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - reserved command bits of the last parsed packet
+*/
+uint16_t Packet::currentFlags()
+{
+	return command & COMMAND_FLAGS;
+}
+
+
+/*
+ uint8_t Packet::currentPacketID()
+ Description:
+ ------------
+  * Returns the ID of the last parsed packet
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint8_t - ID of the last parsed packet
+*/
+uint8_t Packet::currentPacketID()
+{
+	return idByte;
+}
+
+
+/*
+ uint16_t Packet::currentReceived()
+ Description:
+ ------------
+  * Returns the bytes received of the last parsed packet
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint8_t - bytes received of the last parsed packet
+*/
+uint16_t Packet::currentReceived()
+{
+	return bytesToRec;
+}
+
+
+/*
+ uint32_t Packet::currentMessageLen()
+ Description:
+ ------------
+  * Returns the length of the last completed fragmented message
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint32_t - length of the last completed fragmented message
+*/
+uint32_t Packet::currentMessageLen()
+{
+	return messageLen;
+}
+
+
+/*
+ uint32_t Packet::currentTimestamp()
+ Description:
+ ------------
+  * Returns the sender's timestamp of the last parsed packet sent
+  with TIMESTAMP_FLAG
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint32_t - Sender's "clock" tick when the packet was constructed
+*/
+uint32_t Packet::currentTimestamp()
+{
+	return rxTimestamp;
+}
+
+
+/*
+ uint16_t Packet::maxPayload()
+ Description:
+ ------------
+  * Returns how many message bytes fit in one packet after FEC parity
+  and the timestamp (if enabled) take their share
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - Max message bytes per packet
+*/
+uint16_t Packet::maxPayload()
+{
+	uint16_t maxSize = MAX_PACKET_SIZE;
+
+	if (fec)
+		maxSize = fec->maxDataLen(MAX_PACKET_SIZE);
+
+	if (timestamps)
+		maxSize -= TIMESTAMP_SIZE;
+
+	return maxSize;
+}
+
+
+/*
+ uint16_t Packet::txChunk(const uint8_t data[], const uint16_t& len, const uint32_t& offset, const bool& last, const uint8_t& messageID)
+ Description:
+ ------------
+  * Stuffs a fragment header followed by up to MAX_FRAGMENT_SIZE
+  bytes of "data" (less with FEC or timestamps) into the transmit
+  buffer (txBuff). The resulting
+  payload must be sent with FRAGMENT_FLAG set in its command
+ Inputs:
+ -------
+  * const uint8_t data[] - Message bytes carried by this fragment
+  * const uint16_t& len - Number of bytes in data[]
+  * const uint32_t& offset - Position of data[0] within the message
+  * const bool& last - Whether or not this fragment ends the message
+  * const uint8_t& messageID - Identifier shared by all fragments of
+  the message
+ Return:
+ -------
+  * uint16_t - Number of payload bytes stuffed into txBuff
+*/
+uint16_t Packet::txChunk(const uint8_t data[], const uint16_t& len, const uint32_t& offset, const bool& last, const uint8_t& messageID)
+{
+	uint16_t size = len;
+	if (len > (maxPayload() - FRAGMENT_HEADER_SIZE))
+		size = maxPayload() - FRAGMENT_HEADER_SIZE;
+
+	txBuff[0] = messageID;
+	txBuff[1] = last ? FRAGMENT_LAST : 0;
+	txBuff[2] = (offset >> 24) & 0xFF; // Extract highest byte
+	txBuff[3] = (offset >> 16) & 0xFF;
+	txBuff[4] = (offset >> 8) & 0xFF;
+	txBuff[5] = offset & 0xFF;         // Extract lowest byte
+
+	memcpy(txBuff + FRAGMENT_HEADER_SIZE, data, size);
+
+	return size + FRAGMENT_HEADER_SIZE;
+}
+
+
+/*
+ int8_t Packet::processFragment()
+ Description:
+ ------------
+  * Handles the fragment held in the receive buffer (rxBuff). If a
+  chunk callback is set, the fragment is handed to it without
+  copying. Otherwise, if a message buffer is set, the fragment is
+  copied to its offset within that buffer - fragments may arrive
+  in any order and repeats are only counted once. The message
+  callback is executed once every byte of the message is in
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * int8_t - NEW_DATA if the packet is not a fragment to be handled
+  here, CONTINUE if the fragment was consumed or NEW_MESSAGE if the
+  fragment completed the message
+*/
+int8_t Packet::processFragment()
+{
+	if (!(command & FRAGMENT_FLAG) || (!chunkCallback && !messageBuff) || (bytesToRec < FRAGMENT_HEADER_SIZE))
+		return NEW_DATA;
+
+	uint8_t  id     = rxBuff[0];
+	uint8_t  flags  = rxBuff[1];
+	uint32_t offset = ((uint32_t)rxBuff[2] << 24) | ((uint32_t)rxBuff[3] << 16) | ((uint32_t)rxBuff[4] << 8) | rxBuff[5];
+	uint16_t len    = bytesToRec - FRAGMENT_HEADER_SIZE;
+
+	if (chunkCallback)
+	{
+		chunkCallback(rxBuff + FRAGMENT_HEADER_SIZE, len, offset);
+
+		if (!(flags & FRAGMENT_LAST))
+			return CONTINUE;
+
+		messageLen = offset + len;
+	}
+	else
+	{
+		if (!messageActive || (id != messageID)) // Fragment of a new message, drop what is left of the previous one
+		{
+			messageActive = true;
+			messageID     = id;
+			messageLast   = false;
+			messageLen    = 0;
+			ranges        = 0;
+		}
+
+		if ((offset > messageBuffLen) || (len > (messageBuffLen - offset))) // offset is off the wire, offset + len may wrap
+		{
+			if (debug)
+				debugPort->println("ERROR: MESSAGE BUFFER OVERFLOW");
+
+			return CONTINUE;
+		}
+
+		if (len && !addRange(offset, offset + len))
+		{
+			if (debug)
+				debugPort->println("ERROR: TOO MANY MESSAGE GAPS");
+
+			return CONTINUE;
+		}
+
+		memcpy(messageBuff + offset, rxBuff + FRAGMENT_HEADER_SIZE, len);
+
+		if (flags & FRAGMENT_LAST)
+		{
+			messageLast = true;
+			messageLen  = offset + len;
+		}
+
+		if (!messageLast || (messageLen && ((ranges != 1) || rangeStart[0] || (rangeEnd[0] != messageLen)))) // Duplicates add no range, so holes stay holes
+			return CONTINUE;
+
+		messageActive = false;
+	}
+
+	if (messageCallback)
+		messageCallback(messageLen);
+
+	return NEW_MESSAGE;
+}
+
+
+/*
+ bool Packet::addRange(const uint32_t& start, const uint32_t& end)
+ Description:
+ ------------
+  * Records that bytes start to end (exclusive) of the message being
+  reassembled have arrived, merging the run into the sorted list of
+  runs received so far. Bytes received twice are only counted once
+ Inputs:
+ -------
+  * const uint32_t& start - Offset of the first byte
+  * const uint32_t& end - Offset after the last byte
+ Return:
+ -------
+  * bool - Whether or not the run was recorded (false if it would
+  open more than MESSAGE_MAX_RANGES runs)
+*/
+bool Packet::addRange(const uint32_t& start, const uint32_t& end)
+{
+	uint8_t first = 0;
+
+	while ((first < ranges) && (rangeEnd[first] < start)) // First run touching or after the new one
+		first++;
+
+	uint8_t last = first;
+
+	while ((last < ranges) && (rangeStart[last] <= end)) // Runs touching the new one are first to last - 1
+		last++;
+
+	if (first == last) // Touches none, insert it
+	{
+		if (ranges >= MESSAGE_MAX_RANGES)
+			return false;
+
+		for (uint8_t i = ranges; i > first; i--)
+		{
+			rangeStart[i] = rangeStart[i - 1];
+			rangeEnd[i]   = rangeEnd[i - 1];
+		}
+
+		rangeStart[first] = start;
+		rangeEnd[first]   = end;
+		ranges++;
+
+		return true;
+	}
+
+	if (rangeStart[first] > start)
+		rangeStart[first] = start;
+
+	rangeEnd[first] = (rangeEnd[last - 1] > end) ? rangeEnd[last - 1] : end;
+
+	uint8_t merged = last - first - 1;
+
+	for (uint8_t i = first + 1; (i + merged) < ranges; i++)
+	{
+		rangeStart[i] = rangeStart[i + merged];
+		rangeEnd[i]   = rangeEnd[i + merged];
+	}
+
+	ranges -= merged;
+
+	return true;
+}
+
+
+/*
+ void Packet::calcOverhead(uint8_t arr[], const uint8_t &len)
+ Description:
+ ------------
+  * Calculates the COBS (Consistent Overhead Stuffing) Overhead
+  byte and stores it in the class's overheadByte variable. This
+  variable holds the byte position (within the payload) of the
+  first payload byte equal to that of START_BYTE
+ Inputs:
+ -------
+  * uint8_t arr[] - Array of values the overhead is to be calculated
+  over
+  * const uint8_t &len - Number of elements in arr[]
+ Return:
+ -------
+  * void
+*/
+void Packet::calcOverhead(uint8_t arr[], const uint16_t& len)
+{
+	overheadByte = 0xFF;
+
+	for (uint8_t i = 0; i < len; i++)
+	{
+		if (arr[i] == START_BYTE)
+		{
+			overheadByte = i;
+			break;
+		}
+	}
+}
+
+
+/*
+ int16_t Packet::findLast(uint8_t arr[], const uint8_t &len)
+ Description:
+ ------------
+  * Finds last instance of the value START_BYTE within the given
+  packet array
+ Inputs:
+ -------
+  * uint8_t arr[] - Packet array
+  * const uint8_t &len - Number of elements in arr[]
+ Return:
+ -------
+  * int16_t - Index of last instance of the value START_BYTE within the given
+  packet array
+*/
+int16_t Packet::findLast(uint8_t arr[], const uint16_t& len)
+{
+	for (uint8_t i = (len - 1); i != 0xFF; i--)
+		if (arr[i] == START_BYTE)
+			return i;
+
+	return -1;
+}
+
+
+/*
+ void Packet::stuffPacket(uint8_t arr[], const uint8_t &len)
+ Description:
+ ------------
+  * Enforces the COBS (Consistent Overhead Stuffing) ruleset across
+  all bytes in the packet against the value of START_BYTE
+ Inputs:
+ -------
+  * uint8_t arr[] - Array of values to stuff
+  * const uint8_t &len - Number of elements in arr[]
+ Return:
+ -------
+  * void
+*/
+void Packet::stuffPacket(uint8_t arr[], const uint16_t& len)
+{
+	int16_t refByte = findLast(arr, len);
+
+	if (refByte != -1)
+	{
+		for (uint8_t i = (len - 1); i != 0xFF; i--)
+		{
+			if (arr[i] == START_BYTE)
+			{
+				arr[i]  = refByte - i;
+				refByte = i;
+			}
+		}
+	}
+}
+
+
+/*
+ void Packet::unpackPacket(uint8_t arr[], const uint8_t &len)
+ Description:
+ ------------
+  * Unpacks all COBS-stuffed bytes within the array
+ Inputs:
+ -------
+  * uint8_t arr[] - Array of values to unpack
+  * const uint8_t &len - Number of elements in arr[]
+ Return:
+ -------
+  * void
+*/
+void Packet::unpackPacket(uint8_t arr[])
+{
+	uint16_t testIndex = recOverheadByte;
+	uint8_t  delta     = 0;
+
+	if (testIndex < bytesToRec) // 0xFF = no START_BYTE was stuffed, never walk past the payload received
+	{
+		while (arr[testIndex] && ((testIndex + arr[testIndex]) < bytesToRec))
+		{
+			delta          = arr[testIndex];
+			arr[testIndex] = START_BYTE;
+			testIndex += delta;
+		}
+		arr[testIndex] = START_BYTE;
+	}
+}
+
+
+/*
+ void Packet::reset()
+ Description:
+ ------------
+  * Clears out the tx, and rx buffers, plus resets
+  the "bytes read" variable, finite state machine, etc
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void Packet::reset()
+{
+	memset(txBuff, 0, sizeof(txBuff));
+	resetParser();
+}
+
+
+/*
+ void Packet::resetParser()
+ Description:
+ ------------
+  * Clears out the rx buffer and restarts the parser, leaving txBuff
+  alone so a packet can be received while one is being sent
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void Packet::resetParser()
+{
+	memset(rxBuff, 0, sizeof(rxBuff));
+
+	bytesRead   = 0;
+	recvCrc   	= 0;
+	packetStart = 0;
+}
+
+
+/*
+ uint8_t Packet::writeStats(uint8_t arr[], const linkStatsST& linkStats)
+ Description:
+ ------------
+  * Encodes link statistics as a STATS_COMMAND payload: STATS_VERSION,
+  the 32-bit counters in declaration order and rxQueueMax, all big
+  endian so both ends can differ in word size and byte order
+ Inputs:
+ -------
+  * uint8_t arr[] - Buffer of at least STATS_SIZE bytes
+  * const linkStatsST& linkStats - Counters to encode
+ Return:
+ -------
+  * uint8_t - Number of bytes written to arr[] (STATS_SIZE)
+*/
+uint8_t Packet::writeStats(uint8_t arr[], const linkStatsST& linkStats)
+{
+	uint8_t index = 0;
+
+	arr[index++] = STATS_VERSION;
+
+	for (uint8_t i = 0; i < STATS_COUNTERS; i++)
+	{
+		uint32_t counter = linkStats.*statsCounters[i];
+
+		arr[index++] = (counter >> 24) & 0xFF;
+		arr[index++] = (counter >> 16) & 0xFF;
+		arr[index++] = (counter >> 8) & 0xFF;
+		arr[index++] = counter & 0xFF;
+	}
+
+	arr[index++] = (linkStats.rxQueueMax >> 8) & 0xFF;
+	arr[index++] = linkStats.rxQueueMax & 0xFF;
+
+	return index;
+}
+
+
+/*
+ bool Packet::readStats(const uint8_t arr[], const uint16_t& len, linkStatsST& linkStats)
+ Description:
+ ------------
+  * Decodes a STATS_COMMAND payload written by writeStats()
+ Inputs:
+ -------
+  * const uint8_t arr[] - Received payload
+  * const uint16_t& len - Number of bytes in arr[]
+  * linkStatsST& linkStats - Set to the decoded counters
+ Return:
+ -------
+  * bool - Whether or not arr[] held statistics this version understands
+*/
+bool Packet::readStats(const uint8_t arr[], const uint16_t& len, linkStatsST& linkStats)
+{
+	uint8_t index = 1;
+
+	if ((len < STATS_SIZE) || (arr[0] != STATS_VERSION))
+		return false;
+
+	for (uint8_t i = 0; i < STATS_COUNTERS; i++)
+	{
+		linkStats.*statsCounters[i] = ((uint32_t)arr[index] << 24) | ((uint32_t)arr[index + 1] << 16) | ((uint32_t)arr[index + 2] << 8) | arr[index + 3];
+		index += 4;
+	}
+
+	linkStats.rxQueueMax = ((uint16_t)arr[index] << 8) | arr[index + 1];
+
+	return true;
+}
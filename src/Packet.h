@@ -1,205 +1,384 @@
-/*
-01111110 00000000 00000000 00000000 11111111 00000000 00000000 00000000 00000000 ... 00000000 00000000 10000001
-|      | |      | |               | |      | |               | |      | |      | | | |               | |______|__Stop byte
-|      | |      | |               | |      | |               | |      | |      | | | |_______________|___________8-bit CRC
-|      | |      | |               | |      | |               | |      | |      | |_|_____________________________Rest of payload
-|      | |      | |               | |      | |               | |      | |______|_________________________________2nd payload byte
-|      | |      | |               | |      | |               | |______|__________________________________________1st payload byte
-|      | |      | |               | |      | |_______________|___________________________________________________# of payload bytes
-|      | |      | |               | |______|_____________________________________________________________________COBS Overhead byte
-|      | |      | |_______________|______________________________________________________________________________Command
-|      | |______|________________________________________________________________________________________________Packet ID (0 by default)
-|______|_________________________________________________________________________________________________________Start byte (constant)
-*/
-
-#pragma once
-#include "Arduino.h"
-#include "PacketCRC.h"
-
-
-typedef void (*functionPtr)();
-
-
-const int8_t CONTINUE           = 3;
-const int8_t NEW_DATA           = 2;
-const int8_t NO_DATA            = 1;
-const int8_t CRC_ERROR          = 0;
-const int8_t PAYLOAD_ERROR      = -1;
-const int8_t STOP_BYTE_ERROR    = -2;
-const int8_t STALE_PACKET_ERROR = -3;
-
-const uint8_t START_BYTE = 0x7E;
-const uint8_t STOP_BYTE  = 0x81;
-
-const uint8_t PREAMBLE_SIZE   = 7;
-const uint8_t POSTAMBLE_SIZE  = 3;
-const uint16_t PACKET_SIZE = 0x400;
-const uint16_t MAX_PACKET_SIZE = (uint16_t)PACKET_SIZE - (uint16_t)PREAMBLE_SIZE - (uint16_t)POSTAMBLE_SIZE; // Maximum allowed payload bytes per packet
-
-const uint8_t DEFAULT_TIMEOUT = 50;
-
-
-struct configST
-{
-	Stream*            debugPort    = &Serial;
-	uint8_t            debug        = 1; // 0 = none, 1 = limited, 2 = verbose
-	bool               packed       = false;
-	const functionPtr* callbacks    = NULL;
-	uint8_t            callbacksLen = 0;
-	uint32_t           timeout      = __UINT32_MAX__;
-};
-
-
-class Packet
-{
-  public: // <<---------------------------------------//public
-	uint8_t txBuff[MAX_PACKET_SIZE];
-	uint8_t rxBuff[MAX_PACKET_SIZE];
-	// uint8_t preamble[PREAMBLE_SIZE]   = {START_BYTE, 0, 0, 0, 0};
-	// uint8_t postamble[POSTAMBLE_SIZE] = {0, 0, STOP_BYTE};
-	uint8_t preamble[PREAMBLE_SIZE];
-	uint8_t postamble[POSTAMBLE_SIZE];
-
-	uint16_t bytesRead = 0;
-	int8_t  status    = 0;
-
-
-	void    begin(const configST& configs);
-	void    begin(const uint8_t& _debug = 1, Stream& _debugPort = Serial, const uint32_t& _timeout = DEFAULT_TIMEOUT);
-	uint16_t constructPacket(const uint16_t& messageLen, const uint16_t& command = 0, const uint8_t& packetID = 0);
-	uint16_t parse(const uint8_t& recChar, const bool& valid = true);
-	uint16_t currentCommand();
-	uint8_t currentPacketID();
-	uint16_t currentReceived();
-	void    reset();
-
-
-	/*
-	 uint16_t Packet::txObj(const T &val, const uint16_t &index=0, const uint16_t &len=sizeof(T))
-	 Description:
-	 ------------
-	  * Stuffs "len" number of bytes of an arbitrary object (byte, int,
-	  float, double, struct, etc...) into the transmit buffer (txBuff)
-	  starting at the index as specified by the argument "index"
-
-	 Inputs:
-	 -------
-	  * const T &val - Pointer to the object to be copied to the
-	  transmit buffer (txBuff)
-	  * const uint16_t &index - Starting index of the object within the
-	  transmit buffer (txBuff)
-	  * const uint16_t &len - Number of bytes of the object "val" to transmit
-
-	 Return:
-	 -------
-	  * uint16_t maxIndex - uint16_t maxIndex - Index of the transmit buffer (txBuff) that directly follows the bytes processed
-	  by the calling of this member function
-	*/
-	template <typename T>
-	uint16_t txObj(const T& val, const uint16_t& index = 0, const uint16_t& len = sizeof(T))
-	{
-		uint8_t* ptr = (uint8_t*)&val;
-		uint16_t maxIndex;
-
-		if ((len + index) > MAX_PACKET_SIZE)
-			maxIndex = MAX_PACKET_SIZE;
-		else
-			maxIndex = len + index;
-
-		// not sure why the for loop instead of memcpy?!
-		for (uint16_t i = index; i < maxIndex; i++)
-		{
-			txBuff[i] = *ptr;
-			ptr++;
-		}
-      	// memcpy(txBuff + index, &val, maxIndex);
-
-		return maxIndex;
-	}
-
-
-	/*
-	 uint16_t Packet::rxObj(const T &val, const uint16_t &index=0, const uint16_t &len=sizeof(T))
-	 Description:
-	 ------------
-	  * Reads "len" number of bytes from the receive buffer (rxBuff)
-	  starting at the index as specified by the argument "index"
-	  into an arbitrary object (byte, int, float, double, struct, etc...)
-
-	 Inputs:
-	 -------
-	  * const T &val - Pointer to the object to be copied into from the
-	  receive buffer (rxBuff)
-	  * const uint16_t &index - Starting index of the object within the
-	  receive buffer (rxBuff)
-	  * const uint16_t &len - Number of bytes in the object "val" received
-
-	 Return:
-	 -------
-	  * uint16_t maxIndex - Index of the receive buffer (rxBuff) that directly follows the bytes processed
-	  by the calling of this member function
-	*/
-	template <typename T>
-	uint16_t rxObj(const T& val, const uint16_t& index = 0, const uint16_t& len = sizeof(T))
-	{
-		uint8_t* ptr = (uint8_t*)&val;
-		uint16_t maxIndex;
-
-		if ((len + index) > MAX_PACKET_SIZE)
-			maxIndex = MAX_PACKET_SIZE;
-		else
-			maxIndex = len + index;
-
-		for (uint16_t i = index; i < maxIndex; i++)
-		{
-			*ptr = rxBuff[i];
-			ptr++;
-		}
-		// memcpy(&val, rxBuff + index, maxIndex);
-
-		return maxIndex;
-	}
-
-
-  private: // <<---------------------------------------//private
-	enum fsm
-	{
-		find_start_byte,
-		find_id_byte,
-		find_command,
-		find_command2,
-		find_overhead_byte,
-		find_payload_len,
-		find_payload_len2,
-		find_payload,
-		find_crc,
-		find_crc2,
-		find_end_byte
-	};
-	fsm state = find_start_byte;
-
-	const functionPtr* callbacks    = NULL;
-	uint8_t            callbacksLen = 0;
-
-	Stream* debugPort;
-	uint8_t debug = 0;
-	bool packed = false;
-
-	uint16_t bytesToRec      = 0;
-	uint16_t command         = 0;
-	uint16_t recvCrc         = 0;
-	uint16_t payIndex        = 0;
-	uint8_t idByte           = 0;
-	uint8_t overheadByte     = 0;
-	uint8_t recOverheadByte  = 0;
-	uint8_t recCharPrevious  = 0;
-
-	uint32_t packetStart     = 0;
-	uint32_t timeout;
-
-
-	void    calcOverhead(uint8_t arr[], const uint16_t& len);
-	int16_t findLast(uint8_t arr[], const uint16_t& len);
-	void    stuffPacket(uint8_t arr[], const uint16_t& len);
-	void    unpackPacket(uint8_t arr[]);
-};
+/*
+01111110 00000000 00000000 00000000 11111111 00000000 00000000 00000000 00000000 ... 00000000 00000000 10000001
+|      | |      | |               | |      | |               | |      | |      | | | |               | |______|__Stop byte
+|      | |      | |               | |      | |               | |      | |      | | | |_______________|___________8-bit CRC
+|      | |      | |               | |      | |               | |      | |      | |_|_____________________________Rest of payload
+|      | |      | |               | |      | |               | |      | |______|_________________________________2nd payload byte
+|      | |      | |               | |      | |               | |______|__________________________________________1st payload byte
+|      | |      | |               | |      | |_______________|___________________________________________________# of payload bytes
+|      | |      | |               | |______|_____________________________________________________________________COBS Overhead byte
+|      | |      | |_______________|______________________________________________________________________________Command
+|      | |______|________________________________________________________________________________________________Packet ID (0 by default)
+|______|_________________________________________________________________________________________________________Start byte (constant)
+*/
+
+#pragma once
+#include "Arduino.h"
+#include "PacketClock.h"
+#include "PacketCRC.h"
+
+
+// Optional features, set in configST. Sketches using one include its header, Packet only calls
+// their virtual members, so one that is never constructed is never linked
+class PacketCapture;
+class PacketCompressor;
+class PacketFEC;
+class PacketLatency;
+class PacketTrace;
+
+
+typedef void (*functionPtr)();
+typedef void (*chunkFunctionPtr)(const uint8_t chunk[], const uint16_t& len, const uint32_t& offset);
+typedef void (*messageFunctionPtr)(const uint32_t& messageLen);
+
+
+const int8_t NEW_MESSAGE        = 4;
+const int8_t CONTINUE           = 3;
+const int8_t NEW_DATA           = 2;
+const int8_t NO_DATA            = 1;
+const int8_t CRC_ERROR          = 0;
+const int8_t PAYLOAD_ERROR      = -1;
+const int8_t STOP_BYTE_ERROR    = -2;
+const int8_t STALE_PACKET_ERROR = -3;
+
+const uint8_t START_BYTE = 0x7E;
+const uint8_t STOP_BYTE  = 0x81;
+
+const uint8_t PREAMBLE_SIZE   = 7;
+const uint8_t POSTAMBLE_SIZE  = 3;
+#ifndef SERIALTRANSFER_PACKET_SIZE
+#define SERIALTRANSFER_PACKET_SIZE 0x400 // Override (e.g. 0x100) to shrink the tx/rx buffers on small MCUs
+#endif
+const uint16_t PACKET_SIZE = SERIALTRANSFER_PACKET_SIZE;
+const uint16_t MAX_PACKET_SIZE = (uint16_t)PACKET_SIZE - (uint16_t)PREAMBLE_SIZE - (uint16_t)POSTAMBLE_SIZE; // Maximum allowed payload bytes per packet
+
+const uint8_t DEFAULT_TIMEOUT = 50;
+
+const uint16_t FRAGMENT_FLAG = 0x8000; // Command bit set on packets whose payload starts with a fragment header
+const uint16_t RELIABLE_FLAG = 0x4000; // Command bit set on packets whose payload starts with a ReliableTransfer header
+const uint16_t CONTROL_FLAG  = 0x2000; // Command bit set on link control packets, which are consumed by the library
+const uint16_t TIMESTAMP_FLAG = 0x1000; // Command bit set on packets whose payload ends with the sender's 32-bit timestamp
+const uint16_t COMPRESSED_FLAG = 0x0800; // Command bit set on packets whose payload (timestamp excluded) is PacketCompressor compressed
+const uint16_t COMMAND_FLAGS = FRAGMENT_FLAG | RELIABLE_FLAG | CONTROL_FLAG | TIMESTAMP_FLAG | COMPRESSED_FLAG; // Command bits reserved by the library
+
+const uint16_t CREDIT_COMMAND = CONTROL_FLAG | 0x01; // Flow control credit: 32-bit bytes consumed, 16-bit window
+const uint16_t STATS_COMMAND  = CONTROL_FLAG | 0x02; // Link statistics, see Packet::writeStats()
+const uint16_t PING_COMMAND   = CONTROL_FLAG | 0x03; // Echo request: 32-bit send tick
+const uint16_t PONG_COMMAND   = CONTROL_FLAG | 0x04; // Echo reply: ping's send tick, 32-bit receive and reply ticks
+
+const uint16_t DEFAULT_FLOW_TIMEOUT = 100; // Ticks of configST.clock (ms with the default clockMillis)
+
+const uint8_t MAX_CONTROL_SIZE = 64; // Max payload bytes of a library control packet
+const uint8_t FEC_MAX_PARITY   = 32; // Max parity bytes per PacketFEC block (corrects up to FEC_MAX_PARITY / 2 bytes per block)
+
+const uint8_t STATS_VERSION  = 1;  // First byte of a STATS_COMMAND payload, bumped when the layout changes
+const uint8_t STATS_COUNTERS = 10; // 32-bit counters in linkStatsST
+const uint8_t STATS_SIZE     = 1 + (4 * STATS_COUNTERS) + 2; // Bytes of a STATS_COMMAND payload
+
+const uint8_t TIMESTAMP_SIZE = 4; // Bytes of the timestamp trailing the payload of TIMESTAMP_FLAG packets
+
+const uint8_t  FRAGMENT_LAST        = 0x01; // Fragment header flag set on the final fragment of a message
+const uint8_t  FRAGMENT_HEADER_SIZE = 6;    // Message ID, flags and 32-bit message offset
+const uint16_t MAX_FRAGMENT_SIZE    = MAX_PACKET_SIZE - FRAGMENT_HEADER_SIZE; // Maximum message bytes per fragment
+
+#ifndef MESSAGE_MAX_RANGES
+#define MESSAGE_MAX_RANGES 8 // Separate runs of bytes a message being reassembled may have (gaps + 1), fragments that would open more are dropped
+#endif
+
+
+struct linkStatsST
+{
+	uint32_t framesIn       = 0; // Packets parsed, control packets and fragments included
+	uint32_t framesOut      = 0; // Packets written
+	uint32_t bytesIn        = 0; // Bytes run through the parser
+	uint32_t bytesOut       = 0; // Frame bytes written
+	uint32_t crcErrors      = 0;
+	uint32_t payloadErrors  = 0; // Malformed headers/lengths
+	uint32_t stopByteErrors = 0;
+	uint32_t staleErrors    = 0; // Packets dropped for taking longer than the timeout
+	uint32_t resyncBytes    = 0; // Bytes skipped or discarded while looking for the next start byte
+	uint32_t timeouts       = 0; // Waits the transport gave up on (flow credit, SPI ready)
+	uint16_t rxQueueMax     = 0; // Most bytes found waiting in the transport's receive buffer
+};
+
+
+struct configST
+{
+	Stream*            debugPort    = &Serial;
+	uint8_t            debug        = 1; // 0 = none, 1+ = error messages (use "trace" to follow packets)
+	bool               packed       = false;
+	const functionPtr* callbacks    = NULL;
+	uint8_t            callbacksLen = 0;
+	uint32_t           timeout      = __UINT32_MAX__; // Ticks of "clock" before a partially received packet goes stale
+	clockFunctionPtr   clock        = clockMillis;    // Time source of "timeout" - clockMicros for us, VirtualClock::now for simulation
+	chunkFunctionPtr   chunkCallback   = NULL; // Streams fragment payloads straight out of rxBuff
+	messageFunctionPtr messageCallback = NULL; // Called once the last fragment of a message is streamed/reassembled
+	uint8_t*           messageBuff     = NULL; // Caller-provided buffer fragments are reassembled into
+	uint32_t           messageBuffLen  = 0;
+	uint16_t           flowWindow      = 0; // Bytes this end can absorb between calls to available(), 0 = no flow control
+	uint32_t           flowTimeout     = DEFAULT_FLOW_TIMEOUT; // Ticks of "clock" to wait for credit before assuming it was lost
+	uint32_t           pingInterval    = 0; // Ticks of "clock" between automatic pings (SerialTransfer), 0 = only ping() sends them
+	PacketFEC*         fec             = NULL; // Reed-Solomon codec applied to payloads, both ends must match
+	PacketTrace*       trace           = NULL; // Records every byte parsed and packet sent/received, NULL = off
+	bool               timestamps      = false; // Stamp every packet sent with the "clock" tick (TIMESTAMP_FLAG)
+	PacketLatency*     latency         = NULL; // Latency histograms of packets received, NULL = off
+	PacketCapture*     capture         = NULL; // Binary log of the raw bytes read/written and each frame parsed, NULL = off
+	PacketCompressor*  compressor      = NULL; // Compresses payloads that shrink (COMPRESSED_FLAG), both ends must set one, NULL = off
+};
+
+
+class Packet
+{
+  public: // <<---------------------------------------//public
+	uint8_t txBuff[MAX_PACKET_SIZE];
+	uint8_t rxBuff[MAX_PACKET_SIZE];
+	// uint8_t preamble[PREAMBLE_SIZE]   = {START_BYTE, 0, 0, 0, 0};
+	// uint8_t postamble[POSTAMBLE_SIZE] = {0, 0, STOP_BYTE};
+	uint8_t preamble[PREAMBLE_SIZE];
+	uint8_t postamble[POSTAMBLE_SIZE];
+
+	uint16_t bytesRead   = 0;
+	uint16_t bytesToSend = 0;      // Payload bytes on the wire (after FEC) of the last constructed packet
+	uint8_t* txPayload   = txBuff; // Where those bytes are: the array it was built from, or the compressor's buffer
+	int8_t  status    = 0;
+	linkStatsST stats; // Counters since begin(), the transport adds what it sends
+
+
+	void    begin(const configST& configs);
+	void    begin(const uint8_t& _debug = 1, Stream& _debugPort = Serial, const uint32_t& _timeout = DEFAULT_TIMEOUT);
+	uint16_t constructPacket(const uint16_t& messageLen, const uint16_t& command = 0, const uint8_t& packetID = 0);
+	uint16_t constructPacket(uint8_t arr[], const uint16_t& messageLen, const uint16_t& command = 0, const uint8_t& packetID = 0);
+	uint16_t parse(const uint8_t& recChar, const bool& valid = true);
+	uint16_t parse(const uint8_t arr[], const uint16_t& len, uint16_t& consumed);
+	uint16_t pendingBytes();
+	uint32_t now();
+	uint16_t currentCommand();
+	uint16_t currentFlags();
+	uint8_t currentPacketID();
+	uint16_t currentReceived();
+	uint32_t currentMessageLen();
+	uint32_t currentTimestamp();
+	uint16_t maxPayload();
+	uint16_t txChunk(const uint8_t data[], const uint16_t& len, const uint32_t& offset, const bool& last = false, const uint8_t& messageID = 0);
+	void    reset();
+	void    resetParser();
+
+	static uint8_t writeStats(uint8_t arr[], const linkStatsST& linkStats);
+	static bool    readStats(const uint8_t arr[], const uint16_t& len, linkStatsST& linkStats);
+
+
+	/*
+	 uint16_t Packet::txObj(const T &val, const uint16_t &index=0, const uint16_t &len=sizeof(T))
+	 Description:
+	 ------------
+	  * Stuffs "len" number of bytes of an arbitrary object (byte, int,
+	  float, double, struct, etc...) into the transmit buffer (txBuff)
+	  starting at the index as specified by the argument "index"
+
+	 Inputs:
+	 -------
+	  * const T &val - Pointer to the object to be copied to the
+	  transmit buffer (txBuff)
+	  * const uint16_t &index - Starting index of the object within the
+	  transmit buffer (txBuff)
+	  * const uint16_t &len - Number of bytes of the object "val" to transmit
+
+	 Return:
+	 -------
+	  * uint16_t maxIndex - uint16_t maxIndex - Index of the transmit buffer (txBuff) that directly follows the bytes processed
+	  by the calling of this member function
+	*/
+	template <typename T>
+	uint16_t txObj(const T& val, const uint16_t& index = 0, const uint16_t& len = sizeof(T))
+	{
+		uint8_t* ptr = (uint8_t*)&val;
+		uint16_t maxIndex;
+
+		if ((len + index) > MAX_PACKET_SIZE)
+			maxIndex = MAX_PACKET_SIZE;
+		else
+			maxIndex = len + index;
+
+		// not sure why the for loop instead of memcpy?!
+		for (uint16_t i = index; i < maxIndex; i++)
+		{
+			txBuff[i] = *ptr;
+			ptr++;
+		}
+      	// memcpy(txBuff + index, &val, maxIndex);
+
+		return maxIndex;
+	}
+
+
+	/*
+	 uint16_t Packet::rxObj(const T &val, const uint16_t &index=0, const uint16_t &len=sizeof(T))
+	 Description:
+	 ------------
+	  * Reads "len" number of bytes from the receive buffer (rxBuff)
+	  starting at the index as specified by the argument "index"
+	  into an arbitrary object (byte, int, float, double, struct, etc...)
+
+	 Inputs:
+	 -------
+	  * const T &val - Pointer to the object to be copied into from the
+	  receive buffer (rxBuff)
+	  * const uint16_t &index - Starting index of the object within the
+	  receive buffer (rxBuff)
+	  * const uint16_t &len - Number of bytes in the object "val" received
+
+	 Return:
+	 -------
+	  * uint16_t maxIndex - Index of the receive buffer (rxBuff) that directly follows the bytes processed
+	  by the calling of this member function
+	*/
+	template <typename T>
+	uint16_t rxObj(const T& val, const uint16_t& index = 0, const uint16_t& len = sizeof(T))
+	{
+		uint8_t* ptr = (uint8_t*)&val;
+		uint16_t maxIndex;
+
+		if ((len + index) > MAX_PACKET_SIZE)
+			maxIndex = MAX_PACKET_SIZE;
+		else
+			maxIndex = len + index;
+
+		for (uint16_t i = index; i < maxIndex; i++)
+		{
+			*ptr = rxBuff[i];
+			ptr++;
+		}
+		// memcpy(&val, rxBuff + index, maxIndex);
+
+		return maxIndex;
+	}
+
+
+	/*
+	 uint16_t Packet::txSchema<Schema>(const T &val, const uint16_t &index=0)
+	 Description:
+	 ------------
+	  * Encodes the fields of "val" listed in "Schema" (a PacketSchema)
+	  into the transmit buffer (txBuff) starting at the index as
+	  specified by the argument "index" - little endian, no padding, the
+	  same bytes on every target
+
+	 Inputs:
+	 -------
+	  * const T &val - Object to be encoded into the transmit buffer (txBuff)
+	  * const uint16_t &index - Starting index of the object within the
+	  transmit buffer (txBuff)
+
+	 Return:
+	 -------
+	  * uint16_t maxIndex - Index of the transmit buffer (txBuff) that directly follows the bytes processed
+	  by the calling of this member function ("index" if Schema::SIZE bytes do not fit)
+	*/
+	template <typename Schema, typename T>
+	uint16_t txSchema(const T& val, const uint16_t& index = 0)
+	{
+		if ((index + Schema::SIZE) > MAX_PACKET_SIZE)
+			return index;
+
+		Schema::encode(val, txBuff + index);
+
+		return index + Schema::SIZE;
+	}
+
+
+	/*
+	 uint16_t Packet::rxSchema<Schema>(T &val, const uint16_t &index=0)
+	 Description:
+	 ------------
+	  * Decodes the fields of "val" listed in "Schema" (a PacketSchema)
+	  from the receive buffer (rxBuff) starting at the index as specified
+	  by the argument "index"
+
+	 Inputs:
+	 -------
+	  * T &val - Object to be decoded into from the receive buffer (rxBuff)
+	  * const uint16_t &index - Starting index of the object within the
+	  receive buffer (rxBuff)
+
+	 Return:
+	 -------
+	  * uint16_t maxIndex - Index of the receive buffer (rxBuff) that directly follows the bytes processed
+	  by the calling of this member function ("index" if Schema::SIZE bytes do not fit)
+	*/
+	template <typename Schema, typename T>
+	uint16_t rxSchema(T& val, const uint16_t& index = 0)
+	{
+		if ((index + Schema::SIZE) > MAX_PACKET_SIZE)
+			return index;
+
+		Schema::decode(rxBuff + index, val);
+
+		return index + Schema::SIZE;
+	}
+
+
+  private: // <<---------------------------------------//private
+	enum fsm
+	{
+		find_start_byte,
+		find_id_byte,
+		find_command,
+		find_command2,
+		find_overhead_byte,
+		find_payload_len,
+		find_payload_len2,
+		find_payload,
+		find_crc,
+		find_crc2,
+		find_end_byte
+	};
+	fsm state = find_start_byte;
+
+	const functionPtr* callbacks    = NULL;
+	uint8_t            callbacksLen = 0;
+	chunkFunctionPtr   chunkCallback   = NULL;
+	messageFunctionPtr messageCallback = NULL;
+	uint8_t*           messageBuff     = NULL;
+	uint32_t           messageBuffLen  = 0;
+
+	Stream* debugPort;
+	uint8_t debug = 0;
+	bool packed = false;
+	PacketFEC* fec = NULL;
+	PacketTrace* trace = NULL;
+	PacketCapture* capture = NULL;
+	PacketLatency* latency = NULL;
+	PacketCompressor* compressor = NULL;
+	bool timestamps = false;
+	uint32_t rxTimestamp = 0;
+
+	uint16_t bytesToRec      = 0;
+	uint16_t command         = 0;
+	uint16_t recvCrc         = 0;
+	uint16_t payIndex        = 0;
+	uint8_t idByte           = 0;
+	uint8_t overheadByte     = 0;
+	uint8_t recOverheadByte  = 0;
+	uint8_t recCharPrevious  = 0;
+
+	uint32_t         packetStart = 0; // Tick the current packet's start byte arrived
+	uint32_t         timeout;
+	clockFunctionPtr clock       = clockMillis;
+
+	bool     messageActive = false;
+	uint8_t  messageID     = 0;
+	bool     messageLast   = false; // The FRAGMENT_LAST fragment arrived, messageLen is known
+	uint32_t messageLen    = 0;
+	uint32_t rangeStart[MESSAGE_MAX_RANGES]; // Sorted, disjoint runs of message bytes received
+	uint32_t rangeEnd[MESSAGE_MAX_RANGES];
+	uint8_t  ranges        = 0;
+
+
+	uint16_t parseByte(const uint8_t& recChar, const bool& valid, const uint32_t& current);
+	void    calcOverhead(uint8_t arr[], const uint16_t& len);
+	int16_t findLast(uint8_t arr[], const uint16_t& len);
+	void    stuffPacket(uint8_t arr[], const uint16_t& len);
+	void    unpackPacket(uint8_t arr[]);
+	int8_t  processFragment();
+	bool    addRange(const uint32_t& start, const uint32_t& end);
+};
@@ -0,0 +1,252 @@
+#include "PacketCapture.h"
+
+
+/*
+ void PacketCapture::begin(Stream& _out, const uint32_t& ticksPerSecond)
+ Description:
+ ------------
+  * Starts a capture: writes the header to "_out", records follow it
+ Inputs:
+ -------
+  * Stream& _out - Where to write the capture
+  * const uint32_t& ticksPerSecond - Rate of the clock the records are
+  timed with (configST.clock: 1000 for clockMillis, 1000000 for
+  clockMicros), so a replay can run at the original speed
+ Return:
+ -------
+  * void
+*/
+void PacketCapture::begin(Stream& _out, const uint32_t& ticksPerSecond)
+{
+	uint8_t header[CAPTURE_HEADER_SIZE] = {'S', 'T', 'C', 'P', CAPTURE_VERSION};
+
+	out  = &_out;
+	last = 0;
+
+	header[5] = ticksPerSecond & 0xFF;
+	header[6] = (ticksPerSecond >> 8) & 0xFF;
+	header[7] = (ticksPerSecond >> 16) & 0xFF;
+	header[8] = (ticksPerSecond >> 24) & 0xFF;
+
+	bytesWritten = out->write(header, sizeof(header));
+}
+
+
+/*
+ void PacketCapture::rx(const uint8_t arr[], const uint16_t& len, const uint32_t& time)
+ Description:
+ ------------
+  * Records bytes read from the port
+ Inputs:
+ -------
+  * const uint8_t arr[] - Bytes read
+  * const uint16_t& len - Number of bytes in arr[]
+  * const uint32_t& time - Tick they were read
+ Return:
+ -------
+  * void
+*/
+void PacketCapture::rx(const uint8_t arr[], const uint16_t& len, const uint32_t& time)
+{
+	if (len)
+		record(CAPTURE_RX, arr, len, time);
+}
+
+
+/*
+ void PacketCapture::tx(const uint8_t preamble[], const uint8_t& preambleLen, const uint8_t payload[], const uint16_t& payloadLen, const uint8_t postamble[], const uint8_t& postambleLen, const uint32_t& time)
+ Description:
+ ------------
+  * Records a frame written to the port as one record
+ Inputs:
+ -------
+  * const uint8_t preamble[] - Frame preamble
+  * const uint8_t& preambleLen - Number of bytes in preamble[]
+  * const uint8_t payload[] - Payload as written
+  * const uint16_t& payloadLen - Number of bytes in payload[]
+  * const uint8_t postamble[] - Frame postamble
+  * const uint8_t& postambleLen - Number of bytes in postamble[]
+  * const uint32_t& time - Tick the frame was written
+ Return:
+ -------
+  * void
+*/
+void PacketCapture::tx(const uint8_t preamble[], const uint8_t& preambleLen, const uint8_t payload[], const uint16_t& payloadLen, const uint8_t postamble[], const uint8_t& postambleLen, const uint32_t& time)
+{
+	if (!out)
+		return;
+
+	writeHeader(CAPTURE_TX, preambleLen + payloadLen + postambleLen, time);
+
+	bytesWritten += out->write(preamble, preambleLen);
+	bytesWritten += out->write(payload, payloadLen);
+	bytesWritten += out->write(postamble, postambleLen);
+}
+
+
+/*
+ void PacketCapture::frame(const int8_t& status, const uint8_t& packetID, const uint16_t& command, const uint16_t& len, const uint32_t& time)
+ Description:
+ ------------
+  * Records the parser's outcome for a frame
+ Inputs:
+ -------
+  * const int8_t& status - NEW_DATA, CRC_ERROR, ...
+  * const uint8_t& packetID - Packet ID received
+  * const uint16_t& command - Command received, flags included
+  * const uint16_t& len - Payload bytes read
+  * const uint32_t& time - Tick of the outcome
+ Return:
+ -------
+  * void
+*/
+void PacketCapture::frame(const int8_t& status, const uint8_t& packetID, const uint16_t& command, const uint16_t& len, const uint32_t& time)
+{
+	uint8_t data[CAPTURE_FRAME_SIZE];
+
+	data[0] = status;
+	data[1] = packetID;
+	data[2] = command & 0xFF;
+	data[3] = (command >> 8) & 0xFF;
+	data[4] = len & 0xFF;
+	data[5] = (len >> 8) & 0xFF;
+
+	record(CAPTURE_FRAME, data, sizeof(data), time);
+}
+
+
+/*
+ void PacketCapture::discard(const uint8_t arr[], const uint16_t& len, const uint32_t& time)
+ Description:
+ ------------
+  * Records bytes read from the port and dropped without being parsed
+ Inputs:
+ -------
+  * const uint8_t arr[] - Bytes dropped
+  * const uint16_t& len - Number of bytes in arr[]
+  * const uint32_t& time - Tick they were read
+ Return:
+ -------
+  * void
+*/
+void PacketCapture::discard(const uint8_t arr[], const uint16_t& len, const uint32_t& time)
+{
+	if (len)
+		record(CAPTURE_DISCARD, arr, len, time);
+}
+
+
+/*
+ void PacketCapture::config(const uint32_t& timeout, const bool& packed, const uint8_t& parityLen, const bool& compressed, const uint32_t& time)
+ Description:
+ ------------
+  * Records the receive settings a replay needs to parse the same way
+ Inputs:
+ -------
+  * const uint32_t& timeout - Ticks before a partial packet goes stale
+  * const bool& packed - Whether or not payloads are COBS stuffed
+  * const uint8_t& parityLen - FEC parity bytes, 0 = no FEC
+  * const bool& compressed - Whether or not a PacketCompressor is set
+  * const uint32_t& time - Tick the settings took effect
+ Return:
+ -------
+  * void
+*/
+void PacketCapture::config(const uint32_t& timeout, const bool& packed, const uint8_t& parityLen, const bool& compressed, const uint32_t& time)
+{
+	uint8_t data[CAPTURE_CONFIG_SIZE];
+
+	data[0] = timeout & 0xFF;
+	data[1] = (timeout >> 8) & 0xFF;
+	data[2] = (timeout >> 16) & 0xFF;
+	data[3] = (timeout >> 24) & 0xFF;
+	data[4] = packed;
+	data[5] = parityLen;
+	data[6] = compressed;
+
+	record(CAPTURE_CONFIG, data, sizeof(data), time);
+}
+
+
+/*
+ void PacketCapture::record(const uint8_t& type, const uint8_t arr[], const uint16_t& len, const uint32_t& time)
+ Description:
+ ------------
+  * Writes one record - also for the application's own (CAPTURE_USER
+  and up) records, i.e. to mark when a fault was noticed
+ Inputs:
+ -------
+  * const uint8_t& type - CAPTURE_* record type
+  * const uint8_t arr[] - Record data
+  * const uint16_t& len - Number of bytes in arr[]
+  * const uint32_t& time - Tick of the record
+ Return:
+ -------
+  * void
+*/
+void PacketCapture::record(const uint8_t& type, const uint8_t arr[], const uint16_t& len, const uint32_t& time)
+{
+	if (!out)
+		return;
+
+	writeHeader(type, len, time);
+	bytesWritten += out->write(arr, len);
+}
+
+
+/*
+ void PacketCapture::writeHeader(const uint8_t& type, const uint16_t& len, const uint32_t& time)
+ Description:
+ ------------
+  * Writes a record's type, tick delta and data length
+ Inputs:
+ -------
+  * const uint8_t& type - CAPTURE_* record type
+  * const uint16_t& len - Bytes of data following
+  * const uint32_t& time - Tick of the record
+ Return:
+ -------
+  * void
+*/
+void PacketCapture::writeHeader(const uint8_t& type, const uint16_t& len, const uint32_t& time)
+{
+	uint8_t header[11]; // Type, up to 5 + 5 bytes of varints
+	uint8_t size = 1;
+
+	header[0] = type;
+	size     += writeVarint(header + size, time - last);
+	size     += writeVarint(header + size, len);
+	last      = time;
+
+	bytesWritten += out->write(header, size);
+}
+
+
+/*
+ uint8_t PacketCapture::writeVarint(uint8_t arr[], uint32_t val)
+ Description:
+ ------------
+  * Encodes an unsigned LEB128 value: 7 bits per byte, low bits first,
+  top bit set on every byte but the last
+ Inputs:
+ -------
+  * uint8_t arr[] - Buffer to encode into (at least 5 bytes)
+  * uint32_t val - Value to encode
+ Return:
+ -------
+  * uint8_t - Number of bytes written to arr[]
+*/
+uint8_t PacketCapture::writeVarint(uint8_t arr[], uint32_t val)
+{
+	uint8_t len = 0;
+
+	while (val > 0x7F)
+	{
+		arr[len++] = (val & 0x7F) | 0x80;
+		val      >>= 7;
+	}
+
+	arr[len++] = val;
+
+	return len;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "Arduino.h"
+
+
+const uint8_t CAPTURE_RX      = 1; // Raw bytes read from the port, in the chunks they were parsed in
+const uint8_t CAPTURE_TX      = 2; // Raw bytes of a frame written to the port
+const uint8_t CAPTURE_FRAME   = 3; // Parser outcome: status, packet ID, 16-bit command (flags included), 16-bit bytes read
+const uint8_t CAPTURE_DISCARD = 4; // Bytes read and dropped unparsed while resyncing after an error
+const uint8_t CAPTURE_CONFIG  = 5; // Receive settings: 32-bit timeout, packed, FEC parity length, compressed
+const uint8_t CAPTURE_USER    = 0x80; // First record type free for the application
+
+const uint8_t CAPTURE_VERSION     = 1;
+const uint8_t CAPTURE_HEADER_SIZE = 9;  // "STCP", CAPTURE_VERSION, 32-bit ticks per second
+const uint8_t CAPTURE_FRAME_SIZE  = 6;  // Bytes of a CAPTURE_FRAME record's data
+const uint8_t CAPTURE_CONFIG_SIZE = 7;  // Bytes of a CAPTURE_CONFIG record's data
+
+
+/*
+ class PacketCapture
+ Description:
+ ------------
+  * Writes a timestamped binary log of a link to any Stream (an SD
+  file, a spare UART, a host file): every raw byte SerialTransfer reads
+  and writes plus the parser's outcome for each frame, so what was on
+  the wire can be replayed through Packet::parse() on a host with
+  extras/tools/capture_replay.cpp. Set configST.capture to use it.
+  After the header, each record is a type byte, the ticks since the
+  previous record and the data length (both unsigned LEB128), then the
+  data - a short chunk of received bytes costs 3 bytes of overhead.
+  Multi-byte fields in the header and record data are little endian
+*/
+class PacketCapture
+{
+  public: // <<---------------------------------------//public
+	uint32_t bytesWritten = 0; // Capture bytes written since begin()
+
+
+	virtual ~PacketCapture() {}
+
+	void begin(Stream& _out, const uint32_t& ticksPerSecond = 1000);
+
+	// Called by Packet and SerialTransfer through configST.capture
+	virtual void rx(const uint8_t arr[], const uint16_t& len, const uint32_t& time);
+	virtual void tx(const uint8_t preamble[], const uint8_t& preambleLen, const uint8_t payload[], const uint16_t& payloadLen, const uint8_t postamble[], const uint8_t& postambleLen, const uint32_t& time);
+	virtual void frame(const int8_t& status, const uint8_t& packetID, const uint16_t& command, const uint16_t& len, const uint32_t& time);
+	virtual void discard(const uint8_t arr[], const uint16_t& len, const uint32_t& time);
+	virtual void config(const uint32_t& timeout, const bool& packed, const uint8_t& parityLen, const bool& compressed, const uint32_t& time);
+
+	void record(const uint8_t& type, const uint8_t arr[], const uint16_t& len, const uint32_t& time);
+
+
+  private: // <<---------------------------------------//private
+	Stream*  out  = NULL;
+	uint32_t last = 0; // Tick of the previous record
+
+
+	void    writeHeader(const uint8_t& type, const uint16_t& len, const uint32_t& time);
+	uint8_t writeVarint(uint8_t arr[], uint32_t val);
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include "Arduino.h"
+
+
+typedef uint32_t (*clockFunctionPtr)();
+
+
+/*
+ uint32_t clockMillis()
+ Description:
+ ------------
+  * Default time source of configST.clock - timeouts in ms
+*/
+inline uint32_t clockMillis()
+{
+	return millis();
+}
+
+
+/*
+ uint32_t clockMicros()
+ Description:
+ ------------
+  * Time source for timeouts in us, i.e. to drop a stalled packet
+  within a few byte times at high baud rates
+*/
+inline uint32_t clockMicros()
+{
+	return micros();
+}
+
+
+/*
+ class VirtualClock
+ Description:
+ ------------
+  * Time source that only moves when told to, for deterministic host
+  simulation: set configST.clock to VirtualClock::now and advance()
+  it by however much simulated time passes. Timeouts then fire the
+  same way on every run, as fast as the host can go
+*/
+class VirtualClock
+{
+  public: // <<---------------------------------------//public
+	static uint32_t now()
+	{
+		return ticks();
+	}
+
+	static void set(const uint32_t& value)
+	{
+		ticks() = value;
+	}
+
+	static void advance(const uint32_t& delta)
+	{
+		ticks() += delta;
+	}
+
+
+  private: // <<---------------------------------------//private
+	static volatile uint32_t& ticks()
+	{
+		static volatile uint32_t value = 0;
+		return value;
+	}
+};
@@ -0,0 +1,343 @@
+#include "PacketCompress.h"
+
+
+/*
+ PacketCompressor::PacketCompressor(const uint16_t& _minSize)
+ Description:
+ ------------
+  * Constructor for the PacketCompressor Class
+ Inputs:
+ -------
+  * const uint16_t& _minSize - Payloads shorter than this are sent as
+  they are - a few bytes rarely hold a repeat worth a token
+ Return:
+ -------
+  * void
+*/
+PacketCompressor::PacketCompressor(const uint16_t& _minSize)
+{
+	minSize = _minSize;
+}
+
+
+/*
+ uint16_t PacketCompressor::compress(const uint8_t arr[], const uint16_t& len, const uint16_t& maxLen)
+ Description:
+ ------------
+  * Compresses a payload into compressed() if it is worth trying and
+  shrinks, leaving arr[] as it is
+ Inputs:
+ -------
+  * const uint8_t arr[] - Payload
+  * const uint16_t& len - Number of bytes in arr[]
+  * const uint16_t& maxLen - Most compressed bytes to accept (up to
+  COMPRESS_MAX_SIZE), so the caller can keep room after them
+ Return:
+ -------
+  * uint16_t - Compressed length, 0 if the payload is to be sent as
+  it is
+*/
+uint16_t PacketCompressor::compress(const uint8_t arr[], const uint16_t& len, const uint16_t& maxLen)
+{
+	if (!len || (len < minSize) || (len > COMPRESS_MAX_SIZE) || skip)
+	{
+		if (skip)
+			skip--;
+
+		framesSkipped++;
+		return 0;
+	}
+
+	uint16_t limit         = (maxLen < len) ? maxLen : len - 1;
+	uint16_t compressedLen = limit ? encodeBlock(arr, len, txBlock, limit) : 0;
+
+	if (!compressedLen) // Back off exponentially while payloads do not shrink
+	{
+		backoff = backoff ? backoff * 2 : 1;
+
+		if (backoff > COMPRESS_MAX_BACKOFF)
+			backoff = COMPRESS_MAX_BACKOFF;
+
+		skip = backoff;
+		framesSkipped++;
+		return 0;
+	}
+
+	backoff = 0;
+
+	framesCompressed++;
+	bytesIn  += len;
+	bytesOut += compressedLen;
+
+	return compressedLen;
+}
+
+
+/*
+ uint8_t* PacketCompressor::compressed()
+ Description:
+ ------------
+  * Returns the buffer compress() wrote the last compressed payload
+  to. It is COMPRESS_MAX_SIZE bytes long, so the caller may append to
+  the payload in place
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint8_t* - Last compressed payload
+*/
+uint8_t* PacketCompressor::compressed()
+{
+	return txBlock;
+}
+
+
+/*
+ uint16_t PacketCompressor::decompress(uint8_t arr[], const uint16_t& len, const uint16_t& maxLen)
+ Description:
+ ------------
+  * Decompresses a payload in place
+ Inputs:
+ -------
+  * uint8_t arr[] - Compressed payload, replaced by the original
+  * const uint16_t& len - Number of bytes in arr[]
+  * const uint16_t& maxLen - Size of arr[]
+ Return:
+ -------
+  * uint16_t - Decompressed length, 0 if arr[] is not a valid block
+  or does not fit
+*/
+uint16_t PacketCompressor::decompress(uint8_t arr[], const uint16_t& len, const uint16_t& maxLen)
+{
+	uint16_t limit = (maxLen < COMPRESS_MAX_SIZE) ? maxLen : COMPRESS_MAX_SIZE;
+	uint16_t size  = decodeBlock(arr, len, scratch, limit);
+
+	if (!size)
+	{
+		failed++;
+		return 0;
+	}
+
+	memcpy(arr, scratch, size);
+
+	return size;
+}
+
+
+/*
+ uint16_t PacketCompressor::encodeBlock(const uint8_t src[], const uint16_t& len, uint8_t dst[], const uint16_t& maxLen)
+ Description:
+ ------------
+  * Compresses src[] into dst[]. Each token byte holds the number of
+  literals (high nibble) and the match length less COMPRESS_MIN_MATCH
+  (low nibble), 15 meaning more length bytes follow (255 = keep
+  adding). Then come the literals, the 16-bit little endian match
+  offset and the extra match length bytes. The last token has only
+  literals
+ Inputs:
+ -------
+  * const uint8_t src[] - Bytes to compress
+  * const uint16_t& len - Number of bytes in src[]
+  * uint8_t dst[] - Buffer to compress into
+  * const uint16_t& maxLen - Size of dst[]
+ Return:
+ -------
+  * uint16_t - Number of bytes written to dst[], 0 if they do not fit
+*/
+uint16_t PacketCompressor::encodeBlock(const uint8_t src[], const uint16_t& len, uint8_t dst[], const uint16_t& maxLen)
+{
+	uint16_t in     = 0;
+	uint16_t anchor = 0; // First byte not yet written, as a literal or part of a match
+	uint16_t out    = 0;
+
+	memset(table, 0, sizeof(table));
+
+	while ((in + COMPRESS_MIN_MATCH) <= len)
+	{
+		uint16_t h   = hash(src + in);
+		uint16_t ref = table[h];
+
+		table[h] = in;
+
+		if ((ref >= in) || memcmp(src + ref, src + in, COMPRESS_MIN_MATCH)) // Empty slot or hash collision
+		{
+			in++;
+			continue;
+		}
+
+		uint16_t match = COMPRESS_MIN_MATCH;
+
+		while (((in + match) < len) && (src[ref + match] == src[in + match]))
+			match++;
+
+		uint16_t literals = in - anchor;
+		uint16_t extra    = match - COMPRESS_MIN_MATCH;
+
+		if ((out + 1 + (literals / 255) + 1 + literals + 2 + (extra / 255) + 1) > maxLen) // Worst case size of this token
+			return 0;
+
+		dst[out++] = ((literals < 15 ? literals : 15) << 4) | (extra < 15 ? extra : 15);
+
+		if (literals >= 15)
+			out += writeLength(dst + out, literals - 15);
+
+		memcpy(dst + out, src + anchor, literals);
+		out += literals;
+
+		dst[out++] = (in - ref) & 0xFF;
+		dst[out++] = ((in - ref) >> 8) & 0xFF;
+
+		if (extra >= 15)
+			out += writeLength(dst + out, extra - 15);
+
+		in    += match;
+		anchor = in;
+	}
+
+	uint16_t literals = len - anchor;
+
+	if ((out + 1 + (literals / 255) + 1 + literals) > maxLen)
+		return 0;
+
+	dst[out++] = (literals < 15 ? literals : 15) << 4;
+
+	if (literals >= 15)
+		out += writeLength(dst + out, literals - 15);
+
+	memcpy(dst + out, src + anchor, literals);
+
+	return out + literals;
+}
+
+
+/*
+ uint16_t PacketCompressor::decodeBlock(const uint8_t src[], const uint16_t& len, uint8_t dst[], const uint16_t& maxLen)
+ Description:
+ ------------
+  * Decompresses a block written by encodeBlock(), checking every
+  length and offset against the buffers
+ Inputs:
+ -------
+  * const uint8_t src[] - Compressed bytes
+  * const uint16_t& len - Number of bytes in src[]
+  * uint8_t dst[] - Buffer to decompress into
+  * const uint16_t& maxLen - Size of dst[]
+ Return:
+ -------
+  * uint16_t - Number of bytes written to dst[], 0 if src[] is malformed
+  or does not fit
+*/
+uint16_t PacketCompressor::decodeBlock(const uint8_t src[], const uint16_t& len, uint8_t dst[], const uint16_t& maxLen)
+{
+	uint16_t in  = 0;
+	uint16_t out = 0;
+
+	while (in < len)
+	{
+		uint8_t  token    = src[in++];
+		uint32_t literals = token >> 4;
+		uint8_t  next;
+
+		if (literals == 15)
+		{
+			do
+			{
+				if (in >= len)
+					return 0;
+
+				next      = src[in++];
+				literals += next;
+			} while (next == 255);
+		}
+
+		if (((in + literals) > len) || ((out + literals) > maxLen))
+			return 0;
+
+		memcpy(dst + out, src + in, literals);
+		in  += literals;
+		out += literals;
+
+		if (in == len) // Last token, literals only
+			return out;
+
+		if ((in + 2) > len)
+			return 0;
+
+		uint16_t offset = src[in] | ((uint16_t)src[in + 1] << 8);
+		uint32_t match  = token & 0x0F;
+
+		in += 2;
+
+		if (match == 15)
+		{
+			do
+			{
+				if (in >= len)
+					return 0;
+
+				next   = src[in++];
+				match += next;
+			} while (next == 255);
+		}
+
+		match += COMPRESS_MIN_MATCH;
+
+		if (!offset || (offset > out) || ((out + match) > maxLen))
+			return 0;
+
+		for (; match; match--, out++) // Byte by byte, a match may overlap its own output
+			dst[out] = dst[out - offset];
+	}
+
+	return out;
+}
+
+
+/*
+ uint16_t PacketCompressor::hash(const uint8_t arr[])
+ Description:
+ ------------
+  * Hashes COMPRESS_MIN_MATCH bytes to a match finder table slot
+ Inputs:
+ -------
+  * const uint8_t arr[] - Bytes to hash
+ Return:
+ -------
+  * uint16_t - Table slot
+*/
+uint16_t PacketCompressor::hash(const uint8_t arr[])
+{
+	uint32_t val = arr[0] | ((uint32_t)arr[1] << 8) | ((uint32_t)arr[2] << 16) | ((uint32_t)arr[3] << 24);
+
+	return (uint32_t)(val * 2654435761UL) >> (32 - COMPRESS_HASH_BITS);
+}
+
+
+/*
+ uint16_t PacketCompressor::writeLength(uint8_t dst[], uint16_t len)
+ Description:
+ ------------
+  * Writes the extra bytes of a length that did not fit its nibble
+ Inputs:
+ -------
+  * uint8_t dst[] - Where to write
+  * uint16_t len - Length less 15
+ Return:
+ -------
+  * uint16_t - Number of bytes written
+*/
+uint16_t PacketCompressor::writeLength(uint8_t dst[], uint16_t len)
+{
+	uint16_t size = 0;
+
+	while (len >= 255)
+	{
+		dst[size++] = 255;
+		len        -= 255;
+	}
+
+	dst[size++] = len;
+
+	return size;
+}
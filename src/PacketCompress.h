@@ -0,0 +1,66 @@
+#pragma once
+#include "Arduino.h"
+
+
+#ifndef COMPRESS_HASH_BITS
+#define COMPRESS_HASH_BITS 8 // Match finder table of 2^COMPRESS_HASH_BITS 16-bit entries, more finds more matches
+#endif
+
+#ifndef COMPRESS_MAX_SIZE
+#define COMPRESS_MAX_SIZE 0x400 // Largest payload compressed/decompressed (size of the scratch buffer), larger ones go out as they are
+#endif
+
+const uint16_t COMPRESS_HASH_SIZE   = 1 << COMPRESS_HASH_BITS;
+const uint8_t  COMPRESS_MIN_MATCH   = 4;
+const uint16_t COMPRESS_MIN_SIZE    = 32; // Default smallest payload worth trying
+const uint8_t  COMPRESS_MAX_BACKOFF = 32; // Most payloads sent as they are after incompressible ones before trying again
+
+
+/*
+ class PacketCompressor
+ Description:
+ ------------
+  * LZ4-style block codec for packet payloads: a sequence of tokens,
+  each a run of literal bytes followed by a copy of earlier output
+  (16-bit offset, length of 4 and up), found greedily with a small
+  hash table. Decoding is a bounds-checked copy loop with no tables.
+  Set configST.compressor at both ends to use it - payloads that do
+  not shrink go out as they are, and each one that does not makes
+  the next few skip the attempt (up to COMPRESS_MAX_BACKOFF), so
+  incompressible traffic costs little CPU. RAM is the table plus two
+  COMPRESS_MAX_SIZE buffers, one per direction
+*/
+class PacketCompressor
+{
+  public: // <<---------------------------------------//public
+	uint16_t minSize          = COMPRESS_MIN_SIZE;
+	uint32_t framesCompressed = 0;
+	uint32_t framesSkipped    = 0; // Payloads sent as they are: too small, backed off or did not shrink
+	uint32_t bytesIn          = 0; // Payload bytes before compression, of the frames compressed
+	uint32_t bytesOut         = 0; // Payload bytes after compression, of the frames compressed
+	uint32_t failed           = 0; // Payloads that did not decompress
+
+
+	PacketCompressor(const uint16_t& _minSize = COMPRESS_MIN_SIZE);
+	virtual ~PacketCompressor() {}
+
+	// Called by Packet through configST.compressor
+	virtual uint16_t compress(const uint8_t arr[], const uint16_t& len, const uint16_t& maxLen = COMPRESS_MAX_SIZE);
+	virtual uint8_t* compressed();
+	virtual uint16_t decompress(uint8_t arr[], const uint16_t& len, const uint16_t& maxLen);
+
+	uint16_t encodeBlock(const uint8_t src[], const uint16_t& len, uint8_t dst[], const uint16_t& maxLen);
+	uint16_t decodeBlock(const uint8_t src[], const uint16_t& len, uint8_t dst[], const uint16_t& maxLen);
+
+
+  private: // <<---------------------------------------//private
+	uint16_t table[COMPRESS_HASH_SIZE];
+	uint8_t  txBlock[COMPRESS_MAX_SIZE]; // Output of compress(), apart from scratch so a packet decompressed mid-send leaves it alone
+	uint8_t  scratch[COMPRESS_MAX_SIZE]; // Output of decompress()
+	uint8_t  backoff = 0; // Payloads to skip after the last incompressible one
+	uint8_t  skip    = 0; // Payloads left to skip
+
+
+	uint16_t hash(const uint8_t arr[]);
+	uint16_t writeLength(uint8_t dst[], uint16_t len);
+};
@@ -0,0 +1,408 @@
+#include "PacketFEC.h"
+
+
+/*
+ PacketFEC::PacketFEC(const uint8_t& _parityLen)
+ Description:
+ ------------
+  * Constructor for the PacketFEC Class - a Reed-Solomon codec over
+  GF(2^8) (polynomial 0x11D). Payloads are split into blocks of up to
+  FEC_BLOCK_SIZE bytes, each carrying "_parityLen" parity bytes and
+  able to correct up to "_parityLen" / 2 corrupted bytes
+ Inputs:
+ -------
+  * const uint8_t& _parityLen - Number of parity bytes per block
+  (clamped to FEC_MAX_PARITY)
+ Return:
+ -------
+  * void
+*/
+PacketFEC::PacketFEC(const uint8_t& _parityLen)
+{
+	parityLen = _parityLen;
+
+	if (parityLen > FEC_MAX_PARITY)
+		parityLen = FEC_MAX_PARITY;
+
+	uint16_t val = 1;
+
+	for (uint16_t i = 0; i < 255; i++)
+	{
+		expTable[i] = val;
+		logTable[val] = i;
+
+		val <<= 1;
+		if (val & 0x100)
+			val ^= 0x11D;
+	}
+
+	for (uint16_t i = 255; i < 512; i++)
+		expTable[i] = expTable[i - 255];
+
+	logTable[0] = 0;
+
+	// generator(x) = (x + a^0)(x + a^1)...(x + a^(parityLen - 1)), highest degree first
+	memset(generator, 0, sizeof(generator));
+	generator[0] = 1;
+
+	for (uint8_t i = 0; i < parityLen; i++)
+		for (uint8_t j = i + 1; j > 0; j--)
+			generator[j] ^= mul(generator[j - 1], expTable[i]);
+}
+
+
+/*
+ uint16_t PacketFEC::encodedLen(const uint16_t& len)
+ Description:
+ ------------
+  * Computes the number of bytes "len" data bytes take once encoded
+ Inputs:
+ -------
+  * const uint16_t& len - Number of data bytes
+ Return:
+ -------
+  * uint16_t - Number of encoded bytes
+*/
+uint16_t PacketFEC::encodedLen(const uint16_t& len)
+{
+	uint8_t  dataPerBlock = FEC_BLOCK_SIZE - parityLen;
+	uint16_t blocks       = (len + dataPerBlock - 1) / dataPerBlock;
+
+	return len + (blocks * parityLen);
+}
+
+
+/*
+ uint16_t PacketFEC::maxDataLen(const uint16_t& len)
+ Description:
+ ------------
+  * Computes the max number of data bytes that fit in "len" bytes
+  once encoded
+ Inputs:
+ -------
+  * const uint16_t& len - Number of bytes available for encoded data
+ Return:
+ -------
+  * uint16_t - Max number of data bytes
+*/
+uint16_t PacketFEC::maxDataLen(const uint16_t& len)
+{
+	uint16_t fullBlocks = len / FEC_BLOCK_SIZE;
+	uint16_t remainder  = len % FEC_BLOCK_SIZE;
+	uint16_t dataLen    = fullBlocks * (FEC_BLOCK_SIZE - parityLen);
+
+	if (remainder > parityLen)
+		dataLen += remainder - parityLen;
+
+	return dataLen;
+}
+
+
+/*
+ uint16_t PacketFEC::encode(uint8_t arr[], const uint16_t& len)
+ Description:
+ ------------
+  * Appends parity to every block of "arr" in place. "arr" must have
+  room for encodedLen(len) bytes
+ Inputs:
+ -------
+  * uint8_t arr[] - Data to encode
+  * const uint16_t& len - Number of data bytes in arr[]
+ Return:
+ -------
+  * uint16_t - Number of encoded bytes in arr[]
+*/
+uint16_t PacketFEC::encode(uint8_t arr[], const uint16_t& len)
+{
+	uint8_t  dataPerBlock = FEC_BLOCK_SIZE - parityLen;
+	uint16_t blocks       = (len + dataPerBlock - 1) / dataPerBlock;
+
+	if (!parityLen)
+		return len;
+
+	for (uint16_t i = blocks; i > 0; i--) // Last block first so that blocks can be spread out in place
+	{
+		uint16_t block   = i - 1;
+		uint8_t  dataLen = dataPerBlock;
+
+		if (block == (blocks - 1))
+			dataLen = len - (block * dataPerBlock);
+
+		memmove(arr + (block * FEC_BLOCK_SIZE), arr + (block * dataPerBlock), dataLen);
+		encodeBlock(arr + (block * FEC_BLOCK_SIZE), dataLen);
+	}
+
+	return encodedLen(len);
+}
+
+
+/*
+ uint16_t PacketFEC::decode(uint8_t arr[], const uint16_t& len)
+ Description:
+ ------------
+  * Corrects every block of "arr" in place and strips the parity.
+  Blocks with too many errors are left as-is for the CRC to reject
+ Inputs:
+ -------
+  * uint8_t arr[] - Encoded data
+  * const uint16_t& len - Number of encoded bytes in arr[]
+ Return:
+ -------
+  * uint16_t - Number of data bytes in arr[]
+*/
+uint16_t PacketFEC::decode(uint8_t arr[], const uint16_t& len)
+{
+	uint8_t  dataPerBlock = FEC_BLOCK_SIZE - parityLen;
+	uint16_t blocks       = (len + FEC_BLOCK_SIZE - 1) / FEC_BLOCK_SIZE;
+	uint16_t dataLen      = 0;
+
+	if (!parityLen)
+		return len;
+
+	for (uint16_t block = 0; block < blocks; block++) // First block first so that blocks can be packed in place
+	{
+		uint8_t blockLen = FEC_BLOCK_SIZE;
+
+		if (block == (blocks - 1))
+			blockLen = len - (block * FEC_BLOCK_SIZE);
+
+		if (blockLen <= parityLen)
+			break;
+
+		if (!decodeBlock(arr + (block * FEC_BLOCK_SIZE), blockLen))
+			failed++;
+
+		memmove(arr + (block * dataPerBlock), arr + (block * FEC_BLOCK_SIZE), blockLen - parityLen);
+		dataLen += blockLen - parityLen;
+	}
+
+	return dataLen;
+}
+
+
+/*
+ uint8_t PacketFEC::mul(const uint8_t& a, const uint8_t& b)
+ Description:
+ ------------
+  * Multiplies two GF(2^8) elements
+ Inputs:
+ -------
+  * const uint8_t& a - Multiplicand
+  * const uint8_t& b - Multiplier
+ Return:
+ -------
+  * uint8_t - Product
+*/
+uint8_t PacketFEC::mul(const uint8_t& a, const uint8_t& b)
+{
+	if (!a || !b)
+		return 0;
+
+	return expTable[logTable[a] + logTable[b]];
+}
+
+
+/*
+ uint8_t PacketFEC::div(const uint8_t& a, const uint8_t& b)
+ Description:
+ ------------
+  * Divides two GF(2^8) elements
+ Inputs:
+ -------
+  * const uint8_t& a - Dividend
+  * const uint8_t& b - Divisor (must not be 0)
+ Return:
+ -------
+  * uint8_t - Quotient
+*/
+uint8_t PacketFEC::div(const uint8_t& a, const uint8_t& b)
+{
+	if (!a)
+		return 0;
+
+	return expTable[logTable[a] + 255 - logTable[b]];
+}
+
+
+/*
+ void PacketFEC::encodeBlock(uint8_t block[], const uint8_t& dataLen)
+ Description:
+ ------------
+  * Computes the parity of a single block (the remainder of
+  data(x) * x^parityLen divided by the generator) and stores it
+  right after the data
+ Inputs:
+ -------
+  * uint8_t block[] - Block to encode
+  * const uint8_t& dataLen - Number of data bytes in block[]
+ Return:
+ -------
+  * void
+*/
+void PacketFEC::encodeBlock(uint8_t block[], const uint8_t& dataLen)
+{
+	uint8_t* parity = block + dataLen;
+
+	memset(parity, 0, parityLen);
+
+	for (uint8_t i = 0; i < dataLen; i++)
+	{
+		uint8_t feedback = block[i] ^ parity[0];
+
+		for (uint8_t j = 0; j < (parityLen - 1); j++)
+			parity[j] = parity[j + 1] ^ mul(feedback, generator[j + 1]);
+
+		parity[parityLen - 1] = mul(feedback, generator[parityLen]);
+	}
+}
+
+
+/*
+ bool PacketFEC::decodeBlock(uint8_t block[], const uint8_t& len)
+ Description:
+ ------------
+  * Corrects a single block in place: syndromes, Berlekamp-Massey for
+  the error locator, Chien search for the error positions and Forney
+  for the error values
+ Inputs:
+ -------
+  * uint8_t block[] - Block to correct, data followed by parity
+  * const uint8_t& len - Number of bytes in block[]
+ Return:
+ -------
+  * bool - Whether or not the block is (now) error free
+*/
+bool PacketFEC::decodeBlock(uint8_t block[], const uint8_t& len)
+{
+	uint8_t syndromes[FEC_MAX_PARITY];
+	bool    clean = true;
+
+	for (uint8_t i = 0; i < parityLen; i++)
+	{
+		uint8_t syndrome = 0;
+
+		for (uint8_t j = 0; j < len; j++)
+			syndrome = mul(syndrome, expTable[i]) ^ block[j];
+
+		syndromes[i] = syndrome;
+
+		if (syndrome)
+			clean = false;
+	}
+
+	if (clean)
+		return true;
+
+	// Berlekamp-Massey, polynomials lowest degree first
+	uint8_t locator[FEC_MAX_PARITY + 1] = {1};
+	uint8_t prev[FEC_MAX_PARITY + 1]    = {1};
+	uint8_t temp[FEC_MAX_PARITY + 1];
+	uint8_t errors = 0;
+	uint8_t shift  = 1;
+	uint8_t scale  = 1;
+
+	for (uint8_t n = 0; n < parityLen; n++)
+	{
+		uint8_t discrepancy = syndromes[n];
+
+		for (uint8_t i = 1; i <= errors; i++)
+			discrepancy ^= mul(locator[i], syndromes[n - i]);
+
+		if (!discrepancy)
+		{
+			shift++;
+			continue;
+		}
+
+		uint8_t coef = div(discrepancy, scale);
+
+		memcpy(temp, locator, sizeof(temp));
+
+		for (uint8_t i = 0; (i + shift) <= FEC_MAX_PARITY; i++)
+			locator[i + shift] ^= mul(coef, prev[i]);
+
+		if ((2 * errors) <= n)
+		{
+			errors = n + 1 - errors;
+			memcpy(prev, temp, sizeof(prev));
+			scale = discrepancy;
+			shift = 1;
+		}
+		else
+			shift++;
+	}
+
+	if ((2 * errors) > parityLen)
+		return false;
+
+	// Chien search - byte "pos" is the coefficient of x^(len - 1 - pos)
+	uint8_t positions[FEC_MAX_PARITY / 2];
+	uint8_t found = 0;
+
+	for (uint16_t pos = 0; pos < len; pos++)
+	{
+		uint8_t invX = expTable[255 - (len - 1 - pos)]; // X^-1
+		uint8_t sum  = 0;
+		uint8_t pow  = 1;
+
+		for (uint8_t i = 0; i <= errors; i++)
+		{
+			sum ^= mul(locator[i], pow);
+			pow = mul(pow, invX);
+		}
+
+		if (!sum)
+		{
+			if (found == errors)
+				return false;
+
+			positions[found++] = pos;
+		}
+	}
+
+	if (found != errors)
+		return false;
+
+	// Forney - evaluator(x) = syndromes(x) * locator(x) mod x^parityLen
+	uint8_t evaluator[FEC_MAX_PARITY];
+
+	for (uint8_t i = 0; i < parityLen; i++)
+	{
+		evaluator[i] = 0;
+
+		for (uint8_t j = 0; (j <= i) && (j <= errors); j++)
+			evaluator[i] ^= mul(locator[j], syndromes[i - j]);
+	}
+
+	for (uint8_t k = 0; k < found; k++)
+	{
+		uint8_t x    = expTable[len - 1 - positions[k]];
+		uint8_t invX = expTable[255 - (len - 1 - positions[k])];
+		uint8_t num  = 0;
+		uint8_t den  = 0;
+		uint8_t pow  = 1;
+
+		for (uint8_t i = 0; i < parityLen; i++)
+		{
+			num ^= mul(evaluator[i], pow);
+			pow = mul(pow, invX);
+		}
+
+		pow = 1;
+
+		for (uint8_t i = 1; i <= errors; i += 2) // Formal derivative keeps the odd terms
+		{
+			den ^= mul(locator[i], pow);
+			pow = mul(pow, mul(invX, invX));
+		}
+
+		if (!den)
+			return false;
+
+		block[positions[k]] ^= mul(x, div(num, den));
+	}
+
+	corrected += found;
+
+	return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "Arduino.h"
+#include "Packet.h"
+
+
+const uint8_t FEC_BLOCK_SIZE = 255; // Max bytes per Reed-Solomon block, data + parity
+
+
+class PacketFEC
+{
+  public: // <<---------------------------------------//public
+	uint8_t  parityLen = 0;
+	uint32_t corrected = 0; // Total bytes corrected so far
+	uint32_t failed    = 0; // Total blocks with too many errors to correct
+
+
+	PacketFEC(const uint8_t& _parityLen = 8);
+	virtual ~PacketFEC() {}
+
+	uint16_t encodedLen(const uint16_t& len);
+
+	// Called by Packet through configST.fec
+	virtual uint16_t maxDataLen(const uint16_t& len);
+	virtual uint16_t encode(uint8_t arr[], const uint16_t& len);
+	virtual uint16_t decode(uint8_t arr[], const uint16_t& len);
+
+
+  private: // <<---------------------------------------//private
+	uint8_t expTable[512];
+	uint8_t logTable[256];
+	uint8_t generator[FEC_MAX_PARITY + 1];
+
+
+	uint8_t mul(const uint8_t& a, const uint8_t& b);
+	uint8_t div(const uint8_t& a, const uint8_t& b);
+	void    encodeBlock(uint8_t block[], const uint8_t& dataLen);
+	bool    decodeBlock(uint8_t block[], const uint8_t& len);
+};
@@ -0,0 +1,324 @@
+#include "PacketLatency.h"
+
+
+/*
+ void LatencyHistogram::add(const uint32_t& value)
+ Description:
+ ------------
+  * Counts one value
+ Inputs:
+ -------
+  * const uint32_t& value - Value to count, in ticks
+ Return:
+ -------
+  * void
+*/
+void LatencyHistogram::add(const uint32_t& value)
+{
+	buckets[bucketOf(value)]++;
+	count++;
+
+	if (value > maxValue)
+		maxValue = value;
+}
+
+
+/*
+ uint32_t LatencyHistogram::percentile(const float& percent)
+ Description:
+ ------------
+  * Returns the value "percent" % of the counted values are at or below
+ Inputs:
+ -------
+  * const float& percent - Percentile to report, 0 - 100 (i.e. 99.9)
+ Return:
+ -------
+  * uint32_t - Upper bound of the bucket the percentile falls in,
+  capped at the largest value counted (0 if nothing was counted)
+*/
+uint32_t LatencyHistogram::percentile(const float& percent)
+{
+	uint32_t rank = (uint32_t)((percent / 100) * count + 0.5f); // Values at or below the percentile
+	uint32_t seen = 0;
+
+	if (!count)
+		return 0;
+
+	if (!rank)
+		rank = 1;
+
+	for (uint8_t i = 0; i < LATENCY_BUCKETS; i++)
+	{
+		seen += buckets[i];
+
+		if (seen >= rank)
+			return (bucketMax(i) < maxValue) ? bucketMax(i) : maxValue;
+	}
+
+	return maxValue;
+}
+
+
+/*
+ void LatencyHistogram::clear()
+ Description:
+ ------------
+  * Drops every value counted
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void LatencyHistogram::clear()
+{
+	memset(buckets, 0, sizeof(buckets));
+
+	count    = 0;
+	maxValue = 0;
+}
+
+
+/*
+ uint8_t LatencyHistogram::bucketOf(const uint32_t& value)
+ Description:
+ ------------
+  * Maps a value to its bucket: 0 and 1 get their own, then each power
+  of 2 is split in two by the bit below the most significant one
+ Inputs:
+ -------
+  * const uint32_t& value - Value to map
+ Return:
+ -------
+  * uint8_t - Bucket index
+*/
+uint8_t LatencyHistogram::bucketOf(const uint32_t& value)
+{
+	uint8_t msb = 0;
+
+	if (value < 2)
+		return value;
+
+	for (uint32_t v = value >> 1; v; v >>= 1)
+		msb++;
+
+	return (msb << 1) | ((value >> (msb - 1)) & 1);
+}
+
+
+/*
+ uint32_t LatencyHistogram::bucketMax(const uint8_t& bucket)
+ Description:
+ ------------
+  * Returns the largest value mapped to a bucket
+ Inputs:
+ -------
+  * const uint8_t& bucket - Bucket index
+ Return:
+ -------
+  * uint32_t - Largest value of the bucket
+*/
+uint32_t LatencyHistogram::bucketMax(const uint8_t& bucket)
+{
+	if (bucket < 2)
+		return bucket;
+
+	if (bucket == (LATENCY_BUCKETS - 1))
+		return __UINT32_MAX__;
+
+	uint8_t msb = bucket >> 1;
+
+	return ((uint32_t)1 << msb) + ((uint32_t)((bucket & 1) + 1) << (msb - 1)) - 1;
+}
+
+
+/*
+ void PacketLatency::recordOneWay(const uint16_t& command, const uint32_t& sent, const uint32_t& received)
+ Description:
+ ------------
+  * Counts the one-way latency of a timestamped packet
+ Inputs:
+ -------
+  * const uint16_t& command - Command of the packet (flags cleared)
+  * const uint32_t& sent - Sender's timestamp
+  * const uint32_t& received - Tick the packet was received
+ Return:
+ -------
+  * void
+*/
+void PacketLatency::recordOneWay(const uint16_t& command, const uint32_t& sent, const uint32_t& received)
+{
+	int32_t ticks = (int32_t)(received - sent + clockOffset);
+
+	if (ticks < 0) // Clock offset not known well enough yet
+		ticks = 0;
+
+	slotFor(command, true)->oneWay.add(ticks);
+}
+
+
+/*
+ void PacketLatency::recordDispatch(const uint16_t& command, const uint32_t& ticks)
+ Description:
+ ------------
+  * Counts the dispatch latency of a packet
+ Inputs:
+ -------
+  * const uint16_t& command - Command of the packet (flags cleared)
+  * const uint32_t& ticks - Ticks from the start byte to dispatch
+ Return:
+ -------
+  * void
+*/
+void PacketLatency::recordDispatch(const uint16_t& command, const uint32_t& ticks)
+{
+	slotFor(command, true)->dispatch.add(ticks);
+}
+
+
+/*
+ LatencyHistogram* PacketLatency::oneWay(const uint16_t& command)
+ Description:
+ ------------
+  * Returns the one-way latency histogram of a command
+ Inputs:
+ -------
+  * const uint16_t& command - Command, or LATENCY_OTHER for the
+  commands that did not get a slot of their own
+ Return:
+ -------
+  * LatencyHistogram* - Histogram (NULL if the command was never seen)
+*/
+LatencyHistogram* PacketLatency::oneWay(const uint16_t& command)
+{
+	Slot* slot = slotFor(command, false);
+
+	return slot ? &slot->oneWay : NULL;
+}
+
+
+/*
+ LatencyHistogram* PacketLatency::dispatch(const uint16_t& command)
+ Description:
+ ------------
+  * Returns the dispatch latency histogram of a command
+ Inputs:
+ -------
+  * const uint16_t& command - Command, or LATENCY_OTHER for the
+  commands that did not get a slot of their own
+ Return:
+ -------
+  * LatencyHistogram* - Histogram (NULL if the command was never seen)
+*/
+LatencyHistogram* PacketLatency::dispatch(const uint16_t& command)
+{
+	Slot* slot = slotFor(command, false);
+
+	return slot ? &slot->dispatch : NULL;
+}
+
+
+/*
+ uint32_t PacketLatency::oneWayPercentile(const uint16_t& command, const float& percent)
+ Description:
+ ------------
+  * Returns a percentile of a command's one-way latency
+ Inputs:
+ -------
+  * const uint16_t& command - Command, or LATENCY_OTHER
+  * const float& percent - Percentile to report, 0 - 100
+ Return:
+ -------
+  * uint32_t - Latency in ticks (0 if nothing was counted)
+*/
+uint32_t PacketLatency::oneWayPercentile(const uint16_t& command, const float& percent)
+{
+	LatencyHistogram* histogram = oneWay(command);
+
+	return histogram ? histogram->percentile(percent) : 0;
+}
+
+
+/*
+ uint32_t PacketLatency::dispatchPercentile(const uint16_t& command, const float& percent)
+ Description:
+ ------------
+  * Returns a percentile of a command's dispatch latency
+ Inputs:
+ -------
+  * const uint16_t& command - Command, or LATENCY_OTHER
+  * const float& percent - Percentile to report, 0 - 100
+ Return:
+ -------
+  * uint32_t - Latency in ticks (0 if nothing was counted)
+*/
+uint32_t PacketLatency::dispatchPercentile(const uint16_t& command, const float& percent)
+{
+	LatencyHistogram* histogram = dispatch(command);
+
+	return histogram ? histogram->percentile(percent) : 0;
+}
+
+
+/*
+ void PacketLatency::clear()
+ Description:
+ ------------
+  * Drops every value counted and frees every command slot
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void PacketLatency::clear()
+{
+	for (uint8_t i = 0; i <= LATENCY_MAX_COMMANDS; i++)
+	{
+		slots[i].command = LATENCY_OTHER;
+		slots[i].used    = false;
+		slots[i].oneWay.clear();
+		slots[i].dispatch.clear();
+	}
+}
+
+
+/*
+ PacketLatency::Slot* PacketLatency::slotFor(const uint16_t& command, const bool& claim)
+ Description:
+ ------------
+  * Finds the slot of a command. Commands get a slot of their own in
+  the order they are first seen, later ones share the last slot
+ Inputs:
+ -------
+  * const uint16_t& command - Command to look up
+  * const bool& claim - Whether or not to give the command a slot if
+  it has none yet
+ Return:
+ -------
+  * PacketLatency::Slot* - Slot of the command (NULL if it has none
+  and "claim" is clear)
+*/
+PacketLatency::Slot* PacketLatency::slotFor(const uint16_t& command, const bool& claim)
+{
+	for (uint8_t i = 0; i < LATENCY_MAX_COMMANDS; i++)
+	{
+		if (slots[i].used && (slots[i].command == command))
+			return &slots[i];
+
+		if (!slots[i].used)
+		{
+			if (!claim)
+				return (command == LATENCY_OTHER) ? &slots[LATENCY_MAX_COMMANDS] : NULL;
+
+			slots[i].command = command;
+			slots[i].used    = true;
+
+			return &slots[i];
+		}
+	}
+
+	return &slots[LATENCY_MAX_COMMANDS]; // Every slot is taken, the command shares the last one
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "Arduino.h"
+
+
+#ifndef LATENCY_MAX_COMMANDS
+#define LATENCY_MAX_COMMANDS 4 // Commands tracked separately by a PacketLatency, the rest share one slot
+#endif
+
+
+const uint8_t  LATENCY_BUCKETS = 64;     // Two per power of 2, covering all 32-bit values
+const uint16_t LATENCY_OTHER   = 0xFFFF; // Command key of the slot shared by untracked commands
+
+
+/*
+ class LatencyHistogram
+ Description:
+ ------------
+  * Fixed-memory histogram of tick counts with log-scale buckets, two
+  per power of 2, so any value lands in a bucket at most ~33% wide
+  whatever its magnitude. Percentiles are reported as the upper bound
+  of the bucket they fall in
+*/
+class LatencyHistogram
+{
+  public: // <<---------------------------------------//public
+	uint32_t count    = 0;
+	uint32_t maxValue = 0;
+
+
+	void     add(const uint32_t& value);
+	uint32_t percentile(const float& percent);
+	void     clear();
+
+
+  private: // <<---------------------------------------//private
+	uint32_t buckets[LATENCY_BUCKETS] = {};
+
+
+	static uint8_t  bucketOf(const uint32_t& value);
+	static uint32_t bucketMax(const uint8_t& bucket);
+};
+
+
+/*
+ class PacketLatency
+ Description:
+ ------------
+  * Receiver-side latency histograms keyed by currentCommand(), filled
+  by Packet when configST.latency points to one:
+   * One-way latency - receive tick minus the sender's timestamp
+   (packets sent with configST.timestamps), corrected by clockOffset
+   * Dispatch latency - ticks between the parser seeing a packet's
+   start byte and handing the packet over (callback or available())
+  Both ends' clocks must count the same ticks (configST.clock)
+*/
+class PacketLatency
+{
+  public: // <<---------------------------------------//public
+	int32_t clockOffset = 0; // Ticks the sender's clock runs ahead of this end's
+
+
+	virtual ~PacketLatency() {}
+
+	// Called by Packet through configST.latency
+	virtual void recordOneWay(const uint16_t& command, const uint32_t& sent, const uint32_t& received);
+	virtual void recordDispatch(const uint16_t& command, const uint32_t& ticks);
+
+	LatencyHistogram* oneWay(const uint16_t& command);
+	LatencyHistogram* dispatch(const uint16_t& command);
+	uint32_t          oneWayPercentile(const uint16_t& command, const float& percent);
+	uint32_t          dispatchPercentile(const uint16_t& command, const float& percent);
+	void              clear();
+
+
+  private: // <<---------------------------------------//private
+	struct Slot
+	{
+		uint16_t         command = LATENCY_OTHER;
+		bool             used    = false; // Whether or not a command has claimed the slot
+		LatencyHistogram oneWay;
+		LatencyHistogram dispatch;
+	};
+
+	Slot slots[LATENCY_MAX_COMMANDS + 1]; // The last one is shared by untracked commands
+
+
+	Slot* slotFor(const uint16_t& command, const bool& claim);
+};
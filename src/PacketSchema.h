@@ -0,0 +1,281 @@
+/*
+struct telemetry                                   Wire layout (little endian, no padding)
+{                                                  ---------------------------------------
+	uint32_t time;                                 bytes 0 - 3
+	int16_t  temperature;                          bytes 4 - 5
+	float    volts;                                bytes 6 - 9
+	uint8_t  flags[2];                             bytes 10 - 11
+};
+
+typedef PacketSchema<SCHEMA_FIELD(telemetry, time),
+                     SCHEMA_FIELD(telemetry, temperature),
+                     SCHEMA_FIELD(telemetry, volts),
+                     SCHEMA_FIELD(telemetry, flags)> telemetrySchema; // telemetrySchema::SIZE == 12
+
+myTransfer.sendSchema<telemetrySchema>(reading);
+myTransfer.rxSchema<telemetrySchema>(reading);
+*/
+
+#pragma once
+#include "Arduino.h"
+
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define SCHEMA_BIG_ENDIAN 1
+#else
+#define SCHEMA_BIG_ENDIAN 0
+#endif
+
+
+/*
+ SCHEMA_FIELD(Type, member)
+ Description:
+ ------------
+  * Declares the field "member" of struct "Type" for a PacketSchema.
+  Its wire size comes from its declared type, so declare fields with
+  fixed-width types (uint16_t, int32_t, float, ...) - "int" and "long"
+  are different sizes on AVR and ARM/x86
+*/
+#define SCHEMA_FIELD(Type, member) SchemaField<Type, decltype(((Type*)0)->member), &Type::member>
+
+
+/*
+ struct SchemaCodec<V>
+ Description:
+ ------------
+  * Encodes/decodes one value of type V as little endian bytes.
+  Integers, bool, enums and float are copied as they are on little
+  endian targets (a fixed-size memcpy, i.e. one or two moves) and byte
+  reversed on big endian ones
+*/
+template <typename V>
+struct SchemaCodec
+{
+	enum : uint16_t { SIZE = sizeof(V) };
+
+	static_assert((SIZE == 1) || (SIZE == 2) || (SIZE == 4) || (SIZE == 8), "SCHEMA_FIELD types must be 1, 2, 4 or 8 bytes wide");
+
+	static void encode(const V& val, uint8_t arr[])
+	{
+#if SCHEMA_BIG_ENDIAN
+		const uint8_t* src = (const uint8_t*)&val;
+
+		for (uint8_t i = 0; i < SIZE; i++)
+			arr[i] = src[SIZE - 1 - i];
+#else
+		memcpy(arr, &val, SIZE);
+#endif
+	}
+
+	static void decode(const uint8_t arr[], V& val)
+	{
+#if SCHEMA_BIG_ENDIAN
+		uint8_t* dst = (uint8_t*)&val;
+
+		for (uint8_t i = 0; i < SIZE; i++)
+			dst[i] = arr[SIZE - 1 - i];
+#else
+		memcpy(&val, arr, SIZE);
+#endif
+	}
+};
+
+
+/*
+ struct SchemaCodec<double>
+ Description:
+ ------------
+  * double always travels as an 8-byte IEEE 754 value. Where double is
+  only 4 bytes (AVR) it is widened on encode and narrowed (truncating
+  the extra precision, saturating to infinity) on decode
+*/
+template <>
+struct SchemaCodec<double>
+{
+	enum : uint16_t { SIZE = 8 };
+
+	static void encode(const double& val, uint8_t arr[])
+	{
+#if __SIZEOF_DOUBLE__ == 8
+		uint64_t bits;
+
+		memcpy(&bits, &val, sizeof(bits));
+		SchemaCodec<uint64_t>::encode(bits, arr);
+#else
+		uint32_t single;
+		uint32_t high;
+		uint32_t low;
+
+		memcpy(&single, &val, sizeof(single));
+
+		uint32_t sign     = single & 0x80000000UL;
+		int16_t  exponent = (single >> 23) & 0xFF;
+		uint32_t mantissa = single & 0x7FFFFFUL;
+
+		if (exponent == 0xFF) // Infinity/NaN
+			exponent = 0x7FF;
+		else if (exponent) // Normal, rebias
+			exponent += 1023 - 127;
+		else if (mantissa) // Subnormal single, normal double
+		{
+			exponent = 1023 - 126;
+
+			while (!(mantissa & 0x800000UL))
+			{
+				mantissa <<= 1;
+				exponent--;
+			}
+
+			mantissa &= 0x7FFFFFUL;
+		}
+
+		high = sign | ((uint32_t)exponent << 20) | (mantissa >> 3);
+		low  = mantissa << 29;
+
+		SchemaCodec<uint32_t>::encode(low, arr);
+		SchemaCodec<uint32_t>::encode(high, arr + 4);
+#endif
+	}
+
+	static void decode(const uint8_t arr[], double& val)
+	{
+#if __SIZEOF_DOUBLE__ == 8
+		uint64_t bits;
+
+		SchemaCodec<uint64_t>::decode(arr, bits);
+		memcpy(&val, &bits, sizeof(bits));
+#else
+		uint32_t high;
+		uint32_t low;
+
+		SchemaCodec<uint32_t>::decode(arr, low);
+		SchemaCodec<uint32_t>::decode(arr + 4, high);
+
+		uint32_t sign     = high & 0x80000000UL;
+		int16_t  exponent = (high >> 20) & 0x7FF;
+		uint32_t mantissa = ((high & 0xFFFFFUL) << 3) | (low >> 29);
+		uint32_t single;
+
+		if (exponent == 0x7FF) // Infinity/NaN
+			single = sign | 0x7F800000UL | (mantissa ? 0x400000UL : 0);
+		else if (exponent > (1023 + 127)) // Too big for a float
+			single = sign | 0x7F800000UL;
+		else if (exponent <= (1023 - 127)) // Zero or too small for a normal float
+		{
+			int16_t shift = (1023 - 126) - exponent;
+
+			single = sign;
+
+			if (exponent && (shift < 24))
+				single |= (mantissa | 0x800000UL) >> shift;
+		}
+		else
+			single = sign | ((uint32_t)(exponent - 1023 + 127) << 23) | mantissa;
+
+		memcpy(&val, &single, sizeof(single));
+#endif
+	}
+};
+
+
+/*
+ struct SchemaCodec<V[N]>
+ Description:
+ ------------
+  * Arrays are their elements back to back
+*/
+template <typename V, size_t N>
+struct SchemaCodec<V[N]>
+{
+	enum : uint16_t { SIZE = SchemaCodec<V>::SIZE * N };
+
+	static void encode(const V (&val)[N], uint8_t arr[])
+	{
+		for (size_t i = 0; i < N; i++)
+			SchemaCodec<V>::encode(val[i], arr + (i * SchemaCodec<V>::SIZE));
+	}
+
+	static void decode(const uint8_t arr[], V (&val)[N])
+	{
+		for (size_t i = 0; i < N; i++)
+			SchemaCodec<V>::decode(arr + (i * SchemaCodec<V>::SIZE), val[i]);
+	}
+};
+
+
+/*
+ struct SchemaField<T, V, Member>
+ Description:
+ ------------
+  * One field of a PacketSchema - declare it with SCHEMA_FIELD()
+*/
+template <typename T, typename V, V T::*Member>
+struct SchemaField
+{
+	enum : uint16_t { SIZE = SchemaCodec<V>::SIZE };
+
+	static void encode(const T& obj, uint8_t arr[])
+	{
+		SchemaCodec<V>::encode(obj.*Member, arr);
+	}
+
+	static void decode(const uint8_t arr[], T& obj)
+	{
+		SchemaCodec<V>::decode(arr, obj.*Member);
+	}
+};
+
+
+/*
+ struct PacketSchema<Fields...>
+ Description:
+ ------------
+  * Fixed wire layout of a struct: its SCHEMA_FIELD()s in the order
+  listed, little endian, with no padding, whatever the struct's own
+  layout on the target. Everything is resolved at compile time - no
+  descriptors are stored or walked at run time. SIZE is the number of
+  bytes on the wire. Used through txSchema()/rxSchema()/sendSchema()
+  or directly with encode()/decode()
+*/
+template <typename... Fields>
+struct PacketSchema;
+
+template <>
+struct PacketSchema<>
+{
+	enum : uint16_t { SIZE = 0 };
+
+	template <typename T>
+	static void encode(const T& obj, uint8_t arr[])
+	{
+		(void)obj;
+		(void)arr;
+	}
+
+	template <typename T>
+	static void decode(const uint8_t arr[], T& obj)
+	{
+		(void)arr;
+		(void)obj;
+	}
+};
+
+template <typename First, typename... Rest>
+struct PacketSchema<First, Rest...>
+{
+	enum : uint16_t { SIZE = First::SIZE + PacketSchema<Rest...>::SIZE };
+
+	template <typename T>
+	static void encode(const T& obj, uint8_t arr[])
+	{
+		First::encode(obj, arr);
+		PacketSchema<Rest...>::encode(obj, arr + First::SIZE);
+	}
+
+	template <typename T>
+	static void decode(const uint8_t arr[], T& obj)
+	{
+		First::decode(arr, obj);
+		PacketSchema<Rest...>::decode(arr + First::SIZE, obj);
+	}
+};
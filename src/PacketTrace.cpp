@@ -0,0 +1,115 @@
+#include "PacketTrace.h"
+
+
+/*
+ uint16_t PacketTrace::size()
+ Description:
+ ------------
+  * Returns the number of records held
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - Number of records held
+*/
+uint16_t PacketTrace::size()
+{
+	return count;
+}
+
+
+/*
+ uint16_t PacketTrace::read(traceRecordST arr[], const uint16_t& len)
+ Description:
+ ------------
+  * Copies the oldest records out without removing them
+ Inputs:
+ -------
+  * traceRecordST arr[] - Buffer to copy records into, oldest first
+  * const uint16_t& len - Size of arr[]
+ Return:
+ -------
+  * uint16_t - Number of records copied into arr[]
+*/
+uint16_t PacketTrace::read(traceRecordST arr[], const uint16_t& len)
+{
+	uint16_t tail = (head - count) & (PACKET_TRACE_SIZE - 1);
+	uint16_t num  = (len < count) ? len : count;
+
+	for (uint16_t i = 0; i < num; i++)
+		arr[i] = records[(tail + i) & (PACKET_TRACE_SIZE - 1)];
+
+	return num;
+}
+
+
+/*
+ size_t PacketTrace::dump(Stream& port)
+ Description:
+ ------------
+  * Writes every record held, oldest first, in the binary dump format
+  read by extras/tools/trace_decode.cpp: "PTRC", TRACE_DUMP_VERSION,
+  16-bit record count and 32-bit overwritten count, then per record
+  32-bit time, event, arg and 16-bit value - all little endian
+ Inputs:
+ -------
+  * Stream& port - Where to write the dump
+ Return:
+ -------
+  * size_t - Number of bytes written
+*/
+size_t PacketTrace::dump(Stream& port)
+{
+	uint8_t  header[11] = {'P', 'T', 'R', 'C', TRACE_DUMP_VERSION};
+	uint16_t tail       = (head - count) & (PACKET_TRACE_SIZE - 1);
+	size_t   written;
+
+	header[5]  = count & 0xFF;
+	header[6]  = (count >> 8) & 0xFF;
+	header[7]  = overwritten & 0xFF;
+	header[8]  = (overwritten >> 8) & 0xFF;
+	header[9]  = (overwritten >> 16) & 0xFF;
+	header[10] = (overwritten >> 24) & 0xFF;
+
+	written = port.write(header, sizeof(header));
+
+	for (uint16_t i = 0; i < count; i++)
+	{
+		const traceRecordST& rec = records[(tail + i) & (PACKET_TRACE_SIZE - 1)];
+		uint8_t              buff[8];
+
+		buff[0] = rec.time & 0xFF;
+		buff[1] = (rec.time >> 8) & 0xFF;
+		buff[2] = (rec.time >> 16) & 0xFF;
+		buff[3] = (rec.time >> 24) & 0xFF;
+		buff[4] = rec.event;
+		buff[5] = rec.arg;
+		buff[6] = rec.value & 0xFF;
+		buff[7] = (rec.value >> 8) & 0xFF;
+
+		written += port.write(buff, sizeof(buff));
+	}
+
+	return written;
+}
+
+
+/*
+ void PacketTrace::clear()
+ Description:
+ ------------
+  * Drops every record held
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void PacketTrace::clear()
+{
+	head        = 0;
+	count       = 0;
+	overwritten = 0;
+}
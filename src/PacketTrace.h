@@ -0,0 +1,88 @@
+#pragma once
+#include "Arduino.h"
+
+
+#ifndef PACKET_TRACE_SIZE
+#define PACKET_TRACE_SIZE 256 // Records kept per PacketTrace, power of 2 (8 bytes each)
+#endif
+
+
+const uint8_t TRACE_RX_BYTE    = 1;    // arg = parser state, value = byte received
+const uint8_t TRACE_RX_PAYLOAD = 2;    // arg = parser state, value = payload bytes taken as one block
+const uint8_t TRACE_RX_STATUS  = 3;    // arg = status (NEW_DATA, CRC_ERROR, ...), value = bytes read
+const uint8_t TRACE_TX_PACKET  = 4;    // arg = packet ID, value = payload bytes on the wire
+const uint8_t TRACE_TX_COMMAND = 5;    // arg = 0, value = command, flags included
+const uint8_t TRACE_USER       = 0x80; // First event code free for the application
+
+const uint8_t TRACE_DUMP_VERSION = 1;
+
+
+struct traceRecordST
+{
+	uint32_t time;  // Tick of the packet clock
+	uint8_t  event; // TRACE_* code
+	uint8_t  arg;   // Depends on event
+	uint16_t value; // Depends on event
+};
+
+
+/*
+ class PacketTrace
+ Description:
+ ------------
+  * RAM ring of fixed-size binary event records, filled by Packet
+  (configST.trace) as it parses and constructs packets. Recording costs
+  a few stores, so tracing can stay on at full line rate without
+  changing timing the way printing does. Once full, the oldest records
+  are overwritten. dump() writes the records out in a compact binary
+  form, extras/tools/trace_decode.cpp renders them on a host
+*/
+class PacketTrace
+{
+  public: // <<---------------------------------------//public
+	uint32_t overwritten = 0; // Records lost to the ring wrapping since the last clear()
+
+
+	/*
+	 void PacketTrace::record(const uint8_t& event, const uint8_t& arg, const uint16_t& value, const uint32_t& time)
+	 Description:
+	 ------------
+	  * Adds one record, overwriting the oldest one if the ring is full
+	 Inputs:
+	 -------
+	  * const uint8_t& event - TRACE_* code
+	  * const uint8_t& arg - Event argument
+	  * const uint16_t& value - Event value
+	  * const uint32_t& time - Tick of the event
+	 Return:
+	 -------
+	  * void
+	*/
+	void record(const uint8_t& event, const uint8_t& arg, const uint16_t& value, const uint32_t& time)
+	{
+		traceRecordST& rec = records[head];
+
+		rec.time  = time;
+		rec.event = event;
+		rec.arg   = arg;
+		rec.value = value;
+
+		head = (head + 1) & (PACKET_TRACE_SIZE - 1);
+
+		if (count < PACKET_TRACE_SIZE)
+			count++;
+		else
+			overwritten++;
+	}
+
+	uint16_t size();
+	uint16_t read(traceRecordST arr[], const uint16_t& len);
+	size_t   dump(Stream& port);
+	void     clear();
+
+
+  private: // <<---------------------------------------//private
+	traceRecordST records[PACKET_TRACE_SIZE];
+	uint16_t      head  = 0; // Index the next record goes to
+	uint16_t      count = 0; // Records held
+};
@@ -0,0 +1,135 @@
+#include "PosixSerial.h"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <asm/termbits.h> // termios2/BOTHER - not compatible with <termios.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+
+
+/*
+ bool PosixSerial::begin(const char* path, const uint32_t& baud)
+ Description:
+ ------------
+  * Opens a serial port in raw, non-blocking mode
+ Inputs:
+ -------
+  * const char* path - Device to open (i.e. "/dev/ttyUSB0")
+  * const uint32_t& baud - Any baud rate the driver can generate,
+  not just the standard ones
+ Return:
+ -------
+  * bool - Whether or not the port was opened and configured
+*/
+bool PosixSerial::begin(const char* path, const uint32_t& baud)
+{
+	end();
+
+	fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+
+	if (fd < 0)
+		return false;
+
+	ownsFd = true;
+
+	if (!configure(baud))
+	{
+		end();
+		return false;
+	}
+
+	return true;
+}
+
+
+/*
+ bool PosixSerial::begin(const int& _fd, const uint32_t& baud)
+ Description:
+ ------------
+  * Wraps a tty file descriptor opened elsewhere (i.e. a pty master).
+  The descriptor is switched to raw, non-blocking mode but left open
+  by end()
+ Inputs:
+ -------
+  * const int& _fd - Open tty file descriptor
+  * const uint32_t& baud - Baud rate, 0 to leave it unchanged
+ Return:
+ -------
+  * bool - Whether or not the descriptor was configured
+*/
+bool PosixSerial::begin(const int& _fd, const uint32_t& baud)
+{
+	if (!PosixStream::begin(_fd))
+		return false;
+
+	return configure(baud);
+}
+
+
+/*
+ void PosixSerial::flush()
+ Description:
+ ------------
+  * Waits until every byte written has been transmitted
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void PosixSerial::flush()
+{
+	ioctl(fd, TCSBRK, 1); // tcdrain()
+}
+
+
+/*
+ bool PosixSerial::configure(const uint32_t& baud)
+ Description:
+ ------------
+  * Puts the port in raw 8N1 mode with non-blocking reads (VMIN = VTIME
+  = 0) and, through termios2/BOTHER, sets the exact baud rate requested
+ Inputs:
+ -------
+  * const uint32_t& baud - Baud rate, 0 to leave it unchanged
+ Return:
+ -------
+  * bool - Whether or not the port accepted the settings
+*/
+bool PosixSerial::configure(const uint32_t& baud)
+{
+	struct termios2 tio;
+
+	if (ioctl(fd, TCGETS2, &tio) < 0)
+		return false;
+
+	tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF | IXANY);
+	tio.c_oflag &= ~OPOST;
+	tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+	tio.c_cflag &= ~(CSIZE | PARENB | CSTOPB | CRTSCTS);
+	tio.c_cflag |= CS8 | CLOCAL | CREAD;
+
+	tio.c_cc[VMIN]  = 0;
+	tio.c_cc[VTIME] = 0;
+
+	if (baud)
+	{
+		tio.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+		tio.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+		tio.c_ispeed = baud;
+		tio.c_ospeed = baud;
+	}
+
+	if (ioctl(fd, TCSETS2, &tio) < 0)
+		return false;
+
+	ioctl(fd, TCFLSH, TCIOFLUSH); // Drop whatever arrived before the port was configured
+	rxLen = 0;
+	rxPos = 0;
+
+	return true;
+}
+
+
+#endif // defined(__linux__) && !defined(ARDUINO)
@@ -0,0 +1,32 @@
+#pragma once
+#include "Arduino.h"
+#include "PosixStream.h"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+
+/*
+ class PosixSerial
+ Description:
+ ------------
+  * Stream over a Linux serial port (or any tty/pty file descriptor)
+  so that SerialTransfer can run on the host end of a link. The port
+  is opened non-blocking in raw mode at an arbitrary baud rate
+  (termios2/BOTHER), received bytes are pulled from the kernel in
+  bulk into a buffer, and SerialTransfer sends each frame with a
+  single writev() syscall
+*/
+class PosixSerial : public PosixStream
+{
+  public: // <<---------------------------------------//public
+	bool begin(const char* path, const uint32_t& baud);
+	bool begin(const int& _fd, const uint32_t& baud = 0);
+	void flush();
+
+
+  private: // <<---------------------------------------//private
+	bool configure(const uint32_t& baud);
+};
+
+
+#endif // defined(__linux__) && !defined(ARDUINO)
@@ -0,0 +1,172 @@
+#include "PosixSocket.h"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <poll.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+/*
+ bool PosixSocket::connect(const char* path, const int& type)
+ Description:
+ ------------
+  * Connects to a socket another process is accepting on
+ Inputs:
+ -------
+  * const char* path - Filesystem path of the socket
+  * const int& type - SOCK_STREAM or SOCK_SEQPACKET, must match the
+  other end
+ Return:
+ -------
+  * bool - Whether or not the socket is connected
+*/
+bool PosixSocket::connect(const char* path, const int& type)
+{
+	struct sockaddr_un addr;
+	int                sock;
+
+	end();
+
+	if (strlen(path) >= sizeof(addr.sun_path))
+		return false;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	sock = socket(AF_UNIX, type | SOCK_CLOEXEC, 0);
+
+	if (sock < 0)
+		return false;
+
+	if (::connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+	{
+		close(sock);
+		return false;
+	}
+
+	return adopt(sock);
+}
+
+
+/*
+ bool PosixSocket::accept(const char* path, const int& type, const uint32_t& waitMs)
+ Description:
+ ------------
+  * Creates a socket at "path" and waits for one peer to connect. The
+  path is removed again once the peer is connected
+ Inputs:
+ -------
+  * const char* path - Filesystem path of the socket, replaced if it
+  already exists
+  * const int& type - SOCK_STREAM or SOCK_SEQPACKET
+  * const uint32_t& waitMs - Max ms to wait for the peer
+ Return:
+ -------
+  * bool - Whether or not a peer connected
+*/
+bool PosixSocket::accept(const char* path, const int& type, const uint32_t& waitMs)
+{
+	struct sockaddr_un addr;
+	struct pollfd      pfd;
+	int                listener;
+	int                sock = -1;
+
+	end();
+
+	if (strlen(path) >= sizeof(addr.sun_path))
+		return false;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+	unlink(path);
+
+	listener = socket(AF_UNIX, type | SOCK_CLOEXEC, 0);
+
+	if (listener < 0)
+		return false;
+
+	if (!bind(listener, (struct sockaddr*)&addr, sizeof(addr)) && !listen(listener, 1))
+	{
+		pfd.fd     = listener;
+		pfd.events = POLLIN;
+
+		if (poll(&pfd, 1, waitMs) > 0)
+			sock = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+	}
+
+	close(listener);
+	unlink(path);
+
+	if (sock < 0)
+		return false;
+
+	return adopt(sock);
+}
+
+
+/*
+ bool PosixSocket::pair(PosixSocket& a, PosixSocket& b, const int& type)
+ Description:
+ ------------
+  * Connects two sockets to each other (socketpair()), i.e. for a link
+  between two threads of one process
+ Inputs:
+ -------
+  * PosixSocket& a - One end of the link
+  * PosixSocket& b - The other end
+  * const int& type - SOCK_STREAM or SOCK_SEQPACKET
+ Return:
+ -------
+  * bool - Whether or not the link was created
+*/
+bool PosixSocket::pair(PosixSocket& a, PosixSocket& b, const int& type)
+{
+	int socks[2];
+
+	a.end();
+	b.end();
+
+	if (socketpair(AF_UNIX, type | SOCK_CLOEXEC, 0, socks) < 0)
+		return false;
+
+	if (!a.adopt(socks[0]))
+	{
+		close(socks[1]);
+		return false;
+	}
+
+	return b.adopt(socks[1]);
+}
+
+
+/*
+ bool PosixSocket::adopt(const int& _fd)
+ Description:
+ ------------
+  * Takes ownership of a connected socket - end() closes it
+ Inputs:
+ -------
+  * const int& _fd - Connected socket
+ Return:
+ -------
+  * bool - Whether or not the socket could be used
+*/
+bool PosixSocket::adopt(const int& _fd)
+{
+	if (!begin(_fd))
+	{
+		close(_fd);
+		fd = -1;
+		return false;
+	}
+
+	ownsFd = true;
+
+	return true;
+}
+
+
+#endif // defined(__linux__) && !defined(ARDUINO)
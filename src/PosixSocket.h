@@ -0,0 +1,33 @@
+#pragma once
+#include "Arduino.h"
+#include "PosixStream.h"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <sys/socket.h>
+
+
+/*
+ class PosixSocket
+ Description:
+ ------------
+  * Stream over a Unix domain socket, to run simulated links between
+  processes (or threads) without serial hardware. SOCK_STREAM behaves
+  like a UART, SOCK_SEQPACKET keeps the boundaries of every write so a
+  frame sent by SerialTransfer is delivered (or lost) as a whole
+*/
+class PosixSocket : public PosixStream
+{
+  public: // <<---------------------------------------//public
+	bool connect(const char* path, const int& type = SOCK_STREAM);
+	bool accept(const char* path, const int& type = SOCK_STREAM, const uint32_t& waitMs = 1000);
+
+	static bool pair(PosixSocket& a, PosixSocket& b, const int& type = SOCK_STREAM);
+
+
+  private: // <<---------------------------------------//private
+	bool adopt(const int& _fd);
+};
+
+
+#endif // defined(__linux__) && !defined(ARDUINO)
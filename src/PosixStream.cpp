@@ -0,0 +1,387 @@
+#include "PosixStream.h"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+
+/*
+ PosixStream::~PosixStream()
+ Description:
+ ------------
+  * Closes the descriptor if it was opened by the stream
+*/
+PosixStream::~PosixStream()
+{
+	end();
+}
+
+
+/*
+ bool PosixStream::begin(const int& _fd)
+ Description:
+ ------------
+  * Wraps a file descriptor opened elsewhere. The descriptor is
+  switched to non-blocking mode but left open by end()
+ Inputs:
+ -------
+  * const int& _fd - Open file descriptor
+ Return:
+ -------
+  * bool - Whether or not the descriptor could be used
+*/
+bool PosixStream::begin(const int& _fd)
+{
+	end();
+
+	fd     = _fd;
+	ownsFd = false;
+
+	return fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) >= 0;
+}
+
+
+/*
+ void PosixStream::end()
+ Description:
+ ------------
+  * Releases the descriptor and drops buffered bytes
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void PosixStream::end()
+{
+	if ((fd >= 0) && ownsFd)
+		close(fd);
+
+	fd     = -1;
+	ownsFd = false;
+	rxLen  = 0;
+	rxPos  = 0;
+}
+
+
+/*
+ int PosixStream::available()
+ Description:
+ ------------
+  * Returns the number of buffered bytes, pulling whatever the kernel
+  holds into the buffer once it has run dry
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * int - Number of bytes that can be read without blocking
+*/
+int PosixStream::available()
+{
+	if (rxPos == rxLen)
+		fill();
+
+	return rxLen - rxPos;
+}
+
+
+/*
+ int PosixStream::read()
+ Description:
+ ------------
+  * Reads the next received byte
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * int - Next byte, -1 if none has been received
+*/
+int PosixStream::read()
+{
+	if ((rxPos == rxLen) && !fill())
+		return -1;
+
+	return rxBuff[rxPos++];
+}
+
+
+/*
+ int PosixStream::peek()
+ Description:
+ ------------
+  * Returns the next received byte without consuming it
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * int - Next byte, -1 if none has been received
+*/
+int PosixStream::peek()
+{
+	if ((rxPos == rxLen) && !fill())
+		return -1;
+
+	return rxBuff[rxPos];
+}
+
+
+/*
+ size_t PosixStream::readAvailable(uint8_t arr[], const size_t& len)
+ Description:
+ ------------
+  * Copies up to "len" received bytes without blocking
+ Inputs:
+ -------
+  * uint8_t arr[] - Buffer to copy received bytes into
+  * const size_t& len - Size of arr[]
+ Return:
+ -------
+  * size_t - Number of bytes copied into arr[]
+*/
+size_t PosixStream::readAvailable(uint8_t arr[], const size_t& len)
+{
+	size_t count = rxLen - rxPos;
+
+	if (!count)
+		count = fill();
+
+	if (count > len)
+		count = len;
+
+	memcpy(arr, rxBuff + rxPos, count);
+	rxPos += count;
+
+	return count;
+}
+
+
+/*
+ bool PosixStream::waitAvailable(const uint32_t& waitMs)
+ Description:
+ ------------
+  * Sleeps until bytes are received instead of spinning on available()
+ Inputs:
+ -------
+  * const uint32_t& waitMs - Max ms to sleep
+ Return:
+ -------
+  * bool - Whether or not bytes can be read
+*/
+bool PosixStream::waitAvailable(const uint32_t& waitMs)
+{
+	struct pollfd pfd;
+
+	if (rxPos < rxLen)
+		return true;
+
+	pfd.fd     = fd;
+	pfd.events = POLLIN;
+
+	if (poll(&pfd, 1, waitMs) <= 0)
+		return false;
+
+	return available() > 0;
+}
+
+
+/*
+ size_t PosixStream::write(uint8_t val)
+ Description:
+ ------------
+  * Writes a single byte
+ Inputs:
+ -------
+  * uint8_t val - Byte to write
+ Return:
+ -------
+  * size_t - Number of bytes written
+*/
+size_t PosixStream::write(uint8_t val)
+{
+	return write(&val, 1);
+}
+
+
+/*
+ size_t PosixStream::write(const uint8_t* buffer, size_t size)
+ Description:
+ ------------
+  * Writes a block of bytes, waiting for the port to drain (at most
+  the Stream timeout at a time) if the kernel buffer is full
+ Inputs:
+ -------
+  * const uint8_t* buffer - Bytes to write
+  * size_t size - Number of bytes in buffer
+ Return:
+ -------
+  * size_t - Number of bytes written
+*/
+size_t PosixStream::write(const uint8_t* buffer, size_t size)
+{
+	struct iovec iov;
+
+	iov.iov_base = (void*)buffer;
+	iov.iov_len  = size;
+
+	return writeAll(&iov, 1);
+}
+
+
+/*
+ size_t PosixStream::writeFrame(const uint8_t preamble[], const size_t& preambleLen, const uint8_t payload[], const size_t& payloadLen, const uint8_t postamble[], const size_t& postambleLen)
+ Description:
+ ------------
+  * Writes a whole frame with a single writev() syscall instead of one
+  write() per part
+ Inputs:
+ -------
+  * const uint8_t preamble[] - Frame preamble
+  * const size_t& preambleLen - Number of bytes in preamble[]
+  * const uint8_t payload[] - Stuffed payload
+  * const size_t& payloadLen - Number of bytes in payload[]
+  * const uint8_t postamble[] - Frame postamble
+  * const size_t& postambleLen - Number of bytes in postamble[]
+ Return:
+ -------
+  * size_t - Number of bytes written
+*/
+size_t PosixStream::writeFrame(const uint8_t preamble[], const size_t& preambleLen, const uint8_t payload[], const size_t& payloadLen, const uint8_t postamble[], const size_t& postambleLen)
+{
+	struct iovec iov[3];
+
+	iov[0].iov_base = (void*)preamble;
+	iov[0].iov_len  = preambleLen;
+	iov[1].iov_base = (void*)payload;
+	iov[1].iov_len  = payloadLen;
+	iov[2].iov_base = (void*)postamble;
+	iov[2].iov_len  = postambleLen;
+
+	return writeAll(iov, 3);
+}
+
+
+/*
+ int PosixStream::fileDescriptor()
+ Description:
+ ------------
+  * Returns the port's file descriptor, i.e. to add it to an epoll set
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * int - File descriptor, -1 if the port is closed
+*/
+int PosixStream::fileDescriptor()
+{
+	return fd;
+}
+
+
+/*
+ size_t PosixStream::fill()
+ Description:
+ ------------
+  * Refills the empty receive buffer with a single non-blocking read()
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * size_t - Number of bytes buffered
+*/
+size_t PosixStream::fill()
+{
+	ssize_t count;
+
+	rxLen = 0;
+	rxPos = 0;
+
+	if (fd < 0)
+		return 0;
+
+	do
+		count = ::read(fd, rxBuff, sizeof(rxBuff));
+	while ((count < 0) && (errno == EINTR));
+
+	if (count > 0)
+		rxLen = count;
+
+	return rxLen;
+}
+
+
+/*
+ size_t PosixStream::writeAll(struct iovec iov[], int count)
+ Description:
+ ------------
+  * Writes every byte described by iov[], polling for the port to
+  drain whenever the kernel buffer fills. Gives up if the port does
+  not drain within the Stream timeout
+ Inputs:
+ -------
+  * struct iovec iov[] - Parts to write, advanced as they are written
+  * int count - Number of parts in iov[]
+ Return:
+ -------
+  * size_t - Number of bytes written
+*/
+size_t PosixStream::writeAll(struct iovec iov[], int count)
+{
+	size_t total = 0;
+
+	if (fd < 0)
+		return 0;
+
+	while (count)
+	{
+		ssize_t written = writev(fd, iov, count);
+
+		if (written < 0)
+		{
+			struct pollfd pfd;
+
+			if (errno == EINTR)
+				continue;
+
+			if (errno != EAGAIN)
+				break;
+
+			pfd.fd     = fd;
+			pfd.events = POLLOUT;
+
+			if (poll(&pfd, 1, timeout) <= 0)
+				break;
+
+			continue;
+		}
+
+		total += written;
+
+		while (count && ((size_t)written >= iov->iov_len)) // Skip the parts written in full
+		{
+			written -= iov->iov_len;
+			iov++;
+			count--;
+		}
+
+		if (count)
+		{
+			iov->iov_base = (uint8_t*)iov->iov_base + written;
+			iov->iov_len -= written;
+		}
+	}
+
+	return total;
+}
+
+
+#endif // defined(__linux__) && !defined(ARDUINO)
@@ -0,0 +1,57 @@
+#pragma once
+#include "Arduino.h"
+#include "BulkStream.h"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+
+#ifndef POSIX_STREAM_RX_SIZE
+#define POSIX_STREAM_RX_SIZE 4096 // Max bytes pulled from the kernel per read() syscall
+#endif
+
+struct iovec;
+
+
+/*
+ class PosixStream
+ Description:
+ ------------
+  * BulkStream over a non-blocking Linux file descriptor. Received
+  bytes are pulled from the kernel in bulk into a buffer and each
+  frame is sent with a single writev() syscall. PosixSerial and
+  PosixSocket open and set up the descriptor
+*/
+class PosixStream : public BulkStream
+{
+  public: // <<---------------------------------------//public
+	virtual ~PosixStream();
+	bool   begin(const int& _fd);
+	void   end();
+	int    available();
+	int    read();
+	int    peek();
+	size_t readAvailable(uint8_t arr[], const size_t& len);
+	bool   waitAvailable(const uint32_t& waitMs);
+	size_t write(uint8_t val);
+	size_t write(const uint8_t* buffer, size_t size);
+	size_t writeFrame(const uint8_t preamble[], const size_t& preambleLen, const uint8_t payload[], const size_t& payloadLen, const uint8_t postamble[], const size_t& postambleLen);
+	int    fileDescriptor();
+
+	using Print::write;
+
+
+  protected: // <<---------------------------------------//protected
+	int  fd     = -1;
+	bool ownsFd = false; // Whether or not end() closes fd
+
+	uint8_t rxBuff[POSIX_STREAM_RX_SIZE];
+	size_t  rxLen = 0; // Bytes in rxBuff
+	size_t  rxPos = 0; // Next byte of rxBuff to hand out
+
+
+	size_t fill();
+	size_t writeAll(struct iovec iov[], int count);
+};
+
+
+#endif // defined(__linux__) && !defined(ARDUINO)
@@ -0,0 +1,729 @@
+#include "ReliableTransfer.h"
+
+
+/*
+ void ReliableTransfer::begin(SerialTransfer& _transfer, const uint8_t& _windowSize, const uint32_t& _ackDelay)
+ Description:
+ ------------
+  * Initializer for the ReliableTransfer Class. Both ends of the link
+  must use the same window size
+ Inputs:
+ -------
+  * SerialTransfer& _transfer - Initialized link to deliver packets
+  over. All of its traffic is owned by this class from now on
+  * const uint8_t& _windowSize - Max number of unacknowledged packets
+  in flight (clamped to RELIABLE_WINDOW_SIZE)
+  * const uint32_t& _ackDelay - Number of ticks of the link's clock to hold back a pure ACK
+  in the hope of piggybacking it on reverse traffic
+ Return:
+ -------
+  * void
+*/
+void ReliableTransfer::begin(SerialTransfer& _transfer, const uint8_t& _windowSize, const uint32_t& _ackDelay)
+{
+	transfer   = &_transfer;
+	windowSize = _windowSize;
+	ackDelay   = _ackDelay;
+
+	if (!windowSize || (windowSize > RELIABLE_SLOTS))
+		windowSize = RELIABLE_SLOTS;
+
+	reset();
+}
+
+
+/*
+ uint16_t ReliableTransfer::send(const uint8_t data[], const uint16_t& len, const uint16_t command)
+ Description:
+ ------------
+  * Queues a payload for reliable, in-order delivery and transmits it
+  right away. The payload is kept until the peer acknowledges it and
+  is retransmitted on its own if it times out (selective repeat)
+ Inputs:
+ -------
+  * const uint8_t data[] - Payload to send
+  * const uint16_t& len - Number of bytes in data[] (at most
+  RELIABLE_MAX_PAYLOAD, less with FEC or timestamps)
+  * const uint16_t command - The packet 16-bit command
+ Return:
+ -------
+  * uint16_t - Number of payload bytes queued (0 if the window is full
+  or the link did not take the packet, i.e. flow control refused it)
+*/
+uint16_t ReliableTransfer::send(const uint8_t data[], const uint16_t& len, const uint16_t command)
+{
+	if (!canSend() || !len)
+		return 0;
+
+	uint8_t  seq     = txNext;
+	txSlot&  slot    = txSlots[seq % RELIABLE_SLOTS];
+	uint16_t size    = len;
+	uint16_t maxSize = transfer->packet.maxPayload() - RELIABLE_HEADER_SIZE; // Less FEC parity and timestamp
+
+	if (maxSize > RELIABLE_MAX_PAYLOAD)
+		maxSize = RELIABLE_MAX_PAYLOAD;
+
+	if (len > maxSize)
+		size = maxSize;
+
+	memcpy(slot.data, data, size);
+	slot.len           = size;
+	slot.command       = command & ~COMMAND_FLAGS;
+	slot.acked         = false;
+	slot.retransmitted = false;
+
+	if (!transmit(seq)) // Never went out - don't time it or wait for its ACK
+		return 0;
+
+	txNext++;
+
+	return size;
+}
+
+
+/*
+ bool ReliableTransfer::canSend()
+ Description:
+ ------------
+  * Checks whether or not the send window has room for another payload
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not send() will accept a payload
+*/
+bool ReliableTransfer::canSend()
+{
+	return inFlight() < windowSize;
+}
+
+
+/*
+ uint8_t ReliableTransfer::inFlight()
+ Description:
+ ------------
+  * Returns the number of sent payloads not yet acknowledged
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint8_t - Number of payloads in flight
+*/
+uint8_t ReliableTransfer::inFlight()
+{
+	return (uint8_t)(txNext - txBase);
+}
+
+
+/*
+ uint16_t ReliableTransfer::available()
+ Description:
+ ------------
+  * Parses all incoming packets, processes the ACKs they carry,
+  retransmits timed out payloads and delivers the next in-order
+  payload, if any. The delivered payload stays valid until the next
+  call
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t bytesRead - Num bytes in the delivered payload
+*/
+uint16_t ReliableTransfer::available()
+{
+	if (rxHeld) // The user is done with the last delivered payload
+	{
+		rxSlots[rxHeldSlot].valid = false;
+		rxHeld                    = false;
+	}
+
+	while (transfer->available())
+		processPacket();
+
+	serviceTimers();
+
+	rxSlot& next = rxSlots[rxBase % RELIABLE_SLOTS];
+
+	if (next.valid)
+	{
+		rxHeld     = true;
+		rxHeldSlot = rxBase % RELIABLE_SLOTS;
+		rxBase++;
+		bytesRead  = next.len;
+		status     = NEW_DATA;
+	}
+	else
+	{
+		bytesRead = 0;
+		status    = NO_DATA;
+	}
+
+	return bytesRead;
+}
+
+
+/*
+ bool ReliableTransfer::tick()
+ Description:
+ ------------
+  * Wrapper around the method "available()"
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not a payload was delivered
+*/
+bool ReliableTransfer::tick()
+{
+	if (available())
+		return true;
+
+	return false;
+}
+
+
+/*
+ uint16_t ReliableTransfer::currentCommand()
+ Description:
+ ------------
+  * Returns the command of the last delivered payload
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - command of the last delivered payload
+*/
+uint16_t ReliableTransfer::currentCommand()
+{
+	return rxSlots[rxHeldSlot].command;
+}
+
+
+/*
+ uint32_t ReliableTransfer::currentRTO()
+ Description:
+ ------------
+  * Returns the current retransmit timeout
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint32_t - retransmit timeout in ticks of the link's clock
+*/
+uint32_t ReliableTransfer::currentRTO()
+{
+	return rto;
+}
+
+
+/*
+ uint32_t ReliableTransfer::smoothedRTT()
+ Description:
+ ------------
+  * Returns the smoothed round trip time measured from ACKs
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint32_t - smoothed round trip time in ticks of the link's clock (0 until measured)
+*/
+uint32_t ReliableTransfer::smoothedRTT()
+{
+	return srtt >> 3;
+}
+
+
+/*
+ uint32_t ReliableTransfer::retransmissions()
+ Description:
+ ------------
+  * Returns the number of payloads retransmitted so far
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint32_t - number of retransmissions
+*/
+uint32_t ReliableTransfer::retransmissions()
+{
+	return retransmit;
+}
+
+
+/*
+ uint32_t ReliableTransfer::checksumErrors()
+ Description:
+ ------------
+  * Returns the number of packets dropped for failing the CRC-16 check
+  - corruption the link's CRC-8 let through
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint32_t - number of packets dropped
+*/
+uint32_t ReliableTransfer::checksumErrors()
+{
+	return badChecks;
+}
+
+
+/*
+ void ReliableTransfer::reset()
+ Description:
+ ------------
+  * Drops all queued and buffered payloads and restarts the sequence
+  numbers and RTT estimate
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void ReliableTransfer::reset()
+{
+	for (uint8_t i = 0; i < RELIABLE_SLOTS; i++)
+	{
+		txSlots[i].acked = true;
+		rxSlots[i].valid = false;
+	}
+
+	txBase     = 0;
+	txNext     = 0;
+	rxBase     = 0;
+	rxHeld     = false;
+	ackPending = false;
+	rttValid   = false;
+	srtt       = 0;
+	rttvar     = 0;
+	rto        = RELIABLE_INITIAL_RTO;
+	backoff    = 0;
+	bytesRead  = 0;
+	status     = NO_DATA;
+}
+
+
+/*
+ bool ReliableTransfer::transmit(const uint8_t& seq)
+ Description:
+ ------------
+  * Sends the payload queued under sequence number "seq" with the
+  current cumulative/selective ACK piggybacked in its header. Its
+  send time is only updated if the packet went out
+ Inputs:
+ -------
+  * const uint8_t& seq - Sequence number of the payload to send
+ Return:
+ -------
+  * bool - Whether or not the link took the whole packet
+*/
+bool ReliableTransfer::transmit(const uint8_t& seq)
+{
+	txSlot& slot = txSlots[seq % RELIABLE_SLOTS];
+
+	writeHeader(seq, slot.command, slot.data, slot.len);
+	memcpy(transfer->packet.txBuff + RELIABLE_HEADER_SIZE, slot.data, slot.len);
+
+	if (transfer->sendData(slot.len + RELIABLE_HEADER_SIZE, slot.command | RELIABLE_FLAG) != (slot.len + RELIABLE_HEADER_SIZE))
+		return false;
+
+	slot.sentAt = transfer->packet.now();
+	ackPending  = false;
+
+	return true;
+}
+
+
+/*
+ void ReliableTransfer::sendAck()
+ Description:
+ ------------
+  * Sends a header-only packet carrying the current
+  cumulative/selective ACK
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void ReliableTransfer::sendAck()
+{
+	writeHeader(txNext, 0, NULL, 0);
+
+	if (transfer->sendData(RELIABLE_HEADER_SIZE, RELIABLE_FLAG)) // Else still due, tried again next time
+		ackPending = false;
+}
+
+
+/*
+ void ReliableTransfer::processPacket()
+ Description:
+ ------------
+  * Processes the ACK carried by the packet just parsed and buffers
+  its payload, if any, into the receive window
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void ReliableTransfer::processPacket()
+{
+	uint8_t* buff = transfer->packet.rxBuff;
+	uint16_t len  = transfer->packet.currentReceived();
+
+	if ((transfer->status != NEW_DATA) || !(transfer->packet.currentFlags() & RELIABLE_FLAG) || (len < RELIABLE_HEADER_SIZE))
+		return;
+
+	if (checksum(buff, transfer->currentCommand(), buff + RELIABLE_HEADER_SIZE, len - RELIABLE_HEADER_SIZE) != (((uint16_t)buff[4] << 8) | buff[5]))
+	{
+		badChecks++;
+		return;
+	}
+
+	processAck(buff[1], ((uint16_t)buff[2] << 8) | buff[3]);
+
+	if ((len == RELIABLE_HEADER_SIZE) || ((len - RELIABLE_HEADER_SIZE) > RELIABLE_MAX_PAYLOAD)) // Pure ACK, or more than a slot holds (peer built with a larger RELIABLE_PAYLOAD_SIZE)
+		return;
+
+	uint8_t seq      = buff[0];
+	uint8_t distance = seq - rxBase;
+
+	if (!ackPending)
+		ackPendingSince = transfer->packet.now();
+	ackPending = true; // Duplicates are re-acknowledged in case our last ACK was lost
+
+	if (distance >= windowSize)
+		return;
+
+	rxSlot& slot = rxSlots[seq % RELIABLE_SLOTS];
+
+	if (slot.valid) // Duplicate, or its slot is still on loan to the user
+		return;
+
+	slot.len     = len - RELIABLE_HEADER_SIZE;
+	slot.command = transfer->currentCommand();
+	slot.valid   = true;
+	memcpy(slot.data, buff + RELIABLE_HEADER_SIZE, slot.len);
+}
+
+
+/*
+ void ReliableTransfer::processAck(const uint8_t& ack, const uint16_t& sack)
+ Description:
+ ------------
+  * Marks payloads acknowledged by the peer, takes an RTT sample and
+  slides the send window forward
+ Inputs:
+ -------
+  * const uint8_t& ack - Next sequence number the peer expects
+  * const uint16_t& sack - Selective ACK bitmap, bit i set if the peer
+  holds sequence number ack+1+i
+ Return:
+ -------
+  * void
+*/
+void ReliableTransfer::processAck(const uint8_t& ack, const uint16_t& sack)
+{
+	uint8_t  acked   = ack - txBase;
+	uint32_t now     = transfer->packet.now();
+	bool     sampled  = false;
+	bool     progress = false;
+	uint32_t sample   = 0;
+
+	if (acked > inFlight()) // Stale or bogus ACK
+		return;
+
+	for (uint8_t i = 0; i < inFlight(); i++)
+	{
+		uint8_t seq  = txBase + i;
+		txSlot& slot = txSlots[seq % RELIABLE_SLOTS];
+		bool    hit  = (i < acked);
+
+		if (!hit)
+		{
+			uint8_t bit = seq - ack - 1;
+			hit         = (bit < 16) && (sack & (1 << bit));
+		}
+
+		if (hit && !slot.acked)
+		{
+			slot.acked = true;
+			progress   = true;
+
+			if (!slot.retransmitted) // Karn's algorithm - retransmitted payloads give ambiguous samples
+			{
+				sample  = now - slot.sentAt;
+				sampled = true;
+			}
+		}
+	}
+
+	if (progress) // The path works again, drop the backoff
+		backoff = 0;
+
+	if (sampled)
+		updateRTO(sample);
+	else if (progress)
+		setRTO();
+
+	while ((txBase != txNext) && txSlots[txBase % RELIABLE_SLOTS].acked)
+		txBase++;
+}
+
+
+/*
+ void ReliableTransfer::updateRTO(const uint32_t& sample)
+ Description:
+ ------------
+  * Folds an RTT sample into the smoothed RTT and RTT variance
+  (Jacobson/Karels) and recomputes the retransmit timeout
+ Inputs:
+ -------
+  * const uint32_t& sample - Measured round trip time in ticks
+ Return:
+ -------
+  * void
+*/
+void ReliableTransfer::updateRTO(const uint32_t& sample)
+{
+	if (!rttValid)
+	{
+		srtt     = sample << 3;
+		rttvar   = sample << 1;
+		rttValid = true;
+	}
+	else
+	{
+		int32_t delta = (int32_t)sample - (int32_t)(srtt >> 3);
+
+		if (delta < 0)
+			delta = -delta;
+
+		srtt   = srtt - (srtt >> 3) + sample;             // srtt = 7/8 srtt + 1/8 sample
+		rttvar = rttvar - (rttvar >> 2) + (uint32_t)delta; // rttvar = 3/4 rttvar + 1/4 |delta|
+	}
+
+	setRTO();
+}
+
+
+/*
+ void ReliableTransfer::setRTO()
+ Description:
+ ------------
+  * Recomputes the retransmit timeout from the RTT estimate (the
+  initial RTO until there is one), doubled once per backoff
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void ReliableTransfer::setRTO()
+{
+	rto = rttValid ? ((srtt >> 3) + rttvar) : RELIABLE_INITIAL_RTO;
+
+	if (rto < RELIABLE_MIN_RTO)
+		rto = RELIABLE_MIN_RTO;
+
+	for (uint8_t i = 0; (i < backoff) && (rto < RELIABLE_MAX_RTO); i++)
+		rto <<= 1;
+
+	if (rto > RELIABLE_MAX_RTO)
+		rto = RELIABLE_MAX_RTO;
+}
+
+
+/*
+ void ReliableTransfer::serviceTimers()
+ Description:
+ ------------
+  * Retransmits every payload in flight whose timer expired and sends
+  a pure ACK if one is due and could not be piggybacked
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void ReliableTransfer::serviceTimers()
+{
+	uint32_t now     = transfer->packet.now();
+	bool     expired = false;
+
+	for (uint8_t i = 0; i < inFlight(); i++)
+	{
+		uint8_t seq  = txBase + i;
+		txSlot& slot = txSlots[seq % RELIABLE_SLOTS];
+
+		if (!slot.acked && ((now - slot.sentAt) >= rto))
+		{
+			expired = true;
+
+			if (!transmit(seq)) // Still due, tried again next time
+				continue;
+
+			slot.retransmitted = true;
+			retransmit++;
+		}
+	}
+
+	if (expired && (backoff < RELIABLE_MAX_BACKOFF) && ((now - backoffAt) >= rto)) // Back off once per RTO, not once per payload, until something is acknowledged
+	{
+		backoff++;
+		backoffAt = now;
+		setRTO();
+	}
+
+	if (ackPending && ((now - ackPendingSince) >= ackDelay))
+		sendAck();
+}
+
+
+/*
+ uint8_t ReliableTransfer::ackNumber()
+ Description:
+ ------------
+  * Finds the cumulative ACK - the first sequence number not yet
+  received. Payloads buffered but not yet delivered count as received
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint8_t - Cumulative ACK
+*/
+uint8_t ReliableTransfer::ackNumber()
+{
+	uint8_t ack = rxBase;
+
+	while (((uint8_t)(ack - rxBase) < windowSize) && rxSlots[ack % RELIABLE_SLOTS].valid && !(rxHeld && ((ack % RELIABLE_SLOTS) == rxHeldSlot)))
+		ack++;
+
+	return ack;
+}
+
+
+/*
+ uint16_t ReliableTransfer::sackBits(const uint8_t& ack)
+ Description:
+ ------------
+  * Builds the selective ACK bitmap for payloads buffered beyond the
+  cumulative ACK
+ Inputs:
+ -------
+  * const uint8_t& ack - Cumulative ACK the bitmap is relative to
+ Return:
+ -------
+  * uint16_t - Selective ACK bitmap
+*/
+uint16_t ReliableTransfer::sackBits(const uint8_t& ack)
+{
+	uint16_t sack = 0;
+
+	for (uint8_t i = 0; i < 16; i++)
+	{
+		uint8_t seq = ack + 1 + i;
+
+		if ((uint8_t)(seq - rxBase) >= windowSize)
+			break;
+
+		if (rxSlots[seq % RELIABLE_SLOTS].valid && !(rxHeld && ((seq % RELIABLE_SLOTS) == rxHeldSlot))) // The held slot is still the user's, not a payload received
+			sack |= 1 << i;
+	}
+
+	return sack;
+}
+
+
+/*
+ void ReliableTransfer::writeHeader(const uint8_t& seq, const uint16_t& command, const uint8_t data[], const uint16_t& len)
+ Description:
+ ------------
+  * Writes the header of the next packet to txBuff with the current
+  cumulative/selective ACK and the CRC-16 of the packet
+ Inputs:
+ -------
+  * const uint8_t& seq - Sequence number of the packet
+  * const uint16_t& command - The packet 16-bit command (flags excluded)
+  * const uint8_t data[] - Payload of the packet
+  * const uint16_t& len - Number of bytes in data[]
+ Return:
+ -------
+  * void
+*/
+void ReliableTransfer::writeHeader(const uint8_t& seq, const uint16_t& command, const uint8_t data[], const uint16_t& len)
+{
+	uint8_t* header = transfer->packet.txBuff;
+	uint8_t  ack    = ackNumber();
+	uint16_t sack   = sackBits(ack);
+
+	header[0] = seq;
+	header[1] = ack;
+	header[2] = (sack >> 8) & 0xFF;
+	header[3] = sack & 0xFF;
+
+	uint16_t check = checksum(header, command, data, len);
+
+	header[4] = (check >> 8) & 0xFF;
+	header[5] = check & 0xFF;
+}
+
+
+/*
+ uint16_t ReliableTransfer::checksum(const uint8_t header[], const uint16_t& command, const uint8_t data[], const uint16_t& len)
+ Description:
+ ------------
+  * CRC-16/CCITT (polynomial 0x1021, nibble at a time) of the command,
+  the first four header bytes and the payload. The link's CRC-8
+  misses about 1 in 256 corrupted frames and does not cover the
+  command at all - this keeps those away from the application
+ Inputs:
+ -------
+  * const uint8_t header[] - Packet header
+  * const uint16_t& command - The packet 16-bit command (flags excluded)
+  * const uint8_t data[] - Payload
+  * const uint16_t& len - Number of bytes in data[]
+ Return:
+ -------
+  * uint16_t - CRC-16
+*/
+uint16_t ReliableTransfer::checksum(const uint8_t header[], const uint16_t& command, const uint8_t data[], const uint16_t& len)
+{
+	static const uint16_t table[16] = {0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	                                   0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF};
+
+	uint16_t crc16 = 0xFFFF;
+
+	for (uint16_t i = 0; i < (2 + 4 + len); i++)
+	{
+		uint8_t val;
+
+		if (i < 2)
+			val = (i ? command : (command >> 8)) & 0xFF;
+		else if (i < 6)
+			val = header[i - 2];
+		else
+			val = data[i - 6];
+
+		crc16 = (crc16 << 4) ^ table[(crc16 >> 12) ^ (val >> 4)];
+		crc16 = (crc16 << 4) ^ table[(crc16 >> 12) ^ (val & 0x0F)];
+	}
+
+	return crc16;
+}
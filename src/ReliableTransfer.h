@@ -0,0 +1,240 @@
+/*
+00000101 00000011 00000000 00000101 10110010 01101100 ... payload ...
+|      | |      | |               | |               | |___User payload (none for a pure ACK)
+|      | |      | |               | |_______________|_______CRC-16 of the command, the rest of the header and the payload
+|      | |      | |_______________|_______________________Selective ACK bitmap (bit i = seq ack+1+i received)
+|      | |______|_______________________________________Cumulative ACK (next sequence number expected)
+|______|________________________________________________Sequence number
+*/
+
+#pragma once
+#include "Arduino.h"
+#include "SerialTransfer.h"
+
+
+const uint8_t RELIABLE_HEADER_SIZE = 6;
+const uint8_t RELIABLE_MAX_WINDOW  = 16; // Limited by the width of the selective ACK bitmap
+
+#if defined(__AVR__)
+#ifndef RELIABLE_WINDOW_SIZE
+#define RELIABLE_WINDOW_SIZE 4 // Max packets in flight, a power of 2 no larger than RELIABLE_MAX_WINDOW
+#endif
+
+#ifndef RELIABLE_PAYLOAD_SIZE
+#define RELIABLE_PAYLOAD_SIZE 64 // Largest payload send() takes - each of the RELIABLE_WINDOW_SIZE send and receive slots holds one
+#endif
+#else
+#ifndef RELIABLE_WINDOW_SIZE
+#define RELIABLE_WINDOW_SIZE 8 // Max packets in flight, a power of 2 no larger than RELIABLE_MAX_WINDOW
+#endif
+
+#ifndef RELIABLE_PAYLOAD_SIZE
+#define RELIABLE_PAYLOAD_SIZE (MAX_PACKET_SIZE - RELIABLE_HEADER_SIZE) // Largest payload send() takes - each of the RELIABLE_WINDOW_SIZE send and receive slots holds one
+#endif
+#endif
+
+const uint16_t RELIABLE_MAX_PAYLOAD = ((uint16_t)RELIABLE_PAYLOAD_SIZE < (MAX_PACKET_SIZE - RELIABLE_HEADER_SIZE)) ? (uint16_t)RELIABLE_PAYLOAD_SIZE : (MAX_PACKET_SIZE - RELIABLE_HEADER_SIZE);
+const uint8_t  RELIABLE_SLOTS       = (RELIABLE_WINDOW_SIZE < RELIABLE_MAX_WINDOW) ? RELIABLE_WINDOW_SIZE : RELIABLE_MAX_WINDOW;
+
+static_assert(RELIABLE_SLOTS && !(RELIABLE_SLOTS & (RELIABLE_SLOTS - 1)), "RELIABLE_WINDOW_SIZE must be a power of 2 - slots are indexed by the 8-bit sequence number modulo the window");
+
+const uint32_t RELIABLE_INITIAL_RTO = 200; // Ticks of the link's configST.clock, like all times here (ms by default)
+const uint32_t RELIABLE_MIN_RTO     = 5;   // Ticks
+const uint32_t RELIABLE_MAX_RTO     = 2000; // Ticks
+const uint8_t  RELIABLE_MAX_BACKOFF = 3;   // Most times the RTO is doubled while nothing is acknowledged
+
+
+class ReliableTransfer
+{
+  public: // <<---------------------------------------//public
+	uint16_t bytesRead = 0;
+	int8_t   status    = 0;
+
+
+	void     begin(SerialTransfer& _transfer, const uint8_t& _windowSize = RELIABLE_WINDOW_SIZE, const uint32_t& _ackDelay = 0);
+	uint16_t send(const uint8_t data[], const uint16_t& len, const uint16_t command = 0);
+	bool     canSend();
+	uint8_t  inFlight();
+	uint16_t available();
+	bool     tick();
+	uint16_t currentCommand();
+	uint32_t currentRTO();
+	uint32_t smoothedRTT();
+	uint32_t retransmissions();
+	uint32_t checksumErrors();
+	void     reset();
+
+
+	/*
+	 uint16_t ReliableTransfer::rxObj(const T &val, const uint16_t &index=0, const uint16_t &len=sizeof(T))
+	 Description:
+	 ------------
+	  * Reads "len" number of bytes from the last in-order payload
+	  delivered by available() starting at the index as specified by
+	  the argument "index" into an arbitrary object (byte, int, float,
+	  double, struct, etc...)
+	 Inputs:
+	 -------
+	  * const T &val - Pointer to the object to be copied into from the
+	  delivered payload
+	  * const uint16_t &index - Starting index of the object within the
+	  delivered payload
+	  * const uint16_t &len - Number of bytes in the object "val" received
+	 Return:
+	 -------
+	  * uint16_t maxIndex - Index of the delivered payload that directly follows the bytes processed
+	  by the calling of this member function
+	*/
+	template <typename T>
+	uint16_t rxObj(const T& val, const uint16_t& index = 0, const uint16_t& len = sizeof(T))
+	{
+		uint16_t maxIndex = len + index;
+
+		if (!rxHeld)
+			return index;
+
+		if (maxIndex > rxSlots[rxHeldSlot].len)
+			maxIndex = rxSlots[rxHeldSlot].len;
+
+		if (maxIndex > index)
+			memcpy((uint8_t*)&val, rxSlots[rxHeldSlot].data + index, maxIndex - index);
+
+		return maxIndex;
+	}
+
+
+	/*
+	 uint16_t ReliableTransfer::sendDatum(const T &val, const uint16_t command=0, const uint16_t &len=sizeof(T))
+	 Description:
+	 ------------
+	  * Queues "len" number of bytes of an arbitrary object (byte, int,
+	  float, double, struct, etc...) for reliable delivery in an
+	  individual packet
+	 Inputs:
+	 -------
+	  * const T &val - Pointer to the object to be sent
+	  * const uint16_t command - The packet 16-bit command
+	  * const uint16_t &len - Number of bytes of the object "val" to transmit
+	 Return:
+	 -------
+	  * uint16_t - Number of payload bytes queued (0 if the window is full)
+	*/
+	template <typename T>
+	uint16_t sendDatum(const T& val, const uint16_t command = 0, const uint16_t& len = sizeof(T))
+	{
+		return send((const uint8_t*)&val, len, command);
+	}
+
+
+	/*
+	 uint16_t ReliableTransfer::rxSchema<Schema>(T &val, const uint16_t &index=0)
+	 Description:
+	 ------------
+	  * Decodes the fields of "val" listed in "Schema" (a PacketSchema)
+	  from the last in-order payload delivered by available() starting
+	  at the index as specified by the argument "index"
+	 Inputs:
+	 -------
+	  * T &val - Object to be decoded into from the delivered payload
+	  * const uint16_t &index - Starting index of the object within the
+	  delivered payload
+	 Return:
+	 -------
+	  * uint16_t maxIndex - Index of the delivered payload that directly follows the bytes processed
+	  by the calling of this member function ("index" if the payload is too short)
+	*/
+	template <typename Schema, typename T>
+	uint16_t rxSchema(T& val, const uint16_t& index = 0)
+	{
+		if (!rxHeld || ((index + Schema::SIZE) > rxSlots[rxHeldSlot].len))
+			return index;
+
+		Schema::decode(rxSlots[rxHeldSlot].data + index, val);
+
+		return index + Schema::SIZE;
+	}
+
+
+	/*
+	 uint16_t ReliableTransfer::sendSchema<Schema>(const T &val, const uint16_t command=0)
+	 Description:
+	 ------------
+	  * Queues the fields of "val" listed in "Schema" (a PacketSchema)
+	  for reliable delivery in an individual packet
+	 Inputs:
+	 -------
+	  * const T &val - Object to be sent
+	  * const uint16_t command - The packet 16-bit command
+	 Return:
+	 -------
+	  * uint16_t - Number of payload bytes queued (0 if the window is full)
+	*/
+	template <typename Schema, typename T>
+	uint16_t sendSchema(const T& val, const uint16_t command = 0)
+	{
+		uint8_t buff[Schema::SIZE];
+
+		Schema::encode(val, buff);
+
+		return send(buff, Schema::SIZE, command);
+	}
+
+
+  private: // <<---------------------------------------//private
+	struct txSlot
+	{
+		uint8_t  data[RELIABLE_MAX_PAYLOAD];
+		uint16_t len;
+		uint16_t command;
+		uint32_t sentAt;
+		bool     acked;
+		bool     retransmitted;
+	};
+
+	struct rxSlot
+	{
+		uint8_t  data[RELIABLE_MAX_PAYLOAD];
+		uint16_t len;
+		uint16_t command;
+		bool     valid;
+	};
+
+	txSlot txSlots[RELIABLE_SLOTS];
+	rxSlot rxSlots[RELIABLE_SLOTS];
+
+	SerialTransfer* transfer;
+	uint8_t         windowSize = RELIABLE_SLOTS;
+	uint32_t        ackDelay   = 0;
+
+	uint8_t txBase = 0; // Oldest unacknowledged sequence number
+	uint8_t txNext = 0; // Next sequence number to send
+	uint8_t rxBase = 0; // Next sequence number to deliver
+
+	bool    rxHeld     = false; // Whether or not rxSlots[rxHeldSlot] is on loan to the user
+	uint8_t rxHeldSlot = 0;
+
+	bool     ackPending      = false;
+	uint32_t ackPendingSince = 0;
+
+	bool     rttValid   = false;
+	uint32_t srtt       = 0; // Smoothed RTT, ticks << 3
+	uint32_t rttvar     = 0; // RTT variance, ticks << 2
+	uint32_t rto        = RELIABLE_INITIAL_RTO;
+	uint8_t  backoff    = 0; // Times the RTO was doubled since something was last acknowledged
+	uint32_t backoffAt  = 0; // Tick the RTO was last doubled
+	uint32_t retransmit = 0;
+	uint32_t badChecks  = 0;
+
+
+	bool     transmit(const uint8_t& seq);
+	void     sendAck();
+	void     processPacket();
+	void     processAck(const uint8_t& ack, const uint16_t& sack);
+	void     updateRTO(const uint32_t& sample);
+	void     setRTO();
+	void     serviceTimers();
+	void     writeHeader(const uint8_t& seq, const uint16_t& command, const uint8_t data[], const uint16_t& len);
+	uint16_t checksum(const uint8_t header[], const uint16_t& command, const uint8_t data[], const uint16_t& len);
+	uint8_t  ackNumber();
+	uint16_t sackBits(const uint8_t& ack);
+};
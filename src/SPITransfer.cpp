@@ -1,137 +1,471 @@
-#include "Arduino.h"
-/* UNCOMMENT FOR USAGE
-#if not(defined(MBED_H) || defined(__SAM3X8E__) || defined(DISABLE_SPI_SERIALTRANSFER)) // These boards are/will not be supported by SPITransfer.h
-
-#include "SPITransfer.h"
-
-*/
-/*
- void SPITransfer::begin(SPIClass &_port, configST configs, const uint8_t &_SS)
- Description:
- ------------
-  * Advanced initializer for the SPITransfer Class
- Inputs:
- -------
-  * const SPIClass &_port - SPI port to communicate over
-  * const configST configs - Struct that holds config
-  * const uint8_t &_SS - SPI buslave select pin used
-  values for all possible initialization parameters
- Return:
- -------
-  * void
-*//*
-void SPITransfer::begin(SPIClass& _port, const configST configs, const uint8_t& _SS)
-{
-	port = &_port;
-	packet.begin(configs);
-	ssPin = _SS;
-}
-
-*/
-/*
- void SPITransfer::begin(SPIClass &_port, const uint8_t &_SS, const bool _debug, Stream &_debugPort)
- Description:
- ------------
-  * Simple initializer for the SPITransfer Class
- Inputs:
- -------
-  * const Stream &_port - SPI port to communicate over
-  * const uint8_t &_SS - SPI buslave select pin used
-  * const bool _debug - Whether or not to print error messages
-  * const Stream &_debugPort - Serial port to print error messages
- Return:
- -------
-  * void
-*//*
-void SPITransfer::begin(SPIClass& _port, const uint8_t& _SS, const bool _debug, Stream& _debugPort)
-{
-	port = &_port;
-	packet.begin(_debug, _debugPort);
-	ssPin = _SS;
-}
-
-*/
-/*
- uint8_t SPITransfer::sendData(const uint16_t &messageLen, const uint8_t packetID)
- Description:
- ------------
-  * Send a specified number of bytes in packetized form
- Inputs:
- -------
-  * const uint16_t &messageLen - Number of values in txBuff
-  to send as the payload in the next packet
-  * const uint8_t packetID - The packet 8-bit identifier
- Return:
- -------
-  * uint8_t numBytesIncl - Number of payload bytes included in packet
-*//*
-uint8_t SPITransfer::sendData(const uint16_t& messageLen, const uint8_t packetID)
-{
-	uint8_t numBytesIncl = packet.constructPacket(messageLen, packetID);
-
-	digitalWrite(SS, LOW); // Enable SS (active low)
-	for (uint8_t i = 0; i < sizeof(packet.preamble); i++)
-	{
-		delay(1); // This delay is needed
-		port->transfer(packet.preamble[i]);
-	}
-
-	for (uint8_t i = 0; i < numBytesIncl; i++)
-	{
-		delay(1); // This delay is needed
-		port->transfer(packet.txBuff[i]);
-	}
-
-	for (uint8_t i = 0; i < sizeof(packet.postamble); i++)
-	{
-		delay(1); // This delay is needed
-		port->transfer(packet.postamble[i]);
-	}
-	digitalWrite(SS, HIGH); // Disable SS (active low)
-
-	return numBytesIncl;
-}
-
-*/
-/*
- uint8_t SPITransfer::available()
- Description:
- ------------
-  * Parses incoming serial data, analyzes packet contents,
-  and reports errors/successful packet reception
- Inputs:
- -------
-  * void
- Return:
- -------
-  * uint8_t bytesRead - Num bytes in RX buffer
-*//*
-uint8_t SPITransfer::available()
-{
-	volatile uint8_t recChar = SPDR;
-	bytesRead                = packet.parse(recChar);
-	status                   = packet.status;
-
-	return bytesRead;
-}
-
-*/
-/*
- uint8_t SPITransfer::currentPacketID()
- Description:
- ------------
-  * Returns the ID of the last parsed packet
- Inputs:
- -------
-  * void
- Return:
- -------
-  * uint8_t - ID of the last parsed packet
-*//*
-uint8_t SPITransfer::currentPacketID()
-{
-	return packet.currentPacketID();
-}
-
-#endif // not (defined(MBED_H) || defined(__SAM3X8E__))
-*/
+#include "SPITransfer.h"
+
+#if not(defined(DISABLE_SPI_SERIALTRANSFER))
+
+
+/*
+ void SPITransfer::begin(SPIClass &_port, configST configs, const uint8_t &_SS, const uint8_t &_readyPin, const uint32_t &_clock)
+ Description:
+ ------------
+  * Advanced initializer for the SPITransfer Class as the SPI master
+ Inputs:
+ -------
+  * const SPIClass &_port - SPI port to communicate over
+  * const configST configs - Struct that holds config
+  values for all possible initialization parameters
+  * const uint8_t &_SS - SPI slave select pin used
+  * const uint8_t &_readyPin - Input driven HIGH by the slave while it
+  can absorb a full frame (NO_READY_PIN if not wired). The master waits
+  up to configs.flowTimeout ticks of configs.clock for it before each frame
+  * const uint32_t &_clock - SPI clock frequency in Hz
+ Return:
+ -------
+  * void
+*/
+void SPITransfer::begin(SPIClass& _port, const configST configs, const uint8_t& _SS, const uint8_t& _readyPin, const uint32_t& _clock)
+{
+	port         = &_port;
+	settings     = SPISettings(_clock, MSBFIRST, SPI_MODE0);
+	ssPin        = _SS;
+	readyPin     = _readyPin;
+	readyTimeout = configs.flowTimeout;
+	beginTransfer(configs);
+
+	pinMode(ssPin, OUTPUT);
+	digitalWrite(ssPin, HIGH); // Disable SS (active low)
+
+	if (readyPin != NO_READY_PIN)
+		pinMode(readyPin, INPUT);
+}
+
+
+/*
+ void SPITransfer::begin(SPIClass &_port, const uint8_t &_SS, const uint8_t _debug, Stream &_debugPort)
+ Description:
+ ------------
+  * Simple initializer for the SPITransfer Class as the SPI master
+ Inputs:
+ -------
+  * const SPIClass &_port - SPI port to communicate over
+  * const uint8_t &_SS - SPI slave select pin used
+  * const uint8_t _debug - Whether or not to print error messages
+  * const Stream &_debugPort - Serial port to print error messages
+ Return:
+ -------
+  * void
+*/
+void SPITransfer::begin(SPIClass& _port, const uint8_t& _SS, const uint8_t _debug, Stream& _debugPort)
+{
+	configST configs;
+
+	configs.debug     = _debug;
+	configs.debugPort = &_debugPort;
+	configs.timeout   = DEFAULT_TIMEOUT;
+
+	begin(_port, configs, _SS);
+}
+
+
+/*
+ void SPITransfer::beginSlave(SPIClass &_port, configST configs, const uint8_t &_readyPin)
+ Description:
+ ------------
+  * Initializer for the SPITransfer Class as the SPI slave. The sketch
+  must pass every byte received to SPITransfer::receiveByte() from its
+  SPI interrupt
+ Inputs:
+ -------
+  * const SPIClass &_port - SPI port to communicate over
+  * const configST configs - Struct that holds config
+  values for all possible initialization parameters
+  * const uint8_t &_readyPin - Output driven HIGH while the RX ring can
+  absorb a full frame (NO_READY_PIN if not wired)
+ Return:
+ -------
+  * void
+*/
+void SPITransfer::beginSlave(SPIClass& _port, const configST configs, const uint8_t& _readyPin)
+{
+	port     = &_port;
+	readyPin = _readyPin;
+	slave    = true;
+	rxHead   = 0;
+	rxTail   = 0;
+	txIndex  = 0;
+	txLen    = 0;
+	beginTransfer(configs);
+
+	if (readyPin != NO_READY_PIN)
+		pinMode(readyPin, OUTPUT);
+
+	updateReady();
+}
+
+
+/*
+ uint16_t SPITransfer::exchange(const uint16_t &messageLen, const uint16_t command, const uint8_t packetID)
+ Description:
+ ------------
+  * Master only - sends a packet and, in the same transaction,
+  receives the packet the slave queued with sendData(). Both frames
+  are shifted simultaneously, and the transaction is stretched with
+  idle bytes if the slave's frame is the longer of the two. As the
+  slave can only queue its reply once a request has been parsed, the
+  frame received is typically the reply to the previous exchange()
+ Inputs:
+ -------
+  * const uint16_t &messageLen - Number of values in txBuff
+  to send as the payload in the next packet
+  * const uint16_t command - The packet 16-bit command
+  * const uint8_t packetID - The packet 8-bit identifier
+ Return:
+ -------
+  * uint16_t bytesRead - Num bytes in RX buffer (0 if the slave had
+  nothing queued or never signalled ready)
+*/
+uint16_t SPITransfer::exchange(const uint16_t& messageLen, const uint16_t command, const uint8_t packetID)
+{
+	uint16_t frameLen;
+
+	bytesRead = 0;
+
+	if (!waitReady())
+	{
+		status = NO_DATA;
+		return bytesRead;
+	}
+
+	packet.constructPacket(messageLen, command, packetID);
+	frameLen = buildFrame();
+
+	packet.stats.framesOut++;
+	packet.stats.bytesOut += frameLen;
+
+	if (transferFrame(frameLen)) // Replaces any packet received during sendData() and not read yet
+		rxPending = false;
+
+	return bytesRead;
+}
+
+
+/*
+ uint8_t SPITransfer::receiveByte(const uint8_t recChar)
+ Description:
+ ------------
+  * Buffers a byte received as the SPI slave - call from the SPI
+  interrupt (i.e. "SPDR = SPITransfer::receiveByte(SPDR);" in
+  ISR(SPI_STC_vect) on AVR). Bytes that do not fit in the RX ring
+  are dropped
+ Inputs:
+ -------
+  * const uint8_t recChar - Byte received
+ Return:
+ -------
+  * uint8_t - Next byte to shift out to the master: the frame queued
+  with sendData(), else SPI_IDLE_BYTE
+*/
+uint8_t SPITransfer::receiveByte(const uint8_t recChar)
+{
+	SPITransfer* self  = classToUse;
+	uint16_t     tail  = self->rxTail;
+	uint16_t     next  = (self->rxHead + 1) % SPI_RX_BUFFER_SIZE;
+	uint8_t      reply = SPI_IDLE_BYTE;
+
+	if (self->txIndex < self->txLen)
+	{
+		reply = self->frame[self->txIndex];
+		self->txIndex++;
+	}
+
+	if (next == tail)
+		return reply;
+
+	self->rxRing[self->rxHead] = recChar;
+	self->rxHead               = next;
+
+	if ((self->readyPin != NO_READY_PIN) && ((SPI_RX_BUFFER_SIZE - 1 - ((next + SPI_RX_BUFFER_SIZE - tail) % SPI_RX_BUFFER_SIZE)) < PACKET_SIZE))
+		digitalWrite(self->readyPin, LOW);
+
+	return reply;
+}
+
+
+/*
+ uint16_t SPITransfer::readBytes(uint8_t arr[], const uint16_t& len)
+ Description:
+ ------------
+  * Moves bytes buffered by receiveByte() out of the RX ring
+ Inputs:
+ -------
+  * uint8_t arr[] - Buffer to copy received bytes into
+  * const uint16_t& len - Size of arr[]
+ Return:
+ -------
+  * uint16_t - Number of bytes copied into arr[]
+*/
+uint16_t SPITransfer::readBytes(uint8_t arr[], const uint16_t& len)
+{
+	uint16_t count = rxUsed();
+	uint16_t run;
+
+	if (count > packet.stats.rxQueueMax)
+		packet.stats.rxQueueMax = count;
+
+	if (count > len)
+		count = len;
+
+	run = count;
+
+	if (run > (SPI_RX_BUFFER_SIZE - rxTail)) // Copy up to the end of the ring, then wrap
+		run = SPI_RX_BUFFER_SIZE - rxTail;
+
+	memcpy(arr, rxRing + rxTail, run);
+	memcpy(arr + run, rxRing, count - run);
+
+	noInterrupts();
+	rxTail = (rxTail + count) % SPI_RX_BUFFER_SIZE;
+	interrupts();
+
+	return count;
+}
+
+
+/*
+ bool SPITransfer::prepareSend(const uint16_t& messageLen)
+ Description:
+ ------------
+  * As the master, waits for the slave to signal ready. As the slave,
+  checks the previous frame has been clocked out
+ Inputs:
+ -------
+  * const uint16_t& messageLen - Number of payload bytes to send
+ Return:
+ -------
+  * bool - Whether or not a frame can be sent
+*/
+bool SPITransfer::prepareSend(const uint16_t& messageLen)
+{
+	(void)messageLen;
+
+	if (slave)
+	{
+		noInterrupts();
+		bool busy = txIndex < txLen;
+		interrupts();
+
+		return !busy;
+	}
+
+	return waitReady();
+}
+
+
+/*
+ bool SPITransfer::writeFrame()
+ Description:
+ ------------
+  * As the master, clocks the whole frame out with a single buffer
+  transfer, which the SPI driver is free to hand to DMA. A packet the
+  slave queued comes back in the same transaction, as with exchange(),
+  and is reported by the next available(). As the slave, queues the
+  frame for the master to clock out during its next transaction
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not the frame was sent or queued (always)
+*/
+bool SPITransfer::writeFrame()
+{
+	uint16_t frameLen = buildFrame();
+
+	if (slave)
+	{
+		noInterrupts();
+		txIndex = 0;
+		txLen   = frameLen;
+		interrupts();
+
+		return true;
+	}
+
+	if (transferFrame(frameLen))
+		rxPending = true;
+
+	return true;
+}
+
+
+/*
+ void SPITransfer::afterAvailable()
+ Description:
+ ------------
+  * Raises the ready line again once available() has freed the RX ring
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SPITransfer::afterAvailable()
+{
+	updateReady();
+}
+
+
+/*
+ uint16_t SPITransfer::buildFrame()
+ Description:
+ ------------
+  * Lays the constructed packet out in frame[]
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t frameLen - Number of bytes in frame[]
+*/
+uint16_t SPITransfer::buildFrame()
+{
+	uint16_t frameLen = 0;
+
+	memcpy(frame, packet.preamble, sizeof(packet.preamble));
+	frameLen += sizeof(packet.preamble);
+	memcpy(frame + frameLen, packet.txPayload, packet.bytesToSend);
+	frameLen += packet.bytesToSend;
+	memcpy(frame + frameLen, packet.postamble, sizeof(packet.postamble));
+	frameLen += sizeof(packet.postamble);
+
+	return frameLen;
+}
+
+
+/*
+ bool SPITransfer::transferFrame(const uint16_t& frameLen)
+ Description:
+ ------------
+  * Master only - clocks frame[] out and parses what the slave shifts
+  back at the same time, stretching the transaction with idle bytes
+  while the slave's frame is the longer of the two
+ Inputs:
+ -------
+  * const uint16_t& frameLen - Number of bytes in frame[]
+ Return:
+ -------
+  * bool - Whether or not a packet was received
+*/
+bool SPITransfer::transferFrame(const uint16_t& frameLen)
+{
+	uint16_t consumed;
+
+	port->beginTransaction(settings);
+	digitalWrite(ssPin, LOW); // Enable SS (active low)
+	port->transfer(frame, frameLen);
+	parseBytes(frame, frameLen, consumed);
+
+	while (status == CONTINUE)
+	{
+		uint16_t pending = packet.pendingBytes();
+
+		if (!pending)
+			break;
+
+		if (pending > sizeof(frame))
+			pending = sizeof(frame);
+
+		memset(frame, SPI_IDLE_BYTE, pending);
+		port->transfer(frame, pending);
+		parseBytes(frame, pending, consumed);
+	}
+
+	digitalWrite(ssPin, HIGH); // Disable SS (active low)
+	port->endTransaction();
+
+	return status == NEW_DATA;
+}
+
+
+/*
+ bool SPITransfer::waitReady()
+ Description:
+ ------------
+  * Waits for the slave to signal it can absorb a full frame
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not the slave is ready
+*/
+bool SPITransfer::waitReady()
+{
+	uint32_t start = packet.now();
+
+	if (readyPin == NO_READY_PIN)
+		return true;
+
+	while (digitalRead(readyPin) != HIGH)
+		if ((packet.now() - start) >= readyTimeout)
+		{
+			packet.stats.timeouts++;
+			return false;
+		}
+
+	return true;
+}
+
+
+/*
+ uint16_t SPITransfer::rxUsed()
+ Description:
+ ------------
+  * Returns the number of bytes waiting in the RX ring
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - Number of bytes waiting in the RX ring
+*/
+uint16_t SPITransfer::rxUsed()
+{
+	uint16_t head;
+
+	noInterrupts(); // 16-bit reads are not atomic on 8-bit MCUs
+	head = rxHead;
+	interrupts();
+
+	return (head + SPI_RX_BUFFER_SIZE - rxTail) % SPI_RX_BUFFER_SIZE;
+}
+
+
+/*
+ void SPITransfer::updateReady()
+ Description:
+ ------------
+  * Drives the ready line HIGH while the RX ring can absorb a full
+  frame and LOW otherwise
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SPITransfer::updateReady()
+{
+	if (readyPin == NO_READY_PIN)
+		return;
+
+	noInterrupts(); // Keep receiveByte() from lowering the line between the check and the write
+	uint16_t used = (rxHead + SPI_RX_BUFFER_SIZE - rxTail) % SPI_RX_BUFFER_SIZE;
+	digitalWrite(readyPin, ((SPI_RX_BUFFER_SIZE - 1 - used) >= PACKET_SIZE) ? HIGH : LOW);
+	interrupts();
+}
+
+
+SPITransfer* SPITransfer::classToUse = NULL;
+
+#endif // not(defined(DISABLE_SPI_SERIALTRANSFER))
@@ -1,108 +1,73 @@
-#pragma once
-/* UNCOMMENT FOR USAGE
-#include "Arduino.h"
-
-#if not(defined(MBED_H) || defined(__SAM3X8E__)) // These boards are/will not be supported by SPITransfer.h
-
-#include "Packet.h"
-#include "SPI.h"
-
-
-class SPITransfer
-{
-  public: // <<---------------------------------------//public
-	Packet  packet;
-	uint8_t bytesRead = 0;
-	int8_t  status    = 0;
-
-
-	void    begin(SPIClass& _port, const configST configs, const uint8_t& _SS = SS);
-	void    begin(SPIClass& _port, const uint8_t& _SS = SS, const bool _debug = true, Stream& _debugPort = Serial);
-	uint8_t sendData(const uint16_t& messageLen, const uint8_t packetID = 0);
-	uint8_t available();
-	uint8_t currentPacketID();
-
-*/
-	/*
-	 uint16_t SPITransfer::txObj(const T &val, const uint16_t &index=0, const uint16_t &len=sizeof(T))
-	 Description:
-	 ------------
-	  * Stuffs "len" number of bytes of an arbitrary object (byte, int,
-	  float, double, struct, etc...) into the transmit buffer (txBuff)
-	  starting at the index as specified by the argument "index"
-	 Inputs:
-	 -------
-	  * const T &val - Pointer to the object to be copied to the
-	  transmit buffer (txBuff)
-	  * const uint16_t &index - Starting index of the object within the
-	  transmit buffer (txBuff)
-	  * const uint16_t &len - Number of bytes of the object "val" to transmit
-	 Return:
-	 -------
-	  * uint16_t maxIndex - uint16_t maxIndex - Index of the transmit buffer (txBuff) that directly follows the bytes processed
-	  by the calling of this member function
-	*//*
-	template <typename T>
-	uint16_t txObj(const T& val, const uint16_t& index = 0, const uint16_t& len = sizeof(T))
-	{
-		return packet.txObj(val, index, len);
-	}
-
-*/
-	/*
-	 uint16_t SPITransfer::rxObj(const T &val, const uint16_t &index=0, const uint16_t &len=sizeof(T))
-	 Description:
-	 ------------
-	  * Reads "len" number of bytes from the receive buffer (rxBuff)
-	  starting at the index as specified by the argument "index"
-	  into an arbitrary object (byte, int, float, double, struct, etc...)
-	 Inputs:
-	 -------
-	  * const T &val - Pointer to the object to be copied into from the
-	  receive buffer (rxBuff)
-	  * const uint16_t &index - Starting index of the object within the
-	  receive buffer (rxBuff)
-	  * const uint16_t &len - Number of bytes in the object "val" received
-	 Return:
-	 -------
-	  * uint16_t maxIndex - Index of the receive buffer (rxBuff) that directly follows the bytes processed
-	  by the calling of this member function
-	*//*
-	template <typename T>
-	uint16_t rxObj(const T& val, const uint16_t& index = 0, const uint16_t& len = sizeof(T))
-	{
-		return packet.rxObj(val, index, len);
-	}
-
-*/
-	/*
-	 uint8_t SPITransfer::sendDatum(const T &val, const uint16_t &len=sizeof(T))
-	 Description:
-	 ------------
-	  * Stuffs "len" number of bytes of an arbitrary object (byte, int,
-	  float, double, struct, etc...) into the transmit buffer (txBuff)
-	  starting at the index as specified by the argument "index" and
-	  automatically transmits the bytes in an individual packet
-	 Inputs:
-	 -------
-	  * const T &val - Pointer to the object to be copied to the
-	  transmit buffer (txBuff)
-	  * const uint16_t &len - Number of bytes of the object "val" to transmit
-	 Return:
-	 -------
-	  * uint8_t - Number of payload bytes included in packet
-	*//*
-	template <typename T>
-	uint8_t sendDatum(const T& val, const uint16_t& len = sizeof(T))
-	{
-		return sendData(packet.txObj(val, 0, len));
-	}
-
-
-  private: // <<---------------------------------------//private
-	SPIClass* port;
-	uint8_t   ssPin;
-};
-
-#endif // not (defined(MBED_H) || defined(__SAM3X8E__))
-*/
+#pragma once
+#include "Arduino.h"
+
+#if not(defined(DISABLE_SPI_SERIALTRANSFER))
+
+#include "Packet.h"
+#include "Transfer.h"
+#include "SPI.h"
+
+
+#ifndef SPI_RX_BUFFER_SIZE
+#define SPI_RX_BUFFER_SIZE (PACKET_SIZE + 1) // Slave RX ring size, holds SPI_RX_BUFFER_SIZE - 1 bytes
+#endif
+
+const uint8_t NO_READY_PIN  = 0xFF; // No ready line wired - the master sends frames unpaced
+const uint8_t SPI_IDLE_BYTE = 0x00; // Shifted out when there is nothing to send, ignored by the parser
+
+#if defined(__AVR__)
+const uint32_t SPI_DEFAULT_CLOCK = 1000000; // Hz - leaves an AVR slave time for its per-byte ISR
+#else
+const uint32_t SPI_DEFAULT_CLOCK = 8000000; // Hz
+#endif
+
+
+class SPITransfer : public Transfer<SPITransfer>
+{
+  public: // <<---------------------------------------//public
+	static SPITransfer* classToUse;
+
+
+	SPITransfer()
+	{
+		classToUse = this;
+	};
+	void     begin(SPIClass& _port, const configST configs, const uint8_t& _SS = SS, const uint8_t& _readyPin = NO_READY_PIN, const uint32_t& _clock = SPI_DEFAULT_CLOCK);
+	void     begin(SPIClass& _port, const uint8_t& _SS = SS, const uint8_t _debug = 1, Stream& _debugPort = Serial);
+	void     beginSlave(SPIClass& _port, const configST configs, const uint8_t& _readyPin = NO_READY_PIN);
+	uint16_t exchange(const uint16_t& messageLen, const uint16_t command = 0, const uint8_t packetID = 0);
+
+	static uint8_t receiveByte(const uint8_t recChar);
+
+
+  private: // <<---------------------------------------//private
+	friend class Transfer<SPITransfer>;
+
+	SPIClass*   port;
+	SPISettings settings;
+	uint8_t     ssPin        = SS;
+	uint8_t     readyPin     = NO_READY_PIN;
+	uint32_t    readyTimeout = DEFAULT_FLOW_TIMEOUT;
+	bool        slave        = false;
+
+	uint8_t           frame[PACKET_SIZE]; // Whole frame, so that it goes out in a single block (DMA) transfer
+	volatile uint16_t txIndex = 0;        // Slave only - next frame byte receiveByte() shifts out
+	volatile uint16_t txLen   = 0;        // Slave only - frame bytes queued for the master to clock out
+
+	uint8_t           rxRing[SPI_RX_BUFFER_SIZE]; // Filled by receiveByte() from the SPI ISR
+	volatile uint16_t rxHead = 0;                 // Written by the ISR only
+	volatile uint16_t rxTail = 0;                 // Written by readBytes() only
+
+
+	uint16_t readBytes(uint8_t arr[], const uint16_t& len);
+	bool     prepareSend(const uint16_t& messageLen);
+	bool     writeFrame();
+	void     afterAvailable();
+	uint16_t buildFrame();
+	bool     transferFrame(const uint16_t& frameLen);
+	bool     waitReady();
+	uint16_t rxUsed();
+	void     updateReady();
+};
+
+#endif // not(defined(DISABLE_SPI_SERIALTRANSFER))
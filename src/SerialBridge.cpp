@@ -0,0 +1,688 @@
+#include "SerialBridge.h"
+#include "PacketCRC.h"
+
+
+SerialBridge* SerialBridge::bridges = NULL;
+
+
+/*
+ SerialBridge::SerialBridge()
+ Description:
+ ------------
+  * Registers the bridge so others relaying to the same port can see
+  when it is in the middle of a frame
+*/
+SerialBridge::SerialBridge()
+{
+	next    = bridges;
+	bridges = this;
+}
+
+
+/*
+ SerialBridge::~SerialBridge()
+ Description:
+ ------------
+  * Unregisters the bridge
+*/
+SerialBridge::~SerialBridge()
+{
+	for (SerialBridge** link = &bridges; *link; link = &(*link)->next)
+	{
+		if (*link == this)
+		{
+			*link = next;
+			break;
+		}
+	}
+}
+
+
+/*
+ void SerialBridge::begin(Stream &_port, const configST configs)
+ Description:
+ ------------
+  * Advanced initializer for the SerialBridge Class. Routes are kept
+ Inputs:
+ -------
+  * const Stream &_port - Serial port frames are received from
+  * const configST configs - Struct that holds config
+  values for all possible initialization parameters
+ Return:
+ -------
+  * void
+*/
+void SerialBridge::begin(Stream& _port, const configST configs)
+{
+	port      = &_port;
+	verifyCrc = (configs.fec == NULL);
+	beginTransfer(configs);
+	beginBridge();
+}
+
+
+/*
+ void SerialBridge::begin(Stream &_port, const uint8_t _debug, Stream &_debugPort, uint32_t _timeout)
+ Description:
+ ------------
+  * Simple initializer for the SerialBridge Class. Routes are kept
+ Inputs:
+ -------
+  * const Stream &_port - Serial port frames are received from
+  * const uint8_t _debug - Whether or not to print error messages; 0 = none, 1+ = errors (per-byte tracing is done by configST.trace)
+  * const Stream &_debugPort - Serial port to print error messages
+  * uint32_t _timeout - ms before a partially received or relayed
+  packet goes stale
+ Return:
+ -------
+  * void
+*/
+void SerialBridge::begin(Stream& _port, const uint8_t _debug, Stream& _debugPort, uint32_t _timeout)
+{
+	port      = &_port;
+	verifyCrc = true;
+	beginTransfer(_debug, _debugPort, _timeout);
+	beginBridge();
+}
+
+
+/*
+ bool SerialBridge::addRoute(const bridgeRouteST& route)
+ Description:
+ ------------
+  * Relays frames matching "route" to route.port. Routes are checked
+  in the order they were added and the first match wins. CONTROL_FLAG
+  packets belong to a single link and are never relayed
+ Inputs:
+ -------
+  * const bridgeRouteST& route - Port and header fields to match
+ Return:
+ -------
+  * bool - Whether or not the route was added
+*/
+bool SerialBridge::addRoute(const bridgeRouteST& route)
+{
+	if ((numRoutes >= BRIDGE_MAX_ROUTES) || !route.port)
+		return false;
+
+	routes[numRoutes++] = route;
+
+	return true;
+}
+
+
+/*
+ bool SerialBridge::routeID(Stream& out, const uint8_t& packetID, const uint8_t& idMask)
+ Description:
+ ------------
+  * Relays frames by packet ID
+ Inputs:
+ -------
+  * Stream& out - Port matching frames are relayed to
+  * const uint8_t& packetID - Packet ID to match
+  * const uint8_t& idMask - Bits of the packet ID compared, i.e. 0xF0
+  relays a block of 16 IDs
+ Return:
+ -------
+  * bool - Whether or not the route was added
+*/
+bool SerialBridge::routeID(Stream& out, const uint8_t& packetID, const uint8_t& idMask)
+{
+	bridgeRouteST route;
+
+	route.port     = &out;
+	route.packetID = packetID;
+	route.idMask   = idMask;
+
+	return addRoute(route);
+}
+
+
+/*
+ bool SerialBridge::routeCommand(Stream& out, const uint16_t& command, const uint16_t& commandMask)
+ Description:
+ ------------
+  * Relays frames by command. The library flags (COMMAND_FLAGS) are not
+  compared, so fragments and reliable packets follow their command
+ Inputs:
+ -------
+  * Stream& out - Port matching frames are relayed to
+  * const uint16_t& command - Command to match
+  * const uint16_t& commandMask - Bits of the command compared
+ Return:
+ -------
+  * bool - Whether or not the route was added
+*/
+bool SerialBridge::routeCommand(Stream& out, const uint16_t& command, const uint16_t& commandMask)
+{
+	bridgeRouteST route;
+
+	route.port        = &out;
+	route.command     = command;
+	route.commandMask = commandMask;
+
+	return addRoute(route);
+}
+
+
+/*
+ void SerialBridge::clearRoutes()
+ Description:
+ ------------
+  * Removes every route, all frames are then parsed locally
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialBridge::clearRoutes()
+{
+	numRoutes = 0;
+}
+
+
+/*
+ uint16_t SerialBridge::available()
+ Description:
+ ------------
+  * Relays routed frames and parses the others, reporting errors and
+  successful reception of the latter just like SerialTransfer
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t bytesRead - Num bytes in RX buffer
+*/
+uint16_t SerialBridge::available()
+{
+	bytesRead = 0;
+
+	while (true)
+	{
+		if (rxPos == rxLen)
+		{
+			rxPos = 0;
+			rxLen = readBytes(rxChunk, sizeof(rxChunk));
+
+			if (!rxLen)
+				break;
+		}
+
+		if (process())
+			return bytesRead;
+	}
+
+	if (mode == local_frame)
+	{
+		bytesRead = packet.parse(0xFF, false);
+		status    = packet.status;
+
+		if (status <= 0)
+			reset();
+	}
+	else if ((headerLen || (mode == forward_frame)) && ((packet.now() - lastRx) >= timeout))
+	{
+		if (debug && (mode == forward_frame))
+			debugPort->println("ERROR: STALE RELAYED PACKET");
+
+		reset();
+	}
+	else if (holdLen && (mode == find_header))
+		flushHold();
+
+	return bytesRead;
+}
+
+
+/*
+ void SerialBridge::reset()
+ Description:
+ ------------
+  * Drops the frame in progress (a frame being relayed is padded out
+  with BRIDGE_ABORT_BYTE so the next hop rejects it and stays in sync)
+  and resets the parser. A complete frame waiting for its port is kept
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialBridge::reset()
+{
+	if (mode == forward_frame)
+		abortForward();
+
+	mode      = find_header;
+	headerLen = 0;
+
+	Transfer::reset();
+}
+
+
+/*
+ bool SerialBridge::portBusy(const Stream& out)
+ Description:
+ ------------
+  * Whether or not a bridge is in the middle of relaying a frame to
+  "out". Sketches sending their own packets on a port bridges relay
+  to must wait for this to clear or the frames interleave
+ Inputs:
+ -------
+  * const Stream& out - Port to check
+ Return:
+ -------
+  * bool - Whether or not "out" is busy
+*/
+bool SerialBridge::portBusy(const Stream& out)
+{
+	for (SerialBridge* bridge = bridges; bridge; bridge = bridge->next)
+		if ((bridge->mode == forward_frame) && bridge->direct && (bridge->out == &out))
+			return true;
+
+	return false;
+}
+
+
+/*
+ void SerialBridge::beginBridge()
+ Description:
+ ------------
+  * Resets the relay state shared by both initializers
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialBridge::beginBridge()
+{
+	mode      = find_header;
+	headerLen = 0;
+	holdLen   = 0;
+	direct    = false;
+	out       = NULL;
+}
+
+
+/*
+ bool SerialBridge::process()
+ Description:
+ ------------
+  * Runs the bytes left in rxChunk through the bridge: preambles are
+  collected and routed, relayed frames are passed on and the others
+  are parsed
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not available() should return now, either with
+  a packet/error or because a relayed frame has to wait for its port
+*/
+bool SerialBridge::process()
+{
+	while (rxPos < rxLen)
+	{
+		switch (mode)
+		{
+		case find_header:
+		{
+			uint8_t val;
+
+			if (holdLen && !flushHold()) // Held frame still waiting for its port, leave the input unread meanwhile
+				return true;
+
+			val = rxChunk[rxPos++];
+
+			if (!headerLen && (val != START_BYTE))
+				break;
+
+			header[headerLen++] = val;
+			lastRx              = packet.now();
+
+			if ((headerLen == PREAMBLE_SIZE) && routeFrame())
+				return true;
+
+			break;
+		}
+
+		case local_frame:
+		{
+			uint16_t consumed;
+			bool     done = parseBytes(rxChunk + rxPos, rxLen - rxPos, consumed);
+
+			rxPos += consumed;
+
+			if (!packet.pendingBytes())
+				mode = find_header;
+
+			if (done)
+				return true;
+
+			break;
+		}
+
+		case forward_frame:
+		{
+			uint16_t relayed = forwardBytes(rxChunk + rxPos, rxLen - rxPos);
+
+			if (!relayed) // Hold full - stall the input until the port frees up
+				return true;
+
+			rxPos += relayed;
+			lastRx = packet.now();
+			break;
+		}
+		}
+	}
+
+	return false;
+}
+
+
+/*
+ bool SerialBridge::routeFrame()
+ Description:
+ ------------
+  * Matches a complete preamble against the routes. A routed frame
+  starts relaying right away, any other frame is handed to the parser
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not the parser reported an error in the preamble
+*/
+bool SerialBridge::routeFrame()
+{
+	uint16_t command = ((uint16_t)header[2] << 8) | header[3];
+	uint16_t len     = ((uint16_t)header[5] << 8) | header[6];
+	uint16_t consumed;
+
+	headerLen = 0;
+
+	if (!(command & CONTROL_FLAG) && len && (len <= MAX_PACKET_SIZE) && ((command & ~COMMAND_FLAGS) <= MAX_PACKET_SIZE))
+	{
+		for (uint8_t i = 0; i < numRoutes; i++)
+		{
+			if (((header[1] ^ routes[i].packetID) & routes[i].idMask) || (((command & ~COMMAND_FLAGS) ^ routes[i].command) & routes[i].commandMask))
+				continue;
+
+			out         = routes[i].port;
+			direct      = !portBusy(*out);
+			frameLeft   = len + POSTAMBLE_SIZE;
+			payloadLeft = len;
+			frameCrc    = 0;
+			recvCrc     = 0;
+			mode        = forward_frame;
+
+			emit(header, PREAMBLE_SIZE);
+
+			return false;
+		}
+	}
+
+	mode = local_frame;
+
+	if (parseBytes(header, PREAMBLE_SIZE, consumed))
+	{
+		mode = find_header;
+		return true;
+	}
+
+	return false;
+}
+
+
+/*
+ uint16_t SerialBridge::forwardBytes(const uint8_t arr[], const uint16_t& len)
+ Description:
+ ------------
+  * Relays bytes of the current frame, checking its CRC on the way. The
+  STOP byte is only passed on once the CRC is known to match, otherwise
+  BRIDGE_ABORT_BYTE takes its place
+ Inputs:
+ -------
+  * const uint8_t arr[] - Received bytes
+  * const uint16_t& len - Number of bytes in arr[]
+ Return:
+ -------
+  * uint16_t - Number of bytes of arr[] relayed (0 if the hold is full)
+*/
+uint16_t SerialBridge::forwardBytes(const uint8_t arr[], const uint16_t& len)
+{
+	uint16_t run = len;
+	uint16_t body;
+
+	if (run > frameLeft)
+		run = frameLeft;
+
+	if (!direct && !flushHold())
+	{
+		if (run > (sizeof(hold) - holdLen))
+			run = sizeof(hold) - holdLen;
+
+		if (!run)
+			return 0;
+	}
+
+	body = run;
+
+	if (run == frameLeft)
+		body--;
+
+	for (uint16_t i = 0; i < body; i++)
+	{
+		if (payloadLeft)
+		{
+			frameCrc = crc.calculate(frameCrc ^ arr[i]);
+			payloadLeft--;
+		}
+		else
+			recvCrc = (recvCrc << 8) | arr[i];
+	}
+
+	emit(arr, body);
+	frameLeft -= run;
+
+	if (!frameLeft)
+	{
+		uint8_t stop = arr[body];
+
+		if (verifyCrc && ((stop != STOP_BYTE) || (frameCrc != recvCrc)))
+		{
+			if (debug)
+				debugPort->println("ERROR: RELAYED PACKET FAILED CRC CHECK");
+
+			stop = BRIDGE_ABORT_BYTE;
+			forwardErrors++;
+		}
+		else
+			framesForwarded++;
+
+		emit(&stop, 1);
+		mode = find_header;
+		flushHold();
+	}
+
+	return run;
+}
+
+
+/*
+ void SerialBridge::emit(const uint8_t arr[], const uint16_t& len)
+ Description:
+ ------------
+  * Writes relayed bytes to the route's port, or holds them while
+  another bridge is relaying to it
+ Inputs:
+ -------
+  * const uint8_t arr[] - Bytes to relay
+  * const uint16_t& len - Number of bytes in arr[] (must fit the hold)
+ Return:
+ -------
+  * void
+*/
+void SerialBridge::emit(const uint8_t arr[], const uint16_t& len)
+{
+	if (direct)
+	{
+		out->write(arr, len);
+		return;
+	}
+
+	memcpy(hold + holdLen, arr, len);
+	holdLen += len;
+}
+
+
+/*
+ bool SerialBridge::flushHold()
+ Description:
+ ------------
+  * Writes held bytes to the route's port once no other bridge is
+  relaying to it. The rest of the frame then goes out directly
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not the hold is empty
+*/
+bool SerialBridge::flushHold()
+{
+	if (!holdLen)
+		return true;
+
+	if (portBusy(*out))
+		return false;
+
+	out->write(hold, holdLen);
+	holdLen = 0;
+
+	if (mode == forward_frame)
+		direct = true;
+
+	return true;
+}
+
+
+/*
+ void SerialBridge::abortForward()
+ Description:
+ ------------
+  * Gives up on the frame being relayed. A frame still in the hold is
+  dropped, one partly written is padded out with BRIDGE_ABORT_BYTE
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialBridge::abortForward()
+{
+	forwardErrors++;
+
+	if (direct)
+	{
+		while (frameLeft--)
+			out->write(BRIDGE_ABORT_BYTE);
+	}
+	else
+		holdLen = 0;
+
+	frameLeft = 0;
+	mode      = find_header;
+}
+
+
+/*
+ uint16_t SerialBridge::readBytes(uint8_t arr[], const uint16_t& len)
+ Description:
+ ------------
+  * Reads whatever the port has buffered, up to "len" bytes
+ Inputs:
+ -------
+  * uint8_t arr[] - Buffer to copy received bytes into
+  * const uint16_t& len - Size of arr[]
+ Return:
+ -------
+  * uint16_t - Number of bytes copied into arr[]
+*/
+uint16_t SerialBridge::readBytes(uint8_t arr[], const uint16_t& len)
+{
+	uint16_t count = 0;
+
+	while ((count < len) && port->available())
+		arr[count++] = port->read();
+
+	return count;
+}
+
+
+/*
+ bool SerialBridge::prepareSend(const uint16_t& messageLen)
+ Description:
+ ------------
+  * Keeps packets sent back on the port from landing in the middle of
+  a frame another bridge is relaying to it
+ Inputs:
+ -------
+  * const uint16_t& messageLen - Number of payload bytes to send
+ Return:
+ -------
+  * bool - Whether or not the port is free
+*/
+bool SerialBridge::prepareSend(const uint16_t& messageLen)
+{
+	(void)messageLen;
+
+	return !portBusy(*port);
+}
+
+
+/*
+ bool SerialBridge::writeFrame()
+ Description:
+ ------------
+  * Writes the constructed packet to the port
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not the packet was written (always)
+*/
+bool SerialBridge::writeFrame()
+{
+	port->write(packet.preamble, sizeof(packet.preamble));
+	port->write(packet.txPayload, packet.bytesToSend);
+	port->write(packet.postamble, sizeof(packet.postamble));
+
+	return true;
+}
+
+
+/*
+ bool SerialBridge::acceptPacket()
+ Description:
+ ------------
+  * Control packets are dropped, flow control is not supported on
+  bridged ports
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not to report the packet just parsed
+*/
+bool SerialBridge::acceptPacket()
+{
+	return !(packet.currentFlags() & CONTROL_FLAG);
+}
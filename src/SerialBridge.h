@@ -0,0 +1,108 @@
+#pragma once
+#include "Arduino.h"
+#include "Packet.h"
+#include "Transfer.h"
+
+
+#ifndef BRIDGE_MAX_ROUTES
+#define BRIDGE_MAX_ROUTES 8
+#endif
+
+#ifndef BRIDGE_HOLD_SIZE
+#define BRIDGE_HOLD_SIZE PACKET_SIZE // Bytes buffered while another bridge is relaying to the same port, smaller values stall the input instead
+#endif
+
+
+const uint8_t BRIDGE_ABORT_BYTE = 0x00; // Sent in place of the STOP byte of a relayed frame that failed its CRC check
+
+
+struct bridgeRouteST
+{
+	Stream*  port        = NULL; // Port matching frames are relayed to
+	uint8_t  packetID    = 0;
+	uint8_t  idMask      = 0;    // Packet ID bits that must equal packetID, 0 matches any ID
+	uint16_t command     = 0;
+	uint16_t commandMask = 0;    // Command bits (library flags excluded) that must equal command, 0 matches any command
+};
+
+
+/*
+ class SerialBridge
+ Description:
+ ------------
+  * Receives from one port like SerialTransfer, but relays every frame
+  whose header matches a route to that route's port as it arrives
+  (cut-through) instead of storing the whole packet first. Only the
+  preamble is buffered; the CRC of a relayed frame is checked on the
+  fly and its STOP byte held back until then, so a corrupted frame is
+  never passed on as a valid one. Frames that match no route are
+  parsed and reported by available() as usual
+*/
+class SerialBridge : public Transfer<SerialBridge>
+{
+  public: // <<---------------------------------------//public
+	uint32_t framesForwarded = 0; // Frames relayed intact
+	uint32_t forwardErrors   = 0; // Relayed frames that failed the CRC check or stalled part way
+
+
+	SerialBridge();
+	~SerialBridge();
+	void     begin(Stream& _port, const configST configs);
+	void     begin(Stream& _port, const uint8_t _debug = 0, Stream& _debugPort = Serial, uint32_t _timeout = DEFAULT_TIMEOUT);
+	bool     addRoute(const bridgeRouteST& route);
+	bool     routeID(Stream& out, const uint8_t& packetID, const uint8_t& idMask = 0xFF);
+	bool     routeCommand(Stream& out, const uint16_t& command, const uint16_t& commandMask = 0xFFFF);
+	void     clearRoutes();
+	uint16_t available();
+	void     reset();
+
+	static bool portBusy(const Stream& out);
+
+
+  private: // <<---------------------------------------//private
+	friend class Transfer<SerialBridge>;
+
+	enum bridgeMode
+	{
+		find_header,
+		local_frame,
+		forward_frame
+	};
+
+	static SerialBridge* bridges; // Every bridge, to keep relayed frames from interleaving on a shared port
+
+	SerialBridge* next = NULL;
+	Stream*       port = NULL;
+
+	bridgeRouteST routes[BRIDGE_MAX_ROUTES];
+	uint8_t       numRoutes = 0;
+
+	bridgeMode mode = find_header;
+	uint8_t    header[PREAMBLE_SIZE];
+	uint8_t    headerLen = 0;
+	uint32_t   lastRx    = 0;    // When the current frame last received a byte
+	bool       verifyCrc = true; // FEC frames are checked by the next hop only, their CRC covers the decoded payload
+
+	Stream*  out         = NULL;  // Port the current frame is relayed to
+	bool     direct      = false; // Whether the current frame is written straight to "out" rather than held
+	uint16_t frameLeft   = 0;     // Bytes of the current frame not relayed yet, postamble included
+	uint16_t payloadLeft = 0;
+	uint8_t  frameCrc    = 0;
+	uint16_t recvCrc     = 0;
+
+	uint8_t  hold[BRIDGE_HOLD_SIZE];
+	uint16_t holdLen = 0;
+
+
+	void     beginBridge();
+	bool     process();
+	bool     routeFrame();
+	uint16_t forwardBytes(const uint8_t arr[], const uint16_t& len);
+	void     emit(const uint8_t arr[], const uint16_t& len);
+	bool     flushHold();
+	void     abortForward();
+	uint16_t readBytes(uint8_t arr[], const uint16_t& len);
+	bool     prepareSend(const uint16_t& messageLen);
+	bool     writeFrame();
+	bool     acceptPacket();
+};
@@ -0,0 +1,577 @@
+#include "SerialGateway.h"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+
+const uint32_t GATEWAY_SEND_TOKEN = 0xFFFFFFFF; // epoll tag of the send eventfd, links are tagged with their index
+const int      GATEWAY_IDLE_MS    = 100;        // Max ms between stale packet checks on quiet links
+const uint32_t GATEWAY_STALL_MS   = 1000;       // Max ms to wait for a full worker or send queue before dropping
+
+
+/*
+ SerialGateway::SerialGateway()
+ Description:
+ ------------
+  * Constructor for the SerialGateway Class
+*/
+SerialGateway::SerialGateway()
+{
+	for (uint8_t i = 0; i < GATEWAY_MAX_LINKS; i++)
+		links[i] = NULL;
+}
+
+
+/*
+ SerialGateway::~SerialGateway()
+ Description:
+ ------------
+  * Stops the gateway and closes every link
+*/
+SerialGateway::~SerialGateway()
+{
+	end();
+
+	for (uint8_t i = 0; i < numLinks; i++)
+		delete links[i];
+}
+
+
+/*
+ int16_t SerialGateway::addLink(const char* path, const uint32_t& baud, const configST& configs)
+ Description:
+ ------------
+  * Opens a serial port and adds it to the gateway. Links can only be
+  added before begin()
+ Inputs:
+ -------
+  * const char* path - Device to open (i.e. "/dev/ttyUSB0")
+  * const uint32_t& baud - Baud rate
+  * const configST& configs - SerialTransfer settings of the link
+ Return:
+ -------
+  * int16_t - Link index, -1 on failure
+*/
+int16_t SerialGateway::addLink(const char* path, const uint32_t& baud, const configST& configs)
+{
+	Link* link = new Link;
+
+	if (!link->port.begin(path, baud))
+	{
+		delete link;
+		return -1;
+	}
+
+	return addLink(link, configs);
+}
+
+
+/*
+ int16_t SerialGateway::addLink(const int& fd, const uint32_t& baud, const configST& configs)
+ Description:
+ ------------
+  * Adds a tty file descriptor opened elsewhere (i.e. a pty master) to
+  the gateway. Links can only be added before begin()
+ Inputs:
+ -------
+  * const int& fd - Open tty file descriptor, left open by the gateway
+  * const uint32_t& baud - Baud rate, 0 to leave it unchanged
+  * const configST& configs - SerialTransfer settings of the link
+ Return:
+ -------
+  * int16_t - Link index, -1 on failure
+*/
+int16_t SerialGateway::addLink(const int& fd, const uint32_t& baud, const configST& configs)
+{
+	Link* link = new Link;
+
+	if (!link->port.begin(fd, baud))
+	{
+		delete link;
+		return -1;
+	}
+
+	return addLink(link, configs);
+}
+
+
+/*
+ bool SerialGateway::begin(gatewayHandler _handler, const uint8_t& _workers)
+ Description:
+ ------------
+  * Starts the event loop and the worker pool
+ Inputs:
+ -------
+  * gatewayHandler _handler - Called by a worker thread for every
+  packet received. Packets of a link are always handled by the same
+  worker, in order
+  * const uint8_t& _workers - Number of worker threads
+ Return:
+ -------
+  * bool - Whether or not the gateway started
+*/
+bool SerialGateway::begin(gatewayHandler _handler, const uint8_t& _workers)
+{
+	struct epoll_event event;
+
+	if (running || !_handler || !_workers || (_workers > GATEWAY_MAX_WORKERS))
+		return false;
+
+	handler    = _handler;
+	numWorkers = _workers;
+	epollFd    = epoll_create1(EPOLL_CLOEXEC);
+	sendFd     = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if ((epollFd < 0) || (sendFd < 0))
+		return false;
+
+	event.events   = EPOLLIN;
+	event.data.u32 = GATEWAY_SEND_TOKEN;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, sendFd, &event);
+
+	for (uint8_t i = 0; i < numLinks; i++)
+	{
+		event.events   = EPOLLIN;
+		event.data.u32 = i;
+
+		if (epoll_ctl(epollFd, EPOLL_CTL_ADD, links[i]->port.fileDescriptor(), &event) < 0)
+			return false;
+	}
+
+	running = true;
+
+	for (uint8_t i = 0; i < numWorkers; i++)
+	{
+		workers[i].wakeFd = eventfd(0, EFD_CLOEXEC);
+		workers[i].thread = std::thread(&SerialGateway::workerLoop, this, i);
+	}
+
+	loopThread = std::thread(&SerialGateway::eventLoop, this);
+
+	return true;
+}
+
+
+/*
+ void SerialGateway::end()
+ Description:
+ ------------
+  * Stops the event loop and the worker pool. Packets still queued
+  are dropped
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialGateway::end()
+{
+	if (!running)
+		return;
+
+	running = false;
+	wake(sendFd);
+	loopThread.join();
+
+	for (uint8_t i = 0; i < numWorkers; i++)
+	{
+		wake(workers[i].wakeFd);
+		workers[i].thread.join();
+		close(workers[i].wakeFd);
+		workers[i].wakeFd = -1;
+	}
+
+	close(epollFd);
+	close(sendFd);
+	epollFd = -1;
+	sendFd  = -1;
+}
+
+
+/*
+ bool SerialGateway::send(const uint8_t& link, const uint8_t payload[], const uint16_t& len, const uint16_t& command, const uint8_t& packetID)
+ Description:
+ ------------
+  * Queues a packet for the event loop to send over a link. Each
+  link's queue takes a single producer: call send() for a given link
+  from one thread only (i.e. the worker handling that link). While the
+  link's queue is full, send() waits for the event loop to drain it
+  (backpressure), for up to GATEWAY_STALL_MS
+ Inputs:
+ -------
+  * const uint8_t& link - Link index
+  * const uint8_t payload[] - Payload to send
+  * const uint16_t& len - Number of bytes in payload[]
+  * const uint16_t& command - The packet 16-bit command
+  * const uint8_t& packetID - The packet 8-bit identifier
+ Return:
+ -------
+  * bool - Whether or not the packet was queued (counted in the link's
+  txDropped if not)
+*/
+bool SerialGateway::send(const uint8_t& link, const uint8_t payload[], const uint16_t& len, const uint16_t& command, const uint8_t& packetID)
+{
+	if ((link >= numLinks) || (len > MAX_PACKET_SIZE))
+		return false;
+
+	GatewayPacket* slot  = links[link]->sendQueue.pushSlot();
+	uint32_t       start = millis();
+
+	while (!slot && running && ((millis() - start) < GATEWAY_STALL_MS))
+	{
+		if (!sendPending.exchange(true)) // Make sure the loop knows there is something to drain
+			wake(sendFd);
+
+		std::this_thread::yield();
+		slot = links[link]->sendQueue.pushSlot();
+	}
+
+	if (!slot)
+	{
+		links[link]->txDropped++;
+		return false;
+	}
+
+	slot->link     = link;
+	slot->packetID = packetID;
+	slot->command  = command;
+	slot->len      = len;
+	memcpy(slot->payload, payload, len);
+	links[link]->sendQueue.commitPush();
+
+	if (!sendPending.exchange(true)) // Only the first packet queued since the loop last looked needs a wakeup
+		wake(sendFd);
+
+	return true;
+}
+
+
+/*
+ uint8_t SerialGateway::linkCount()
+ Description:
+ ------------
+  * Returns the number of links added
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint8_t - Number of links
+*/
+uint8_t SerialGateway::linkCount()
+{
+	return numLinks;
+}
+
+
+/*
+ GatewayLinkStats SerialGateway::linkStats(const uint8_t& link)
+ Description:
+ ------------
+  * Returns the packet counters of a link
+ Inputs:
+ -------
+  * const uint8_t& link - Link index
+ Return:
+ -------
+  * GatewayLinkStats - Counters since the link was added
+*/
+GatewayLinkStats SerialGateway::linkStats(const uint8_t& link)
+{
+	GatewayLinkStats stats;
+
+	memset(&stats, 0, sizeof(stats));
+
+	if (link >= numLinks)
+		return stats;
+
+	stats.rxPackets = links[link]->rxPackets;
+	stats.rxDropped = links[link]->rxDropped;
+	stats.txPackets = links[link]->txPackets;
+	stats.txDropped = links[link]->txDropped;
+	stats.rxErrors  = links[link]->rxErrors;
+	stats.connected = links[link]->connected;
+
+	return stats;
+}
+
+
+/*
+ int16_t SerialGateway::addLink(Link* link, const configST& configs)
+ Description:
+ ------------
+  * Registers an opened link
+ Inputs:
+ -------
+  * Link* link - Link with its port opened, owned by the gateway
+  from here on
+  * const configST& configs - SerialTransfer settings of the link
+ Return:
+ -------
+  * int16_t - Link index, -1 on failure
+*/
+int16_t SerialGateway::addLink(Link* link, const configST& configs)
+{
+	if (running || (numLinks >= GATEWAY_MAX_LINKS))
+	{
+		delete link;
+		return -1;
+	}
+
+	link->transfer.begin(link->port, configs);
+	links[numLinks] = link;
+
+	return numLinks++;
+}
+
+
+/*
+ void SerialGateway::eventLoop()
+ Description:
+ ------------
+  * Event loop thread - parses every link that has bytes waiting and
+  sends whatever has been queued
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialGateway::eventLoop()
+{
+	struct epoll_event events[GATEWAY_MAX_LINKS + 1];
+
+	while (running)
+	{
+		int count = epoll_wait(epollFd, events, numLinks + 1, GATEWAY_IDLE_MS);
+
+		if (count < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			break;
+		}
+
+		if (!count) // Quiet - let partially received packets go stale
+			for (uint8_t i = 0; i < numLinks; i++)
+				readLink(i);
+
+		for (int i = 0; i < count; i++)
+		{
+			if (events[i].data.u32 == GATEWAY_SEND_TOKEN)
+			{
+				uint64_t value;
+
+				if (::read(sendFd, &value, sizeof(value)) < 0)
+					continue;
+			}
+			else
+			{
+				uint8_t index = events[i].data.u32;
+
+				readLink(index);
+
+				if (events[i].events & (EPOLLHUP | EPOLLERR)) // Unplugged - stop polling the port instead of spinning on it
+				{
+					epoll_ctl(epollFd, EPOLL_CTL_DEL, links[index]->port.fileDescriptor(), NULL);
+					links[index]->connected = false;
+				}
+			}
+		}
+
+		sendQueued();
+	}
+}
+
+
+/*
+ void SerialGateway::readLink(const uint8_t& index)
+ Description:
+ ------------
+  * Parses every packet a link has received and queues them for the
+  link's worker, along with any link statistics the peer sent (as a
+  STATS_COMMAND packet). While the worker's queue is full, the event loop
+  waits for it rather than dropping packets. Packets the workers queue
+  to send meanwhile are sent as they come, so a worker waiting in
+  send() is never stuck behind a long burst of received packets
+ Inputs:
+ -------
+  * const uint8_t& index - Link index
+ Return:
+ -------
+  * void
+*/
+void SerialGateway::readLink(const uint8_t& index)
+{
+	Link&   link   = *links[index];
+	Worker& worker = workers[index % numWorkers];
+
+	while (true)
+	{
+		if (sendPending)
+			sendQueued();
+
+		uint16_t       len      = link.transfer.available();
+		uint16_t       command  = link.transfer.currentCommand();
+		uint8_t        packetID = link.transfer.currentPacketID();
+		const uint8_t* payload  = link.transfer.packet.rxBuff;
+		uint8_t        stats[STATS_SIZE];
+
+		if (!len && (link.transfer.peerStatsReceived != link.peerStatsSeen)) // Hand the peer's link statistics over like a packet
+		{
+			link.peerStatsSeen = link.transfer.peerStatsReceived;
+			len                = Packet::writeStats(stats, link.transfer.peerStats);
+			command            = STATS_COMMAND;
+			packetID           = 0;
+			payload            = stats;
+		}
+
+		if (!len)
+		{
+			if (link.transfer.status <= 0)
+				link.rxErrors++;
+
+			break;
+		}
+
+		GatewayPacket* slot  = worker.queue.pushSlot();
+		uint32_t       start = millis();
+
+		while (!slot && running && ((millis() - start) < GATEWAY_STALL_MS)) // Backpressure - unread bytes wait in the kernel
+		{
+			if (sendPending) // The worker may be waiting in send() itself
+				sendQueued();
+
+			std::this_thread::yield();
+			slot = worker.queue.pushSlot();
+		}
+
+		if (!slot)
+		{
+			link.rxDropped++;
+			continue;
+		}
+
+		slot->link     = index;
+		slot->packetID = packetID;
+		slot->command  = command;
+		slot->len      = len;
+		memcpy(slot->payload, payload, len);
+		worker.queue.commitPush();
+		link.rxPackets++;
+
+		if (worker.sleeping.exchange(false))
+			wake(worker.wakeFd);
+	}
+}
+
+
+/*
+ void SerialGateway::sendQueued()
+ Description:
+ ------------
+  * Sends the packets queued on every link
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialGateway::sendQueued()
+{
+	sendPending = false; // Before looking, so that a packet queued meanwhile wakes the loop again
+
+	for (uint8_t i = 0; i < numLinks; i++)
+	{
+		Link&          link = *links[i];
+		GatewayPacket* slot;
+
+		while ((slot = link.sendQueue.frontSlot()))
+		{
+			memcpy(link.transfer.packet.txBuff, slot->payload, slot->len);
+
+			if (link.transfer.sendData(slot->len, slot->command, slot->packetID) || !slot->len)
+				link.txPackets++;
+			else
+				link.txDropped++;
+
+			link.sendQueue.commitPop();
+		}
+	}
+}
+
+
+/*
+ void SerialGateway::workerLoop(const uint8_t& index)
+ Description:
+ ------------
+  * Worker thread - runs the handler on every packet queued for it,
+  sleeping on its eventfd while the queue is empty
+ Inputs:
+ -------
+  * const uint8_t& index - Worker index
+ Return:
+ -------
+  * void
+*/
+void SerialGateway::workerLoop(const uint8_t& index)
+{
+	Worker& worker = workers[index];
+
+	while (running)
+	{
+		GatewayPacket* slot = worker.queue.frontSlot();
+
+		if (slot)
+		{
+			handler(*this, *slot);
+			worker.queue.commitPop();
+			continue;
+		}
+
+		worker.sleeping = true;
+
+		if (!worker.queue.empty()) // Queued between the check above and announcing sleep
+		{
+			worker.sleeping = false;
+			continue;
+		}
+
+		uint64_t value;
+
+		if (::read(worker.wakeFd, &value, sizeof(value)) < 0)
+			break;
+	}
+}
+
+
+/*
+ void SerialGateway::wake(const int& fd)
+ Description:
+ ------------
+  * Signals an eventfd
+ Inputs:
+ -------
+  * const int& fd - eventfd to signal
+ Return:
+ -------
+  * void
+*/
+void SerialGateway::wake(const int& fd)
+{
+	uint64_t value = 1;
+
+	if (::write(fd, &value, sizeof(value)) < 0)
+		return;
+}
+
+
+#endif // defined(__linux__) && !defined(ARDUINO)
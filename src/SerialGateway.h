@@ -0,0 +1,187 @@
+#pragma once
+#include "Arduino.h"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include "Packet.h"
+#include "PosixSerial.h"
+#include "SerialTransfer.h"
+#include <atomic>
+#include <thread>
+
+
+#ifndef GATEWAY_MAX_LINKS
+#define GATEWAY_MAX_LINKS 64
+#endif
+
+#ifndef GATEWAY_MAX_WORKERS
+#define GATEWAY_MAX_WORKERS 16
+#endif
+
+#ifndef GATEWAY_WORKER_QUEUE_SIZE
+#define GATEWAY_WORKER_QUEUE_SIZE 256 // Parsed packets waiting per worker, power of 2
+#endif
+
+#ifndef GATEWAY_SEND_QUEUE_SIZE
+#define GATEWAY_SEND_QUEUE_SIZE 16 // Packets waiting to be sent per link, power of 2
+#endif
+
+
+struct GatewayPacket
+{
+	uint8_t  link;
+	uint8_t  packetID;
+	uint16_t command;
+	uint16_t len;
+	uint8_t  payload[MAX_PACKET_SIZE];
+};
+
+
+struct GatewayLinkStats
+{
+	uint32_t rxPackets; // Packets handed to a worker
+	uint32_t rxDropped; // Packets dropped because the worker queue was full
+	uint32_t txPackets; // Packets sent
+	uint32_t txDropped; // Packets not sent: send() timed out on a full send queue, or the link refused them
+	uint32_t rxErrors;  // Framing/CRC errors
+	bool     connected; // Whether or not the port is still open (cleared on hang up)
+};
+
+
+class SerialGateway;
+
+typedef void (*gatewayHandler)(SerialGateway& gateway, const GatewayPacket& packet);
+
+
+/*
+ template <typename T, uint16_t size> class SpscQueue
+ Description:
+ ------------
+  * Lock-free single producer, single consumer ring of "size" slots
+  (a power of 2). The producer fills a slot in place through
+  pushSlot()/commitPush() and the consumer reads it in place through
+  frontSlot()/commitPop(), so packets are copied only once
+*/
+template <typename T, uint16_t size>
+class SpscQueue
+{
+  public: // <<---------------------------------------//public
+	T* pushSlot()
+	{
+		uint32_t head = headIndex.load(std::memory_order_relaxed);
+
+		if ((head - tailIndex.load(std::memory_order_acquire)) == size)
+			return NULL;
+
+		return &slots[head & (size - 1)];
+	}
+
+	void commitPush()
+	{
+		headIndex.store(headIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	T* frontSlot()
+	{
+		uint32_t tail = tailIndex.load(std::memory_order_relaxed);
+
+		if (tail == headIndex.load(std::memory_order_acquire))
+			return NULL;
+
+		return &slots[tail & (size - 1)];
+	}
+
+	void commitPop()
+	{
+		tailIndex.store(tailIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	bool empty()
+	{
+		return tailIndex.load(std::memory_order_acquire) == headIndex.load(std::memory_order_acquire);
+	}
+
+
+  private: // <<---------------------------------------//private
+	T slots[size];
+
+	std::atomic<uint32_t> headIndex{0}; // Written by the producer only
+	uint8_t               padding[60];  // Keeps the indices on separate cache lines
+	std::atomic<uint32_t> tailIndex{0}; // Written by the consumer only
+};
+
+
+/*
+ class SerialGateway
+ Description:
+ ------------
+  * Serves many SerialTransfer links from one process. A single event
+  loop thread waits on every port with epoll, parses whatever arrived
+  and hands each packet to a pool of worker threads through lock-free
+  queues. Every link is pinned to one worker (link % workers) so its
+  packets are handled in order. Packets to send are queued per link
+  and written by the event loop thread
+*/
+class SerialGateway
+{
+  public: // <<---------------------------------------//public
+	SerialGateway();
+	~SerialGateway();
+	int16_t          addLink(const char* path, const uint32_t& baud, const configST& configs);
+	int16_t          addLink(const int& fd, const uint32_t& baud, const configST& configs);
+	bool             begin(gatewayHandler _handler, const uint8_t& _workers = 1);
+	void             end();
+	bool             send(const uint8_t& link, const uint8_t payload[], const uint16_t& len, const uint16_t& command = 0, const uint8_t& packetID = 0);
+	uint8_t          linkCount();
+	GatewayLinkStats linkStats(const uint8_t& link);
+
+
+  private: // <<---------------------------------------//private
+	struct Link
+	{
+		PosixSerial    port;
+		SerialTransfer transfer;
+
+		SpscQueue<GatewayPacket, GATEWAY_SEND_QUEUE_SIZE> sendQueue;
+
+		std::atomic<uint32_t> rxPackets{0};
+		std::atomic<uint32_t> rxDropped{0};
+		std::atomic<uint32_t> txPackets{0};
+		std::atomic<uint32_t> txDropped{0};
+		std::atomic<uint32_t> rxErrors{0};
+		std::atomic<bool>     connected{true};
+		uint32_t              peerStatsSeen = 0; // transfer.peerStatsReceived when the peer's statistics were last queued
+	};
+
+	struct Worker
+	{
+		SpscQueue<GatewayPacket, GATEWAY_WORKER_QUEUE_SIZE> queue;
+
+		int               wakeFd = -1;
+		std::atomic<bool> sleeping{false};
+		std::thread       thread;
+	};
+
+	Link*          links[GATEWAY_MAX_LINKS];
+	uint8_t        numLinks = 0;
+	Worker         workers[GATEWAY_MAX_WORKERS];
+	uint8_t        numWorkers = 0;
+	gatewayHandler handler    = NULL;
+
+	int               epollFd = -1;
+	int               sendFd  = -1; // eventfd - wakes the event loop when packets are queued to send
+	std::atomic<bool> sendPending{false};
+	std::atomic<bool> running{false};
+	std::thread       loopThread;
+
+
+	int16_t addLink(Link* link, const configST& configs);
+	void    eventLoop();
+	void    readLink(const uint8_t& index);
+	void    sendQueued();
+	void    workerLoop(const uint8_t& index);
+	void    wake(const int& fd);
+};
+
+
+#endif // defined(__linux__) && !defined(ARDUINO)
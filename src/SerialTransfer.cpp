@@ -1,247 +1,782 @@
-#include "SerialTransfer.h"
-
-
-/*
- void SerialTransfer::begin(Stream &_port, configST configs)
- Description:
- ------------
-  * Advanced initializer for the SerialTransfer Class
- Inputs:
- -------
-  * const Stream &_port - Serial port to communicate over
-  * const configST configs - Struct that holds config
-  values for all possible initialization parameters
- Return:
- -------
-  * void
-*/
-void SerialTransfer::begin(Stream& _port, const configST configs)
-{
-	port = &_port;
-	packet.begin(configs);
-}
-
-
-/*
- void SerialTransfer::begin(Stream &_port, const bool _debug, Stream &_debugPort)
- Description:
- ------------
-  * Simple initializer for the SerialTransfer Class
- Inputs:
- -------
-  * const Stream &_port - Serial port to communicate over
-  * const bool _debug - Whether or not to print error messages; 0 = none, 1 = limited, 2 = verbose send, 3 = verbose receive
-  * const Stream &_debugPort - Serial port to print error messages
- Return:
- -------
-  * void
-*/
-void SerialTransfer::begin(Stream& _port, const uint8_t _debug, Stream& _debugPort, uint32_t _timeout)
-{
-	debug   = _debug;
-	debugPort = &_debugPort;
-	port    = &_port;
-	timeout = _timeout;
-	packet.begin(_debug, _debugPort, _timeout);
-}
-
-
-/*
- uint8_t SerialTransfer::sendData(const uint16_t &messageLen, const uint8_t packetID)
- Description:
- ------------
-  * Send a specified number of bytes in packetized form
- Inputs:
- -------
-  * const uint16_t &messageLen - Number of values in txBuff
-  to send as the payload in the next packet
-  * const uint8_t packetID - The packet 8-bit identifier
- Return:
- -------
-  * uint8_t numBytesIncl - Number of payload bytes included in packet
-*/
-uint16_t SerialTransfer::sendData(const uint16_t& messageLen, const uint16_t command, const uint8_t packetID)
-{
-	uint16_t numBytesIncl;
-
-	if (debug == 2) {
-		debugPort->printf("sendData.messageLen: %d, command: %d, packetID: %d\n", messageLen, command, packetID);
-	}
-
-	numBytesIncl = packet.constructPacket(messageLen, command, packetID);
-
-	if (debug == 2) {
-		debugPort->printf("sendData.numBytesIncl: %d\n", numBytesIncl);
-		debugPort->print("sendData.premable: ");
-		for (size_t i = 0; i < PREAMBLE_SIZE; i++)
-			debugPort->printf("%d ", packet.preamble[i]);
-		Serial.println();
-		debugPort->print("sendData.message: ");
-		for (size_t i = 0; i < numBytesIncl; i++)
-			debugPort->printf("%d ", packet.txBuff[i]);
-		Serial.println();
-		debugPort->print("sendData.postamble: ");
-		for (size_t i = 0; i < POSTAMBLE_SIZE; i++)
-			debugPort->printf("%d ", packet.postamble[i]);
-		Serial.println();
-	}
-
-	port->write(packet.preamble, sizeof(packet.preamble));
-	port->write(packet.txBuff, numBytesIncl);
-	// uint16_t current = numBytesIncl;
-	// while (current > 0) {
-	// 	port->write(packet.txBuff, 64);
-	// 	current -= 64;
-	// }
-	port->write(packet.postamble, sizeof(packet.postamble));
-
-	return numBytesIncl;
-}
-
-
-/*
- uint8_t SerialTransfer::available()
- Description:
- ------------
-  * Parses incoming serial data, analyzes packet contents,
-  and reports errors/successful packet reception
- Inputs:
- -------
-  * void
- Return:
- -------
-  * uint16_t bytesRead - Num bytes in RX buffer
-*/
-uint16_t SerialTransfer::available()
-{
-	bool    valid   = false;
-	uint8_t recChar = 0xFF;
-
-	if (port->available())
-	{
-		valid = true;
-
-		while (port->available())
-		{
-			recChar = port->read();
-
-			bytesRead = packet.parse(recChar, valid);
-			status    = packet.status;
-
-			if (status != CONTINUE)
-			{
-				if (status <= 0)
-					reset();
-
-				break;
-			}
-		}
-	}
-	else
-	{
-		bytesRead = packet.parse(recChar, valid);
-		status    = packet.status;
-
-		if (status <= 0)
-			reset();
-	}
-
-	return bytesRead;
-}
-
-
-/*
- bool SerialTransfer::tick()
- Description:
- ------------
-  * Checks to see if any packets have been fully parsed. This
-  is basically a wrapper around the method "available()" and
-  is used primarily in conjunction with callbacks
- Inputs:
- -------
-  * void
- Return:
- -------
-  * bool - Whether or not a full packet has been parsed
-*/
-bool SerialTransfer::tick()
-{
-	if (available())
-		return true;
-
-	return false;
-}
-
-/*
- uint8_t SerialTransfer::currentCommand()
- Description:
- ------------
-  * Returns the command of the last parsed packet
- Inputs:
- -------
-  * void
- Return:
- -------
-  * uint16_t - command of the last parsed packet
-*/
-uint16_t SerialTransfer::currentCommand()
-{
-	return packet.currentCommand();
-}
-
-/*
- uint8_t SerialTransfer::currentPacketID()
- Description:
- ------------
-  * Returns the ID of the last parsed packet
- Inputs:
- -------
-  * void
- Return:
- -------
-  * uint8_t - ID of the last parsed packet
-*/
-uint8_t SerialTransfer::currentPacketID()
-{
-	return packet.currentPacketID();
-}
-
-/*
- uint8_t SerialTransfer::currentReceived()
- Description:
- ------------
-  * Returns the received bytes of the last parsed packet
- Inputs:
- -------
-  * void
- Return:
- -------
-  * uint16_t - received bytes of the last parsed packet
-*/
-uint16_t SerialTransfer::currentReceived()
-{
-	return packet.currentReceived();
-}
-
-
-/*
- void SerialTransfer::reset()
- Description:
- ------------
-  * Clears out the tx, and rx buffers, plus resets
-  the "bytes read" variable, finite state machine, etc
- Inputs:
- -------
-  * void
- Return:
- -------
-  * void
-*/
-void SerialTransfer::reset()
-{
-	while (port->available())
-		port->read();
-
-	packet.reset();
-	status = packet.status;
-}
+#include "SerialTransfer.h"
+#include "PacketCapture.h"
+#include "PacketFEC.h"
+#include "PacketLatency.h"
+
+
+/*
+ void SerialTransfer::begin(Stream &_port, configST configs)
+ Description:
+ ------------
+  * Advanced initializer for the SerialTransfer Class
+ Inputs:
+ -------
+  * const Stream &_port - Serial port to communicate over
+  * const configST configs - Struct that holds config
+  values for all possible initialization parameters
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::begin(Stream& _port, const configST configs)
+{
+	port        = &_port;
+	bulkPort    = NULL;
+	flowWindow  = configs.flowWindow;
+	flowTimeout = configs.flowTimeout;
+	peerWindow  = configs.flowWindow; // Assume a symmetric link until the peer advertises its window
+	capture      = configs.capture;
+	latency      = configs.latency;
+	pingInterval = configs.pingInterval;
+	pongPending  = false;
+	samples      = 0;
+	sampleSlot   = 0;
+	beginTransfer(configs);
+	lastPing = packet.now();
+
+	if (capture)
+		capture->config(configs.timeout, configs.packed, configs.fec ? configs.fec->parityLen : 0, configs.compressor, lastPing);
+
+	if (flowWindow)
+		sendCredit();
+}
+
+
+/*
+ void SerialTransfer::begin(Stream &_port, const bool _debug, Stream &_debugPort)
+ Description:
+ ------------
+  * Simple initializer for the SerialTransfer Class
+ Inputs:
+ -------
+  * const Stream &_port - Serial port to communicate over
+  * const bool _debug - Whether or not to print error messages; 0 = none, 1+ = errors (per-byte tracing is done by configST.trace)
+  * const Stream &_debugPort - Serial port to print error messages
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::begin(Stream& _port, const uint8_t _debug, Stream& _debugPort, uint32_t _timeout)
+{
+	port     = &_port;
+	bulkPort = NULL;
+	capture  = NULL;
+	beginTransfer(_debug, _debugPort, _timeout);
+}
+
+
+/*
+ void SerialTransfer::begin(BulkStream &_port, configST configs)
+ Description:
+ ------------
+  * Advanced initializer for the SerialTransfer Class on a port that
+  takes whole frames (i.e. a single writev() on PosixSerial) and hands
+  over received bytes in blocks
+ Inputs:
+ -------
+  * const BulkStream &_port - Serial port to communicate over
+  * const configST configs - Struct that holds config
+  values for all possible initialization parameters
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::begin(BulkStream& _port, const configST configs)
+{
+	begin((Stream&)_port, configs);
+	bulkPort = &_port;
+}
+
+
+/*
+ void SerialTransfer::begin(BulkStream &_port, const uint8_t _debug, Stream &_debugPort, uint32_t _timeout)
+ Description:
+ ------------
+  * Simple initializer for the SerialTransfer Class on a BulkStream port
+ Inputs:
+ -------
+  * const BulkStream &_port - Serial port to communicate over
+  * const uint8_t _debug - Whether or not to print error messages; 0 = none, 1+ = errors (per-byte tracing is done by configST.trace)
+  * const Stream &_debugPort - Serial port to print error messages
+  * uint32_t _timeout - ms before a partially received packet goes stale
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::begin(BulkStream& _port, const uint8_t _debug, Stream& _debugPort, uint32_t _timeout)
+{
+	begin((Stream&)_port, _debug, _debugPort, _timeout);
+	bulkPort = &_port;
+}
+
+
+/*
+ uint16_t SerialTransfer::readBytes(uint8_t arr[], const uint16_t& len)
+ Description:
+ ------------
+  * Reads whatever the port has buffered, up to "len" bytes
+ Inputs:
+ -------
+  * uint8_t arr[] - Buffer to copy received bytes into
+  * const uint16_t& len - Size of arr[]
+ Return:
+ -------
+  * uint16_t - Number of bytes copied into arr[]
+*/
+uint16_t SerialTransfer::readBytes(uint8_t arr[], const uint16_t& len)
+{
+	uint16_t count = 0;
+
+	if (bulkPort)
+		count = bulkPort->readAvailable(arr, len);
+	else
+	{
+		int queued = port->available();
+
+		if (queued > packet.stats.rxQueueMax)
+			packet.stats.rxQueueMax = queued;
+
+		while ((count < len) && (count < queued))
+			arr[count++] = port->read();
+	}
+
+	if (count > packet.stats.rxQueueMax) // A BulkStream only says how much it handed over
+		packet.stats.rxQueueMax = count;
+
+	bytesConsumed += count;
+
+	if (capture)
+		capture->rx(arr, count, packet.now());
+
+	return count;
+}
+
+
+/*
+ bool SerialTransfer::prepareSend(const uint16_t& messageLen)
+ Description:
+ ------------
+  * With flow control enabled, waits until the peer has credited the
+  whole frame (or half its window for larger frames, as credit is
+  only advertised every half window), parsing incoming traffic for
+  credit and advertising this end's own as it is consumed. If a
+  packet arrives meanwhile the send is refused rather than leave the
+  peer's credit stuck behind it - read it with available() and send
+  again
+ Inputs:
+ -------
+  * const uint16_t& messageLen - Number of payload bytes to send
+ Return:
+ -------
+  * bool - Whether or not to go ahead with the send
+*/
+bool SerialTransfer::prepareSend(const uint16_t& messageLen)
+{
+	if (!flowWindow)
+		return true;
+
+	uint32_t frameLen = PREAMBLE_SIZE + messageLen + (MAX_PACKET_SIZE - packet.maxPayload()) + POSTAMBLE_SIZE; // Room for FEC parity and the timestamp
+	uint32_t start    = packet.now();
+	bool     ready    = true;
+
+	sending = true;
+
+	while (true)
+	{
+		int32_t credit = (int32_t)(peerConsumed + peerWindow - bytesWritten);
+
+		if ((bytesConsumed - lastGrant) >= (flowWindow / 4))
+			sendCredit();
+
+		if ((credit >= (int32_t)frameLen) || (credit >= (int32_t)(peerWindow / 2)))
+			break;
+
+		if (rxPending)
+		{
+			ready = false;
+			break;
+		}
+
+		if ((packet.now() - start) >= flowTimeout) // Credit or bytes were lost - assume the peer drained everything
+		{
+			packet.stats.timeouts++;
+			bytesWritten = peerConsumed;
+			break;
+		}
+
+		bool received;
+
+		if (parseReceived(received) && ((status == NEW_DATA) || (status == NEW_MESSAGE))) // A completed message is reported like a packet
+			rxPending = true;
+		else if (!received)
+			yield();
+	}
+
+	sending = false;
+
+	return ready;
+}
+
+
+/*
+ bool SerialTransfer::writeFrame()
+ Description:
+ ------------
+  * Writes the constructed packet to the port
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not the packet was written (always)
+*/
+bool SerialTransfer::writeFrame()
+{
+	if (capture)
+		capture->tx(packet.preamble, sizeof(packet.preamble), packet.txPayload, packet.bytesToSend, packet.postamble, sizeof(packet.postamble), packet.now());
+
+	if (bulkPort && !flowWindow) // Whole frame at once - with flow control it goes out as credit allows
+	{
+		bytesWritten += bulkPort->writeFrame(packet.preamble, sizeof(packet.preamble), packet.txPayload, packet.bytesToSend, packet.postamble, sizeof(packet.postamble));
+		return true;
+	}
+
+	writeBytes(packet.preamble, sizeof(packet.preamble));
+	writeBytes(packet.txPayload, packet.bytesToSend);
+	writeBytes(packet.postamble, sizeof(packet.postamble));
+
+	return true;
+}
+
+
+/*
+ bool SerialTransfer::acceptPacket()
+ Description:
+ ------------
+  * Control packets are consumed here and never reported
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not to report the packet just parsed
+*/
+bool SerialTransfer::acceptPacket()
+{
+	if (packet.currentFlags() & CONTROL_FLAG)
+	{
+		processControl();
+		return false;
+	}
+
+	return true;
+}
+
+
+/*
+ void SerialTransfer::afterAvailable()
+ Description:
+ ------------
+  * Advertises credit once half the window has been consumed, answers
+  a ping received meanwhile and sends the next automatic ping when due
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::afterAvailable()
+{
+	if (flowWindow && ((bytesConsumed - lastGrant) >= (flowWindow / 2)))
+		sendCredit();
+
+	if (pongPending)
+		sendPong();
+
+	if (pingInterval && ((packet.now() - lastPing) >= pingInterval))
+		ping();
+}
+
+
+/*
+ void SerialTransfer::processControl()
+ Description:
+ ------------
+  * Acts on the control packet held in the receive buffer
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::processControl()
+{
+	uint8_t* buff = packet.rxBuff;
+
+	uint16_t command = packet.currentCommand() | CONTROL_FLAG;
+
+	if ((command == PING_COMMAND) && (packet.currentReceived() >= 4))
+	{
+		pingSent     = ((uint32_t)buff[0] << 24) | ((uint32_t)buff[1] << 16) | ((uint32_t)buff[2] << 8) | buff[3];
+		pingReceived = packet.now();
+		pongPending  = true; // Never write mid-frame, the reply waits for the end of available()
+	}
+	else if ((command == PONG_COMMAND) && (packet.currentReceived() >= 12))
+	{
+		uint32_t ticks[3];
+
+		for (uint8_t i = 0; i < 3; i++)
+			ticks[i] = ((uint32_t)buff[4 * i] << 24) | ((uint32_t)buff[(4 * i) + 1] << 16) | ((uint32_t)buff[(4 * i) + 2] << 8) | buff[(4 * i) + 3];
+
+		addSample(ticks[0], ticks[1], ticks[2], packet.now());
+	}
+	else if (command == STATS_COMMAND)
+	{
+		if (Packet::readStats(buff, packet.currentReceived(), peerStats))
+			peerStatsReceived++;
+	}
+	else if ((command == CREDIT_COMMAND) && (packet.currentReceived() >= 6))
+	{
+		uint32_t consumed = ((uint32_t)buff[0] << 24) | ((uint32_t)buff[1] << 16) | ((uint32_t)buff[2] << 8) | buff[3];
+
+		if ((int32_t)(consumed - peerConsumed) < 0) // Peer restarted, start counting from its view
+			bytesWritten = consumed;
+
+		peerConsumed = consumed;
+		peerWindow   = ((uint16_t)buff[4] << 8) | buff[5];
+	}
+}
+
+
+/*
+ void SerialTransfer::sendControl(const uint8_t payload[], const uint16_t& len, const uint16_t& command)
+ Description:
+ ------------
+  * Sends a control packet without touching txBuff or waiting for
+  credit - control packets are small enough to always be absorbed
+ Inputs:
+ -------
+  * const uint8_t payload[] - Control payload
+  * const uint16_t& len - Number of bytes in payload[] (at most
+  MAX_CONTROL_SIZE)
+  * const uint16_t& command - Control command (CONTROL_FLAG set)
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::sendControl(const uint8_t payload[], const uint16_t& len, const uint16_t& command)
+{
+	uint8_t buff[MAX_CONTROL_SIZE + FEC_MAX_PARITY];
+
+	memcpy(buff, payload, len);
+	packet.constructPacket(buff, len, command);
+
+	uint32_t written = port->write(packet.preamble, sizeof(packet.preamble));
+
+	written += port->write(buff, packet.bytesToSend);
+	written += port->write(packet.postamble, sizeof(packet.postamble));
+
+	if (capture)
+		capture->tx(packet.preamble, sizeof(packet.preamble), buff, packet.bytesToSend, packet.postamble, sizeof(packet.postamble), packet.now());
+
+	bytesWritten += written;
+	packet.stats.framesOut++;
+	packet.stats.bytesOut += written;
+}
+
+
+/*
+ uint16_t SerialTransfer::sendStats()
+ Description:
+ ------------
+  * Sends this end's link statistics (packet.stats) as a
+  STATS_COMMAND control packet. Unlike Transfer::sendStats(),
+  flow control credit is not waited for. The peer's SerialTransfer
+  stores them in peerStats
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - Number of payload bytes included in packet
+*/
+uint16_t SerialTransfer::sendStats()
+{
+	uint8_t payload[STATS_SIZE];
+
+	sendControl(payload, Packet::writeStats(payload, packet.stats), STATS_COMMAND);
+
+	return STATS_SIZE;
+}
+
+
+/*
+ bool SerialTransfer::ping()
+ Description:
+ ------------
+  * Sends a PING_COMMAND control packet. The peer's SerialTransfer
+  answers with a PONG_COMMAND, which updates the RTT estimate and the
+  clock offset
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not the ping was sent (always)
+*/
+bool SerialTransfer::ping()
+{
+	uint8_t payload[4];
+
+	lastPing = packet.now();
+
+	payload[0] = (lastPing >> 24) & 0xFF;
+	payload[1] = (lastPing >> 16) & 0xFF;
+	payload[2] = (lastPing >> 8) & 0xFF;
+	payload[3] = lastPing & 0xFF;
+
+	sendControl(payload, sizeof(payload), PING_COMMAND);
+
+	return true;
+}
+
+
+/*
+ uint16_t SerialTransfer::rttSamples()
+ Description:
+ ------------
+  * Returns the number of pongs received so far
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - Number of RTT samples (saturates at 0xFFFF)
+*/
+uint16_t SerialTransfer::rttSamples()
+{
+	return samples;
+}
+
+
+/*
+ uint32_t SerialTransfer::smoothedRTT()
+ Description:
+ ------------
+  * Returns the smoothed round-trip time (7/8 old + 1/8 new sample)
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint32_t - Smoothed RTT in ticks of configST.clock (0 until the
+  first pong)
+*/
+uint32_t SerialTransfer::smoothedRTT()
+{
+	return srtt >> 3;
+}
+
+
+/*
+ uint32_t SerialTransfer::rttVariance()
+ Description:
+ ------------
+  * Returns the smoothed mean deviation of the round-trip time (3/4
+  old + 1/4 new deviation)
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint32_t - RTT variance in ticks of configST.clock
+*/
+uint32_t SerialTransfer::rttVariance()
+{
+	return rttvar >> 2;
+}
+
+
+/*
+ uint32_t SerialTransfer::suggestedTimeout()
+ Description:
+ ------------
+  * Returns a response timeout fitted to the measured link: smoothed
+  RTT plus four times its variance, as TCP sizes its retransmit timer
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint32_t - Timeout in ticks of configST.clock (DEFAULT_TIMEOUT
+  until the first pong)
+*/
+uint32_t SerialTransfer::suggestedTimeout()
+{
+	if (!samples)
+		return DEFAULT_TIMEOUT;
+
+	return (srtt >> 3) + rttvar; // rttvar is kept << 2
+}
+
+
+/*
+ int32_t SerialTransfer::clockOffset()
+ Description:
+ ------------
+  * Returns how far the peer's clock runs ahead of this end's,
+  estimated NTP style from the pong with the shortest round trip among
+  the last PING_OFFSET_SAMPLES
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * int32_t - Peer's clock minus this end's, in ticks of configST.clock
+*/
+int32_t SerialTransfer::clockOffset()
+{
+	return offset;
+}
+
+
+/*
+ void SerialTransfer::sendCredit()
+ Description:
+ ------------
+  * Advertises how many bytes this end has consumed so far and how
+  many more it can absorb
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::sendCredit()
+{
+	uint8_t payload[6];
+
+	payload[0] = (bytesConsumed >> 24) & 0xFF;
+	payload[1] = (bytesConsumed >> 16) & 0xFF;
+	payload[2] = (bytesConsumed >> 8) & 0xFF;
+	payload[3] = bytesConsumed & 0xFF;
+	payload[4] = (flowWindow >> 8) & 0xFF;
+	payload[5] = flowWindow & 0xFF;
+
+	lastGrant = bytesConsumed;
+	sendControl(payload, sizeof(payload), CREDIT_COMMAND);
+}
+
+
+/*
+ void SerialTransfer::sendPong()
+ Description:
+ ------------
+  * Answers the last ping received with its send tick, the tick it was
+  received and the tick of the reply
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::sendPong()
+{
+	uint32_t ticks[3] = {pingSent, pingReceived, packet.now()};
+	uint8_t  payload[12];
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		payload[4 * i]       = (ticks[i] >> 24) & 0xFF;
+		payload[(4 * i) + 1] = (ticks[i] >> 16) & 0xFF;
+		payload[(4 * i) + 2] = (ticks[i] >> 8) & 0xFF;
+		payload[(4 * i) + 3] = ticks[i] & 0xFF;
+	}
+
+	pongPending = false;
+	sendControl(payload, sizeof(payload), PONG_COMMAND);
+}
+
+
+/*
+ void SerialTransfer::addSample(const uint32_t& t1, const uint32_t& t2, const uint32_t& t3, const uint32_t& t4)
+ Description:
+ ------------
+  * Updates the RTT estimate and clock offset from a pong
+ Inputs:
+ -------
+  * const uint32_t& t1 - Tick the ping was sent (this end's clock)
+  * const uint32_t& t2 - Tick the ping was received (peer's clock)
+  * const uint32_t& t3 - Tick the pong was sent (peer's clock)
+  * const uint32_t& t4 - Tick the pong was received (this end's clock)
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::addSample(const uint32_t& t1, const uint32_t& t2, const uint32_t& t3, const uint32_t& t4)
+{
+	uint32_t sample = (t4 - t1) - (t3 - t2); // Round trip less the time the peer held the ping
+	uint8_t  best   = 0;
+
+	if ((int32_t)sample < 0) // Peer's clock runs faster than this end's
+		sample = 0;
+
+	if (!samples)
+	{
+		srtt   = sample << 3;
+		rttvar = sample << 1;
+	}
+	else
+	{
+		int32_t delta = (int32_t)sample - (int32_t)(srtt >> 3);
+
+		if (delta < 0)
+			delta = -delta;
+
+		srtt   = srtt - (srtt >> 3) + sample;             // srtt = 7/8 srtt + 1/8 sample
+		rttvar = rttvar - (rttvar >> 2) + (uint32_t)delta; // rttvar = 3/4 rttvar + 1/4 |delta|
+	}
+
+	offsets[sampleSlot] = ((int32_t)(t2 - t1) + (int32_t)(t3 - t4)) / 2;
+	delays[sampleSlot]  = sample;
+	sampleSlot          = (sampleSlot + 1) % PING_OFFSET_SAMPLES; // Not from samples, which stops counting at 0xFFFF
+
+	if (samples < 0xFFFF)
+		samples++;
+
+	for (uint8_t i = 1; (i < samples) && (i < PING_OFFSET_SAMPLES); i++) // The shortest round trip had the least queueing to skew it
+		if (delays[i] < delays[best])
+			best = i;
+
+	offset = offsets[best];
+
+	if (latency)
+		latency->clockOffset = offset;
+}
+
+
+/*
+ void SerialTransfer::writeBytes(const uint8_t arr[], const uint16_t& len)
+ Description:
+ ------------
+  * Writes bytes to the port. With flow control enabled, never lets
+  more bytes be in flight than the peer advertised it can absorb,
+  parsing incoming traffic for credit while it waits. Only frames
+  larger than half the peer's window wait here, prepareSend() holds
+  the rest back until they fit. Credit can't be advertised part way
+  through a frame, so while both ends do this at once it only moves
+  on flowTimeout
+ Inputs:
+ -------
+  * const uint8_t arr[] - Bytes to write
+  * const uint16_t& len - Number of bytes in arr[]
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::writeBytes(const uint8_t arr[], const uint16_t& len)
+{
+	uint16_t written = 0;
+	uint32_t start   = packet.now();
+
+	sending = true;
+
+	while (written < len)
+	{
+		uint16_t chunk = len - written;
+
+		if (flowWindow)
+		{
+			int32_t credit = (int32_t)(peerConsumed + peerWindow - bytesWritten);
+
+			if (credit <= 0)
+			{
+				if ((packet.now() - start) >= flowTimeout) // Credit or bytes were lost - assume the peer drained everything
+				{
+					packet.stats.timeouts++;
+					bytesWritten = peerConsumed;
+					start        = packet.now();
+				}
+				else if (!rxPending)
+				{
+					bool received;
+
+					if (parseReceived(received) && ((status == NEW_DATA) || (status == NEW_MESSAGE))) // Reported by the next available(), after the frame is out
+						rxPending = true;
+					else if (!received)
+						yield();
+				}
+				else
+					yield();
+
+				continue;
+			}
+
+			if (credit < (int32_t)chunk)
+				chunk = credit;
+
+			start = packet.now();
+		}
+
+		bytesWritten += port->write(arr + written, chunk);
+		written += chunk;
+	}
+
+	sending = false;
+}
+
+
+/*
+ void SerialTransfer::reset()
+ Description:
+ ------------
+  * Clears out the tx, and rx buffers, plus resets
+  the "bytes read" variable, finite state machine, etc
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::reset()
+{
+	uint8_t  dropped[32];
+	uint16_t count = 0;
+
+	if (sending) // Parse error while waiting for credit - the frame going out is in txPayload and more credit may be in the port
+	{
+		packet.resetParser();
+		status = packet.status;
+		return;
+	}
+
+	while (port->available())
+	{
+		dropped[count++] = port->read();
+		bytesConsumed++;
+		packet.stats.resyncBytes++;
+
+		if (count == sizeof(dropped))
+		{
+			if (capture)
+				capture->discard(dropped, count, packet.now());
+
+			count = 0;
+		}
+	}
+
+	if (capture)
+		capture->discard(dropped, count, packet.now());
+
+	packet.stats.resyncBytes += rxLen - rxPos;
+
+	rxLen = 0; // Drop what was read ahead of the error as well
+	rxPos = 0;
+
+	Transfer::reset();
+}
@@ -1,106 +1,76 @@
-#pragma once
-#include "Arduino.h"
-#include "Packet.h"
-
-
-class SerialTransfer
-{
-  public: // <<---------------------------------------//public
-	Packet  packet;
-	uint8_t bytesRead = 0;
-	int8_t  status    = 0;
-
-
-	void    begin(Stream& _port, const configST configs);
-	void    begin(Stream& _port, const uint8_t _debug = 0, Stream& _debugPort = Serial, uint32_t _timeout = DEFAULT_TIMEOUT);
-	uint16_t sendData(const uint16_t& messageLen, const uint16_t command = 0, const uint8_t packetID = 0);
-	uint16_t available();
-	bool    tick();
-	uint16_t currentCommand();
-	uint8_t currentPacketID();
-	uint16_t currentReceived();
-	void    reset();
-
-
-	/*
-	 uint16_t SerialTransfer::txObj(const T &val, const uint16_t &index=0, const uint16_t &len=sizeof(T))
-	 Description:
-	 ------------
-	  * Stuffs "len" number of bytes of an arbitrary object (byte, int,
-	  float, double, struct, etc...) into the transmit buffer (txBuff)
-	  starting at the index as specified by the argument "index"
-	 Inputs:
-	 -------
-	  * const T &val - Pointer to the object to be copied to the
-	  transmit buffer (txBuff)
-	  * const uint16_t &index - Starting index of the object within the
-	  transmit buffer (txBuff)
-	  * const uint16_t &len - Number of bytes of the object "val" to transmit
-	 Return:
-	 -------
-	  * uint16_t maxIndex - uint16_t maxIndex - Index of the transmit buffer (txBuff) that directly follows the bytes processed
-	  by the calling of this member function
-	*/
-	template <typename T>
-	uint16_t txObj(const T& val, const uint16_t& index = 0, const uint16_t& len = sizeof(T))
-	{
-		return packet.txObj(val, index, len);
-	}
-
-
-	/*
-	 uint16_t SerialTransfer::rxObj(const T &val, const uint16_t &index=0, const uint16_t &len=sizeof(T))
-	 Description:
-	 ------------
-	  * Reads "len" number of bytes from the receive buffer (rxBuff)
-	  starting at the index as specified by the argument "index"
-	  into an arbitrary object (byte, int, float, double, struct, etc...)
-	 Inputs:
-	 -------
-	  * const T &val - Pointer to the object to be copied into from the
-	  receive buffer (rxBuff)
-	  * const uint16_t &index - Starting index of the object within the
-	  receive buffer (rxBuff)
-	  * const uint16_t &len - Number of bytes in the object "val" received
-	 Return:
-	 -------
-	  * uint16_t maxIndex - Index of the receive buffer (rxBuff) that directly follows the bytes processed
-	  by the calling of this member function
-	*/
-	template <typename T>
-	uint16_t rxObj(const T& val, const uint16_t& index = 0, const uint16_t& len = sizeof(T))
-	{
-		return packet.rxObj(val, index, len);
-	}
-
-
-	/*
-	 uint8_t SerialTransfer::sendDatum(const T &val, const uint16_t &len=sizeof(T))
-	 Description:
-	 ------------
-	  * Stuffs "len" number of bytes of an arbitrary object (byte, int,
-	  float, double, struct, etc...) into the transmit buffer (txBuff)
-	  starting at the index as specified by the argument "index" and
-	  automatically transmits the bytes in an individual packet
-	 Inputs:
-	 -------
-	  * const T &val - Pointer to the object to be copied to the
-	  transmit buffer (txBuff)
-	  * const uint16_t &len - Number of bytes of the object "val" to transmit
-	 Return:
-	 -------
-	  * uint8_t - Number of payload bytes included in packet
-	*/
-	template <typename T>
-	uint16_t sendDatum(const T& val, const uint16_t& len = sizeof(T))
-	{
-		return sendData(packet.txObj(val, 0, len));
-	}
-
-
-  private: // <<---------------------------------------//private
-	uint8_t debug = 0;
-	Stream* debugPort;
-	Stream* port;
-	uint32_t timeout;
-};
+#pragma once
+#include "Arduino.h"
+#include "BulkStream.h"
+#include "Packet.h"
+#include "Transfer.h"
+
+
+#ifndef PING_OFFSET_SAMPLES
+#define PING_OFFSET_SAMPLES 8 // Recent pongs the clock offset is picked from
+#endif
+
+
+class SerialTransfer : public Transfer<SerialTransfer>
+{
+  public: // <<---------------------------------------//public
+	linkStatsST peerStats;             // Last statistics the peer sent with sendStats()
+	uint32_t    peerStatsReceived = 0; // Number of statistics packets received from the peer
+
+
+	void     begin(Stream& _port, const configST configs);
+	void     begin(Stream& _port, const uint8_t _debug = 0, Stream& _debugPort = Serial, uint32_t _timeout = DEFAULT_TIMEOUT);
+	void     begin(BulkStream& _port, const configST configs);
+	void     begin(BulkStream& _port, const uint8_t _debug = 0, Stream& _debugPort = Serial, uint32_t _timeout = DEFAULT_TIMEOUT);
+	uint16_t sendStats();
+	bool     ping();
+	uint16_t rttSamples();
+	uint32_t smoothedRTT();
+	uint32_t rttVariance();
+	uint32_t suggestedTimeout();
+	int32_t  clockOffset();
+	void     reset();
+
+
+  private: // <<---------------------------------------//private
+	friend class Transfer<SerialTransfer>;
+
+	Stream*     port;
+	BulkStream* bulkPort = NULL; // Set when frames can be written whole and received bytes read in blocks
+
+	uint16_t flowWindow    = 0;
+	uint32_t flowTimeout   = DEFAULT_FLOW_TIMEOUT;
+	uint32_t bytesWritten  = 0; // Total bytes written to the port
+	uint32_t bytesConsumed = 0; // Total bytes read from the port
+	uint32_t lastGrant     = 0; // bytesConsumed when credit was last advertised
+	uint32_t peerConsumed  = 0; // Total bytes the peer reported reading
+	uint16_t peerWindow    = 0;
+	bool     sending       = false; // Waiting for credit - reset() must leave txBuff and the port alone
+
+	PacketCapture* capture      = NULL; // Gets every byte read and written
+	PacketLatency* latency      = NULL; // Gets the clock offset, so one-way latency is measured against the peer's clock
+	uint32_t       pingInterval = 0;
+	uint32_t       lastPing     = 0;     // Tick the last ping went out
+	bool           pongPending  = false; // Ping received, reply sent by afterAvailable()
+	uint32_t       pingSent     = 0;     // Peer's send tick of the ping to reply to
+	uint32_t       pingReceived = 0;     // Tick that ping was received
+	uint16_t       samples      = 0;     // Pongs received, saturates at 0xFFFF
+	uint8_t        sampleSlot   = 0;     // Next slot of offsets[]/delays[] to write, wraps at PING_OFFSET_SAMPLES
+	uint32_t       srtt         = 0;     // Smoothed RTT, ticks << 3
+	uint32_t       rttvar       = 0;     // RTT variance, ticks << 2
+	int32_t        offset       = 0;     // Peer's clock minus this end's, ticks
+	int32_t        offsets[PING_OFFSET_SAMPLES];
+	uint32_t       delays[PING_OFFSET_SAMPLES];
+
+
+	uint16_t readBytes(uint8_t arr[], const uint16_t& len);
+	bool     prepareSend(const uint16_t& messageLen);
+	bool     writeFrame();
+	bool     acceptPacket();
+	void     afterAvailable();
+	void     processControl();
+	void     sendControl(const uint8_t payload[], const uint16_t& len, const uint16_t& command);
+	void     sendCredit();
+	void     sendPong();
+	void     addSample(const uint32_t& t1, const uint32_t& t2, const uint32_t& t3, const uint32_t& t4);
+	void     writeBytes(const uint8_t arr[], const uint16_t& len);
+};
@@ -0,0 +1,597 @@
+#include "StateMirror.h"
+
+
+/*
+ void StateMirror::begin(SerialTransfer& _transfer, void* _state, const uint16_t& _size, const uint16_t& _command, const uint16_t& _keyframeInterval)
+ Description:
+ ------------
+  * Initializer for the StateMirror Class, at both ends of the link
+ Inputs:
+ -------
+  * SerialTransfer& _transfer - Initialized link to mirror over
+  * void* _state - Struct to mirror: read by update() on the sender,
+  rebuilt in place by available() on the receiver
+  * const uint16_t& _size - Number of bytes in _state (at most
+  MIRROR_MAX_STATE, and it must fit in one packet with the keyframe
+  header)
+  * const uint16_t& _command - The packet 16-bit command mirror
+  packets are sent with, packets with other commands are left alone
+  * const uint16_t& _keyframeInterval - Send a keyframe every this many
+  updates, 0 = only when the receiver asks for one
+ Return:
+ -------
+  * void
+*/
+void StateMirror::begin(SerialTransfer& _transfer, void* _state, const uint16_t& _size, const uint16_t& _command, const uint16_t& _keyframeInterval)
+{
+	uint16_t maxSize = _transfer.packet.maxPayload() - MIRROR_KEYFRAME_HEADER;
+
+	transfer = &_transfer;
+	state    = (uint8_t*)_state;
+	size     = _size;
+	command  = _command & ~COMMAND_FLAGS;
+	interval = _keyframeInterval;
+
+	if (size > MIRROR_MAX_STATE)
+		size = MIRROR_MAX_STATE;
+
+	if (size > maxSize)
+		size = maxSize;
+
+	keyframesSent  = 0;
+	deltasSent     = 0;
+	bytesSent      = 0;
+	updatesApplied = 0;
+	updatesDropped = 0;
+
+	reset();
+}
+
+
+/*
+ uint16_t StateMirror::update()
+ Description:
+ ------------
+  * Sends the current state: the byte runs that changed since the
+  base both ends agree on, or a keyframe when one is due, requested or
+  smaller. Nothing is sent if the receiver already has this state.
+  Call at the rate the state should be mirrored
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - Number of payload bytes sent (0 if nothing was sent)
+*/
+uint16_t StateMirror::update()
+{
+	if (!transfer)
+		return 0;
+
+	if (!baseValid || keyframeWanted || (interval && ((sinceKeyframe + 1) >= interval)))
+		return sendKeyframe();
+
+	uint8_t* buff  = transfer->packet.txBuff;
+	uint16_t limit = size + MIRROR_KEYFRAME_HEADER - MIRROR_DELTA_HEADER; // Deltas this long are no smaller than a keyframe
+	uint16_t len   = encodeDelta(buff + MIRROR_DELTA_HEADER, limit);
+	bool     keep  = candidateAge >= (candidateValid ? MIRROR_ACK_UPDATES : MIRROR_KEEP_UPDATES);
+
+	if (len >= limit)
+		return sendKeyframe();
+
+	if (!len && sentEmpty)
+		return 0;
+
+	buff[0] = MIRROR_DELTA | (keep ? MIRROR_KEEP : 0);
+	buff[1] = seq;
+	buff[2] = baseSeq;
+
+	if (keep)
+	{
+		memcpy(candidate, state, size);
+		candidateValid = true;
+		candidateSeq   = seq;
+		candidateAge   = 0;
+	}
+	else
+		candidateAge++;
+
+	seq++;
+	sinceKeyframe++;
+	deltasSent++;
+	sentEmpty  = !len;
+	len       += MIRROR_DELTA_HEADER;
+	bytesSent += len;
+
+	transfer->sendData(len, command);
+
+	return len;
+}
+
+
+/*
+ void StateMirror::keyframe()
+ Description:
+ ------------
+  * Makes the next update() send a keyframe
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void StateMirror::keyframe()
+{
+	keyframeWanted = true;
+}
+
+
+/*
+ uint16_t StateMirror::available()
+ Description:
+ ------------
+  * Parses all incoming packets and applies the mirror packets among
+  them. All traffic of the link is owned by this class, use
+  process() to share it with other packets
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t bytesChanged - Num state bytes changed by the updates
+  applied, see changed()
+*/
+uint16_t StateMirror::available()
+{
+	clearChanged();
+
+	while (transfer && transfer->available())
+		process();
+
+	return bytesChanged;
+}
+
+
+/*
+ bool StateMirror::process()
+ Description:
+ ------------
+  * Applies the packet the link's available() just parsed, if it is a
+  mirror packet. For links that carry other packets too - changes
+  accumulate until clearChanged()
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not the packet was a mirror packet
+*/
+bool StateMirror::process()
+{
+	if (!transfer)
+		return false;
+
+	uint8_t* buff = transfer->packet.rxBuff;
+	uint16_t len  = transfer->packet.currentReceived();
+
+	if ((transfer->status != NEW_DATA) || (transfer->packet.currentFlags() & (FRAGMENT_FLAG | RELIABLE_FLAG | CONTROL_FLAG)) || (transfer->currentCommand() != command) || !len)
+		return false;
+
+	switch (buff[0] & ~MIRROR_KEEP)
+	{
+	case MIRROR_KEYFRAME:
+		applyKeyframe(buff, len);
+		break;
+
+	case MIRROR_DELTA:
+		applyDelta(buff, len);
+		break;
+
+	case MIRROR_ACK: // The receiver holds the candidate, deltas can be based on it
+		if ((len >= 2) && candidateValid && (buff[1] == candidateSeq))
+		{
+			memcpy(base, candidate, size);
+			baseSeq        = candidateSeq;
+			candidateValid = false;
+			sentEmpty      = false;
+		}
+		break;
+
+	case MIRROR_REQUEST:
+		keyframeWanted = true;
+		break;
+
+	default:
+		return false;
+	}
+
+	return true;
+}
+
+
+/*
+ bool StateMirror::synced()
+ Description:
+ ------------
+  * Checks whether or not a keyframe was sent/received since begin()
+  or reset() - before that the receiver's state is not a mirror
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not the ends are synced
+*/
+bool StateMirror::synced()
+{
+	return baseValid;
+}
+
+
+/*
+ bool StateMirror::changed(const uint16_t& offset, const uint16_t& len)
+ Description:
+ ------------
+  * Checks whether or not any of "len" state bytes at "offset"
+  changed since the last available()/clearChanged(), i.e.
+  mirror.changed(offsetof(telemetry, volts), sizeof(float))
+ Inputs:
+ -------
+  * const uint16_t& offset - First byte of the field within the state
+  * const uint16_t& len - Number of bytes in the field
+ Return:
+ -------
+  * bool - Whether or not any of the bytes changed
+*/
+bool StateMirror::changed(const uint16_t& offset, const uint16_t& len)
+{
+	for (uint16_t i = offset; (i < (offset + len)) && (i < size); i++)
+		if (changedBits[i >> 3] & (1 << (i & 7)))
+			return true;
+
+	return false;
+}
+
+
+/*
+ void StateMirror::clearChanged()
+ Description:
+ ------------
+  * Forgets which state bytes changed
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void StateMirror::clearChanged()
+{
+	memset(changedBits, 0, sizeof(changedBits));
+	bytesChanged = 0;
+}
+
+
+/*
+ void StateMirror::reset()
+ Description:
+ ------------
+  * Forgets the base both ends agree on, the next update sent or
+  received must be a keyframe
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void StateMirror::reset()
+{
+	baseValid       = false;
+	baseSeq         = 0;
+	candidateValid  = false;
+	candidateSeq    = 0;
+	seq             = 0;
+	sinceKeyframe   = 0;
+	candidateAge    = 0;
+	keyframeWanted  = false;
+	sentEmpty       = false;
+	dropsSinceAsked = 0;
+
+	clearChanged();
+}
+
+
+/*
+ uint16_t StateMirror::sendKeyframe()
+ Description:
+ ------------
+  * Sends the whole state and makes it the base
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - Number of payload bytes sent
+*/
+uint16_t StateMirror::sendKeyframe()
+{
+	uint8_t* buff = transfer->packet.txBuff;
+	uint16_t len  = size + MIRROR_KEYFRAME_HEADER;
+
+	buff[0] = MIRROR_KEYFRAME;
+	buff[1] = seq;
+	memcpy(buff + MIRROR_KEYFRAME_HEADER, state, size);
+
+	memcpy(base, state, size);
+	baseValid      = true;
+	baseSeq        = seq;
+	candidateValid = false;
+	keyframeWanted = false;
+	sentEmpty      = true;
+	sinceKeyframe  = 0;
+	candidateAge   = 0;
+
+	seq++;
+	keyframesSent++;
+	bytesSent += len;
+
+	transfer->sendData(len, command);
+
+	return len;
+}
+
+
+/*
+ uint16_t StateMirror::encodeDelta(uint8_t arr[], const uint16_t& maxLen)
+ Description:
+ ------------
+  * Encodes the bytes of the state that differ from the base as runs:
+  unchanged bytes skipped, run length, new values. Runs separated by
+  up to MIRROR_MAX_GAP unchanged bytes are merged, which is no bigger
+  than starting a new run
+ Inputs:
+ -------
+  * uint8_t arr[] - Buffer to encode into
+  * const uint16_t& maxLen - Size of arr[]
+ Return:
+ -------
+  * uint16_t - Number of bytes encoded (maxLen if they do not fit)
+*/
+uint16_t StateMirror::encodeDelta(uint8_t arr[], const uint16_t& maxLen)
+{
+	uint16_t len   = 0;
+	uint16_t pos   = 0; // End of the previous run
+	uint16_t start = 0;
+
+	while (true)
+	{
+		while ((start < size) && (state[start] == base[start]))
+			start++;
+
+		if (start >= size)
+			break;
+
+		uint16_t end = start + 1;
+
+		while (true)
+		{
+			uint16_t gap = 0;
+
+			while ((end < size) && (state[end] != base[end]))
+				end++;
+
+			while (((end + gap) < size) && (gap <= MIRROR_MAX_GAP) && (state[end + gap] == base[end + gap]))
+				gap++;
+
+			if ((gap > MIRROR_MAX_GAP) || ((end + gap) >= size))
+				break;
+
+			end += gap;
+		}
+
+		uint16_t skip = start - pos;
+
+		while (skip > 0xFF)
+		{
+			if ((len + MIRROR_RUN_HEADER) > maxLen)
+				return maxLen;
+
+			arr[len++] = 0xFF;
+			arr[len++] = 0;
+			skip      -= 0xFF;
+		}
+
+		while (start < end)
+		{
+			uint8_t count = ((end - start) > 0xFF) ? 0xFF : (end - start);
+
+			if ((len + MIRROR_RUN_HEADER + count) > maxLen)
+				return maxLen;
+
+			arr[len++] = skip;
+			arr[len++] = count;
+			memcpy(arr + len, state + start, count);
+
+			len   += count;
+			start += count;
+			skip   = 0;
+		}
+
+		pos = end;
+	}
+
+	return len;
+}
+
+
+/*
+ void StateMirror::applyKeyframe(const uint8_t arr[], const uint16_t& len)
+ Description:
+ ------------
+  * Copies a keyframe into the state and makes it the base
+ Inputs:
+ -------
+  * const uint8_t arr[] - Keyframe payload
+  * const uint16_t& len - Number of bytes in arr[]
+ Return:
+ -------
+  * void
+*/
+void StateMirror::applyKeyframe(const uint8_t arr[], const uint16_t& len)
+{
+	if (len != (size + MIRROR_KEYFRAME_HEADER))
+		return;
+
+	for (uint16_t i = 0; i < size; i++)
+		write(i, arr[MIRROR_KEYFRAME_HEADER + i]);
+
+	memcpy(base, state, size);
+	baseValid       = true;
+	baseSeq         = arr[1];
+	candidateValid  = false;
+	dropsSinceAsked = 0;
+
+	updatesApplied++;
+}
+
+
+/*
+ void StateMirror::applyDelta(const uint8_t arr[], const uint16_t& len)
+ Description:
+ ------------
+  * Rebuilds the state from the delta's base and runs. A delta based
+  on an update this end does not hold is dropped and a keyframe asked
+  for (again every MIRROR_REQUEST_EVERY drops, in case the request is
+  lost)
+ Inputs:
+ -------
+  * const uint8_t arr[] - Delta payload
+  * const uint16_t& len - Number of bytes in arr[]
+ Return:
+ -------
+  * void
+*/
+void StateMirror::applyDelta(const uint8_t arr[], const uint16_t& len)
+{
+	if (len < MIRROR_DELTA_HEADER)
+		return;
+
+	uint8_t from = arr[2];
+
+	if (candidateValid && (from == candidateSeq)) // The sender got our ACK and moved its base
+	{
+		memcpy(base, candidate, size);
+		baseSeq        = candidateSeq;
+		candidateValid = false;
+	}
+	else if (!baseValid || (from != baseSeq))
+	{
+		updatesDropped++;
+
+		if (!(dropsSinceAsked++ % MIRROR_REQUEST_EVERY))
+			sendShort(MIRROR_REQUEST, 0, 1);
+
+		return;
+	}
+
+	uint16_t i   = MIRROR_DELTA_HEADER;
+	uint16_t pos = 0;
+
+	while (i < len) // Check the runs before touching the state
+	{
+		if ((i + MIRROR_RUN_HEADER) > len)
+			return;
+
+		pos += arr[i] + arr[i + 1];
+		i   += MIRROR_RUN_HEADER + arr[i + 1];
+
+		if ((i > len) || (pos > size))
+			return;
+	}
+
+	i   = MIRROR_DELTA_HEADER;
+	pos = 0;
+
+	while (i < len)
+	{
+		uint16_t skipEnd = pos + arr[i];
+		uint16_t runEnd  = skipEnd + arr[i + 1];
+
+		i += MIRROR_RUN_HEADER;
+
+		for (; pos < skipEnd; pos++)
+			write(pos, base[pos]);
+
+		for (; pos < runEnd; pos++)
+			write(pos, arr[i++]);
+	}
+
+	for (; pos < size; pos++)
+		write(pos, base[pos]);
+
+	if (arr[0] & MIRROR_KEEP)
+	{
+		memcpy(candidate, state, size);
+		candidateValid = true;
+		candidateSeq   = arr[1];
+
+		sendShort(MIRROR_ACK, arr[1], 2);
+	}
+
+	dropsSinceAsked = 0;
+	updatesApplied++;
+}
+
+
+/*
+ void StateMirror::sendShort(const uint8_t& kind, const uint8_t& val, const uint8_t& len)
+ Description:
+ ------------
+  * Sends an ACK or keyframe request back to the sender
+ Inputs:
+ -------
+  * const uint8_t& kind - MIRROR_ACK or MIRROR_REQUEST
+  * const uint8_t& val - Sequence number ACKed
+  * const uint8_t& len - Payload bytes, 2 with a sequence number
+ Return:
+ -------
+  * void
+*/
+void StateMirror::sendShort(const uint8_t& kind, const uint8_t& val, const uint8_t& len)
+{
+	transfer->packet.txBuff[0] = kind;
+	transfer->packet.txBuff[1] = val;
+	bytesSent                 += len;
+
+	transfer->sendData(len, command);
+}
+
+
+/*
+ void StateMirror::write(const uint16_t& index, const uint8_t& val)
+ Description:
+ ------------
+  * Stores one state byte, marking it if it changed
+ Inputs:
+ -------
+  * const uint16_t& index - Byte of the state
+  * const uint8_t& val - New value
+ Return:
+ -------
+  * void
+*/
+void StateMirror::write(const uint16_t& index, const uint8_t& val)
+{
+	if (state[index] == val)
+		return;
+
+	if (!(changedBits[index >> 3] & (1 << (index & 7))))
+	{
+		changedBits[index >> 3] |= 1 << (index & 7);
+		bytesChanged++;
+	}
+
+	state[index] = val;
+}
@@ -0,0 +1,143 @@
+/*
+Keyframe:  00000000 00000111 ... state ...
+           |      | |      | |_____________Whole state
+           |      | |______|_______________Update sequence number
+           |______|________________________MIRROR_KEYFRAME
+
+Delta:     10000001 00001000 00000111 00000011 00000010 xxxxxxxx xxxxxxxx ...
+           |      | |      | |      | |      | |      | |_______________|____New values of the run's bytes
+           |      | |      | |      | |      | |______|_____________________Run length
+           |      | |      | |      | |______|____________________________Bytes unchanged since the previous run
+           |      | |      | |______|_____________________________________Sequence number of the base update
+           |      | |______|______________________________________________Update sequence number
+           |______|_______________________________________________________MIRROR_DELTA, MIRROR_KEEP set
+
+Ack:       00000010 00001000     Request:  00000011
+           |______| |______|               |______|___MIRROR_REQUEST - receiver has no usable base
+               |        |_______Sequence number of the MIRROR_KEEP update applied
+               |________________MIRROR_ACK
+*/
+
+#pragma once
+#include "Arduino.h"
+#include "SerialTransfer.h"
+
+
+#ifndef MIRROR_MAX_STATE
+#define MIRROR_MAX_STATE 256 // Largest state mirrored, each end keeps two copies of this size
+#endif
+
+#ifndef MIRROR_KEYFRAME_INTERVAL
+#define MIRROR_KEYFRAME_INTERVAL 100 // Updates between keyframes, 0 = only when requested
+#endif
+
+#ifndef MIRROR_KEEP_UPDATES
+#define MIRROR_KEEP_UPDATES 4 // Updates between MIRROR_KEEP updates - fewer ACKs, but deltas collect more changes before the base moves
+#endif
+
+#ifndef MIRROR_ACK_UPDATES
+#define MIRROR_ACK_UPDATES 16 // Updates to wait for the ACK of a MIRROR_KEEP update before marking a newer one
+#endif
+
+const uint8_t MIRROR_KEYFRAME = 0;
+const uint8_t MIRROR_DELTA    = 1;
+const uint8_t MIRROR_ACK      = 2;
+const uint8_t MIRROR_REQUEST  = 3;
+const uint8_t MIRROR_KEEP     = 0x80; // Kind bit: receiver keeps a copy of this update and ACKs it, so it can become the sender's base
+
+const uint8_t MIRROR_KEYFRAME_HEADER = 2;
+const uint8_t MIRROR_DELTA_HEADER    = 3;
+const uint8_t MIRROR_RUN_HEADER      = 2;
+const uint8_t MIRROR_MAX_GAP         = MIRROR_RUN_HEADER; // Unchanged bytes sent inside a run rather than starting a new one
+const uint8_t MIRROR_REQUEST_EVERY   = 8; // Unusable deltas between keyframe requests
+
+
+/*
+ class StateMirror
+ Description:
+ ------------
+  * Keeps a copy of a struct in sync across a SerialTransfer link
+  sending only what changed. The sender encodes each update as the
+  byte runs that differ from the last copy the receiver acknowledged,
+  so a lost delta costs nothing - the next one carries the same
+  changes. The receiver rebuilds the struct in place and reports which
+  bytes changed. Keyframes (the whole struct) go out every
+  MIRROR_KEYFRAME_INTERVAL updates, when a delta would not be smaller
+  and when the receiver asks for one; a link with no return path just
+  deltas against the last keyframe. Both ends must mirror a struct of
+  the same size and layout, see PacketSchema for mixing targets
+*/
+class StateMirror
+{
+  public: // <<---------------------------------------//public
+	uint16_t bytesChanged   = 0; // State bytes changed by the updates applied since the last available()/clearChanged()
+	uint32_t keyframesSent  = 0;
+	uint32_t deltasSent     = 0;
+	uint32_t bytesSent      = 0; // Mirror payload bytes sent, ACKs and requests included
+	uint32_t updatesApplied = 0;
+	uint32_t updatesDropped = 0; // Deltas received with no usable base
+
+
+	void     begin(SerialTransfer& _transfer, void* _state, const uint16_t& _size, const uint16_t& _command = 0, const uint16_t& _keyframeInterval = MIRROR_KEYFRAME_INTERVAL);
+	uint16_t update();
+	void     keyframe();
+	uint16_t available();
+	bool     process();
+	bool     synced();
+	bool     changed(const uint16_t& offset, const uint16_t& len);
+	void     clearChanged();
+	void     reset();
+
+
+	/*
+	 bool StateMirror::changed(const T &field)
+	 Description:
+	 ------------
+	  * Checks whether or not a member of the mirrored struct changed
+	  since the last available()/clearChanged(), i.e.
+	  mirror.changed(state.volts)
+	 Inputs:
+	 -------
+	  * const T &field - Member of the struct given to begin()
+	 Return:
+	 -------
+	  * bool - Whether or not any of its bytes changed
+	*/
+	template <typename T>
+	bool changed(const T& field)
+	{
+		return changed((const uint8_t*)&field - state, sizeof(T));
+	}
+
+
+  private: // <<---------------------------------------//private
+	SerialTransfer* transfer = NULL;
+	uint8_t*        state    = NULL;
+	uint16_t        size     = 0;
+	uint16_t        command  = 0;
+	uint16_t        interval = MIRROR_KEYFRAME_INTERVAL;
+
+	uint8_t base[MIRROR_MAX_STATE];      // Last copy both ends agree on
+	uint8_t candidate[MIRROR_MAX_STATE]; // MIRROR_KEEP update awaiting its ACK (sender) or its first use as a base (receiver)
+	uint8_t changedBits[(MIRROR_MAX_STATE + 7) / 8];
+
+	bool    baseValid      = false;
+	uint8_t baseSeq        = 0;
+	bool    candidateValid = false;
+	uint8_t candidateSeq   = 0;
+	uint8_t seq            = 0; // Sequence number of the next update sent
+
+	uint16_t sinceKeyframe   = 0;
+	uint16_t candidateAge    = 0; // Updates since the last MIRROR_KEEP update
+	bool     keyframeWanted  = false;
+	bool     sentEmpty       = false; // Last delta sent matched the base, another is not needed until the state changes
+	uint8_t  dropsSinceAsked = 0;
+
+
+	uint16_t sendKeyframe();
+	uint16_t encodeDelta(uint8_t arr[], const uint16_t& maxLen);
+	void     applyKeyframe(const uint8_t arr[], const uint16_t& len);
+	void     applyDelta(const uint8_t arr[], const uint16_t& len);
+	void     sendShort(const uint8_t& kind, const uint8_t& val, const uint8_t& len);
+	void     write(const uint16_t& index, const uint8_t& val);
+};
@@ -0,0 +1,819 @@
+#pragma once
+#include "Arduino.h"
+#include "Packet.h"
+
+
+struct TransferConfig
+{
+	static const uint16_t rxChunkSize = 64; // Bytes pulled from the transport per read by available()
+};
+
+
+/*
+ template <typename TransportPolicy, typename Config> class Transfer
+ Description:
+ ------------
+  * Transport-independent half of SerialTransfer, SPITransfer and
+  I2CTransfer: object stuffing, packet construction, the receive loop,
+  fragmented messages and reset logic. A transport derives from
+  Transfer<itself> and provides the hooks below, which are resolved at
+  compile time - there are no virtual calls:
+   * bool writeFrame() - Writes packet.preamble, the first
+   packet.bytesToSend bytes of packet.txPayload and packet.postamble.
+   Returns whether or not the frame went out
+   * uint16_t readBytes(uint8_t arr[], const uint16_t& len) - Copies
+   up to "len" received bytes into arr[] without blocking (optional)
+   * bool prepareSend(const uint16_t& messageLen) - Called ahead of
+   constructing each packet of "messageLen" payload bytes. Returns
+   false to abort the send while txBuff is untouched (optional)
+   * bool acceptPacket() - Called for every packet parsed. Returns
+   false to consume the packet instead of reporting it (optional)
+   * void afterAvailable() - Called at the end of available() (optional)
+   * void reset() - Also resets transport state (optional, must call
+   Transfer::reset())
+ Inputs:
+ -------
+  * TransportPolicy - The transport class deriving from Transfer
+  * Config - Compile time settings, see TransferConfig
+*/
+template <typename TransportPolicy, typename Config = TransferConfig>
+class Transfer
+{
+  public: // <<---------------------------------------//public
+	Packet   packet;
+	uint16_t bytesRead = 0;
+	int8_t   status    = 0;
+
+
+	uint16_t sendData(const uint16_t& messageLen, const uint16_t command = 0, const uint8_t packetID = 0);
+	uint16_t sendChunk(const uint8_t data[], const uint16_t& len, const uint32_t& offset, const bool last = false, const uint16_t command = 0, const uint8_t messageID = 0);
+	uint32_t sendLarge(const uint8_t data[], const uint32_t& len, const uint16_t command = 0);
+	uint16_t sendStats(const uint8_t packetID = 0);
+	uint16_t available();
+	bool     tick();
+	uint16_t currentCommand();
+	uint8_t  currentPacketID();
+	uint16_t currentReceived();
+	uint32_t currentMessageLen();
+	void     reset();
+
+
+	/*
+	 uint16_t Transfer::txObj(const T &val, const uint16_t &index=0, const uint16_t &len=sizeof(T))
+	 Description:
+	 ------------
+	  * Stuffs "len" number of bytes of an arbitrary object (byte, int,
+	  float, double, struct, etc...) into the transmit buffer (txBuff)
+	  starting at the index as specified by the argument "index"
+	 Inputs:
+	 -------
+	  * const T &val - Pointer to the object to be copied to the
+	  transmit buffer (txBuff)
+	  * const uint16_t &index - Starting index of the object within the
+	  transmit buffer (txBuff)
+	  * const uint16_t &len - Number of bytes of the object "val" to transmit
+	 Return:
+	 -------
+	  * uint16_t maxIndex - uint16_t maxIndex - Index of the transmit buffer (txBuff) that directly follows the bytes processed
+	  by the calling of this member function
+	*/
+	template <typename T>
+	uint16_t txObj(const T& val, const uint16_t& index = 0, const uint16_t& len = sizeof(T))
+	{
+		return packet.txObj(val, index, len);
+	}
+
+
+	/*
+	 uint16_t Transfer::rxObj(const T &val, const uint16_t &index=0, const uint16_t &len=sizeof(T))
+	 Description:
+	 ------------
+	  * Reads "len" number of bytes from the receive buffer (rxBuff)
+	  starting at the index as specified by the argument "index"
+	  into an arbitrary object (byte, int, float, double, struct, etc...)
+	 Inputs:
+	 -------
+	  * const T &val - Pointer to the object to be copied into from the
+	  receive buffer (rxBuff)
+	  * const uint16_t &index - Starting index of the object within the
+	  receive buffer (rxBuff)
+	  * const uint16_t &len - Number of bytes in the object "val" received
+	 Return:
+	 -------
+	  * uint16_t maxIndex - Index of the receive buffer (rxBuff) that directly follows the bytes processed
+	  by the calling of this member function
+	*/
+	template <typename T>
+	uint16_t rxObj(const T& val, const uint16_t& index = 0, const uint16_t& len = sizeof(T))
+	{
+		return packet.rxObj(val, index, len);
+	}
+
+
+	/*
+	 uint16_t Transfer::sendDatum(const T &val, const uint16_t &len=sizeof(T))
+	 Description:
+	 ------------
+	  * Stuffs "len" number of bytes of an arbitrary object (byte, int,
+	  float, double, struct, etc...) into the transmit buffer (txBuff)
+	  starting at the index as specified by the argument "index" and
+	  automatically transmits the bytes in an individual packet
+	 Inputs:
+	 -------
+	  * const T &val - Pointer to the object to be copied to the
+	  transmit buffer (txBuff)
+	  * const uint16_t &len - Number of bytes of the object "val" to transmit
+	 Return:
+	 -------
+	  * uint16_t - Number of payload bytes included in packet
+	*/
+	template <typename T>
+	uint16_t sendDatum(const T& val, const uint16_t& len = sizeof(T))
+	{
+		return self().sendData(packet.txObj(val, 0, len));
+	}
+
+
+	/*
+	 uint16_t Transfer::txSchema<Schema>(const T &val, const uint16_t &index=0)
+	 Description:
+	 ------------
+	  * Encodes the fields of "val" listed in "Schema" (a PacketSchema)
+	  into the transmit buffer (txBuff) starting at the index as
+	  specified by the argument "index"
+	 Inputs:
+	 -------
+	  * const T &val - Object to be encoded into the transmit buffer (txBuff)
+	  * const uint16_t &index - Starting index of the object within the
+	  transmit buffer (txBuff)
+	 Return:
+	 -------
+	  * uint16_t maxIndex - Index of the transmit buffer (txBuff) that directly follows the bytes processed
+	  by the calling of this member function
+	*/
+	template <typename Schema, typename T>
+	uint16_t txSchema(const T& val, const uint16_t& index = 0)
+	{
+		return packet.template txSchema<Schema>(val, index);
+	}
+
+
+	/*
+	 uint16_t Transfer::rxSchema<Schema>(T &val, const uint16_t &index=0)
+	 Description:
+	 ------------
+	  * Decodes the fields of "val" listed in "Schema" (a PacketSchema)
+	  from the receive buffer (rxBuff) starting at the index as specified
+	  by the argument "index"
+	 Inputs:
+	 -------
+	  * T &val - Object to be decoded into from the receive buffer (rxBuff)
+	  * const uint16_t &index - Starting index of the object within the
+	  receive buffer (rxBuff)
+	 Return:
+	 -------
+	  * uint16_t maxIndex - Index of the receive buffer (rxBuff) that directly follows the bytes processed
+	  by the calling of this member function
+	*/
+	template <typename Schema, typename T>
+	uint16_t rxSchema(T& val, const uint16_t& index = 0)
+	{
+		return packet.template rxSchema<Schema>(val, index);
+	}
+
+
+	/*
+	 uint16_t Transfer::sendSchema<Schema>(const T &val)
+	 Description:
+	 ------------
+	  * Encodes the fields of "val" listed in "Schema" (a PacketSchema)
+	  and automatically transmits them in an individual packet
+	 Inputs:
+	 -------
+	  * const T &val - Object to be sent
+	 Return:
+	 -------
+	  * uint16_t - Number of payload bytes included in packet
+	*/
+	template <typename Schema, typename T>
+	uint16_t sendSchema(const T& val)
+	{
+		return self().sendData(packet.template txSchema<Schema>(val));
+	}
+
+
+  protected: // <<---------------------------------------//protected
+	uint8_t  debug     = 0;
+	Stream*  debugPort = &Serial;
+	uint32_t timeout   = DEFAULT_TIMEOUT;
+	uint8_t  messageID = 0;
+	bool     rxPending = false; // Packet parsed while sending, reported by the next available()
+
+	uint8_t  rxChunk[Config::rxChunkSize]; // Bytes read from the transport but not parsed yet
+	uint16_t rxLen = 0;
+	uint16_t rxPos = 0;
+
+
+	void     beginTransfer(const configST& configs);
+	void     beginTransfer(const uint8_t& _debug, Stream& _debugPort, const uint32_t& _timeout);
+	uint16_t sendPacket(const uint16_t& messageLen, const uint16_t& command, const uint8_t& packetID);
+	uint16_t sendPacket(uint8_t arr[], const uint16_t& messageLen, const uint16_t& command, const uint8_t& packetID);
+	bool     parseReceived(bool& received);
+	bool     parseBytes(const uint8_t arr[], const uint16_t& len, uint16_t& consumed);
+
+	uint16_t readBytes(uint8_t arr[], const uint16_t& len);
+	bool     prepareSend(const uint16_t& messageLen);
+	bool     acceptPacket();
+	void     afterAvailable();
+
+
+	TransportPolicy& self()
+	{
+		return *static_cast<TransportPolicy*>(this);
+	}
+};
+
+
+/*
+ void Transfer::beginTransfer(const configST& configs)
+ Description:
+ ------------
+  * Applies the transport-independent settings of "configs"
+ Inputs:
+ -------
+  * const configST& configs - Struct that holds config
+  values for all possible initialization parameters
+ Return:
+ -------
+  * void
+*/
+template <typename TransportPolicy, typename Config>
+void Transfer<TransportPolicy, Config>::beginTransfer(const configST& configs)
+{
+	debug     = configs.debug;
+	debugPort = configs.debugPort;
+	timeout   = configs.timeout;
+	rxPending = false;
+	rxLen     = 0;
+	rxPos     = 0;
+	packet.begin(configs);
+}
+
+
+/*
+ void Transfer::beginTransfer(const uint8_t& _debug, Stream& _debugPort, const uint32_t& _timeout)
+ Description:
+ ------------
+  * Applies the transport-independent settings of a simple initializer
+ Inputs:
+ -------
+  * const uint8_t& _debug - Whether or not to print error messages; 0 = none, 1+ = errors (per-byte tracing is done by configST.trace)
+  * Stream& _debugPort - Serial port to print error messages
+  * const uint32_t& _timeout - ms before a partially received packet goes stale
+ Return:
+ -------
+  * void
+*/
+template <typename TransportPolicy, typename Config>
+void Transfer<TransportPolicy, Config>::beginTransfer(const uint8_t& _debug, Stream& _debugPort, const uint32_t& _timeout)
+{
+	debug     = _debug;
+	debugPort = &_debugPort;
+	timeout   = _timeout;
+	rxPending = false;
+	rxLen     = 0;
+	rxPos     = 0;
+	packet.begin(_debug, _debugPort, _timeout);
+}
+
+
+/*
+ uint16_t Transfer::sendData(const uint16_t &messageLen, const uint16_t command, const uint8_t packetID)
+ Description:
+ ------------
+  * Send a specified number of bytes in packetized form
+ Inputs:
+ -------
+  * const uint16_t &messageLen - Number of values in txBuff
+  to send as the payload in the next packet
+  * const uint16_t command - The packet 16-bit command
+  * const uint8_t packetID - The packet 8-bit identifier
+ Return:
+ -------
+  * uint16_t numBytesIncl - Number of payload bytes included in packet
+  (0 if the transport could not send it)
+*/
+template <typename TransportPolicy, typename Config>
+uint16_t Transfer<TransportPolicy, Config>::sendData(const uint16_t& messageLen, const uint16_t command, const uint8_t packetID)
+{
+	return sendPacket(messageLen, command, packetID);
+}
+
+
+/*
+ uint16_t Transfer::sendChunk(const uint8_t data[], const uint16_t& len, const uint32_t& offset, const bool last, const uint16_t command, const uint8_t messageID)
+ Description:
+ ------------
+  * Send one fragment of a message that is larger than a single
+  packet. The receiver streams it to its chunk callback
+ Inputs:
+ -------
+  * const uint8_t data[] - Message bytes carried by this fragment
+  * const uint16_t& len - Number of bytes in data[] (at most
+  MAX_FRAGMENT_SIZE are sent, less with FEC or timestamps)
+  * const uint32_t& offset - Position of data[0] within the message
+  * const bool last - Whether or not this fragment ends the message
+  * const uint16_t command - The packet 16-bit command
+  * const uint8_t messageID - Identifier shared by all fragments of
+  the message
+ Return:
+ -------
+  * uint16_t - Number of message bytes included in packet
+*/
+template <typename TransportPolicy, typename Config>
+uint16_t Transfer<TransportPolicy, Config>::sendChunk(const uint8_t data[], const uint16_t& len, const uint32_t& offset, const bool last, const uint16_t command, const uint8_t messageID)
+{
+	uint16_t payloadLen = packet.txChunk(data, len, offset, last, messageID);
+
+	if (!sendPacket(payloadLen, command | FRAGMENT_FLAG, 0))
+		return 0;
+
+	return payloadLen - FRAGMENT_HEADER_SIZE;
+}
+
+
+/*
+ uint32_t Transfer::sendLarge(const uint8_t data[], const uint32_t& len, const uint16_t command)
+ Description:
+ ------------
+  * Send a message of any length split into as few fragments as
+  possible. The receiver either streams the fragments to its chunk
+  callback or reassembles them into its message buffer
+ Inputs:
+ -------
+  * const uint8_t data[] - Message to send
+  * const uint32_t& len - Number of bytes in data[]
+  * const uint16_t command - The packet 16-bit command shared by
+  all fragments
+ Return:
+ -------
+  * uint32_t - Number of message bytes sent
+*/
+template <typename TransportPolicy, typename Config>
+uint32_t Transfer<TransportPolicy, Config>::sendLarge(const uint8_t data[], const uint32_t& len, const uint16_t command)
+{
+	uint32_t offset  = 0;
+	uint16_t maxSize = packet.maxPayload() - FRAGMENT_HEADER_SIZE; // FEC parity and timestamps leave less than MAX_FRAGMENT_SIZE
+
+	do
+	{
+		uint16_t chunkLen = maxSize;
+		uint16_t sent;
+
+		if ((len - offset) < maxSize)
+			chunkLen = len - offset;
+
+		sent = sendChunk(data + offset, chunkLen, offset, (offset + chunkLen) == len, command, messageID);
+
+		if (!sent && chunkLen)
+			break;
+
+		offset += sent;
+	} while (offset < len);
+
+	messageID++;
+
+	return offset;
+}
+
+
+/*
+ uint16_t Transfer::sendStats(const uint8_t packetID)
+ Description:
+ ------------
+  * Sends this end's link statistics (packet.stats) as a
+  STATS_COMMAND control packet, built outside of txBuff so a message
+  being put together there with txObj() is left alone
+ Inputs:
+ -------
+  * const uint8_t packetID - The packet 8-bit identifier
+ Return:
+ -------
+  * uint16_t - Number of payload bytes included in packet
+  (0 if the transport could not send it)
+*/
+template <typename TransportPolicy, typename Config>
+uint16_t Transfer<TransportPolicy, Config>::sendStats(const uint8_t packetID)
+{
+	uint8_t buff[MAX_CONTROL_SIZE + FEC_MAX_PARITY];
+
+	return sendPacket(buff, Packet::writeStats(buff, packet.stats), STATS_COMMAND, packetID);
+}
+
+
+/*
+ uint16_t Transfer::available()
+ Description:
+ ------------
+  * Parses incoming data, analyzes packet contents,
+  and reports errors/successful packet reception
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t bytesRead - Num bytes in RX buffer
+*/
+template <typename TransportPolicy, typename Config>
+uint16_t Transfer<TransportPolicy, Config>::available()
+{
+	bool received;
+
+	if (rxPending) // Packet parsed while sending
+	{
+		rxPending = false;
+		return bytesRead;
+	}
+
+	if (!parseReceived(received) && !received)
+	{
+		bytesRead = packet.parse(0xFF, false);
+		status    = packet.status;
+
+		if (status <= 0)
+			self().reset();
+	}
+
+	self().afterAvailable();
+
+	return bytesRead;
+}
+
+
+/*
+ bool Transfer::tick()
+ Description:
+ ------------
+  * Checks to see if any packets have been fully parsed. This
+  is basically a wrapper around the method "available()" and
+  is used primarily in conjunction with callbacks
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not a full packet has been parsed
+*/
+template <typename TransportPolicy, typename Config>
+bool Transfer<TransportPolicy, Config>::tick()
+{
+	if (self().available())
+		return true;
+
+	return false;
+}
+
+
+/*
+ uint16_t Transfer::currentCommand()
+ Description:
+ ------------
+  * Returns the command of the last parsed packet
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - command of the last parsed packet
+*/
+template <typename TransportPolicy, typename Config>
+uint16_t Transfer<TransportPolicy, Config>::currentCommand()
+{
+	return packet.currentCommand();
+}
+
+
+/*
+ uint8_t Transfer::currentPacketID()
+ Description:
+ ------------
+  * Returns the ID of the last parsed packet
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint8_t - ID of the last parsed packet
+*/
+template <typename TransportPolicy, typename Config>
+uint8_t Transfer<TransportPolicy, Config>::currentPacketID()
+{
+	return packet.currentPacketID();
+}
+
+
+/*
+ uint16_t Transfer::currentReceived()
+ Description:
+ ------------
+  * Returns the received bytes of the last parsed packet
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - received bytes of the last parsed packet
+*/
+template <typename TransportPolicy, typename Config>
+uint16_t Transfer<TransportPolicy, Config>::currentReceived()
+{
+	return packet.currentReceived();
+}
+
+
+/*
+ uint32_t Transfer::currentMessageLen()
+ Description:
+ ------------
+  * Returns the length of the last completed fragmented message
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint32_t - length of the last completed fragmented message
+*/
+template <typename TransportPolicy, typename Config>
+uint32_t Transfer<TransportPolicy, Config>::currentMessageLen()
+{
+	return packet.currentMessageLen();
+}
+
+
+/*
+ void Transfer::reset()
+ Description:
+ ------------
+  * Clears out the tx, and rx buffers, plus resets
+  the "bytes read" variable, finite state machine, etc
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+template <typename TransportPolicy, typename Config>
+void Transfer<TransportPolicy, Config>::reset()
+{
+	packet.reset();
+	status = packet.status;
+}
+
+
+/*
+ uint16_t Transfer::sendPacket(const uint16_t& messageLen, const uint16_t& command, const uint8_t& packetID)
+ Description:
+ ------------
+  * Constructs a packet and hands it to the transport
+ Inputs:
+ -------
+  * const uint16_t& messageLen - Number of values in txBuff
+  to send as the payload in the next packet
+  * const uint16_t& command - The packet 16-bit command
+  * const uint8_t& packetID - The packet 8-bit identifier
+ Return:
+ -------
+  * uint16_t numBytesIncl - Number of payload bytes included in packet
+  (0 if the transport could not send it)
+*/
+template <typename TransportPolicy, typename Config>
+uint16_t Transfer<TransportPolicy, Config>::sendPacket(const uint16_t& messageLen, const uint16_t& command, const uint8_t& packetID)
+{
+	return sendPacket(packet.txBuff, messageLen, command, packetID);
+}
+
+
+/*
+ uint16_t Transfer::sendPacket(uint8_t arr[], const uint16_t& messageLen, const uint16_t& command, const uint8_t& packetID)
+ Description:
+ ------------
+  * Same as above, but for a payload held outside of txBuff. The
+  transport writes the frame before this returns, so arr[] may be a
+  local buffer
+ Inputs:
+ -------
+  * uint8_t arr[] - Payload to send, with room for FEC parity if enabled
+  * const uint16_t& messageLen - Number of values in arr[]
+  to send as the payload in the next packet
+  * const uint16_t& command - The packet 16-bit command
+  * const uint8_t& packetID - The packet 8-bit identifier
+ Return:
+ -------
+  * uint16_t numBytesIncl - Number of payload bytes included in packet
+  (0 if the transport could not send it)
+*/
+template <typename TransportPolicy, typename Config>
+uint16_t Transfer<TransportPolicy, Config>::sendPacket(uint8_t arr[], const uint16_t& messageLen, const uint16_t& command, const uint8_t& packetID)
+{
+	uint16_t numBytesIncl;
+
+	if (!self().prepareSend(messageLen))
+		return 0;
+
+	numBytesIncl = packet.constructPacket(arr, messageLen, command, packetID);
+
+	if (!self().writeFrame())
+		return 0;
+
+	packet.stats.framesOut++;
+	packet.stats.bytesOut += PREAMBLE_SIZE + packet.bytesToSend + POSTAMBLE_SIZE;
+
+	return numBytesIncl;
+}
+
+
+/*
+ bool Transfer::parseReceived(bool& received)
+ Description:
+ ------------
+  * Parses received bytes, reading more from the transport a chunk
+  at a time, until a packet is reported or an error is found
+ Inputs:
+ -------
+  * bool& received - Set if any bytes were parsed
+ Return:
+ -------
+  * bool - Whether or not parsing stopped on a packet or an error
+*/
+template <typename TransportPolicy, typename Config>
+bool Transfer<TransportPolicy, Config>::parseReceived(bool& received)
+{
+	received = false;
+
+	while (true)
+	{
+		uint16_t consumed;
+
+		if (rxPos == rxLen)
+		{
+			uint16_t want = packet.pendingBytes(); // Never read past the end of the packet, bytes after it stay with the transport
+
+			if (!want)
+				want = 1;
+			else if (want > sizeof(rxChunk))
+				want = sizeof(rxChunk);
+
+			rxPos = 0;
+			rxLen = self().readBytes(rxChunk, want);
+
+			if (!rxLen)
+				return false;
+		}
+
+		received = true;
+
+		if (parseBytes(rxChunk + rxPos, rxLen - rxPos, consumed))
+		{
+			rxPos += consumed;
+
+			if (rxPos > rxLen) // The transport's reset() dropped the chunk
+				rxPos = rxLen;
+
+			return true;
+		}
+
+		rxPos += consumed;
+	}
+}
+
+
+/*
+ bool Transfer::parseBytes(const uint8_t arr[], const uint16_t& len, uint16_t& consumed)
+ Description:
+ ------------
+  * Parses a block of received bytes until a packet is reported or an
+  error is found. Packets the transport consumes are skipped over
+ Inputs:
+ -------
+  * const uint8_t arr[] - Received bytes
+  * const uint16_t& len - Number of bytes in arr[]
+  * uint16_t& consumed - Set to the number of bytes of arr[] parsed
+ Return:
+ -------
+  * bool - Whether or not parsing stopped on a packet or an error
+*/
+template <typename TransportPolicy, typename Config>
+bool Transfer<TransportPolicy, Config>::parseBytes(const uint8_t arr[], const uint16_t& len, uint16_t& consumed)
+{
+	consumed  = 0;
+	bytesRead = 0;
+
+	while (consumed < len)
+	{
+		uint16_t parsed;
+
+		bytesRead = packet.parse(arr + consumed, len - consumed, parsed);
+		status    = packet.status;
+		consumed += parsed;
+
+		if (status == CONTINUE)
+			continue;
+
+		if (status <= 0)
+		{
+			self().reset();
+			return true;
+		}
+
+		if (self().acceptPacket())
+			return true;
+
+		bytesRead = 0;
+		status    = CONTINUE;
+	}
+
+	return false;
+}
+
+
+/*
+ uint16_t Transfer::readBytes(uint8_t arr[], const uint16_t& len)
+ Description:
+ ------------
+  * Default hook for transports that deliver received bytes some
+  other way (i.e. from an interrupt)
+ Inputs:
+ -------
+  * uint8_t arr[] - Buffer to copy received bytes into
+  * const uint16_t& len - Size of arr[]
+ Return:
+ -------
+  * uint16_t - Number of bytes copied into arr[]
+*/
+template <typename TransportPolicy, typename Config>
+uint16_t Transfer<TransportPolicy, Config>::readBytes(uint8_t arr[], const uint16_t& len)
+{
+	(void)arr;
+	(void)len;
+
+	return 0;
+}
+
+
+/*
+ bool Transfer::prepareSend(const uint16_t& messageLen)
+ Description:
+ ------------
+  * Default hook - always ready to send
+ Inputs:
+ -------
+  * const uint16_t& messageLen - Number of payload bytes to send
+ Return:
+ -------
+  * bool - Whether or not to go ahead with the send
+*/
+template <typename TransportPolicy, typename Config>
+bool Transfer<TransportPolicy, Config>::prepareSend(const uint16_t& messageLen)
+{
+	(void)messageLen;
+
+	return true;
+}
+
+
+/*
+ bool Transfer::acceptPacket()
+ Description:
+ ------------
+  * Default hook - every packet is reported
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not to report the packet
+*/
+template <typename TransportPolicy, typename Config>
+bool Transfer<TransportPolicy, Config>::acceptPacket()
+{
+	return true;
+}
+
+
+/*
+ void Transfer::afterAvailable()
+ Description:
+ ------------
+  * Default hook - nothing to do after available()
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+template <typename TransportPolicy, typename Config>
+void Transfer<TransportPolicy, Config>::afterAvailable()
+{
+}